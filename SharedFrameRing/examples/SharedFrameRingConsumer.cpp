@@ -0,0 +1,143 @@
+// Example consumer: follows a ring published by the webcam application and reports what it reads.
+// Usage: SharedFrameRingConsumer [name]
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "SharedFrameRing/SharedFrameRingReader.h"
+
+
+namespace
+{
+	// Works on the frame in place, like an analytics service would
+	double computeMeanValue(const SharedFrameRing::FrameView& frameView)
+	{
+		uint64_t sum = 0;
+		const uint32_t rowBytes = frameView.stride;
+
+		for (uint32_t row = 0; row < frameView.height; row++)
+		{
+			const uint8_t* rowData = frameView.data + static_cast<size_t>(row) * frameView.stride;
+
+			for (uint32_t column = 0; column < rowBytes; column++)
+			{
+				sum += rowData[column];
+			}
+		}
+
+		uint64_t valuesCount = static_cast<uint64_t>(rowBytes) * frameView.height;
+		return valuesCount != 0 ? static_cast<double>(sum) / valuesCount : 0.0;
+	}
+
+	const char* getFormatName(SharedFrameRing::FrameFormatEnum format)
+	{
+		switch (format)
+		{
+			case SharedFrameRing::FrameFormatEnum::Gray8:
+				return "Gray8";
+			case SharedFrameRing::FrameFormatEnum::Bgr8:
+				return "Bgr8";
+			default:
+				return "None";
+		}
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const std::string ringName = argc > 1 ? argv[1] : "/webcam_filters";
+
+	SharedFrameRing::SharedFrameRingReader reader;
+
+	std::cout << "Waiting for " << ringName << "...\n";
+	while (!reader.open(ringName))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	}
+
+	std::cout << "Opened " << ringName << " with " << reader.getSlotCount() << " slots\n";
+
+	uint64_t lastSequence = 0;
+	uint64_t readFramesCount = 0;
+	uint64_t missedFramesCount = 0;
+	uint64_t invalidatedFramesCount = 0;
+	double latencySumMilliseconds = 0.0;
+	bool frameFormatPrinted = false;
+
+	auto reportTime = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+	while (true)
+	{
+		SharedFrameRing::FrameView frameView;
+
+		// Larger frames make the writer replace the ring, the sequence continues in the new one.
+		// The name is missing for a moment in between.
+		if (!reader.isOpen() || reader.isClosed())
+		{
+			if (reader.open(ringName) && !reader.isClosed())
+			{
+				std::cout << "\nReopened " << ringName << ", layout " << reader.getLayoutSequence() << " with " << reader.getSlotCapacity() << " byte slots\n";
+				frameFormatPrinted = false;
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+
+			continue;
+		}
+
+		if (reader.acquireLatest(frameView, lastSequence))
+		{
+			double meanValue = computeMeanValue(frameView);
+
+			// The writer may have lapped the ring while the frame was read
+			if (reader.isValid(frameView))
+			{
+				if (lastSequence != 0)
+					missedFramesCount += frameView.sequence - lastSequence - 1;
+
+				auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+				latencySumMilliseconds += (now.count() - static_cast<int64_t>(frameView.timestampNanoseconds)) / 1e6;
+
+				readFramesCount++;
+
+				if (!frameFormatPrinted)
+				{
+					frameFormatPrinted = true;
+					std::cout << "Frames: " << frameView.width << "x" << frameView.height << " "
+						<< getFormatName(frameView.format) << ", stride " << frameView.stride << "\n";
+				}
+
+				std::cout << "Frame " << frameView.sequence << " mean " << meanValue << "\r";
+			}
+			else
+			{
+				invalidatedFramesCount++;
+			}
+
+			lastSequence = frameView.sequence;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		if (std::chrono::steady_clock::now() >= reportTime)
+		{
+			std::cout << "\nRead " << readFramesCount << " frames, missed " << missedFramesCount
+				<< ", invalidated " << invalidatedFramesCount
+				<< ", mean latency " << (readFramesCount != 0 ? latencySumMilliseconds / readFramesCount : 0.0) << " ms\n";
+
+			readFramesCount = 0;
+			missedFramesCount = 0;
+			invalidatedFramesCount = 0;
+			latencySumMilliseconds = 0.0;
+			reportTime += std::chrono::seconds(1);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+// Memory layout shared by the writer and every reader process.
+// The region starts with the ring header, followed by slotCount slots of slotStride bytes.
+// Each slot is a slot header followed by the frame rows.
+namespace SharedFrameRing
+{
+	constexpr uint32_t ringMagic = 0x52465753; // "SWFR"
+	constexpr uint32_t ringVersion = 2;
+
+	constexpr size_t cacheLineSize = 64;
+
+	enum class FrameFormatEnum : uint32_t
+	{
+		None = 0,
+		Gray8 = 1,
+		Bgr8 = 2
+	};
+
+	// Atomics are shared between processes, they must not fall back to a lock
+	static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+	struct alignas(cacheLineSize) RingHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+
+		// Bumped every time the writer replaces the ring under the same name, e.g. with larger slots
+		uint32_t layoutSequence;
+
+		uint32_t slotCount;
+		uint32_t slotCapacity;
+		uint64_t slotStride;
+		uint64_t slotsOffset;
+
+		// Sequence of the last published frame, 0 before the first one. It continues across layouts.
+		alignas(cacheLineSize) std::atomic<uint64_t> publishedSequence;
+		// Set before the writer unmaps the ring, readers open the name again to follow it
+		std::atomic<uint32_t> closed;
+	};
+
+	struct alignas(cacheLineSize) SlotHeader
+	{
+		// Sequence of the frame in the slot, 0 while the writer is replacing it
+		std::atomic<uint64_t> sequence;
+
+		// Nanoseconds of std::chrono::steady_clock, shared by all processes of the host
+		uint64_t timestampNanoseconds;
+
+		uint32_t width;
+		uint32_t height;
+		uint32_t stride;
+		FrameFormatEnum format;
+		uint64_t dataSize;
+	};
+
+	constexpr size_t alignToCacheLine(size_t size)
+	{
+		return (size + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+	}
+
+	constexpr size_t getSlotStride(size_t slotCapacity)
+	{
+		return alignToCacheLine(sizeof(SlotHeader) + slotCapacity);
+	}
+
+	constexpr size_t getRegionSize(size_t slotCount, size_t slotCapacity)
+	{
+		return alignToCacheLine(sizeof(RingHeader)) + slotCount * getSlotStride(slotCapacity);
+	}
+}
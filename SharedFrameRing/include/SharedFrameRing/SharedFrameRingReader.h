@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "SharedFrameRingLayout.h"
+#include "SharedMemoryRegion.h"
+
+
+namespace SharedFrameRing
+{
+	// A published frame read in place from the shared memory
+	struct FrameView
+	{
+		uint64_t sequence;
+		uint64_t timestampNanoseconds;
+
+		uint32_t width;
+		uint32_t height;
+		uint32_t stride;
+		FrameFormatEnum format;
+
+		const uint8_t* data;
+		uint64_t dataSize;
+	};
+
+	// Maps a ring read-only. Frames are not copied: check isValid after using the data,
+	// the writer may have reused the slot in the meantime.
+	class SharedFrameRingReader
+	{
+	public:
+		SharedFrameRingReader();
+
+		bool open(const std::string& name);
+		void close();
+
+		bool isOpen() const;
+		// The writer closed or replaced the ring, frames stop here. Opening the name again follows a replacement.
+		bool isClosed() const;
+
+		// The newest frame if it is newer than lastSequence, false when there is none or it is being replaced
+		bool acquireLatest(FrameView& frameView, uint64_t lastSequence = 0) const;
+
+		// True while the frame's slot still holds that frame
+		bool isValid(const FrameView& frameView) const;
+
+		uint64_t getPublishedSequence() const;
+		uint32_t getSlotCount() const;
+		uint32_t getSlotCapacity() const;
+		uint32_t getLayoutSequence() const;
+
+	private:
+		const SlotHeader* getSlot(uint64_t sequence) const;
+
+		SharedMemoryRegion m_Region;
+		const RingHeader* m_RingHeader;
+	};
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "SharedFrameRingLayout.h"
+#include "SharedMemoryRegion.h"
+
+
+namespace SharedFrameRing
+{
+	// Publishes frames into a ring of fixed slots. There is one writer per ring and it never waits for readers,
+	// a reader that is slower than slotCount frames sees its frame invalidated instead.
+	class SharedFrameRingWriter
+	{
+	public:
+		SharedFrameRingWriter();
+
+		// Creating again replaces the ring, readers see the old one closed and the new one with the next layout sequence
+		bool create(const std::string& name, uint32_t slotCount, uint32_t slotCapacity);
+		void close();
+
+		bool isOpen() const;
+		uint32_t getSlotCapacity() const;
+		uint32_t getLayoutSequence() const;
+
+		// Copies the rows into the next slot, returns false when the frame does not fit
+		bool publish(const uint8_t* data, size_t sourceStride, uint32_t width, uint32_t height, uint32_t bytesPerPixel,
+					 FrameFormatEnum format, uint64_t timestampNanoseconds);
+
+		uint64_t getPublishedSequence() const;
+
+	private:
+		SlotHeader* getSlot(uint64_t sequence) const;
+
+		SharedMemoryRegion m_Region;
+		RingHeader* m_RingHeader;
+
+		uint64_t m_Sequence;
+		uint32_t m_LayoutSequence;
+	};
+}
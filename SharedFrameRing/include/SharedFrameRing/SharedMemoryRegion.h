@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+namespace SharedFrameRing
+{
+	// Named shared memory: POSIX shm_open, or a named file mapping on Windows.
+	// The creator removes the name when the region is closed, mapped readers keep their view.
+	class SharedMemoryRegion
+	{
+	public:
+		SharedMemoryRegion();
+		~SharedMemoryRegion();
+
+		SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+		SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+		bool create(const std::string& name, size_t size);
+		bool openReadOnly(const std::string& name);
+		void close();
+
+		void* getData() const;
+		size_t getSize() const;
+
+	private:
+		void* m_Data;
+		size_t m_Size;
+
+		std::string m_Name;
+		bool m_Owner;
+
+#ifdef _WIN32
+		void* m_MappingHandle;
+#endif
+	};
+}
@@ -0,0 +1,120 @@
+#include "SharedFrameRing/SharedFrameRingReader.h"
+
+
+namespace SharedFrameRing
+{
+	SharedFrameRingReader::SharedFrameRingReader() :
+		m_RingHeader(nullptr)
+	{
+	}
+
+	bool SharedFrameRingReader::open(const std::string& name)
+	{
+		close();
+
+		if (!m_Region.openReadOnly(name))
+			return false;
+
+		if (m_Region.getSize() < sizeof(RingHeader))
+		{
+			close();
+			return false;
+		}
+
+		const RingHeader* ringHeader = static_cast<const RingHeader*>(m_Region.getData());
+
+		bool isValidRing = ringHeader->magic == ringMagic;
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		isValidRing = isValidRing && ringHeader->version == ringVersion && ringHeader->slotCount != 0 &&
+			ringHeader->slotsOffset + ringHeader->slotCount * ringHeader->slotStride <= m_Region.getSize();
+
+		if (!isValidRing)
+		{
+			close();
+			return false;
+		}
+
+		m_RingHeader = ringHeader;
+
+		return true;
+	}
+
+	void SharedFrameRingReader::close()
+	{
+		m_Region.close();
+		m_RingHeader = nullptr;
+	}
+
+	bool SharedFrameRingReader::isOpen() const
+	{
+		return m_RingHeader != nullptr;
+	}
+
+	bool SharedFrameRingReader::isClosed() const
+	{
+		return m_RingHeader != nullptr && m_RingHeader->closed.load(std::memory_order_acquire) != 0;
+	}
+
+	bool SharedFrameRingReader::acquireLatest(FrameView& frameView, uint64_t lastSequence) const
+	{
+		if (m_RingHeader == nullptr)
+			return false;
+
+		const uint64_t sequence = m_RingHeader->publishedSequence.load(std::memory_order_acquire);
+		if (sequence == 0 || sequence <= lastSequence)
+			return false;
+
+		const SlotHeader* slot = getSlot(sequence);
+
+		if (slot->sequence.load(std::memory_order_acquire) != sequence)
+			return false;
+
+		frameView.sequence = sequence;
+		frameView.timestampNanoseconds = slot->timestampNanoseconds;
+		frameView.width = slot->width;
+		frameView.height = slot->height;
+		frameView.stride = slot->stride;
+		frameView.format = slot->format;
+		frameView.dataSize = slot->dataSize;
+		frameView.data = reinterpret_cast<const uint8_t*>(slot + 1);
+
+		// The header fields above may already belong to the next frame
+		return isValid(frameView) && frameView.dataSize <= m_RingHeader->slotCapacity;
+	}
+
+	bool SharedFrameRingReader::isValid(const FrameView& frameView) const
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		return getSlot(frameView.sequence)->sequence.load(std::memory_order_relaxed) == frameView.sequence;
+	}
+
+	uint64_t SharedFrameRingReader::getPublishedSequence() const
+	{
+		return m_RingHeader != nullptr ? m_RingHeader->publishedSequence.load(std::memory_order_acquire) : 0;
+	}
+
+	uint32_t SharedFrameRingReader::getSlotCount() const
+	{
+		return m_RingHeader != nullptr ? m_RingHeader->slotCount : 0;
+	}
+
+	uint32_t SharedFrameRingReader::getSlotCapacity() const
+	{
+		return m_RingHeader != nullptr ? m_RingHeader->slotCapacity : 0;
+	}
+
+	uint32_t SharedFrameRingReader::getLayoutSequence() const
+	{
+		return m_RingHeader != nullptr ? m_RingHeader->layoutSequence : 0;
+	}
+
+	const SlotHeader* SharedFrameRingReader::getSlot(uint64_t sequence) const
+	{
+		const uint8_t* regionData = static_cast<const uint8_t*>(m_Region.getData());
+		uint64_t slotIndex = sequence % m_RingHeader->slotCount;
+
+		return reinterpret_cast<const SlotHeader*>(regionData + m_RingHeader->slotsOffset + slotIndex * m_RingHeader->slotStride);
+	}
+}
@@ -0,0 +1,131 @@
+#include "SharedFrameRing/SharedFrameRingWriter.h"
+
+#include <cstring>
+#include <new>
+
+
+namespace SharedFrameRing
+{
+	SharedFrameRingWriter::SharedFrameRingWriter() :
+		m_RingHeader(nullptr),
+		m_Sequence(0),
+		m_LayoutSequence(0)
+	{
+	}
+
+	bool SharedFrameRingWriter::create(const std::string& name, uint32_t slotCount, uint32_t slotCapacity)
+	{
+		close();
+
+		if (slotCount == 0 || !m_Region.create(name, getRegionSize(slotCount, slotCapacity)))
+			return false;
+
+		uint8_t* regionData = static_cast<uint8_t*>(m_Region.getData());
+
+		// New mappings are zero filled, every slot starts out empty
+		m_RingHeader = new (regionData) RingHeader();
+		m_RingHeader->slotCount = slotCount;
+		m_RingHeader->slotCapacity = slotCapacity;
+		m_RingHeader->slotStride = getSlotStride(slotCapacity);
+		m_RingHeader->slotsOffset = alignToCacheLine(sizeof(RingHeader));
+		m_RingHeader->layoutSequence = ++m_LayoutSequence;
+		m_RingHeader->publishedSequence.store(m_Sequence, std::memory_order_relaxed);
+		m_RingHeader->closed.store(0, std::memory_order_relaxed);
+
+		for (uint32_t slotIndex = 0; slotIndex < slotCount; slotIndex++)
+		{
+			SlotHeader* slot = new (regionData + m_RingHeader->slotsOffset + slotIndex * m_RingHeader->slotStride) SlotHeader();
+			slot->sequence.store(0, std::memory_order_relaxed);
+		}
+
+		m_RingHeader->version = ringVersion;
+
+		// Readers check the magic last, the layout fields are complete once it is visible
+		std::atomic_thread_fence(std::memory_order_release);
+		m_RingHeader->magic = ringMagic;
+
+		return true;
+	}
+
+	void SharedFrameRingWriter::close()
+	{
+		if (m_RingHeader != nullptr)
+			m_RingHeader->closed.store(1, std::memory_order_release);
+
+		m_Region.close();
+		m_RingHeader = nullptr;
+	}
+
+	bool SharedFrameRingWriter::isOpen() const
+	{
+		return m_RingHeader != nullptr;
+	}
+
+	uint32_t SharedFrameRingWriter::getSlotCapacity() const
+	{
+		return m_RingHeader != nullptr ? m_RingHeader->slotCapacity : 0;
+	}
+
+	bool SharedFrameRingWriter::publish(const uint8_t* data, size_t sourceStride, uint32_t width, uint32_t height, uint32_t bytesPerPixel,
+										FrameFormatEnum format, uint64_t timestampNanoseconds)
+	{
+		const uint32_t stride = width * bytesPerPixel;
+		const uint64_t dataSize = static_cast<uint64_t>(stride) * height;
+
+		if (m_RingHeader == nullptr || dataSize > m_RingHeader->slotCapacity)
+			return false;
+
+		const uint64_t sequence = m_Sequence + 1;
+		SlotHeader* slot = getSlot(sequence);
+
+		// Readers holding the previous frame of this slot see it disappear before any byte changes
+		slot->sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		slot->timestampNanoseconds = timestampNanoseconds;
+		slot->width = width;
+		slot->height = height;
+		slot->stride = stride;
+		slot->format = format;
+		slot->dataSize = dataSize;
+
+		uint8_t* slotData = reinterpret_cast<uint8_t*>(slot + 1);
+
+		if (sourceStride == stride)
+		{
+			std::memcpy(slotData, data, dataSize);
+		}
+		else
+		{
+			for (uint32_t row = 0; row < height; row++)
+			{
+				std::memcpy(slotData + static_cast<size_t>(row) * stride, data + row * sourceStride, stride);
+			}
+		}
+
+		slot->sequence.store(sequence, std::memory_order_release);
+		m_RingHeader->publishedSequence.store(sequence, std::memory_order_release);
+
+		m_Sequence = sequence;
+
+		return true;
+	}
+
+	uint32_t SharedFrameRingWriter::getLayoutSequence() const
+	{
+		return m_RingHeader != nullptr ? m_RingHeader->layoutSequence : 0;
+	}
+
+	uint64_t SharedFrameRingWriter::getPublishedSequence() const
+	{
+		return m_Sequence;
+	}
+
+	SlotHeader* SharedFrameRingWriter::getSlot(uint64_t sequence) const
+	{
+		uint8_t* regionData = static_cast<uint8_t*>(m_Region.getData());
+		uint64_t slotIndex = sequence % m_RingHeader->slotCount;
+
+		return reinterpret_cast<SlotHeader*>(regionData + m_RingHeader->slotsOffset + slotIndex * m_RingHeader->slotStride);
+	}
+}
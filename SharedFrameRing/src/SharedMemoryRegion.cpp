@@ -0,0 +1,160 @@
+#include "SharedFrameRing/SharedMemoryRegion.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace SharedFrameRing
+{
+#ifdef _WIN32
+	namespace
+	{
+		// POSIX names start with a slash, mapping names may not contain one
+		std::string getMappingName(const std::string& name)
+		{
+			return "Local\\" + (name.empty() == false && name.front() == '/' ? name.substr(1) : name);
+		}
+	}
+#endif
+
+	SharedMemoryRegion::SharedMemoryRegion() :
+		m_Data(nullptr),
+		m_Size(0),
+		m_Owner(false)
+#ifdef _WIN32
+		, m_MappingHandle(nullptr)
+#endif
+	{
+	}
+
+	SharedMemoryRegion::~SharedMemoryRegion()
+	{
+		close();
+	}
+
+	bool SharedMemoryRegion::create(const std::string& name, size_t size)
+	{
+		close();
+
+#ifdef _WIN32
+		uint64_t mappingSize = size;
+		m_MappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+											 static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize),
+											 getMappingName(name).c_str());
+		if (m_MappingHandle == nullptr)
+			return false;
+
+		m_Data = MapViewOfFile(m_MappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+#else
+		// A region left behind by a crashed writer is replaced
+		shm_unlink(name.c_str());
+
+		int fileDescriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fileDescriptor == -1)
+			return false;
+
+		if (ftruncate(fileDescriptor, static_cast<off_t>(size)) == 0)
+		{
+			void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+			m_Data = data == MAP_FAILED ? nullptr : data;
+		}
+
+		::close(fileDescriptor);
+#endif
+
+		m_Name = name;
+		m_Owner = true;
+		m_Size = size;
+
+		if (m_Data == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SharedMemoryRegion::openReadOnly(const std::string& name)
+	{
+		close();
+
+#ifdef _WIN32
+		m_MappingHandle = OpenFileMappingA(FILE_MAP_READ, FALSE, getMappingName(name).c_str());
+		if (m_MappingHandle == nullptr)
+			return false;
+
+		m_Data = MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+		MEMORY_BASIC_INFORMATION memoryInformation;
+		if (m_Data != nullptr && VirtualQuery(m_Data, &memoryInformation, sizeof(memoryInformation)) != 0)
+			m_Size = memoryInformation.RegionSize;
+#else
+		int fileDescriptor = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fileDescriptor == -1)
+			return false;
+
+		struct stat fileStatus;
+		if (fstat(fileDescriptor, &fileStatus) == 0 && fileStatus.st_size > 0)
+		{
+			m_Size = static_cast<size_t>(fileStatus.st_size);
+
+			void* data = mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+			m_Data = data == MAP_FAILED ? nullptr : data;
+		}
+
+		::close(fileDescriptor);
+#endif
+
+		m_Name = name;
+		m_Owner = false;
+
+		if (m_Data == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void SharedMemoryRegion::close()
+	{
+#ifdef _WIN32
+		if (m_Data != nullptr)
+			UnmapViewOfFile(m_Data);
+
+		if (m_MappingHandle != nullptr)
+			CloseHandle(m_MappingHandle);
+
+		m_MappingHandle = nullptr;
+#else
+		if (m_Data != nullptr)
+			munmap(m_Data, m_Size);
+
+		if (m_Owner)
+			shm_unlink(m_Name.c_str());
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Name.clear();
+		m_Owner = false;
+	}
+
+	void* SharedMemoryRegion::getData() const
+	{
+		return m_Data;
+	}
+
+	size_t SharedMemoryRegion::getSize() const
+	{
+		return m_Size;
+	}
+}
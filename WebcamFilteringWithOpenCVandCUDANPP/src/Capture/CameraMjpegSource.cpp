@@ -0,0 +1,53 @@
+#include "CameraMjpegSource.h"
+
+#include <iostream>
+
+
+CameraMjpegSource::CameraMjpegSource(int cameraIndex, const CaptureSettings& captureSettings) :
+	m_CameraIndex(cameraIndex),
+	m_CaptureSettings(captureSettings)
+{
+}
+
+bool CameraMjpegSource::open()
+{
+	m_CamCapture = cv::VideoCapture(m_CameraIndex, m_CaptureSettings.backend);
+
+	m_CamCapture.set(cv::CAP_PROP_FRAME_WIDTH, m_CaptureSettings.width);
+	m_CamCapture.set(cv::CAP_PROP_FRAME_HEIGHT, m_CaptureSettings.height);
+
+	m_CamCapture.set(cv::CAP_PROP_FPS, m_CaptureSettings.fps);
+
+	m_CamCapture.set(cv::CAP_PROP_FOURCC, m_CaptureSettings.getFourccCode());
+
+	// Hand out the raw MJPG payload, decoding is done on the worker pool
+	if (m_CaptureSettings.isMjpeg())
+		m_CamCapture.set(cv::CAP_PROP_CONVERT_RGB, 0);
+
+	if (!m_CamCapture.isOpened())
+	{
+		std::cout << "Error: Could not open camera. \n";
+		return false;
+	}
+
+	double actualWidth = m_CamCapture.get(cv::CAP_PROP_FRAME_WIDTH);
+	double actualHeight = m_CamCapture.get(cv::CAP_PROP_FRAME_HEIGHT);
+	double actualFps = m_CamCapture.get(cv::CAP_PROP_FPS);
+
+	std::cout
+		<< "Camera capture initialized!"
+		<< "-----------------------------------------\n"
+		<< "Actual capture resolution:\n"
+		<< actualWidth << "x" << actualHeight << " @ " << actualFps << " fps, " << m_CaptureSettings.fourcc
+		<< " via " << CaptureSettings::getBackendName(m_CaptureSettings.backend) << "\n"
+		<< "-----------------------------------------";
+
+	return true;
+}
+
+bool CameraMjpegSource::grabCompressedFrame(cv::Mat& compressedFrame)
+{
+	m_CamCapture >> compressedFrame;
+
+	return compressedFrame.empty() == false;
+}
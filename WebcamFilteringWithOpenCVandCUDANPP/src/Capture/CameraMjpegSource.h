@@ -0,0 +1,25 @@
+#pragma once
+
+#include <opencv4/opencv2/videoio.hpp>
+
+#include "CaptureSettings.h"
+#include "CompressedFrameSource.h"
+
+
+// MJPG frames are handed out compressed. A camera opened in another format delivers BGR frames,
+// which the decode stage passes through.
+class CameraMjpegSource :
+	public CompressedFrameSource
+{
+public:
+	CameraMjpegSource(int cameraIndex, const CaptureSettings& captureSettings);
+
+	bool open() override;
+	bool grabCompressedFrame(cv::Mat& compressedFrame) override;
+
+private:
+	int m_CameraIndex;
+	CaptureSettings m_CaptureSettings;
+
+	cv::VideoCapture m_CamCapture;
+};
@@ -0,0 +1,67 @@
+#include "CaptureSettings.h"
+
+#include <utility>
+
+#include <opencv4/opencv2/videoio.hpp>
+
+
+namespace
+{
+	const std::pair<const char*, int> backendNames[] = {
+		{ "any", cv::CAP_ANY },
+		{ "dshow", cv::CAP_DSHOW },
+		{ "msmf", cv::CAP_MSMF },
+		{ "v4l2", cv::CAP_V4L2 },
+		{ "gstreamer", cv::CAP_GSTREAMER },
+		{ "ffmpeg", cv::CAP_FFMPEG },
+		{ "avfoundation", cv::CAP_AVFOUNDATION }
+	};
+}
+
+
+CaptureSettings::CaptureSettings() :
+#ifdef _WIN32
+	backend(cv::CAP_DSHOW)
+#else
+	backend(cv::CAP_ANY)
+#endif
+{
+}
+
+bool CaptureSettings::isMjpeg() const
+{
+	return fourcc == "MJPG";
+}
+
+int CaptureSettings::getFourccCode() const
+{
+	if (fourcc.size() != 4)
+		return 0;
+
+	return cv::VideoWriter::fourcc(fourcc[0], fourcc[1], fourcc[2], fourcc[3]);
+}
+
+bool CaptureSettings::parseBackend(const std::string& backendName, int& backend)
+{
+	for (const auto& backendNameEntry : backendNames)
+	{
+		if (backendName == backendNameEntry.first)
+		{
+			backend = backendNameEntry.second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string CaptureSettings::getBackendName(int backend)
+{
+	for (const auto& backendNameEntry : backendNames)
+	{
+		if (backend == backendNameEntry.second)
+			return backendNameEntry.first;
+	}
+
+	return std::to_string(backend);
+}
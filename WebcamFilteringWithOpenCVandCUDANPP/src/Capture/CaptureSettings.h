@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+
+// Mode a camera is asked for. A camera that has no such mode picks the closest one, the source reports what it got.
+struct CaptureSettings
+{
+	int width = 1280;
+	int height = 720;
+	double fps = 60.0;
+	// MJPG is decoded on the worker pool, other formats are converted to BGR by the capture backend
+	std::string fourcc = "MJPG";
+	// cv::VideoCaptureAPIs, DirectShow on Windows and the first working one elsewhere
+	int backend;
+
+	CaptureSettings();
+
+	bool isMjpeg() const;
+	int getFourccCode() const;
+
+	// Names like "dshow", "msmf", "v4l2", "gstreamer", "ffmpeg", "avfoundation" or "any"
+	static bool parseBackend(const std::string& backendName, int& backend);
+	static std::string getBackendName(int backend);
+};
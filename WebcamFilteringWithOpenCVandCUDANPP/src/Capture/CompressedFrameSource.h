@@ -0,0 +1,15 @@
+#pragma once
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+
+// Source of still compressed frames, decoded later by MjpegDecodeStage.
+// A compressed frame is a single row CV_8UC1 mat holding the JPEG bytes.
+class CompressedFrameSource
+{
+public:
+	virtual ~CompressedFrameSource() = default;
+
+	virtual bool open() = 0;
+	virtual bool grabCompressedFrame(cv::Mat& compressedFrame) = 0;
+};
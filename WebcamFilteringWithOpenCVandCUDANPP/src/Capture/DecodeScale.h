@@ -0,0 +1,25 @@
+#pragma once
+
+// DCT domain downscaling done by the JPEG decoder itself
+enum class DecodeScaleEnum
+{
+	Full,
+	Half,
+	Quarter,
+	Eighth
+};
+
+inline int getDecodeScaleDivisor(DecodeScaleEnum decodeScale)
+{
+	switch (decodeScale)
+	{
+		case DecodeScaleEnum::Half:
+			return 2;
+		case DecodeScaleEnum::Quarter:
+			return 4;
+		case DecodeScaleEnum::Eighth:
+			return 8;
+		default:
+			return 1;
+	}
+}
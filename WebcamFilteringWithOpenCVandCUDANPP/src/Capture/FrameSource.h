@@ -0,0 +1,14 @@
+#pragma once
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+
+// Source of decoded BGR frames for the controller
+class FrameSource
+{
+public:
+	virtual ~FrameSource() = default;
+
+	virtual bool open() = 0;
+	virtual bool grabFrame(cv::Mat& frame) = 0;
+};
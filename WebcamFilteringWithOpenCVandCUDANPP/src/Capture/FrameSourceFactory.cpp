@@ -0,0 +1,88 @@
+#include "FrameSourceFactory.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "CameraMjpegSource.h"
+#include "MjpegDecodeStage.h"
+#include "MjpegFileSource.h"
+#include "RawFrameFileSource.h"
+
+
+namespace
+{
+	bool isCameraIndex(const std::string& sourceName)
+	{
+		return sourceName.empty() == false &&
+			std::all_of(sourceName.begin(), sourceName.end(), [](unsigned char character) { return std::isdigit(character) != 0; });
+	}
+}
+
+
+namespace FrameSourceFactory
+{
+	std::unique_ptr<FrameSource> createFrameSource(const std::string& sourceName,
+												   WorkerPool& workerPool,
+												   FrameBufferPool* frameBufferPool,
+												   DecodeScaleEnum decodeScale,
+												   int repeatCount,
+												   double playbackFps,
+												   const CaptureSettings& captureSettings)
+	{
+		// Raw frames are handed out as they are mapped, there is nothing to decode
+		if (RawFrameFileSource::isRawFramePath(sourceName))
+			return std::make_unique<RawFrameFileSource>(sourceName, repeatCount, playbackFps);
+
+		std::unique_ptr<CompressedFrameSource> compressedSource;
+
+		if (isCameraIndex(sourceName))
+			compressedSource = std::make_unique<CameraMjpegSource>(std::stoi(sourceName), captureSettings);
+		else
+			compressedSource = std::make_unique<MjpegFileSource>(sourceName, repeatCount, playbackFps);
+
+		return std::make_unique<MjpegDecodeStage>(std::move(compressedSource), workerPool, decodeScale, 0, frameBufferPool);
+	}
+
+	bool probeFrameSource(const std::string& sourceName,
+						  const CaptureSettings& captureSettings,
+						  DecodeScaleEnum decodeScale,
+						  double playbackFps,
+						  FrameSourceProbe& frameSourceProbe)
+	{
+		frameSourceProbe.frameType = CV_8UC3;
+		frameSourceProbe.framesPerSecond = playbackFps;
+
+		// Raw frames are replayed at the playback rate too, not at the recorded one
+		if (RawFrameFileSource::isRawFramePath(sourceName))
+		{
+			double recordedFps = 0.0;
+
+			frameSourceProbe.kind = FrameSourceKindEnum::RawFrames;
+			return RawFrameFileSource::probeFrameFormat(sourceName, frameSourceProbe.frameSize, frameSourceProbe.frameType, recordedFps);
+		}
+
+		cv::Size frameSize;
+		int scaleDivisor = getDecodeScaleDivisor(decodeScale);
+
+		if (isCameraIndex(sourceName))
+		{
+			frameSourceProbe.kind = FrameSourceKindEnum::Camera;
+			frameSourceProbe.framesPerSecond = captureSettings.fps;
+			frameSize = cv::Size(captureSettings.width, captureSettings.height);
+		}
+		else
+		{
+			frameSourceProbe.kind = FrameSourceKindEnum::MjpegFile;
+			if (!MjpegFileSource::probeFrameSize(sourceName, frameSize))
+				return false;
+		}
+
+		// The decoder rounds a reduced size up, frames of other formats are resized down
+		if (frameSourceProbe.kind == FrameSourceKindEnum::Camera && !captureSettings.isMjpeg())
+			frameSourceProbe.frameSize = cv::Size(frameSize.width / scaleDivisor, frameSize.height / scaleDivisor);
+		else
+			frameSourceProbe.frameSize = cv::Size((frameSize.width + scaleDivisor - 1) / scaleDivisor, (frameSize.height + scaleDivisor - 1) / scaleDivisor);
+
+		return true;
+	}
+}
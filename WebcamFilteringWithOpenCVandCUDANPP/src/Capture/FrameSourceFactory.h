@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "CaptureSettings.h"
+#include "DecodeScale.h"
+#include "FrameSource.h"
+
+class FrameBufferPool;
+class WorkerPool;
+
+
+enum class FrameSourceKindEnum
+{
+	Camera,
+	MjpegFile,
+	RawFrames
+};
+
+// What a source will deliver, known before it is opened
+struct FrameSourceProbe
+{
+	FrameSourceKindEnum kind;
+	cv::Size frameSize;
+	int frameType;
+	// 0 is as fast as frames are consumed
+	double framesPerSecond;
+};
+
+namespace FrameSourceFactory
+{
+	// A number opens that camera in the capture settings' mode, a ".rawframes" file is replayed from a memory map,
+	// anything else is a pre-recorded MJPEG stream. The decode scale does not apply to raw frames.
+	// Streams are looped (repeat count 0) and paced at playbackFps unless it is 0.
+	std::unique_ptr<FrameSource> createFrameSource(const std::string& sourceName,
+												   WorkerPool& workerPool,
+												   FrameBufferPool* frameBufferPool = nullptr,
+												   DecodeScaleEnum decodeScale = DecodeScaleEnum::Full,
+												   int repeatCount = 0,
+												   double playbackFps = 0.0,
+												   const CaptureSettings& captureSettings = CaptureSettings());
+
+	// Files are read only as far as their header, a camera is not opened and reports the requested mode.
+	// False when the file cannot be read.
+	bool probeFrameSource(const std::string& sourceName,
+						  const CaptureSettings& captureSettings,
+						  DecodeScaleEnum decodeScale,
+						  double playbackFps,
+						  FrameSourceProbe& frameSourceProbe);
+}
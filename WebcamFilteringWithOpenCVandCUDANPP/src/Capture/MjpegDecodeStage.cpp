@@ -0,0 +1,174 @@
+#include "MjpegDecodeStage.h"
+
+#include <opencv4/opencv2/imgcodecs.hpp>
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include "Frames/FrameBufferPool.h"
+#include "Threading/WorkerPool.h"
+
+
+namespace
+{
+	int getImreadMode(DecodeScaleEnum decodeScale)
+	{
+		switch (decodeScale)
+		{
+			case DecodeScaleEnum::Half:
+				return cv::IMREAD_REDUCED_COLOR_2;
+			case DecodeScaleEnum::Quarter:
+				return cv::IMREAD_REDUCED_COLOR_4;
+			case DecodeScaleEnum::Eighth:
+				return cv::IMREAD_REDUCED_COLOR_8;
+			default:
+				return cv::IMREAD_COLOR;
+		}
+	}
+}
+
+
+MjpegDecodeStage::MjpegDecodeStage(std::unique_ptr<CompressedFrameSource> compressedSource,
+								   WorkerPool& workerPool,
+								   DecodeScaleEnum decodeScale,
+								   size_t maxFramesInFlight,
+								   FrameBufferPool* frameBufferPool) :
+	m_CompressedSource(std::move(compressedSource)),
+	m_WorkerPool(workerPool),
+	m_DecodeScale(decodeScale),
+	m_MaxFramesInFlight(maxFramesInFlight),
+	m_FrameBufferPool(frameBufferPool),
+	m_DecodedWidth(0),
+	m_DecodedHeight(0),
+	m_SourceEnded(false)
+{
+	if (m_MaxFramesInFlight == 0)
+		m_MaxFramesInFlight = m_WorkerPool.getThreadCount();
+}
+
+MjpegDecodeStage::~MjpegDecodeStage()
+{
+	if (m_ReaderThread.joinable())
+	{
+		m_ReaderThread.request_stop();
+		m_ReaderThread.join();
+	}
+
+	// Decode tasks may still reference the source's memory
+	for (auto& inFlightFrame : m_InFlightFrames)
+	{
+		inFlightFrame.wait();
+	}
+}
+
+bool MjpegDecodeStage::open()
+{
+	if (!m_CompressedSource->open())
+		return false;
+
+	// Decodes are scheduled on the lane of the stream that opens the source
+	int schedulingLane = WorkerPool::getThreadLane();
+
+	m_ReaderThread = std::jthread([this, schedulingLane](std::stop_token stopToken)
+	{
+		WorkerPool::setThreadLane(schedulingLane);
+		readCompressedFramesThread(stopToken);
+	});
+
+	return true;
+}
+
+bool MjpegDecodeStage::grabFrame(cv::Mat& frame)
+{
+	std::future<cv::Mat> decodedFrame;
+
+	{
+		std::unique_lock<std::mutex> lock(m_InFlightMutex);
+		m_InFlightCondition.wait(lock, [this]() { return m_InFlightFrames.empty() == false || m_SourceEnded; });
+
+		if (m_InFlightFrames.empty())
+		{
+			frame.release();
+			return false;
+		}
+
+		decodedFrame = std::move(m_InFlightFrames.front());
+		m_InFlightFrames.pop_front();
+	}
+
+	m_InFlightCondition.notify_all();
+
+	frame = decodedFrame.get();
+
+	return frame.empty() == false;
+}
+
+DecodeScaleEnum MjpegDecodeStage::getDecodeScale() const
+{
+	return m_DecodeScale;
+}
+
+void MjpegDecodeStage::readCompressedFramesThread(std::stop_token stopToken)
+{
+	while (!stopToken.stop_requested())
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_InFlightMutex);
+			if (!m_InFlightCondition.wait(lock, stopToken, [this]() { return m_InFlightFrames.size() < m_MaxFramesInFlight; }))
+				break;
+		}
+
+		cv::Mat compressedFrame;
+		if (!m_CompressedSource->grabCompressedFrame(compressedFrame))
+			break;
+
+		std::future<cv::Mat> decodedFrame = m_WorkerPool.submit([this, compressedFrame]() { return decodeFrame(compressedFrame); });
+
+		{
+			std::lock_guard<std::mutex> lock(m_InFlightMutex);
+			m_InFlightFrames.push_back(std::move(decodedFrame));
+		}
+
+		m_InFlightCondition.notify_all();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_InFlightMutex);
+		m_SourceEnded = true;
+	}
+
+	m_InFlightCondition.notify_all();
+}
+
+cv::Mat MjpegDecodeStage::decodeFrame(const cv::Mat& compressedFrame)
+{
+	// Some capture backends ignore CAP_PROP_CONVERT_RGB and deliver decoded frames
+	if (compressedFrame.rows != 1 || compressedFrame.type() != CV_8UC1)
+	{
+		int scaleDivisor = getDecodeScaleDivisor(m_DecodeScale);
+		cv::Size scaledSize(compressedFrame.cols / scaleDivisor, compressedFrame.rows / scaleDivisor);
+
+		cv::Mat scaledFrame = acquireFrameBuffer(scaledSize, compressedFrame.type());
+		if (scaleDivisor == 1)
+			compressedFrame.copyTo(scaledFrame);
+		else
+			cv::resize(compressedFrame, scaledFrame, scaledSize, 0, 0, cv::INTER_AREA);
+
+		return scaledFrame;
+	}
+
+	// The size of a JPEG is only known once it is decoded, the stream's previous size is a safe guess
+	cv::Mat decodedFrame = acquireFrameBuffer(cv::Size(m_DecodedWidth, m_DecodedHeight), CV_8UC3);
+	cv::imdecode(compressedFrame, getImreadMode(m_DecodeScale), &decodedFrame);
+
+	m_DecodedWidth = decodedFrame.cols;
+	m_DecodedHeight = decodedFrame.rows;
+
+	return decodedFrame;
+}
+
+cv::Mat MjpegDecodeStage::acquireFrameBuffer(cv::Size size, int type)
+{
+	if (m_FrameBufferPool == nullptr || size.area() == 0)
+		return cv::Mat();
+
+	return m_FrameBufferPool->acquire(size, type);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "CompressedFrameSource.h"
+#include "DecodeScale.h"
+#include "FrameSource.h"
+
+class FrameBufferPool;
+class WorkerPool;
+
+
+// Pulls compressed frames on its own thread and decodes them on the worker pool.
+// Several frames are decoded at once, they are handed out in capture order.
+// With a buffer pool, decoded frames reuse pooled buffers once the decoded size is known.
+class MjpegDecodeStage :
+	public FrameSource
+{
+public:
+	MjpegDecodeStage(std::unique_ptr<CompressedFrameSource> compressedSource,
+					 WorkerPool& workerPool,
+					 DecodeScaleEnum decodeScale = DecodeScaleEnum::Full,
+					 size_t maxFramesInFlight = 0,
+					 FrameBufferPool* frameBufferPool = nullptr);
+	~MjpegDecodeStage() override;
+
+	bool open() override;
+	bool grabFrame(cv::Mat& frame) override;
+
+	DecodeScaleEnum getDecodeScale() const;
+
+private:
+	void readCompressedFramesThread(std::stop_token stopToken);
+	cv::Mat decodeFrame(const cv::Mat& compressedFrame);
+	cv::Mat acquireFrameBuffer(cv::Size size, int type);
+
+	std::unique_ptr<CompressedFrameSource> m_CompressedSource;
+	WorkerPool& m_WorkerPool;
+
+	DecodeScaleEnum m_DecodeScale;
+	size_t m_MaxFramesInFlight;
+
+	FrameBufferPool* m_FrameBufferPool;
+	std::atomic<int> m_DecodedWidth;
+	std::atomic<int> m_DecodedHeight;
+
+	std::mutex m_InFlightMutex;
+	std::condition_variable_any m_InFlightCondition;
+	std::deque<std::future<cv::Mat>> m_InFlightFrames;
+	bool m_SourceEnded;
+
+	std::jthread m_ReaderThread;
+};
@@ -0,0 +1,238 @@
+#include "MjpegFileSource.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+
+namespace
+{
+	constexpr uchar markerPrefix = 0xFF;
+	constexpr uchar startOfImage = 0xD8;
+	constexpr uchar endOfImage = 0xD9;
+	constexpr uchar startOfScan = 0xDA;
+
+	// The first frame's header is well within this
+	constexpr size_t probedBytesCount = 256 * 1024;
+
+	bool isStandaloneMarker(uchar marker)
+	{
+		return marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7);
+	}
+
+	// SOF0 to SOF15, without DHT, JPG and DAC which share the range
+	bool isStartOfFrameMarker(uchar marker)
+	{
+		return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+	}
+}
+
+
+MjpegFileSource::MjpegFileSource(const std::string& mjpegStreamPath, int repeatCount, double playbackFps) :
+	m_MjpegStreamPath(mjpegStreamPath),
+	m_RepeatCount(repeatCount),
+	m_FrameInterval(playbackFps > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / playbackFps)) :
+										std::chrono::steady_clock::duration::zero()),
+	m_NextFrameIndex(0),
+	m_CompletedRepeats(0)
+{
+}
+
+bool MjpegFileSource::open()
+{
+	std::ifstream mjpegStream(m_MjpegStreamPath, std::ios::binary);
+	if (!mjpegStream.is_open())
+	{
+		std::cout << "Error: Could not open MJPEG stream " << m_MjpegStreamPath << "\n";
+		return false;
+	}
+
+	m_StreamData.assign(std::istreambuf_iterator<char>(mjpegStream), std::istreambuf_iterator<char>());
+
+	if (!indexFrames())
+	{
+		std::cout << "Error: No JPEG frames found in " << m_MjpegStreamPath << "\n";
+		return false;
+	}
+
+	std::cout << "MJPEG stream loaded: " << m_FrameSpans.size() << " frames, "
+		<< m_StreamData.size() / (1024 * 1024) << " MiB\n";
+
+	return true;
+}
+
+bool MjpegFileSource::grabCompressedFrame(cv::Mat& compressedFrame)
+{
+	if (m_NextFrameIndex == m_FrameSpans.size())
+	{
+		m_CompletedRepeats++;
+		if (m_RepeatCount > 0 && m_CompletedRepeats >= m_RepeatCount)
+		{
+			compressedFrame.release();
+			return false;
+		}
+
+		m_NextFrameIndex = 0;
+	}
+
+	if (m_FrameInterval > std::chrono::steady_clock::duration::zero())
+	{
+		// A slightly late read does not shift the following frames, a consumer that fell far behind restarts the schedule
+		auto now = std::chrono::steady_clock::now();
+		if (m_NextFrameTime > now)
+			std::this_thread::sleep_until(m_NextFrameTime);
+		else if (now - m_NextFrameTime > m_FrameInterval)
+			m_NextFrameTime = now;
+
+		m_NextFrameTime += m_FrameInterval;
+	}
+
+	const FrameSpan& frameSpan = m_FrameSpans[m_NextFrameIndex++];
+
+	// Header over the loaded stream, no copy. The data lives as long as this source.
+	compressedFrame = cv::Mat(1, static_cast<int>(frameSpan.length), CV_8UC1, m_StreamData.data() + frameSpan.offset);
+
+	return true;
+}
+
+size_t MjpegFileSource::getFrameCount() const
+{
+	return m_FrameSpans.size();
+}
+
+bool MjpegFileSource::probeFrameSize(const std::string& mjpegStreamPath, cv::Size& frameSize)
+{
+	std::ifstream mjpegStream(mjpegStreamPath, std::ios::binary);
+	if (!mjpegStream.is_open())
+		return false;
+
+	std::vector<uchar> streamData(probedBytesCount);
+	mjpegStream.read(reinterpret_cast<char*>(streamData.data()), static_cast<std::streamsize>(streamData.size()));
+	streamData.resize(static_cast<size_t>(mjpegStream.gcount()));
+
+	size_t position = 0;
+	while (position + 1 < streamData.size() && (streamData[position] != markerPrefix || streamData[position + 1] != startOfImage))
+	{
+		position++;
+	}
+
+	position += 2;
+
+	while (position + 3 < streamData.size())
+	{
+		if (streamData[position] != markerPrefix)
+			return false;
+
+		uchar marker = streamData[position + 1];
+
+		if (marker == markerPrefix)
+		{
+			position++;
+			continue;
+		}
+
+		if (isStandaloneMarker(marker))
+		{
+			position += 2;
+			continue;
+		}
+
+		if (marker == startOfScan || marker == endOfImage)
+			return false;
+
+		// Length, precision, height, width
+		if (isStartOfFrameMarker(marker) && position + 8 < streamData.size())
+		{
+			int height = (streamData[position + 5] << 8) | streamData[position + 6];
+			int width = (streamData[position + 7] << 8) | streamData[position + 8];
+
+			frameSize = cv::Size(width, height);
+			return width > 0 && height > 0;
+		}
+
+		size_t segmentLength = (static_cast<size_t>(streamData[position + 2]) << 8) | streamData[position + 3];
+		position += 2 + segmentLength;
+	}
+
+	return false;
+}
+
+bool MjpegFileSource::indexFrames()
+{
+	m_FrameSpans.clear();
+
+	size_t position = 0;
+	while (position + 1 < m_StreamData.size())
+	{
+		if (m_StreamData[position] != markerPrefix || m_StreamData[position + 1] != startOfImage)
+		{
+			position++;
+			continue;
+		}
+
+		size_t endPosition = findEndOfImage(position);
+		if (endPosition == 0)
+			break;
+
+		m_FrameSpans.push_back({ position, endPosition - position });
+		position = endPosition;
+	}
+
+	return m_FrameSpans.empty() == false;
+}
+
+// Walks the marker segments instead of searching for the first FFD9,
+// which may belong to an embedded EXIF thumbnail
+size_t MjpegFileSource::findEndOfImage(size_t startOfImagePosition) const
+{
+	const size_t dataSize = m_StreamData.size();
+	size_t position = startOfImagePosition + 2;
+
+	while (position + 1 < dataSize)
+	{
+		if (m_StreamData[position] != markerPrefix)
+			return 0;
+
+		uchar marker = m_StreamData[position + 1];
+
+		if (marker == markerPrefix)
+		{
+			position++;
+			continue;
+		}
+
+		if (marker == endOfImage)
+			return position + 2;
+
+		if (isStandaloneMarker(marker))
+		{
+			position += 2;
+			continue;
+		}
+
+		if (position + 3 >= dataSize)
+			return 0;
+
+		size_t segmentLength = (static_cast<size_t>(m_StreamData[position + 2]) << 8) | m_StreamData[position + 3];
+		position += 2 + segmentLength;
+
+		if (marker != startOfScan)
+			continue;
+
+		// Entropy coded data: FF is either stuffed (FF00) or a restart marker until the next real marker
+		while (position + 1 < dataSize)
+		{
+			if (m_StreamData[position] == markerPrefix)
+			{
+				uchar nextByte = m_StreamData[position + 1];
+				if (nextByte != 0x00 && !(nextByte >= 0xD0 && nextByte <= 0xD7) && nextByte != markerPrefix)
+					break;
+			}
+
+			position++;
+		}
+	}
+
+	return 0;
+}
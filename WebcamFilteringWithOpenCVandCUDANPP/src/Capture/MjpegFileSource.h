@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "CompressedFrameSource.h"
+
+
+// Pre-recorded MJPEG stream (concatenated JPEG images, e.g. "ffmpeg -c:v copy -f mjpeg").
+// The whole file is loaded and indexed on open so that benchmarks do not measure disk reads.
+// A repeat count of 0 loops forever, without a playback rate frames are read as fast as they are consumed.
+class MjpegFileSource :
+	public CompressedFrameSource
+{
+public:
+	MjpegFileSource(const std::string& mjpegStreamPath, int repeatCount = 1, double playbackFps = 0.0);
+
+	bool open() override;
+	bool grabCompressedFrame(cv::Mat& compressedFrame) override;
+
+	size_t getFrameCount() const;
+
+	// Size of the first frame, read from its header without loading the stream or decoding
+	static bool probeFrameSize(const std::string& mjpegStreamPath, cv::Size& frameSize);
+
+private:
+	struct FrameSpan
+	{
+		size_t offset;
+		size_t length;
+	};
+
+	bool indexFrames();
+	size_t findEndOfImage(size_t startOfImage) const;
+
+	std::string m_MjpegStreamPath;
+	int m_RepeatCount;
+	std::chrono::steady_clock::duration m_FrameInterval;
+	std::chrono::steady_clock::time_point m_NextFrameTime;
+
+	std::vector<uchar> m_StreamData;
+	std::vector<FrameSpan> m_FrameSpans;
+
+	size_t m_NextFrameIndex;
+	int m_CompletedRepeats;
+};
@@ -0,0 +1,279 @@
+#include "RawFrameFileSource.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+	const std::string rawFrameExtension = ".rawframes";
+
+	// Frames requested from the disk ahead of the one handed out
+	constexpr size_t readAheadFramesCount = 2;
+}
+
+
+RawFrameFileSource::RawFrameFileSource(const std::string& path, int repeatCount, double playbackFps) :
+	m_Path(path),
+	m_RepeatCount(repeatCount),
+	m_FrameInterval(playbackFps > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / playbackFps)) :
+										std::chrono::steady_clock::duration::zero()),
+	m_MappedData(nullptr),
+	m_MappedSize(0),
+#ifdef _WIN32
+	m_FileHandle(nullptr),
+	m_MappingHandle(nullptr),
+#endif
+	m_FileHeader(),
+	m_NextFrameIndex(0),
+	m_CompletedRepeats(0)
+{
+}
+
+RawFrameFileSource::~RawFrameFileSource()
+{
+	unmapFile();
+}
+
+bool RawFrameFileSource::open()
+{
+	if (!mapFile())
+	{
+		std::cout << "Error: Could not map raw frames " << m_Path << "\n";
+		unmapFile();
+		return false;
+	}
+
+	if (!readIndex())
+	{
+		std::cout << "Error: No raw frames found in " << m_Path << "\n";
+		unmapFile();
+		return false;
+	}
+
+	double recordedSeconds = m_FrameIndex.back().timestampNanoseconds / 1e9;
+
+	std::cout << "Raw frames mapped: " << m_FrameIndex.size() << " frames of " << m_FileHeader.width << "x" << m_FileHeader.height
+		<< ", " << recordedSeconds << " s recorded, " << m_MappedSize / (1024 * 1024) << " MiB\n";
+
+	readAhead(0);
+
+	return true;
+}
+
+bool RawFrameFileSource::grabFrame(cv::Mat& frame)
+{
+	if (m_NextFrameIndex == m_FrameIndex.size())
+	{
+		m_CompletedRepeats++;
+		if (m_RepeatCount > 0 && m_CompletedRepeats >= m_RepeatCount)
+		{
+			frame.release();
+			return false;
+		}
+
+		m_NextFrameIndex = 0;
+	}
+
+	if (m_FrameInterval > std::chrono::steady_clock::duration::zero())
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (m_NextFrameTime > now)
+			std::this_thread::sleep_until(m_NextFrameTime);
+		else if (now - m_NextFrameTime > m_FrameInterval)
+			m_NextFrameTime = now;
+
+		m_NextFrameTime += m_FrameInterval;
+	}
+
+	readAhead(m_NextFrameIndex + 1);
+
+	const RawFrameLayout::FrameIndexEntry& frameIndexEntry = m_FrameIndex[m_NextFrameIndex++];
+
+	// Header over the mapped pages, no copy. The pages live as long as this source.
+	frame = cv::Mat(m_FileHeader.height, m_FileHeader.width, m_FileHeader.type, m_MappedData + frameIndexEntry.offset,
+					static_cast<size_t>(m_FileHeader.rowStride));
+
+	return true;
+}
+
+size_t RawFrameFileSource::getFrameCount() const
+{
+	return m_FrameIndex.size();
+}
+
+bool RawFrameFileSource::isRawFramePath(const std::string& path)
+{
+	return path.size() > rawFrameExtension.size() &&
+		path.compare(path.size() - rawFrameExtension.size(), rawFrameExtension.size(), rawFrameExtension) == 0;
+}
+
+bool RawFrameFileSource::probeFrameFormat(const std::string& path, cv::Size& frameSize, int& frameType, double& framesPerSecond)
+{
+	std::ifstream file(path, std::ios::binary);
+	RawFrameLayout::FileHeader fileHeader;
+
+	if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)))
+		return false;
+
+	if (fileHeader.magic != RawFrameLayout::fileMagic || fileHeader.version != RawFrameLayout::fileVersion ||
+		fileHeader.width <= 0 || fileHeader.height <= 0)
+	{
+		return false;
+	}
+
+	frameSize = cv::Size(fileHeader.width, fileHeader.height);
+	frameType = fileHeader.type;
+	framesPerSecond = fileHeader.framesPerSecond;
+
+	return true;
+}
+
+// Copy-on-write, a stage writing into a frame changes its own pages and not the recording
+bool RawFrameFileSource::mapFile()
+{
+	unmapFile();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(m_Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_FileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+		return false;
+
+	m_MappedSize = static_cast<uint64_t>(fileSize.QuadPart);
+
+	m_MappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (m_MappingHandle == nullptr)
+		return false;
+
+	m_MappedData = static_cast<uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_COPY, 0, 0, 0));
+#else
+	int fileDescriptor = ::open(m_Path.c_str(), O_RDONLY);
+	if (fileDescriptor == -1)
+		return false;
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) == 0 && fileStatus.st_size > 0)
+	{
+		m_MappedSize = static_cast<uint64_t>(fileStatus.st_size);
+
+		void* data = mmap(nullptr, m_MappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+		m_MappedData = data == MAP_FAILED ? nullptr : static_cast<uint8_t*>(data);
+
+		// Pages behind the replay position are dropped early, a long recording does not evict the rest of the page cache
+		if (m_MappedData != nullptr)
+			madvise(m_MappedData, m_MappedSize, MADV_SEQUENTIAL);
+	}
+
+	::close(fileDescriptor);
+#endif
+
+	return m_MappedData != nullptr;
+}
+
+void RawFrameFileSource::unmapFile()
+{
+#ifdef _WIN32
+	if (m_MappedData != nullptr)
+		UnmapViewOfFile(m_MappedData);
+
+	if (m_MappingHandle != nullptr)
+		CloseHandle(m_MappingHandle);
+
+	if (m_FileHandle != nullptr)
+		CloseHandle(m_FileHandle);
+
+	m_MappingHandle = nullptr;
+	m_FileHandle = nullptr;
+#else
+	if (m_MappedData != nullptr)
+		munmap(m_MappedData, m_MappedSize);
+#endif
+
+	m_MappedData = nullptr;
+	m_MappedSize = 0;
+	m_FrameIndex.clear();
+}
+
+// A recording that was not closed has no index, its complete frames are replayed at the recorded rate
+bool RawFrameFileSource::readIndex()
+{
+	if (m_MappedSize < RawFrameLayout::pageSize)
+		return false;
+
+	std::memcpy(&m_FileHeader, m_MappedData, sizeof(m_FileHeader));
+
+	if (m_FileHeader.magic != RawFrameLayout::fileMagic || m_FileHeader.version != RawFrameLayout::fileVersion ||
+		m_FileHeader.width <= 0 || m_FileHeader.height <= 0 || m_FileHeader.frameSize == 0 ||
+		m_FileHeader.rowStride < static_cast<uint64_t>(m_FileHeader.width) * CV_ELEM_SIZE(m_FileHeader.type) ||
+		m_FileHeader.rowStride * m_FileHeader.height != m_FileHeader.frameSize || m_FileHeader.frameStride < m_FileHeader.frameSize)
+	{
+		return false;
+	}
+
+	m_FrameIndex.clear();
+
+	const uint64_t indexSize = m_FileHeader.frameCount * sizeof(RawFrameLayout::FrameIndexEntry);
+
+	if (m_FileHeader.indexOffset != 0 && m_FileHeader.indexOffset + indexSize <= m_MappedSize)
+	{
+		const RawFrameLayout::FrameIndexEntry* frameIndex = reinterpret_cast<const RawFrameLayout::FrameIndexEntry*>(m_MappedData + m_FileHeader.indexOffset);
+		m_FrameIndex.assign(frameIndex, frameIndex + m_FileHeader.frameCount);
+	}
+	else
+	{
+		uint64_t framesCount = (m_MappedSize - RawFrameLayout::pageSize) / m_FileHeader.frameStride;
+		double framesPerSecond = m_FileHeader.framesPerSecond > 0.0 ? m_FileHeader.framesPerSecond : 30.0;
+
+		for (uint64_t frameIndex = 0; frameIndex < framesCount; frameIndex++)
+		{
+			m_FrameIndex.push_back({ RawFrameLayout::pageSize + frameIndex * m_FileHeader.frameStride,
+									 static_cast<uint64_t>(frameIndex * 1e9 / framesPerSecond) });
+		}
+	}
+
+	std::erase_if(m_FrameIndex, [this](const RawFrameLayout::FrameIndexEntry& frameIndexEntry)
+	{
+		return frameIndexEntry.offset % RawFrameLayout::pageSize != 0 || frameIndexEntry.offset + m_FileHeader.frameSize > m_MappedSize;
+	});
+
+	m_NextFrameIndex = 0;
+	m_CompletedRepeats = 0;
+
+	return m_FrameIndex.empty() == false;
+}
+
+// Starts reading the next frames from the disk while the current ones are processed
+void RawFrameFileSource::readAhead(size_t frameIndex) const
+{
+	for (size_t i = 0; i < readAheadFramesCount; i++, frameIndex++)
+	{
+		if (frameIndex >= m_FrameIndex.size())
+			frameIndex = 0;
+
+		uint8_t* frameData = m_MappedData + m_FrameIndex[frameIndex].offset;
+
+#ifdef _WIN32
+		WIN32_MEMORY_RANGE_ENTRY memoryRange = { frameData, static_cast<SIZE_T>(m_FileHeader.frameSize) };
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &memoryRange, 0);
+#else
+		madvise(frameData, m_FileHeader.frameSize, MADV_WILLNEED);
+#endif
+	}
+}
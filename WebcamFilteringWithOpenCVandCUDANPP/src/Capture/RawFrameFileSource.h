@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "FrameSource.h"
+#include "Output/RawFrameLayout.h"
+
+
+// Replays a recording written by RawFrameWriter (".rawframes") through a memory map.
+// Frames are handed out as headers over the mapped pages, nothing is decoded or copied, and the pages are read ahead
+// while the pipeline works. The mapping is copy-on-write, the file is never modified.
+// A repeat count of 0 loops forever, without a playback rate frames are read as fast as they are consumed.
+class RawFrameFileSource :
+	public FrameSource
+{
+public:
+	RawFrameFileSource(const std::string& path, int repeatCount = 1, double playbackFps = 0.0);
+	~RawFrameFileSource() override;
+
+	RawFrameFileSource(const RawFrameFileSource&) = delete;
+	RawFrameFileSource& operator=(const RawFrameFileSource&) = delete;
+
+	bool open() override;
+	bool grabFrame(cv::Mat& frame) override;
+
+	size_t getFrameCount() const;
+
+	static bool isRawFramePath(const std::string& path);
+	// Frame size, type and recorded rate from the file header, without mapping the file
+	static bool probeFrameFormat(const std::string& path, cv::Size& frameSize, int& frameType, double& framesPerSecond);
+
+private:
+	bool mapFile();
+	void unmapFile();
+
+	bool readIndex();
+	void readAhead(size_t frameIndex) const;
+
+	std::string m_Path;
+	int m_RepeatCount;
+	std::chrono::steady_clock::duration m_FrameInterval;
+	std::chrono::steady_clock::time_point m_NextFrameTime;
+
+	uint8_t* m_MappedData;
+	uint64_t m_MappedSize;
+#ifdef _WIN32
+	void* m_FileHandle;
+	void* m_MappingHandle;
+#endif
+
+	RawFrameLayout::FileHeader m_FileHeader;
+	std::vector<RawFrameLayout::FrameIndexEntry> m_FrameIndex;
+
+	size_t m_NextFrameIndex;
+	int m_CompletedRepeats;
+};
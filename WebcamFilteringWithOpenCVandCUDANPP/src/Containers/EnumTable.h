@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+
+// One value per enumerator of an enum numbered 0 to Count - 1, in a contiguous array that starts on a cache line.
+// A lookup is an index, iterating walks the array in enumerator order. Iteration yields (enumerator, value) pairs,
+// so the table reads like the map it replaces.
+template <typename EnumType, typename ValueType, size_t Count>
+class alignas(64) EnumTable
+{
+public:
+	template <typename TableValueType>
+	class Iterator
+	{
+	public:
+		Iterator(TableValueType* values, size_t index) :
+			m_Values(values),
+			m_Index(index)
+		{
+		}
+
+		std::pair<EnumType, TableValueType&> operator*() const
+		{
+			return { static_cast<EnumType>(m_Index), m_Values[m_Index] };
+		}
+
+		Iterator& operator++()
+		{
+			m_Index++;
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const = default;
+
+	private:
+		TableValueType* m_Values;
+		size_t m_Index;
+	};
+
+	EnumTable() = default;
+
+	explicit EnumTable(const ValueType& value)
+	{
+		m_Values.fill(value);
+	}
+
+	// Constructs every value in place from makeValue(enumerator), for values that cannot be default constructed or copied
+	template <typename MakeValue>
+	EnumTable(std::in_place_t, MakeValue makeValue) :
+		EnumTable(makeValue, std::make_index_sequence<Count>())
+	{
+	}
+
+	ValueType& operator[](EnumType key)
+	{
+		return m_Values[static_cast<size_t>(key)];
+	}
+
+	const ValueType& operator[](EnumType key) const
+	{
+		return m_Values[static_cast<size_t>(key)];
+	}
+
+	// Throws like the map for a value cast from outside the enum
+	ValueType& at(EnumType key)
+	{
+		return m_Values.at(static_cast<size_t>(key));
+	}
+
+	const ValueType& at(EnumType key) const
+	{
+		return m_Values.at(static_cast<size_t>(key));
+	}
+
+	static constexpr size_t size()
+	{
+		return Count;
+	}
+
+	Iterator<ValueType> begin()
+	{
+		return { m_Values.data(), 0 };
+	}
+
+	Iterator<ValueType> end()
+	{
+		return { m_Values.data(), Count };
+	}
+
+	Iterator<const ValueType> begin() const
+	{
+		return { m_Values.data(), 0 };
+	}
+
+	Iterator<const ValueType> end() const
+	{
+		return { m_Values.data(), Count };
+	}
+
+private:
+	template <typename MakeValue, size_t... Indices>
+	EnumTable(MakeValue& makeValue, std::index_sequence<Indices...>) :
+		m_Values{ { makeValue(static_cast<EnumType>(Indices))... } }
+	{
+	}
+
+	// Value-initialized, a default table of bools or pointers is all false or null
+	std::array<ValueType, Count> m_Values{};
+};
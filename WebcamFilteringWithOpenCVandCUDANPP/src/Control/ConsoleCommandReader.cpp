@@ -0,0 +1,83 @@
+#include "ConsoleCommandReader.h"
+
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+ConsoleCommandReader::ConsoleCommandReader()
+{
+}
+
+ConsoleCommandReader::~ConsoleCommandReader()
+{
+	if (m_ReaderThread.joinable())
+	{
+		m_ReaderThread.request_stop();
+		m_ReaderThread.join();
+	}
+}
+
+void ConsoleCommandReader::addCommand(const std::string& name, CommandHandler commandHandler)
+{
+	m_CommandHandlers[name] = std::move(commandHandler);
+}
+
+void ConsoleCommandReader::start()
+{
+	m_ReaderThread = std::jthread([this](std::stop_token stopToken) { readCommandsThread(stopToken); });
+}
+
+// Polls so that the thread can be stopped, a blocking read would never return without input
+void ConsoleCommandReader::readCommandsThread(std::stop_token stopToken)
+{
+	while (!stopToken.stop_requested())
+	{
+		if (!waitForInput(std::chrono::milliseconds(100)))
+			continue;
+
+		std::string line;
+		if (!std::getline(std::cin, line))
+			return;
+
+		executeCommand(line);
+	}
+}
+
+bool ConsoleCommandReader::waitForInput(std::chrono::milliseconds timeout) const
+{
+#ifdef _WIN32
+	HANDLE inputHandle = GetStdHandle(STD_INPUT_HANDLE);
+	return WaitForSingleObject(inputHandle, static_cast<DWORD>(timeout.count())) == WAIT_OBJECT_0;
+#else
+	pollfd inputPoll = { STDIN_FILENO, POLLIN, 0 };
+	return poll(&inputPoll, 1, static_cast<int>(timeout.count())) > 0;
+#endif
+}
+
+void ConsoleCommandReader::executeCommand(const std::string& line) const
+{
+	std::istringstream commandLine(line);
+
+	std::string name;
+	std::string argument;
+	commandLine >> name >> argument;
+
+	if (name.empty())
+		return;
+
+	auto commandHandler = m_CommandHandlers.find(name);
+	if (commandHandler == m_CommandHandlers.end())
+	{
+		std::cout << "Unknown command: " << name << "\n";
+		return;
+	}
+
+	commandHandler->second(argument);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+
+// Reads local control commands from the standard input on its own thread.
+// One command per line: "<name> [argument]", handlers run on the reader thread.
+class ConsoleCommandReader
+{
+public:
+	using CommandHandler = std::function<void(const std::string& argument)>;
+
+	ConsoleCommandReader();
+	~ConsoleCommandReader();
+
+	// Commands are added before start
+	void addCommand(const std::string& name, CommandHandler commandHandler);
+	void start();
+
+private:
+	void readCommandsThread(std::stop_token stopToken);
+	bool waitForInput(std::chrono::milliseconds timeout) const;
+	void executeCommand(const std::string& line) const;
+
+	std::unordered_map<std::string, CommandHandler> m_CommandHandlers;
+
+	std::jthread m_ReaderThread;
+};
@@ -20,3 +20,9 @@ void ViewEventQueue::pushViewEvent(std::shared_ptr<ViewEvent> viewEvent)
 	std::unique_lock lock(m_ViewEventMutex);
 	m_ViewEventQueue.push(viewEvent);
 }
+
+size_t ViewEventQueue::getSize()
+{
+	std::unique_lock lock(m_ViewEventMutex);
+	return m_ViewEventQueue.size();
+}
@@ -13,6 +13,8 @@ public:
 	std::shared_ptr<ViewEvent> popViewEvent();
 	void pushViewEvent(std::shared_ptr<ViewEvent> viewEvent);
 
+	size_t getSize();
+
 private:
 	std::mutex m_ViewEventMutex;
 
@@ -0,0 +1,23 @@
+#include "AttachFrameSink.h"
+
+
+AttachFrameSink::AttachFrameSink() :
+	ViewEvent(ViewEventTypesEnum::AttachFrameSink)
+{
+}
+
+void AttachFrameSink::setFrameSink(const FrameSinkSource& frameSinkSource, std::shared_ptr<FrameSink> frameSink)
+{
+	m_frameSinkSource = frameSinkSource;
+	m_frameSink = std::move(frameSink);
+}
+
+const FrameSinkSource& AttachFrameSink::getFrameSinkSource()
+{
+	return m_frameSinkSource;
+}
+
+std::shared_ptr<FrameSink> AttachFrameSink::getFrameSink()
+{
+	return m_frameSink;
+}
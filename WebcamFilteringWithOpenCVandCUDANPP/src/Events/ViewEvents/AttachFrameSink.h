@@ -0,0 +1,22 @@
+#pragma once
+
+#include <memory>
+
+#include "Events/ViewEvents/ViewEvent.h"
+#include "Output/FrameSink.h"
+
+
+class AttachFrameSink:
+	public ViewEvent
+{
+public:
+	AttachFrameSink();
+
+	void setFrameSink(const FrameSinkSource& frameSinkSource, std::shared_ptr<FrameSink> frameSink);
+	const FrameSinkSource& getFrameSinkSource();
+	std::shared_ptr<FrameSink> getFrameSink();
+
+private:
+	FrameSinkSource m_frameSinkSource;
+	std::shared_ptr<FrameSink> m_frameSink;
+};
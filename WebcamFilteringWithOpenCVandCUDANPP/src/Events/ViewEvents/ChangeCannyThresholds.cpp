@@ -0,0 +1,17 @@
+#include "ChangeCannyThresholds.h"
+
+
+ChangeCannyThresholds::ChangeCannyThresholds() :
+	ViewEvent(ViewEventTypesEnum::ChangeCannyThresholds)
+{
+}
+
+void ChangeCannyThresholds::setCannyThresholds(const CannyThresholds& cannyThresholds)
+{
+	m_cannyThresholds = cannyThresholds;
+}
+
+const CannyThresholds& ChangeCannyThresholds::getCannyThresholds()
+{
+	return m_cannyThresholds;
+}
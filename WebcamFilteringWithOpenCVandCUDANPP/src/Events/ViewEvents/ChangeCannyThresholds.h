@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Events/ViewEvents/ViewEvent.h"
+#include "Filters/Edges/CannyEdgeFilter.h"
+
+
+class ChangeCannyThresholds:
+	public ViewEvent
+{
+public:
+	ChangeCannyThresholds();
+
+	void setCannyThresholds(const CannyThresholds& cannyThresholds);
+	const CannyThresholds& getCannyThresholds();
+
+private:
+	CannyThresholds m_cannyThresholds;
+};
@@ -0,0 +1,24 @@
+#include "ChangeGeometricWarp.h"
+
+
+ChangeGeometricWarp::ChangeGeometricWarp() :
+	ViewEvent(ViewEventTypesEnum::ChangeGeometricWarp)
+{
+	m_isEnabled = false;
+}
+
+void ChangeGeometricWarp::setGeometricWarp(const bool isEnabled, const WarpParameters& warpParameters)
+{
+	m_isEnabled = isEnabled;
+	m_warpParameters = warpParameters;
+}
+
+bool ChangeGeometricWarp::getIsEnabled()
+{
+	return m_isEnabled;
+}
+
+const WarpParameters& ChangeGeometricWarp::getWarpParameters()
+{
+	return m_warpParameters;
+}
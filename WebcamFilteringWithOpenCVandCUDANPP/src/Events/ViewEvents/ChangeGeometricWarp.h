@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Events/ViewEvents/ViewEvent.h"
+#include "Geometry/WarpParameters.h"
+
+
+class ChangeGeometricWarp:
+	public ViewEvent
+{
+public:
+	ChangeGeometricWarp();
+
+	void setGeometricWarp(const bool isEnabled, const WarpParameters& warpParameters);
+	bool getIsEnabled();
+	const WarpParameters& getWarpParameters();
+
+private:
+	bool m_isEnabled;
+	WarpParameters m_warpParameters;
+};
@@ -0,0 +1,24 @@
+#include "ChangeQualityGovernor.h"
+
+
+ChangeQualityGovernor::ChangeQualityGovernor() :
+	ViewEvent(ViewEventTypesEnum::ChangeQualityGovernor)
+{
+	m_isEnabled = false;
+}
+
+void ChangeQualityGovernor::setQualityGovernor(const bool isEnabled, const std::vector<QualityStepEnum>& ladder)
+{
+	m_isEnabled = isEnabled;
+	m_ladder = ladder;
+}
+
+bool ChangeQualityGovernor::getIsEnabled()
+{
+	return m_isEnabled;
+}
+
+const std::vector<QualityStepEnum>& ChangeQualityGovernor::getLadder()
+{
+	return m_ladder;
+}
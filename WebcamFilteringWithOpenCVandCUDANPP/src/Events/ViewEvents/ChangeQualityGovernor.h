@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "Events/ViewEvents/ViewEvent.h"
+#include "Pipeline/QualityGovernor.h"
+
+
+class ChangeQualityGovernor:
+	public ViewEvent
+{
+public:
+	ChangeQualityGovernor();
+
+	void setQualityGovernor(const bool isEnabled, const std::vector<QualityStepEnum>& ladder);
+	bool getIsEnabled();
+	const std::vector<QualityStepEnum>& getLadder();
+
+private:
+	bool m_isEnabled;
+	std::vector<QualityStepEnum> m_ladder;
+};
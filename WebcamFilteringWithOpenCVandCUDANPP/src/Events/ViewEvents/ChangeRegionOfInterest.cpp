@@ -0,0 +1,31 @@
+#include "ChangeRegionOfInterest.h"
+
+
+ChangeRegionOfInterest::ChangeRegionOfInterest() :
+	ViewEvent(ViewEventTypesEnum::ChangeRegionOfInterest)
+{
+	m_isEnabled = false;
+	m_cropOutputs = false;
+}
+
+void ChangeRegionOfInterest::setRegionOfInterest(const bool isEnabled, const cv::Rect2d& regionOfInterest, const bool cropOutputs)
+{
+	m_isEnabled = isEnabled;
+	m_regionOfInterest = regionOfInterest;
+	m_cropOutputs = cropOutputs;
+}
+
+bool ChangeRegionOfInterest::getIsEnabled()
+{
+	return m_isEnabled;
+}
+
+const cv::Rect2d& ChangeRegionOfInterest::getRegionOfInterest()
+{
+	return m_regionOfInterest;
+}
+
+bool ChangeRegionOfInterest::getCropOutputs()
+{
+	return m_cropOutputs;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <opencv4/opencv2/core/types.hpp>
+
+#include "Events/ViewEvents/ViewEvent.h"
+
+
+class ChangeRegionOfInterest:
+	public ViewEvent
+{
+public:
+	ChangeRegionOfInterest();
+
+	// The rectangle is in output coordinates relative to the frame size, so it holds at any processing resolution
+	void setRegionOfInterest(const bool isEnabled, const cv::Rect2d& regionOfInterest, const bool cropOutputs);
+	bool getIsEnabled();
+	const cv::Rect2d& getRegionOfInterest();
+	bool getCropOutputs();
+
+private:
+	bool m_isEnabled;
+	cv::Rect2d m_regionOfInterest;
+	bool m_cropOutputs;
+};
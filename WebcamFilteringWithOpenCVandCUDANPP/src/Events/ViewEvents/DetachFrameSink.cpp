@@ -0,0 +1,17 @@
+#include "DetachFrameSink.h"
+
+
+DetachFrameSink::DetachFrameSink() :
+	ViewEvent(ViewEventTypesEnum::DetachFrameSink)
+{
+}
+
+void DetachFrameSink::setFrameSink(std::shared_ptr<FrameSink> frameSink)
+{
+	m_frameSink = std::move(frameSink);
+}
+
+std::shared_ptr<FrameSink> DetachFrameSink::getFrameSink()
+{
+	return m_frameSink;
+}
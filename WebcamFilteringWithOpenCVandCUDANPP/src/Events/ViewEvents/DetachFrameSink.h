@@ -0,0 +1,20 @@
+#pragma once
+
+#include <memory>
+
+#include "Events/ViewEvents/ViewEvent.h"
+#include "Output/FrameSink.h"
+
+
+class DetachFrameSink:
+	public ViewEvent
+{
+public:
+	DetachFrameSink();
+
+	void setFrameSink(std::shared_ptr<FrameSink> frameSink);
+	std::shared_ptr<FrameSink> getFrameSink();
+
+private:
+	std::shared_ptr<FrameSink> m_frameSink;
+};
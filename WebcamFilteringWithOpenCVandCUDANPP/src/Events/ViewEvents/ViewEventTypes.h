@@ -5,5 +5,11 @@ enum class ViewEventTypesEnum
 	ActivateCombinedFilter,
 	ChangeActiveFilters,
 	ChangeActiveFiltersOnCombinedFilter,
+	ChangeCannyThresholds,
+	ChangeGeometricWarp,
+	ChangeQualityGovernor,
+	ChangeRegionOfInterest,
+	AttachFrameSink,
+	DetachFrameSink,
 	None
 };
\ No newline at end of file
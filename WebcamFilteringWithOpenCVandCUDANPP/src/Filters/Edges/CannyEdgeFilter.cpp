@@ -0,0 +1,354 @@
+#include "CannyEdgeFilter.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include "Threading/WorkerPool.h"
+
+
+namespace
+{
+	enum GradientDirection : uint8_t
+	{
+		Horizontal,
+		Diagonal,
+		Vertical,
+		AntiDiagonal
+	};
+
+	enum EdgeCandidate : uint8_t
+	{
+		NoEdge,
+		WeakEdge,
+		StrongEdge
+	};
+
+	// tan(22.5) in Q15, tan(67.5) is 2 more
+	constexpr int tan22Q15 = 13573;
+
+	constexpr int maxMagnitude = 2040;
+}
+
+
+bool CannyThresholds::isValid() const
+{
+	return low >= 0 && low <= high && high <= maxMagnitude;
+}
+
+CannyEdgeFilter::CannyEdgeFilter(WorkerPool& workerPool) :
+	m_WorkerPool(workerPool)
+{
+}
+
+void CannyEdgeFilter::reset(const cv::Size& frameSize)
+{
+	m_Smoothed.create(frameSize, CV_8UC1);
+	m_Magnitude.create(frameSize, CV_16UC1);
+	m_Directions.create(frameSize, CV_8UC1);
+	m_Candidates.create(frameSize, CV_8UC1);
+	m_Labels.assign(static_cast<size_t>(frameSize.area()), 0);
+	m_Output.create(frameSize, CV_8UC1);
+}
+
+void CannyEdgeFilter::release()
+{
+	m_Smoothed.release();
+	m_Magnitude.release();
+	m_Directions.release();
+	m_Candidates.release();
+	m_Labels.clear();
+	m_Labels.shrink_to_fit();
+	m_Output.release();
+}
+
+const cv::Mat& CannyEdgeFilter::apply(const cv::Mat& luma)
+{
+	if (m_Output.size() != luma.size())
+		reset(luma.size());
+
+	const int stripsCount = m_KernelTuning.stripsCount;
+
+	// A strip of a ROI reads the rows of its neighbours, the frame border is reflected
+	m_WorkerPool.parallelFor(0, luma.rows, stripsCount, [&](int rowBegin, int rowEnd)
+	{
+		cv::Mat smoothedStrip = m_Smoothed.rowRange(rowBegin, rowEnd);
+		cv::GaussianBlur(luma.rowRange(rowBegin, rowEnd), smoothedStrip, cv::Size(5, 5), 1.4);
+	});
+
+	m_WorkerPool.parallelFor(0, luma.rows, stripsCount, [this](int rowBegin, int rowEnd) { computeGradientRows(rowBegin, rowEnd); });
+	m_WorkerPool.parallelFor(0, luma.rows, stripsCount, [this](int rowBegin, int rowEnd) { suppressNonMaximumRows(rowBegin, rowEnd); });
+
+	// Labels of a strip only point into the strip until the seams are joined, the strips do not share any state
+	const int labelStripsCount = getStripsCount();
+
+	m_WorkerPool.parallelFor(0, labelStripsCount, labelStripsCount, [&](int stripBegin, int stripEnd)
+	{
+		for (int strip = stripBegin; strip < stripEnd; strip++)
+		{
+			labelCandidateRows(getStripRowBegin(strip, labelStripsCount), getStripRowBegin(strip + 1, labelStripsCount));
+		}
+	});
+
+	// One row per seam, short next to the strips
+	for (int strip = 1; strip < labelStripsCount; strip++)
+	{
+		joinStripSeam(getStripRowBegin(strip, labelStripsCount));
+	}
+
+	m_WorkerPool.parallelFor(0, luma.rows, stripsCount, [this](int rowBegin, int rowEnd) { resolveEdgeRows(rowBegin, rowEnd); });
+
+	return m_Output;
+}
+
+size_t CannyEdgeFilter::getMemoryBytes() const
+{
+	return m_Smoothed.total() * m_Smoothed.elemSize() + m_Magnitude.total() * m_Magnitude.elemSize() +
+		m_Directions.total() * m_Directions.elemSize() + m_Candidates.total() * m_Candidates.elemSize() +
+		m_Labels.capacity() * sizeof(int32_t) + m_Output.total() * m_Output.elemSize();
+}
+
+void CannyEdgeFilter::setKernelTuning(const KernelTuning& kernelTuning)
+{
+	m_KernelTuning = kernelTuning;
+}
+
+void CannyEdgeFilter::setThresholds(const CannyThresholds& cannyThresholds)
+{
+	m_Thresholds = cannyThresholds;
+}
+
+const CannyThresholds& CannyEdgeFilter::getThresholds() const
+{
+	return m_Thresholds;
+}
+
+int CannyEdgeFilter::getStripsCount() const
+{
+	int stripsCount = m_KernelTuning.stripsCount > 0 ? m_KernelTuning.stripsCount : static_cast<int>(m_WorkerPool.getThreadCount());
+
+	return std::clamp(stripsCount, 1, std::max(m_Output.rows, 1));
+}
+
+int CannyEdgeFilter::getStripRowBegin(int strip, int stripsCount) const
+{
+	return m_Output.rows * strip / stripsCount;
+}
+
+// 3x3 Sobel, rows above and below the frame repeat the border row. The outer columns have no gradient.
+void CannyEdgeFilter::computeGradientRows(int rowBegin, int rowEnd)
+{
+	const int width = m_Smoothed.cols;
+	const int lastRow = m_Smoothed.rows - 1;
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* above = m_Smoothed.ptr(std::max(y - 1, 0));
+		const uchar* row = m_Smoothed.ptr(y);
+		const uchar* below = m_Smoothed.ptr(std::min(y + 1, lastRow));
+
+		uint16_t* magnitude = m_Magnitude.ptr<uint16_t>(y);
+		uchar* directions = m_Directions.ptr(y);
+
+		magnitude[0] = 0;
+		magnitude[width - 1] = 0;
+
+		for (int x = 1; x < width - 1; x++)
+		{
+			int gradientX = (above[x + 1] + 2 * row[x + 1] + below[x + 1]) - (above[x - 1] + 2 * row[x - 1] + below[x - 1]);
+			int gradientY = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+
+			int absoluteX = std::abs(gradientX);
+			int absoluteY = std::abs(gradientY);
+
+			magnitude[x] = static_cast<uint16_t>(absoluteX + absoluteY);
+
+			int scaledY = absoluteY << 15;
+			int tan22X = absoluteX * tan22Q15;
+
+			if (scaledY < tan22X)
+				directions[x] = Horizontal;
+			else if (scaledY > tan22X + (absoluteX << 16))
+				directions[x] = Vertical;
+			else
+				directions[x] = (gradientX ^ gradientY) < 0 ? AntiDiagonal : Diagonal;
+		}
+	}
+}
+
+// A pixel is kept where it is the maximum across the edge, ties go to the first pixel so edges stay one pixel wide
+void CannyEdgeFilter::suppressNonMaximumRows(int rowBegin, int rowEnd)
+{
+	const int width = m_Magnitude.cols;
+	const int lastRow = m_Magnitude.rows - 1;
+	const int lowThreshold = m_Thresholds.low;
+	const int highThreshold = m_Thresholds.high;
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		uchar* candidates = m_Candidates.ptr(y);
+
+		if (y == 0 || y == lastRow)
+		{
+			std::fill(candidates, candidates + width, static_cast<uchar>(NoEdge));
+			continue;
+		}
+
+		const uint16_t* above = m_Magnitude.ptr<uint16_t>(y - 1);
+		const uint16_t* row = m_Magnitude.ptr<uint16_t>(y);
+		const uint16_t* below = m_Magnitude.ptr<uint16_t>(y + 1);
+		const uchar* directions = m_Directions.ptr(y);
+
+		candidates[0] = NoEdge;
+		candidates[width - 1] = NoEdge;
+
+		for (int x = 1; x < width - 1; x++)
+		{
+			int magnitude = row[x];
+			candidates[x] = NoEdge;
+
+			if (magnitude <= lowThreshold)
+				continue;
+
+			int before;
+			int after;
+
+			switch (directions[x])
+			{
+				case Horizontal:
+					before = row[x - 1];
+					after = row[x + 1];
+					break;
+				case Vertical:
+					before = above[x];
+					after = below[x];
+					break;
+				case Diagonal:
+					before = above[x - 1];
+					after = below[x + 1];
+					break;
+				default:
+					before = above[x + 1];
+					after = below[x - 1];
+					break;
+			}
+
+			if (magnitude > before && magnitude >= after)
+				candidates[x] = magnitude > highThreshold ? StrongEdge : WeakEdge;
+		}
+	}
+}
+
+// 8-connected components of the candidates within the strip, the rows above the strip are left to the seam
+void CannyEdgeFilter::labelCandidateRows(int rowBegin, int rowEnd)
+{
+	const int width = m_Candidates.cols;
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* candidates = m_Candidates.ptr(y);
+		const uchar* above = y > rowBegin ? m_Candidates.ptr(y - 1) : nullptr;
+
+		for (int x = 0; x < width; x++)
+		{
+			if (candidates[x] == NoEdge)
+				continue;
+
+			int32_t label = y * width + x;
+			m_Labels[label] = label;
+
+			if (x > 0 && candidates[x - 1] != NoEdge)
+				unite(label, label - 1);
+
+			if (above == nullptr)
+				continue;
+
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if (x + dx >= 0 && x + dx < width && above[x + dx] != NoEdge)
+					unite(label, label - width + dx);
+			}
+		}
+	}
+}
+
+void CannyEdgeFilter::joinStripSeam(int seamRow)
+{
+	const int width = m_Candidates.cols;
+	const uchar* candidates = m_Candidates.ptr(seamRow);
+	const uchar* above = m_Candidates.ptr(seamRow - 1);
+
+	for (int x = 0; x < width; x++)
+	{
+		if (candidates[x] == NoEdge)
+			continue;
+
+		int32_t label = seamRow * width + x;
+
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			if (x + dx >= 0 && x + dx < width && above[x + dx] != NoEdge)
+				unite(label, label - width + dx);
+		}
+	}
+}
+
+// The labels are final, the strips only read them
+void CannyEdgeFilter::resolveEdgeRows(int rowBegin, int rowEnd)
+{
+	const int width = m_Candidates.cols;
+	const uchar* candidatesData = m_Candidates.ptr();
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* candidates = m_Candidates.ptr(y);
+		uchar* output = m_Output.ptr(y);
+
+		for (int x = 0; x < width; x++)
+		{
+			bool isEdge = candidates[x] != NoEdge && candidatesData[findRootReadOnly(y * width + x)] == StrongEdge;
+			output[x] = isEdge ? 255 : 0;
+		}
+	}
+}
+
+// Path halving, only called while the caller owns every pixel of the component
+int32_t CannyEdgeFilter::findRoot(int32_t label)
+{
+	while (m_Labels[label] != label)
+	{
+		m_Labels[label] = m_Labels[m_Labels[label]];
+		label = m_Labels[label];
+	}
+
+	return label;
+}
+
+int32_t CannyEdgeFilter::findRootReadOnly(int32_t label) const
+{
+	while (m_Labels[label] != label)
+	{
+		label = m_Labels[label];
+	}
+
+	return label;
+}
+
+// The smaller root wins and inherits the strong state, the candidates are continuous
+void CannyEdgeFilter::unite(int32_t firstLabel, int32_t secondLabel)
+{
+	int32_t firstRoot = findRoot(firstLabel);
+	int32_t secondRoot = findRoot(secondLabel);
+
+	if (firstRoot == secondRoot)
+		return;
+
+	int32_t root = std::min(firstRoot, secondRoot);
+	int32_t child = std::max(firstRoot, secondRoot);
+
+	m_Labels[child] = root;
+
+	uchar* candidates = m_Candidates.ptr();
+	candidates[root] = std::max(candidates[root], candidates[child]);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "Tuning/KernelTuning.h"
+
+class WorkerPool;
+
+
+// On the L1 magnitude of the 3x3 Sobel gradient of the smoothed luma, 0 to 2040
+struct CannyThresholds
+{
+	int low = 40;
+	int high = 100;
+
+	bool isValid() const;
+};
+
+// Canny edges of a luma frame. Smoothing, gradient, non-maximum suppression and the double threshold run in strips
+// on the worker pool. Hysteresis labels the edge candidates of every strip with a union-find of its own, joins the
+// labels across the strip seams and keeps the components that reach a strong pixel, so it is strip-parallel too.
+// The output is 255 on edges and 0 elsewhere.
+class CannyEdgeFilter
+{
+public:
+	explicit CannyEdgeFilter(WorkerPool& workerPool);
+
+	void reset(const cv::Size& frameSize);
+	void release();
+
+	const cv::Mat& apply(const cv::Mat& luma);
+
+	// Smoothed luma, gradient, candidates, labels and output
+	size_t getMemoryBytes() const;
+
+	// Not thread safe, set them between frames
+	void setKernelTuning(const KernelTuning& kernelTuning);
+	void setThresholds(const CannyThresholds& cannyThresholds);
+	const CannyThresholds& getThresholds() const;
+
+private:
+	int getStripsCount() const;
+	int getStripRowBegin(int strip, int stripsCount) const;
+
+	void computeGradientRows(int rowBegin, int rowEnd);
+	void suppressNonMaximumRows(int rowBegin, int rowEnd);
+	void labelCandidateRows(int rowBegin, int rowEnd);
+	void joinStripSeam(int seamRow);
+	void resolveEdgeRows(int rowBegin, int rowEnd);
+
+	int32_t findRoot(int32_t label);
+	int32_t findRootReadOnly(int32_t label) const;
+	void unite(int32_t firstLabel, int32_t secondLabel);
+
+	WorkerPool& m_WorkerPool;
+
+	cv::Mat m_Smoothed;
+	// L1 gradient magnitude and the direction quantized to 0, 45, 90 and 135 degrees
+	cv::Mat m_Magnitude;
+	cv::Mat m_Directions;
+	// 0, weak or strong after the suppression. A root is raised to strong once its component has a strong pixel.
+	cv::Mat m_Candidates;
+	// Parent of every candidate, the smallest pixel index of a component is its root
+	std::vector<int32_t> m_Labels;
+
+	cv::Mat m_Output;
+
+	KernelTuning m_KernelTuning;
+	CannyThresholds m_Thresholds;
+};
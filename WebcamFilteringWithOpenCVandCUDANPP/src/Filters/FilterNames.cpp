@@ -0,0 +1,50 @@
+#include "FilterNames.h"
+
+#include <sstream>
+
+#include "FilterTraits.h"
+
+
+bool parseFilterType(const std::string& filterName, FilterTypeEnum& filterType)
+{
+	for (const FilterTraits& filterTraits : filterTraitsList)
+	{
+		if (filterName == filterTraits.name)
+		{
+			filterType = filterTraits.filterType;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool parseFilterTypeList(const std::string& filterNames, std::vector<FilterTypeEnum>& filterTypes)
+{
+	std::stringstream names(filterNames);
+	std::string filterName;
+
+	filterTypes.clear();
+
+	while (std::getline(names, filterName, ','))
+	{
+		filterName.erase(0, filterName.find_first_not_of(' '));
+		filterName.erase(filterName.find_last_not_of(' ') + 1);
+
+		FilterTypeEnum filterType;
+		if (!parseFilterType(filterName, filterType))
+			return false;
+
+		filterTypes.push_back(filterType);
+	}
+
+	return true;
+}
+
+std::string getFilterTypeName(FilterTypeEnum filterType)
+{
+	if (static_cast<size_t>(filterType) >= filterTypesCount)
+		return "Unknown";
+
+	return getFilterTraits(filterType).name;
+}
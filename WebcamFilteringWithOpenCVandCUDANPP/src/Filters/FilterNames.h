@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "FilterTypes.h"
+
+
+// Names used on the command line, e.g. "Sobel" or "FrameDifference"
+bool parseFilterType(const std::string& filterName, FilterTypeEnum& filterType);
+// Comma separated names, e.g. "None, Sobel"
+bool parseFilterTypeList(const std::string& filterNames, std::vector<FilterTypeEnum>& filterTypes);
+std::string getFilterTypeName(FilterTypeEnum filterType);
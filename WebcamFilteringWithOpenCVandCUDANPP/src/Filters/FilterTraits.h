@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "Containers/EnumTable.h"
+#include "FilterTypes.h"
+
+
+// A buffer the stage of a filter holds while the output is active, at the processing size
+struct FilterBufferTraits
+{
+	const char* name;
+	// GPU memory, otherwise host
+	bool device;
+	int bytesPerPixel;
+};
+
+// What the pipeline knows about a filter besides its stage. A new filter is an enumerator, a row here and a stage,
+// the names, the view labels and rows, the metrics, the memory estimates and every per-filter table follow from this list.
+struct FilterTraits
+{
+	FilterTypeEnum filterType;
+	// Command line, metrics label and memory owner
+	const char* name;
+	// Shown in the view
+	const char* label;
+	// Path of its MJPEG stream over HTTP
+	const char* streamName;
+	// Runs on the CPU over the downloaded luma plane and always updates the whole frame
+	bool cpuLuma;
+	// Pixels read around each output pixel, the ROI is grown by it
+	int halo;
+	// Of the 8-bit output, 3 is BGR
+	int outputChannels;
+	// Everything its stage allocates, the output of a CPU stage included. Kept in step with the stage.
+	std::span<const FilterBufferTraits> stageBuffers;
+};
+
+namespace FilterStageBuffers
+{
+	inline constexpr FilterBufferTraits camera[] = { { "BGR frame", true, 3 } };
+	inline constexpr FilterBufferTraits sobel[] = { { "magnitude", true, 1 }, { "gradient x", true, 1 }, { "gradient y", true, 1 } };
+	inline constexpr FilterBufferTraits frameDifference[] = { { "previous luma", false, 1 }, { "difference", false, 1 } };
+	inline constexpr FilterBufferTraits backgroundSubtraction[] = { { "16-bit background", false, 2 }, { "mask", false, 1 } };
+	inline constexpr FilterBufferTraits temporalDenoise[] = { { "16-bit accumulator", false, 2 }, { "denoised", false, 1 } };
+	inline constexpr FilterBufferTraits motionVectors[] = { { "previous luma", false, 1 }, { "drawn vectors", false, 3 } };
+	inline constexpr FilterBufferTraits canny[] = {
+		{ "smoothed luma", false, 1 }, { "16-bit magnitude", false, 2 }, { "directions", false, 1 },
+		{ "candidates", false, 1 }, { "32-bit labels", false, 4 }, { "edges", false, 1 }
+	};
+}
+
+inline constexpr std::array<FilterTraits, 8> filterTraitsList = { {
+	{ FilterTypeEnum::None, "None", "None", "camera", false, 0, 3, FilterStageBuffers::camera },
+	{ FilterTypeEnum::Grayscale, "Grayscale", "Grayscale", "grayscale", false, 0, 1, {} },
+	{ FilterTypeEnum::Sobel, "Sobel", "Sobel", "sobel", false, 1, 1, FilterStageBuffers::sobel },
+	{ FilterTypeEnum::FrameDifference, "FrameDifference", "Frame Difference", "frame-difference", true, 0, 1, FilterStageBuffers::frameDifference },
+	{ FilterTypeEnum::BackgroundSubtraction, "BackgroundSubtraction", "Foreground Mask", "background-subtraction", true, 0, 1, FilterStageBuffers::backgroundSubtraction },
+	{ FilterTypeEnum::TemporalDenoise, "TemporalDenoise", "Temporal Denoise", "temporal-denoise", true, 0, 1, FilterStageBuffers::temporalDenoise },
+	{ FilterTypeEnum::MotionVectors, "MotionVectors", "Motion Vectors", "motion-vectors", true, 0, 3, FilterStageBuffers::motionVectors },
+	{ FilterTypeEnum::Canny, "Canny", "Canny Edges", "canny", true, 4, 1, FilterStageBuffers::canny }
+} };
+
+inline constexpr size_t filterTypesCount = filterTraitsList.size();
+
+// Tables are indexed by the enumerator
+static_assert([]()
+{
+	for (size_t i = 0; i < filterTypesCount; i++)
+	{
+		if (static_cast<size_t>(filterTraitsList[i].filterType) != i)
+			return false;
+	}
+
+	return true;
+}(), "filterTraitsList has to list every filter in enum order");
+
+inline constexpr std::array<FilterTypeEnum, filterTypesCount> allFilterTypes = []()
+{
+	std::array<FilterTypeEnum, filterTypesCount> filterTypes = {};
+
+	for (size_t i = 0; i < filterTypesCount; i++)
+	{
+		filterTypes[i] = filterTraitsList[i].filterType;
+	}
+
+	return filterTypes;
+}();
+
+constexpr const FilterTraits& getFilterTraits(FilterTypeEnum filterType)
+{
+	return filterTraitsList[static_cast<size_t>(filterType)];
+}
+
+template <typename ValueType>
+using FilterTable = EnumTable<FilterTypeEnum, ValueType, filterTypesCount>;
@@ -4,5 +4,10 @@ enum class FilterTypeEnum
 {
 	None,
 	Grayscale,
-	Sobel
+	Sobel,
+	FrameDifference,
+	BackgroundSubtraction,
+	TemporalDenoise,
+	MotionVectors,
+	Canny
 };
@@ -0,0 +1,228 @@
+#include "BlockMotionFilter.h"
+
+#include <array>
+#include <cstdlib>
+#include <limits>
+
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include "Simd/SimdSad.h"
+#include "Threading/WorkerPool.h"
+
+
+namespace
+{
+	struct SearchOffset
+	{
+		int dx;
+		int dy;
+	};
+
+	constexpr std::array<SearchOffset, 8> largeDiamond = { {
+		{ 0, -2 }, { 1, -1 }, { 2, 0 }, { 1, 1 }, { 0, 2 }, { -1, 1 }, { -2, 0 }, { -1, -1 }
+	} };
+
+	constexpr std::array<SearchOffset, 4> smallDiamond = { {
+		{ 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }
+	} };
+
+	// Below this the block is treated as static and not searched further
+	constexpr uint32_t staticBlockSad = BlockMotionFilter::blockSize * BlockMotionFilter::blockSize * 2;
+
+	// Vectors shorter than this are not drawn
+	constexpr int minimumDrawnMotion = 2;
+}
+
+
+BlockMotionFilter::BlockMotionFilter(WorkerPool& workerPool, int searchRange) :
+	m_WorkerPool(workerPool),
+	m_SearchRange(searchRange),
+	m_HistoryPrimed(false),
+	m_BlockColumns(0),
+	m_BlockRows(0)
+{
+}
+
+void BlockMotionFilter::reset(const cv::Size& frameSize)
+{
+	m_PreviousLuma.create(frameSize, CV_8UC1);
+	m_Output.create(frameSize, CV_8UC3);
+
+	m_BlockColumns = frameSize.width / blockSize;
+	m_BlockRows = frameSize.height / blockSize;
+	m_MotionVectors.assign(static_cast<size_t>(m_BlockColumns) * m_BlockRows, { 0, 0, 0 });
+
+	m_HistoryPrimed = false;
+}
+
+void BlockMotionFilter::release()
+{
+	m_PreviousLuma.release();
+	m_Output.release();
+	m_MotionVectors.clear();
+
+	m_HistoryPrimed = false;
+}
+
+const cv::Mat& BlockMotionFilter::apply(const cv::Mat& luma)
+{
+	if (m_PreviousLuma.size() != luma.size())
+		reset(luma.size());
+
+	if (m_HistoryPrimed)
+	{
+		m_WorkerPool.parallelFor(0, m_BlockRows, m_KernelTuning.stripsCount, [&](int blockRowBegin, int blockRowEnd) { estimateBlockRows(luma, blockRowBegin, blockRowEnd); });
+	}
+	else
+	{
+		m_MotionVectors.assign(m_MotionVectors.size(), { 0, 0, 0 });
+		m_HistoryPrimed = true;
+	}
+
+	drawMotionVectors(luma);
+
+	luma.copyTo(m_PreviousLuma);
+
+	return m_Output;
+}
+
+size_t BlockMotionFilter::getMemoryBytes() const
+{
+	return m_PreviousLuma.total() * m_PreviousLuma.elemSize() + m_Output.total() * m_Output.elemSize();
+}
+
+void BlockMotionFilter::setKernelTuning(const KernelTuning& kernelTuning)
+{
+	m_KernelTuning = kernelTuning;
+}
+
+const std::vector<BlockMotionFilter::MotionVector>& BlockMotionFilter::getMotionVectors() const
+{
+	return m_MotionVectors;
+}
+
+int BlockMotionFilter::getBlockColumns() const
+{
+	return m_BlockColumns;
+}
+
+int BlockMotionFilter::getBlockRows() const
+{
+	return m_BlockRows;
+}
+
+void BlockMotionFilter::estimateBlockRows(const cv::Mat& luma, int blockRowBegin, int blockRowEnd)
+{
+	for (int blockRow = blockRowBegin; blockRow < blockRowEnd; blockRow++)
+	{
+		// The left neighbour's vector is the search predictor, rows are independent
+		MotionVector predictor = { 0, 0, 0 };
+
+		for (int blockColumn = 0; blockColumn < m_BlockColumns; blockColumn++)
+		{
+			MotionVector motionVector = searchBlock(luma, blockColumn * blockSize, blockRow * blockSize, predictor);
+
+			m_MotionVectors[blockRow * m_BlockColumns + blockColumn] = motionVector;
+			predictor = motionVector;
+		}
+	}
+}
+
+BlockMotionFilter::MotionVector BlockMotionFilter::searchBlock(const cv::Mat& luma, int blockX, int blockY, const MotionVector& predictor) const
+{
+	const uchar* currentBlock = luma.ptr(blockY) + blockX;
+	const int maxX = luma.cols - blockSize;
+	const int maxY = luma.rows - blockSize;
+
+	auto evaluate = [&](int dx, int dy) -> uint32_t
+	{
+		int candidateX = blockX + dx;
+		int candidateY = blockY + dy;
+
+		if (std::abs(dx) > m_SearchRange || std::abs(dy) > m_SearchRange
+			|| candidateX < 0 || candidateY < 0 || candidateX > maxX || candidateY > maxY)
+		{
+			return std::numeric_limits<uint32_t>::max();
+		}
+
+		return computeSad16x16(currentBlock, luma.step, m_PreviousLuma.ptr(candidateY) + candidateX, m_PreviousLuma.step, m_KernelTuning.simdVariant);
+	};
+
+	int bestDx = 0;
+	int bestDy = 0;
+	uint32_t bestSad = evaluate(0, 0);
+
+	if (bestSad <= staticBlockSad)
+		return { 0, 0, bestSad };
+
+	if (predictor.dx != 0 || predictor.dy != 0)
+	{
+		uint32_t predictorSad = evaluate(predictor.dx, predictor.dy);
+		if (predictorSad < bestSad)
+		{
+			bestSad = predictorSad;
+			bestDx = predictor.dx;
+			bestDy = predictor.dy;
+		}
+	}
+
+	// Large diamond until the centre wins, each step moves at most two pixels
+	for (int step = 0; step < m_SearchRange; step++)
+	{
+		int centreDx = bestDx;
+		int centreDy = bestDy;
+
+		for (const auto& offset : largeDiamond)
+		{
+			uint32_t sad = evaluate(centreDx + offset.dx, centreDy + offset.dy);
+			if (sad < bestSad)
+			{
+				bestSad = sad;
+				bestDx = centreDx + offset.dx;
+				bestDy = centreDy + offset.dy;
+			}
+		}
+
+		if (bestDx == centreDx && bestDy == centreDy)
+			break;
+	}
+
+	int centreDx = bestDx;
+	int centreDy = bestDy;
+
+	for (const auto& offset : smallDiamond)
+	{
+		uint32_t sad = evaluate(centreDx + offset.dx, centreDy + offset.dy);
+		if (sad < bestSad)
+		{
+			bestSad = sad;
+			bestDx = centreDx + offset.dx;
+			bestDy = centreDy + offset.dy;
+		}
+	}
+
+	return { static_cast<short>(bestDx), static_cast<short>(bestDy), bestSad };
+}
+
+void BlockMotionFilter::drawMotionVectors(const cv::Mat& luma)
+{
+	cv::cvtColor(luma, m_Output, cv::COLOR_GRAY2BGR);
+
+	const cv::Scalar vectorColor(0, 255, 0);
+
+	for (int blockRow = 0; blockRow < m_BlockRows; blockRow++)
+	{
+		for (int blockColumn = 0; blockColumn < m_BlockColumns; blockColumn++)
+		{
+			const MotionVector& motionVector = m_MotionVectors[blockRow * m_BlockColumns + blockColumn];
+
+			if (std::abs(motionVector.dx) + std::abs(motionVector.dy) < minimumDrawnMotion)
+				continue;
+
+			cv::Point blockCentre(blockColumn * blockSize + blockSize / 2, blockRow * blockSize + blockSize / 2);
+
+			// The matched block sits at centre + vector in the previous frame, the arrow points to where it moved
+			cv::arrowedLine(m_Output, blockCentre + cv::Point(motionVector.dx, motionVector.dy), blockCentre, vectorColor, 1, cv::LINE_AA, 0, 0.3);
+		}
+	}
+}
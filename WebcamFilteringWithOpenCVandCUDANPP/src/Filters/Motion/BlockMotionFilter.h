@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "Tuning/KernelTuning.h"
+
+class WorkerPool;
+
+
+// Block matching motion estimation between consecutive luma frames.
+// Each 16x16 block is searched in the previous frame with a large/small diamond search,
+// block rows are spread over the worker pool. The output is the frame with motion vectors drawn on it.
+class BlockMotionFilter
+{
+public:
+	static constexpr int blockSize = 16;
+
+	struct MotionVector
+	{
+		short dx;
+		short dy;
+		uint32_t sad;
+	};
+
+	BlockMotionFilter(WorkerPool& workerPool, int searchRange = 16);
+
+	void reset(const cv::Size& frameSize);
+	void release();
+
+	const cv::Mat& apply(const cv::Mat& luma);
+
+	// Previous luma and output
+	size_t getMemoryBytes() const;
+
+	// Not thread safe, set it between frames
+	void setKernelTuning(const KernelTuning& kernelTuning);
+
+	// Displacement from the previous frame to the current one, one entry per block
+	const std::vector<MotionVector>& getMotionVectors() const;
+	int getBlockColumns() const;
+	int getBlockRows() const;
+
+private:
+	MotionVector searchBlock(const cv::Mat& luma, int blockX, int blockY, const MotionVector& predictor) const;
+	void estimateBlockRows(const cv::Mat& luma, int blockRowBegin, int blockRowEnd);
+	void drawMotionVectors(const cv::Mat& luma);
+
+	WorkerPool& m_WorkerPool;
+	int m_SearchRange;
+
+	cv::Mat m_PreviousLuma;
+	bool m_HistoryPrimed;
+
+	int m_BlockColumns;
+	int m_BlockRows;
+	std::vector<MotionVector> m_MotionVectors;
+
+	cv::Mat m_Output;
+
+	KernelTuning m_KernelTuning;
+};
@@ -0,0 +1,35 @@
+#include "CameraFrameStage.h"
+
+#include "Frames/MemoryBudget.h"
+
+
+void CameraFrameStage::allocate(const cv::Size& frameSize)
+{
+	m_BgrFrame.create(frameSize, CV_8UC3);
+}
+
+void CameraFrameStage::release()
+{
+	m_BgrFrame.release();
+}
+
+bool CameraFrameStage::generate(const FilterStageInput& input, bool gpuOutputNeeded)
+{
+	for (const auto& changedRect : input.changedRects)
+	{
+		if (input.yuvFrame.toBGR(m_BgrFrame, changedRect) == false)
+			return false;
+	}
+
+	return true;
+}
+
+const cv::cuda::GpuMat& CameraFrameStage::getGpuOutput() const
+{
+	return m_BgrFrame;
+}
+
+size_t CameraFrameStage::getMemoryBytes() const
+{
+	return MemoryBudget::getBytes(m_BgrFrame);
+}
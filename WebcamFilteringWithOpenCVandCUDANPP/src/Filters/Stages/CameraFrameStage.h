@@ -0,0 +1,21 @@
+#pragma once
+
+#include "FilterStage.h"
+
+
+// The camera image, converted back to BGR in the changed areas only
+class CameraFrameStage :
+	public FilterStage
+{
+public:
+	void allocate(const cv::Size& frameSize) override;
+	void release() override;
+
+	bool generate(const FilterStageInput& input, bool gpuOutputNeeded) override;
+
+	const cv::cuda::GpuMat& getGpuOutput() const override;
+	size_t getMemoryBytes() const override;
+
+private:
+	cv::cuda::GpuMat m_BgrFrame;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+
+#include "FilterStage.h"
+#include "Frames/MemoryBudget.h"
+
+
+// Runs a CPU filter over the downloaded luma plane. The filter has reset, release, apply, getMemoryBytes and
+// setKernelTuning, its output is uploaded again only while the combined output tiles it.
+template<typename Filter>
+class CpuLumaFilterStage :
+	public FilterStage
+{
+public:
+	explicit CpuLumaFilterStage(std::unique_ptr<Filter> filter) :
+		m_Filter(std::move(filter))
+	{
+	}
+
+	Filter& getFilter()
+	{
+		return *m_Filter;
+	}
+
+	// History buffers are allocated here once, not per frame.
+	// An upload of another size is not tiled until the next frame replaces it.
+	void allocate(const cv::Size& frameSize) override
+	{
+		m_Filter->reset(frameSize);
+
+		if (m_GpuOutput.size() != frameSize)
+			m_GpuOutput.release();
+	}
+
+	void release() override
+	{
+		m_Filter->release();
+		m_Output = cv::Mat();
+		m_GpuOutput.release();
+	}
+
+	bool generate(const FilterStageInput& input, bool gpuOutputNeeded) override
+	{
+		// The filter reuses its output buffer, it is valid until the next frame
+		m_Output = m_Filter->apply(input.luma);
+
+		if (gpuOutputNeeded)
+			m_GpuOutput.upload(m_Output);
+
+		return true;
+	}
+
+	const cv::cuda::GpuMat& getGpuOutput() const override
+	{
+		return m_GpuOutput;
+	}
+
+	const cv::Mat& getHostOutput() const override
+	{
+		return m_Output;
+	}
+
+	size_t getMemoryBytes() const override
+	{
+		return m_Filter->getMemoryBytes() + MemoryBudget::getBytes(m_GpuOutput);
+	}
+
+	void setKernelTuning(const KernelTuning& kernelTuning) override
+	{
+		m_Filter->setKernelTuning(kernelTuning);
+	}
+
+private:
+	std::unique_ptr<Filter> m_Filter;
+
+	cv::Mat m_Output;
+	cv::cuda::GpuMat m_GpuOutput;
+};
@@ -0,0 +1,12 @@
+#include "FilterStage.h"
+
+
+const cv::Mat& FilterStage::getHostOutput() const
+{
+	static const cv::Mat emptyOutput;
+	return emptyOutput;
+}
+
+void FilterStage::setKernelTuning(const KernelTuning& kernelTuning)
+{
+}
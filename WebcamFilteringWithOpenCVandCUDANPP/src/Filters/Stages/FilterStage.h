@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv4/opencv2/core/cuda.hpp>
+
+#include "Frames/YuvFrame.h"
+#include "Tuning/KernelTuning.h"
+
+
+// What a stage reads of the current frame
+struct FilterStageInput
+{
+	// Converted and flipped on the GPU
+	YuvFrame& yuvFrame;
+	// Downloaded luma plane, only read by the CPU stages
+	const cv::Mat& luma;
+	// Where the frame changed, GPU stages only update these
+	const std::vector<cv::Rect>& changedRects;
+};
+
+// One output of the pipeline with the buffers it holds while it is active.
+// GPU stages update their GPU output in the changed areas, CPU stages compute a whole host output from the luma plane.
+class FilterStage
+{
+public:
+	virtual ~FilterStage() = default;
+
+	// Buffers at the frame size, buffers that already have it are kept and the history starts over
+	virtual void allocate(const cv::Size& frameSize) = 0;
+	virtual void release() = 0;
+
+	// CPU stages upload their output only when the GPU output is needed, false when a kernel failed
+	virtual bool generate(const FilterStageInput& input, bool gpuOutputNeeded) = 0;
+
+	// What the combined output tiles, empty until the first frame
+	virtual const cv::cuda::GpuMat& getGpuOutput() const = 0;
+	// Output of the CPU stages, empty for the GPU ones
+	virtual const cv::Mat& getHostOutput() const;
+
+	// Everything the stage allocated
+	virtual size_t getMemoryBytes() const = 0;
+
+	// Only the CPU stages are tuned
+	virtual void setKernelTuning(const KernelTuning& kernelTuning);
+};
@@ -0,0 +1,40 @@
+#include "FilterStageFactory.h"
+
+#include "CameraFrameStage.h"
+#include "CpuLumaFilterStage.h"
+#include "Filters/Edges/CannyEdgeFilter.h"
+#include "Filters/Motion/BlockMotionFilter.h"
+#include "Filters/Temporal/FrameDifferenceFilter.h"
+#include "Filters/Temporal/RunningAverageBackgroundFilter.h"
+#include "Filters/Temporal/TemporalDenoiseFilter.h"
+#include "GrayscaleStage.h"
+#include "SobelStage.h"
+
+
+namespace FilterStageFactory
+{
+	std::unique_ptr<FilterStage> createFilterStage(FilterTypeEnum filterType, WorkerPool& workerPool)
+	{
+		switch (filterType)
+		{
+			case FilterTypeEnum::None:
+				return std::make_unique<CameraFrameStage>();
+			case FilterTypeEnum::Grayscale:
+				return std::make_unique<GrayscaleStage>();
+			case FilterTypeEnum::Sobel:
+				return std::make_unique<SobelStage>();
+			case FilterTypeEnum::FrameDifference:
+				return std::make_unique<CpuLumaFilterStage<TemporalFilter>>(std::make_unique<FrameDifferenceFilter>(workerPool));
+			case FilterTypeEnum::BackgroundSubtraction:
+				return std::make_unique<CpuLumaFilterStage<TemporalFilter>>(std::make_unique<RunningAverageBackgroundFilter>(workerPool));
+			case FilterTypeEnum::TemporalDenoise:
+				return std::make_unique<CpuLumaFilterStage<TemporalFilter>>(std::make_unique<TemporalDenoiseFilter>(workerPool));
+			case FilterTypeEnum::MotionVectors:
+				return std::make_unique<CpuLumaFilterStage<BlockMotionFilter>>(std::make_unique<BlockMotionFilter>(workerPool));
+			case FilterTypeEnum::Canny:
+				return std::make_unique<CpuLumaFilterStage<CannyEdgeFilter>>(std::make_unique<CannyEdgeFilter>(workerPool));
+		}
+
+		return nullptr;
+	}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <memory>
+
+#include "Filters/FilterTypes.h"
+#include "FilterStage.h"
+
+class WorkerPool;
+
+
+namespace FilterStageFactory
+{
+	// The only place that knows which class computes a filter, the CPU filters split their frames over the pool
+	std::unique_ptr<FilterStage> createFilterStage(FilterTypeEnum filterType, WorkerPool& workerPool);
+}
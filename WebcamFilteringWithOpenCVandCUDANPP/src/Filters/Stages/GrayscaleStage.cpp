@@ -0,0 +1,34 @@
+#include "GrayscaleStage.h"
+
+
+GrayscaleStage::GrayscaleStage() :
+	m_Luma(nullptr)
+{
+}
+
+void GrayscaleStage::allocate(const cv::Size& frameSize)
+{
+}
+
+void GrayscaleStage::release()
+{
+	m_Luma = nullptr;
+}
+
+bool GrayscaleStage::generate(const FilterStageInput& input, bool gpuOutputNeeded)
+{
+	m_Luma = &input.yuvFrame.getLuma();
+
+	return true;
+}
+
+const cv::cuda::GpuMat& GrayscaleStage::getGpuOutput() const
+{
+	static const cv::cuda::GpuMat emptyOutput;
+	return m_Luma != nullptr ? *m_Luma : emptyOutput;
+}
+
+size_t GrayscaleStage::getMemoryBytes() const
+{
+	return 0;
+}
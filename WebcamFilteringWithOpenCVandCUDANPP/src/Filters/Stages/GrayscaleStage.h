@@ -0,0 +1,24 @@
+#pragma once
+
+#include "FilterStage.h"
+
+
+// Grayscale is the luma plane itself, no conversion is needed and the stage holds no buffer
+class GrayscaleStage :
+	public FilterStage
+{
+public:
+	GrayscaleStage();
+
+	void allocate(const cv::Size& frameSize) override;
+	void release() override;
+
+	bool generate(const FilterStageInput& input, bool gpuOutputNeeded) override;
+
+	const cv::cuda::GpuMat& getGpuOutput() const override;
+	size_t getMemoryBytes() const override;
+
+private:
+	// Luma plane of the last frame, owned by the capture
+	const cv::cuda::GpuMat* m_Luma;
+};
@@ -0,0 +1,78 @@
+#include "SobelStage.h"
+
+#include <iostream>
+
+#include <nppi_arithmetic_and_logical_operations.h>
+#include <nppi_filtering_functions.h>
+
+#include "Frames/MemoryBudget.h"
+
+
+void SobelStage::allocate(const cv::Size& frameSize)
+{
+	m_Magnitude.create(frameSize, CV_8UC1);
+	m_GradX.create(frameSize, CV_8UC1);
+	m_GradY.create(frameSize, CV_8UC1);
+}
+
+void SobelStage::release()
+{
+	m_Magnitude.release();
+	m_GradX.release();
+	m_GradY.release();
+}
+
+bool SobelStage::generate(const FilterStageInput& input, bool gpuOutputNeeded)
+{
+	cv::cuda::GpuMat& lumaGpuMat = input.yuvFrame.getLuma();
+
+	for (const auto& changedRect : input.changedRects)
+	{
+		NppiSize roi = { changedRect.width, changedRect.height };
+		const Npp8u* lumaGpuMatPtr = static_cast<const Npp8u*>(lumaGpuMat.ptr(changedRect.y)) + changedRect.x;
+
+		Npp8u* gradXGpuPtr = static_cast<Npp8u*>(m_GradX.ptr(changedRect.y)) + changedRect.x;
+
+		NppStatus status = nppiFilterSobelHoriz_8u_C1R(lumaGpuMatPtr, static_cast<Npp32s>(lumaGpuMat.step),
+													   gradXGpuPtr, static_cast<Npp32s>(m_GradX.step),
+													   roi);
+		if (status != NPP_SUCCESS)
+		{
+			std::cerr << "Error computing horizontal gradient: " << status << std::endl;
+			return false;
+		}
+
+		Npp8u* gradYGpuPtr = static_cast<Npp8u*>(m_GradY.ptr(changedRect.y)) + changedRect.x;
+
+		status = nppiFilterSobelVert_8u_C1R(lumaGpuMatPtr, static_cast<Npp32s>(lumaGpuMat.step),
+											gradYGpuPtr, static_cast<Npp32s>(m_GradY.step),
+											roi);
+		if (status != NPP_SUCCESS)
+		{
+			std::cerr << "Error computing vertical gradient: " << status << std::endl;
+			return false;
+		}
+
+		status = nppiAdd_8u_C1RSfs(gradXGpuPtr, static_cast<int>(m_GradX.step),
+								   gradYGpuPtr, static_cast<int>(m_GradY.step),
+								   static_cast<Npp8u*>(m_Magnitude.ptr(changedRect.y)) + changedRect.x, static_cast<int>(m_Magnitude.step),
+								   roi, 0); // no scaling
+		if (status != NPP_SUCCESS)
+		{
+			std::cerr << "Error computing magnitude: " << status << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const cv::cuda::GpuMat& SobelStage::getGpuOutput() const
+{
+	return m_Magnitude;
+}
+
+size_t SobelStage::getMemoryBytes() const
+{
+	return MemoryBudget::getBytes(m_Magnitude) + MemoryBudget::getBytes(m_GradX) + MemoryBudget::getBytes(m_GradY);
+}
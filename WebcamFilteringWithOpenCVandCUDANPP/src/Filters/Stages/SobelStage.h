@@ -0,0 +1,23 @@
+#pragma once
+
+#include "FilterStage.h"
+
+
+// Sobel magnitude of the luma plane with NPP, the horizontal and vertical gradients are added with saturation
+class SobelStage :
+	public FilterStage
+{
+public:
+	void allocate(const cv::Size& frameSize) override;
+	void release() override;
+
+	bool generate(const FilterStageInput& input, bool gpuOutputNeeded) override;
+
+	const cv::cuda::GpuMat& getGpuOutput() const override;
+	size_t getMemoryBytes() const override;
+
+private:
+	cv::cuda::GpuMat m_Magnitude;
+	cv::cuda::GpuMat m_GradX;
+	cv::cuda::GpuMat m_GradY;
+};
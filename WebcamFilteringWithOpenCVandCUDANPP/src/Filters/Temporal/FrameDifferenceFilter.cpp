@@ -0,0 +1,70 @@
+#include "FrameDifferenceFilter.h"
+
+#include <cstdlib>
+
+#include "Simd/SimdConfig.h"
+
+
+FrameDifferenceFilter::FrameDifferenceFilter(WorkerPool& workerPool) :
+	TemporalFilter(workerPool)
+{
+}
+
+void FrameDifferenceFilter::allocateHistory(const cv::Size& frameSize)
+{
+	m_PreviousLuma.create(frameSize, CV_8UC1);
+}
+
+void FrameDifferenceFilter::releaseHistory()
+{
+	m_PreviousLuma.release();
+}
+
+size_t FrameDifferenceFilter::getHistoryBytes() const
+{
+	return m_PreviousLuma.total() * m_PreviousLuma.elemSize();
+}
+
+void FrameDifferenceFilter::primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd)
+{
+	luma.rowRange(rowBegin, rowEnd).copyTo(m_PreviousLuma.rowRange(rowBegin, rowEnd));
+	output.rowRange(rowBegin, rowEnd).setTo(cv::Scalar(0));
+}
+
+void FrameDifferenceFilter::applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd)
+{
+	const int width = luma.cols;
+
+#if SIMD_SSE2_AVAILABLE
+	const bool vectorized = getKernelTuning().simdVariant == SimdVariantEnum::Sse2;
+#endif
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* current = luma.ptr(y);
+		uchar* previous = m_PreviousLuma.ptr(y);
+		uchar* difference = output.ptr(y);
+
+		int x = 0;
+
+#if SIMD_SSE2_AVAILABLE
+		for (; vectorized && x + 16 <= width; x += 16)
+		{
+			__m128i currentBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + x));
+			__m128i previousBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + x));
+
+			// |a - b| for unsigned bytes, one of the saturated differences is always zero
+			__m128i absoluteDifference = _mm_or_si128(_mm_subs_epu8(currentBytes, previousBytes), _mm_subs_epu8(previousBytes, currentBytes));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(difference + x), absoluteDifference);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(previous + x), currentBytes);
+		}
+#endif
+
+		for (; x < width; x++)
+		{
+			difference[x] = static_cast<uchar>(std::abs(static_cast<int>(current[x]) - static_cast<int>(previous[x])));
+			previous[x] = current[x];
+		}
+	}
+}
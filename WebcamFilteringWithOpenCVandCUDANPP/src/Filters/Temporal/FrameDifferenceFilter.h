@@ -0,0 +1,23 @@
+#pragma once
+
+#include "TemporalFilter.h"
+
+
+// Absolute difference between the current and the previous frame
+class FrameDifferenceFilter :
+	public TemporalFilter
+{
+public:
+	FrameDifferenceFilter(WorkerPool& workerPool);
+
+protected:
+	void allocateHistory(const cv::Size& frameSize) override;
+	void releaseHistory() override;
+	size_t getHistoryBytes() const override;
+
+	void primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) override;
+	void applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) override;
+
+private:
+	cv::Mat m_PreviousLuma;
+};
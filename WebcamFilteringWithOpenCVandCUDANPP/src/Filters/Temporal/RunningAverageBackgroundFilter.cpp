@@ -0,0 +1,115 @@
+#include "RunningAverageBackgroundFilter.h"
+
+#include <cstdlib>
+
+#include "Simd/SimdConfig.h"
+
+
+namespace
+{
+	constexpr int fixedPointShift = 7;
+}
+
+
+RunningAverageBackgroundFilter::RunningAverageBackgroundFilter(WorkerPool& workerPool, int adaptationShift, int foregroundThreshold) :
+	TemporalFilter(workerPool),
+	m_AdaptationShift(adaptationShift),
+	m_ForegroundThreshold(foregroundThreshold)
+{
+}
+
+const cv::Mat& RunningAverageBackgroundFilter::getBackground()
+{
+	m_BackgroundQ7.convertTo(m_Background, CV_8U, 1.0 / (1 << fixedPointShift));
+
+	return m_Background;
+}
+
+void RunningAverageBackgroundFilter::allocateHistory(const cv::Size& frameSize)
+{
+	m_BackgroundQ7.create(frameSize, CV_16SC1);
+}
+
+void RunningAverageBackgroundFilter::releaseHistory()
+{
+	m_BackgroundQ7.release();
+	m_Background.release();
+}
+
+size_t RunningAverageBackgroundFilter::getHistoryBytes() const
+{
+	return m_BackgroundQ7.total() * m_BackgroundQ7.elemSize() + m_Background.total() * m_Background.elemSize();
+}
+
+void RunningAverageBackgroundFilter::primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd)
+{
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* current = luma.ptr(y);
+		short* background = m_BackgroundQ7.ptr<short>(y);
+
+		for (int x = 0; x < luma.cols; x++)
+		{
+			background[x] = static_cast<short>(current[x] << fixedPointShift);
+		}
+	}
+
+	output.rowRange(rowBegin, rowEnd).setTo(cv::Scalar(0));
+}
+
+void RunningAverageBackgroundFilter::applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd)
+{
+	const int width = luma.cols;
+
+#if SIMD_SSE2_AVAILABLE
+	const bool vectorized = getKernelTuning().simdVariant == SimdVariantEnum::Sse2;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i threshold = _mm_set1_epi8(static_cast<char>(m_ForegroundThreshold));
+	const __m128i allOnes = _mm_set1_epi8(static_cast<char>(0xFF));
+	const __m128i adaptationShift = _mm_cvtsi32_si128(m_AdaptationShift);
+#endif
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* current = luma.ptr(y);
+		short* background = m_BackgroundQ7.ptr<short>(y);
+		uchar* foreground = output.ptr(y);
+
+		int x = 0;
+
+#if SIMD_SSE2_AVAILABLE
+		for (; vectorized && x + 16 <= width; x += 16)
+		{
+			__m128i currentBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + x));
+
+			__m128i currentLow = _mm_slli_epi16(_mm_unpacklo_epi8(currentBytes, zero), fixedPointShift);
+			__m128i currentHigh = _mm_slli_epi16(_mm_unpackhi_epi8(currentBytes, zero), fixedPointShift);
+
+			__m128i backgroundLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + x));
+			__m128i backgroundHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + x + 8));
+
+			// Mask against the background before it absorbs the current frame
+			__m128i backgroundBytes = _mm_packus_epi16(_mm_srli_epi16(backgroundLow, fixedPointShift), _mm_srli_epi16(backgroundHigh, fixedPointShift));
+			__m128i absoluteDifference = _mm_or_si128(_mm_subs_epu8(currentBytes, backgroundBytes), _mm_subs_epu8(backgroundBytes, currentBytes));
+			__m128i isBackground = _mm_cmpeq_epi8(_mm_subs_epu8(absoluteDifference, threshold), zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(foreground + x), _mm_xor_si128(isBackground, allOnes));
+
+			// background += (current - background) >> shift, both sides stay within int16 in Q7
+			backgroundLow = _mm_add_epi16(backgroundLow, _mm_sra_epi16(_mm_sub_epi16(currentLow, backgroundLow), adaptationShift));
+			backgroundHigh = _mm_add_epi16(backgroundHigh, _mm_sra_epi16(_mm_sub_epi16(currentHigh, backgroundHigh), adaptationShift));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(background + x), backgroundLow);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(background + x + 8), backgroundHigh);
+		}
+#endif
+
+		for (; x < width; x++)
+		{
+			int currentQ7 = current[x] << fixedPointShift;
+			int backgroundValue = background[x] >> fixedPointShift;
+
+			foreground[x] = std::abs(static_cast<int>(current[x]) - backgroundValue) > m_ForegroundThreshold ? 255 : 0;
+			background[x] = static_cast<short>(background[x] + ((currentQ7 - background[x]) >> m_AdaptationShift));
+		}
+	}
+}
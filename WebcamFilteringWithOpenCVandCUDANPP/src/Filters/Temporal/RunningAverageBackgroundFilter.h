@@ -0,0 +1,31 @@
+#pragma once
+
+#include "TemporalFilter.h"
+
+
+// Exponential running average background model, outputs the foreground mask.
+// The background is kept in Q7 fixed point so that the update fits in 16-bit lanes.
+class RunningAverageBackgroundFilter :
+	public TemporalFilter
+{
+public:
+	// The background adapts with alpha = 1 / 2^adaptationShift
+	RunningAverageBackgroundFilter(WorkerPool& workerPool, int adaptationShift = 5, int foregroundThreshold = 25);
+
+	const cv::Mat& getBackground();
+
+protected:
+	void allocateHistory(const cv::Size& frameSize) override;
+	void releaseHistory() override;
+	size_t getHistoryBytes() const override;
+
+	void primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) override;
+	void applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) override;
+
+private:
+	int m_AdaptationShift;
+	int m_ForegroundThreshold;
+
+	cv::Mat m_BackgroundQ7;
+	cv::Mat m_Background;
+};
@@ -0,0 +1,122 @@
+#include "TemporalDenoiseFilter.h"
+
+#include <cstdlib>
+
+#include "Simd/SimdConfig.h"
+
+
+namespace
+{
+	constexpr int fixedPointShift = 7;
+	constexpr int fixedPointHalf = 1 << (fixedPointShift - 1);
+}
+
+
+TemporalDenoiseFilter::TemporalDenoiseFilter(WorkerPool& workerPool, int blendShift, int motionThreshold) :
+	TemporalFilter(workerPool),
+	m_BlendShift(blendShift),
+	m_MotionThreshold(motionThreshold)
+{
+}
+
+void TemporalDenoiseFilter::allocateHistory(const cv::Size& frameSize)
+{
+	m_AccumulatorQ7.create(frameSize, CV_16SC1);
+}
+
+void TemporalDenoiseFilter::releaseHistory()
+{
+	m_AccumulatorQ7.release();
+}
+
+size_t TemporalDenoiseFilter::getHistoryBytes() const
+{
+	return m_AccumulatorQ7.total() * m_AccumulatorQ7.elemSize();
+}
+
+void TemporalDenoiseFilter::primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd)
+{
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* current = luma.ptr(y);
+		short* accumulator = m_AccumulatorQ7.ptr<short>(y);
+
+		for (int x = 0; x < luma.cols; x++)
+		{
+			accumulator[x] = static_cast<short>(current[x] << fixedPointShift);
+		}
+	}
+
+	luma.rowRange(rowBegin, rowEnd).copyTo(output.rowRange(rowBegin, rowEnd));
+}
+
+void TemporalDenoiseFilter::applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd)
+{
+	const int width = luma.cols;
+
+#if SIMD_SSE2_AVAILABLE
+	const bool vectorized = getKernelTuning().simdVariant == SimdVariantEnum::Sse2;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i threshold = _mm_set1_epi8(static_cast<char>(m_MotionThreshold));
+	const __m128i rounding = _mm_set1_epi16(fixedPointHalf);
+	const __m128i blendShift = _mm_cvtsi32_si128(m_BlendShift);
+#endif
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const uchar* current = luma.ptr(y);
+		short* accumulator = m_AccumulatorQ7.ptr<short>(y);
+		uchar* denoised = output.ptr(y);
+
+		int x = 0;
+
+#if SIMD_SSE2_AVAILABLE
+		for (; vectorized && x + 16 <= width; x += 16)
+		{
+			__m128i currentBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + x));
+
+			__m128i currentLow = _mm_slli_epi16(_mm_unpacklo_epi8(currentBytes, zero), fixedPointShift);
+			__m128i currentHigh = _mm_slli_epi16(_mm_unpackhi_epi8(currentBytes, zero), fixedPointShift);
+
+			__m128i accumulatorLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator + x));
+			__m128i accumulatorHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator + x + 8));
+
+			__m128i accumulatorBytes = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(accumulatorLow, rounding), fixedPointShift),
+														_mm_srli_epi16(_mm_add_epi16(accumulatorHigh, rounding), fixedPointShift));
+			__m128i absoluteDifference = _mm_or_si128(_mm_subs_epu8(currentBytes, accumulatorBytes), _mm_subs_epu8(accumulatorBytes, currentBytes));
+
+			// 0xFF where the pixel moved, widened to 16-bit lanes for the select
+			__m128i moved = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(absoluteDifference, threshold), zero), _mm_set1_epi8(static_cast<char>(0xFF)));
+			__m128i movedLow = _mm_unpacklo_epi8(moved, moved);
+			__m128i movedHigh = _mm_unpackhi_epi8(moved, moved);
+
+			__m128i blendedLow = _mm_add_epi16(accumulatorLow, _mm_sra_epi16(_mm_sub_epi16(currentLow, accumulatorLow), blendShift));
+			__m128i blendedHigh = _mm_add_epi16(accumulatorHigh, _mm_sra_epi16(_mm_sub_epi16(currentHigh, accumulatorHigh), blendShift));
+
+			accumulatorLow = _mm_or_si128(_mm_and_si128(movedLow, currentLow), _mm_andnot_si128(movedLow, blendedLow));
+			accumulatorHigh = _mm_or_si128(_mm_and_si128(movedHigh, currentHigh), _mm_andnot_si128(movedHigh, blendedHigh));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator + x), accumulatorLow);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator + x + 8), accumulatorHigh);
+
+			__m128i denoisedBytes = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(accumulatorLow, rounding), fixedPointShift),
+													 _mm_srli_epi16(_mm_add_epi16(accumulatorHigh, rounding), fixedPointShift));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(denoised + x), denoisedBytes);
+		}
+#endif
+
+		for (; x < width; x++)
+		{
+			int currentQ7 = current[x] << fixedPointShift;
+			int accumulatorValue = accumulator[x];
+
+			if (std::abs(static_cast<int>(current[x]) - ((accumulatorValue + fixedPointHalf) >> fixedPointShift)) > m_MotionThreshold)
+				accumulatorValue = currentQ7;
+			else
+				accumulatorValue += (currentQ7 - accumulatorValue) >> m_BlendShift;
+
+			accumulator[x] = static_cast<short>(accumulatorValue);
+			denoised[x] = static_cast<uchar>((accumulatorValue + fixedPointHalf) >> fixedPointShift);
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "TemporalFilter.h"
+
+
+// Recursive (IIR) temporal denoise. Pixels that moved more than the motion threshold
+// restart from the current frame so moving objects do not leave trails.
+class TemporalDenoiseFilter :
+	public TemporalFilter
+{
+public:
+	// Each frame contributes 1 / 2^blendShift to the output
+	TemporalDenoiseFilter(WorkerPool& workerPool, int blendShift = 2, int motionThreshold = 20);
+
+protected:
+	void allocateHistory(const cv::Size& frameSize) override;
+	void releaseHistory() override;
+	size_t getHistoryBytes() const override;
+
+	void primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) override;
+	void applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) override;
+
+private:
+	int m_BlendShift;
+	int m_MotionThreshold;
+
+	cv::Mat m_AccumulatorQ7;
+};
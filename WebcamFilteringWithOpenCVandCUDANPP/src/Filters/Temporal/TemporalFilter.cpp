@@ -0,0 +1,59 @@
+#include "TemporalFilter.h"
+
+#include "Threading/WorkerPool.h"
+
+
+TemporalFilter::TemporalFilter(WorkerPool& workerPool) :
+	m_WorkerPool(workerPool),
+	m_HistoryPrimed(false)
+{
+}
+
+void TemporalFilter::reset(const cv::Size& frameSize)
+{
+	m_Output.create(frameSize, CV_8UC1);
+	allocateHistory(frameSize);
+
+	m_HistoryPrimed = false;
+}
+
+void TemporalFilter::release()
+{
+	m_Output.release();
+	releaseHistory();
+
+	m_HistoryPrimed = false;
+}
+
+const cv::Mat& TemporalFilter::apply(const cv::Mat& luma)
+{
+	if (m_Output.size() != luma.size())
+		reset(luma.size());
+
+	if (m_HistoryPrimed)
+	{
+		m_WorkerPool.parallelFor(0, luma.rows, m_KernelTuning.stripsCount, [&](int rowBegin, int rowEnd) { applyRows(luma, m_Output, rowBegin, rowEnd); });
+	}
+	else
+	{
+		m_WorkerPool.parallelFor(0, luma.rows, m_KernelTuning.stripsCount, [&](int rowBegin, int rowEnd) { primeRows(luma, m_Output, rowBegin, rowEnd); });
+		m_HistoryPrimed = true;
+	}
+
+	return m_Output;
+}
+
+size_t TemporalFilter::getMemoryBytes() const
+{
+	return m_Output.total() * m_Output.elemSize() + getHistoryBytes();
+}
+
+void TemporalFilter::setKernelTuning(const KernelTuning& kernelTuning)
+{
+	m_KernelTuning = kernelTuning;
+}
+
+const KernelTuning& TemporalFilter::getKernelTuning() const
+{
+	return m_KernelTuning;
+}
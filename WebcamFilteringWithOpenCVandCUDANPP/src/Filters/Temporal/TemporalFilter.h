@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "Tuning/KernelTuning.h"
+
+class WorkerPool;
+
+
+// Base of the filters that keep per-pixel state across frames.
+// Works on 8-bit luma, the history is allocated once in reset and the first frame primes it.
+class TemporalFilter
+{
+public:
+	TemporalFilter(WorkerPool& workerPool);
+	virtual ~TemporalFilter() = default;
+
+	void reset(const cv::Size& frameSize);
+	void release();
+
+	const cv::Mat& apply(const cv::Mat& luma);
+
+	// Output and history
+	size_t getMemoryBytes() const;
+
+	// Not thread safe, set it between frames
+	void setKernelTuning(const KernelTuning& kernelTuning);
+	const KernelTuning& getKernelTuning() const;
+
+protected:
+	virtual void allocateHistory(const cv::Size& frameSize) = 0;
+	virtual void releaseHistory() = 0;
+	virtual size_t getHistoryBytes() const = 0;
+
+	virtual void primeRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) = 0;
+	virtual void applyRows(const cv::Mat& luma, cv::Mat& output, int rowBegin, int rowEnd) = 0;
+
+private:
+	WorkerPool& m_WorkerPool;
+
+	cv::Mat m_Output;
+	bool m_HistoryPrimed;
+
+	KernelTuning m_KernelTuning;
+};
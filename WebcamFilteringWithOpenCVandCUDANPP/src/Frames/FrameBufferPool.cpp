@@ -0,0 +1,96 @@
+#include "FrameBufferPool.h"
+
+
+FrameBufferPool::FrameBufferPool(size_t maxPooledBytes) :
+	m_MaxPooledBytes(maxPooledBytes),
+	m_PooledBytes(0),
+	m_MemoryAccount("frame buffer pool"),
+	m_ReusedBuffersCount(0),
+	m_AllocatedBuffersCount(0),
+	m_MetricsCollector([this]() { collectMetrics(); })
+{
+}
+
+cv::Mat FrameBufferPool::acquire(cv::Size size, int type)
+{
+	std::lock_guard<std::mutex> lock(m_BuffersMutex);
+
+	for (const cv::Mat& buffer : m_Buffers)
+	{
+		if (buffer.size() == size && buffer.type() == type && isIdle(buffer))
+		{
+			m_ReusedBuffersCount++;
+			return buffer;
+		}
+	}
+
+	cv::Mat newBuffer(size, type);
+	size_t newBufferBytes = getBufferBytes(newBuffer);
+	m_AllocatedBuffersCount++;
+
+	for (auto bufferItr = m_Buffers.begin(); bufferItr != m_Buffers.end() && m_PooledBytes + newBufferBytes > m_MaxPooledBytes;)
+	{
+		if (isIdle(*bufferItr))
+		{
+			m_PooledBytes -= getBufferBytes(*bufferItr);
+			bufferItr = m_Buffers.erase(bufferItr);
+		}
+		else
+		{
+			bufferItr++;
+		}
+	}
+
+	if (m_PooledBytes + newBufferBytes <= m_MaxPooledBytes)
+	{
+		m_Buffers.push_back(newBuffer);
+		m_PooledBytes += newBufferBytes;
+	}
+
+	m_MemoryAccount.setBytes(m_PooledBytes);
+
+	return newBuffer;
+}
+
+FrameBufferPoolStats FrameBufferPool::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_BuffersMutex);
+
+	FrameBufferPoolStats frameBufferPoolStats;
+	frameBufferPoolStats.pooledBytes = m_PooledBytes;
+	frameBufferPoolStats.inUseBytes = 0;
+	frameBufferPoolStats.maxPooledBytes = m_MaxPooledBytes;
+	frameBufferPoolStats.reusedBuffersCount = m_ReusedBuffersCount;
+	frameBufferPoolStats.allocatedBuffersCount = m_AllocatedBuffersCount;
+
+	for (const cv::Mat& buffer : m_Buffers)
+	{
+		if (!isIdle(buffer))
+			frameBufferPoolStats.inUseBytes += getBufferBytes(buffer);
+	}
+
+	return frameBufferPoolStats;
+}
+
+// Only the pool hands buffers out, so one that only the pool refers to cannot be taken concurrently
+bool FrameBufferPool::isIdle(const cv::Mat& buffer)
+{
+	return buffer.u != nullptr && buffer.u->refcount == 1;
+}
+
+size_t FrameBufferPool::getBufferBytes(const cv::Mat& buffer)
+{
+	return buffer.total() * buffer.elemSize();
+}
+
+void FrameBufferPool::collectMetrics() const
+{
+	FrameBufferPoolStats frameBufferPoolStats = getStats();
+
+	MetricsRegistry& metricsRegistry = MetricsRegistry::getInstance();
+	const char* help = "Bytes held by the frame buffer pool";
+
+	metricsRegistry.getGauge("webcam_frame_buffer_pool_bytes", help, { { "state", "pooled" } }).set(static_cast<double>(frameBufferPoolStats.pooledBytes));
+	metricsRegistry.getGauge("webcam_frame_buffer_pool_bytes", help, { { "state", "in-use" } }).set(static_cast<double>(frameBufferPoolStats.inUseBytes));
+	metricsRegistry.getGauge("webcam_frame_buffer_pool_bytes", help, { { "state", "limit" } }).set(static_cast<double>(frameBufferPoolStats.maxPooledBytes));
+}
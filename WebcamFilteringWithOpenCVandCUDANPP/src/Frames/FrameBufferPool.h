@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "MemoryBudget.h"
+#include "Metrics/MetricsRegistry.h"
+
+
+struct FrameBufferPoolStats
+{
+	size_t pooledBytes;
+	size_t inUseBytes;
+	size_t maxPooledBytes;
+
+	uint64_t reusedBuffersCount;
+	uint64_t allocatedBuffersCount;
+};
+
+// Frame-sized CPU buffers shared by every stream. A buffer goes back to the pool when the last
+// cv::Mat referring to it is released, there is no explicit release call.
+// Past the byte limit idle buffers of other sizes are freed first, then buffers are allocated outside the pool.
+class FrameBufferPool
+{
+public:
+	explicit FrameBufferPool(size_t maxPooledBytes = 512 * 1024 * 1024);
+
+	FrameBufferPool(const FrameBufferPool&) = delete;
+	FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+	cv::Mat acquire(cv::Size size, int type);
+
+	FrameBufferPoolStats getStats() const;
+
+private:
+	static bool isIdle(const cv::Mat& buffer);
+	static size_t getBufferBytes(const cv::Mat& buffer);
+
+	void collectMetrics() const;
+
+	size_t m_MaxPooledBytes;
+
+	mutable std::mutex m_BuffersMutex;
+	std::vector<cv::Mat> m_Buffers;
+	size_t m_PooledBytes;
+	MemoryAccount m_MemoryAccount;
+
+	uint64_t m_ReusedBuffersCount;
+	uint64_t m_AllocatedBuffersCount;
+
+	// Declared last, so it is unregistered before the buffers go away
+	MetricsCollector m_MetricsCollector;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+
+// The captured frame an output was computed from
+struct FrameStamp
+{
+	// Captured frames count of the stream, 0 until the output holds a frame
+	uint64_t sequence = 0;
+	std::chrono::steady_clock::time_point captureTime;
+
+	// Times the output was produced, a consumer that sees it grow by more than one missed frames
+	uint64_t producedCount = 0;
+
+	// Changes only when the pixels do, from a counter of the stream, so a consumer skips outputs it already has
+	uint64_t version = 0;
+};
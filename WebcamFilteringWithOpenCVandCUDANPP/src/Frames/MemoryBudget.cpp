@@ -0,0 +1,173 @@
+#include "MemoryBudget.h"
+
+#include <algorithm>
+
+
+namespace
+{
+	MetricLabels getOwnerLabels(const std::string& stream, const std::string& owner)
+	{
+		if (stream.empty())
+			return { { "owner", owner } };
+
+		return { { "stream", stream }, { "owner", owner } };
+	}
+}
+
+
+MemoryBudget::MemoryBudget() :
+	m_LimitBytes(0),
+	m_UsedBytes(0),
+	m_PeakBytes(0),
+	m_RefusedCount(0),
+	m_ChangesCount(0),
+	m_MetricsCollector([this]() { collectMetrics(); })
+{
+}
+
+MemoryBudget& MemoryBudget::getInstance()
+{
+	static MemoryBudget memoryBudget;
+	return memoryBudget;
+}
+
+void MemoryBudget::setLimit(size_t limitBytes)
+{
+	std::lock_guard<std::mutex> lock(m_OwnersMutex);
+	m_LimitBytes = limitBytes;
+	m_ChangesCount.fetch_add(1, std::memory_order_release);
+}
+
+size_t MemoryBudget::getLimit() const
+{
+	std::lock_guard<std::mutex> lock(m_OwnersMutex);
+	return m_LimitBytes;
+}
+
+MemoryBudgetStats MemoryBudget::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_OwnersMutex);
+
+	MemoryBudgetStats memoryBudgetStats;
+	memoryBudgetStats.limitBytes = m_LimitBytes;
+	memoryBudgetStats.usedBytes = m_UsedBytes;
+	memoryBudgetStats.peakBytes = m_PeakBytes;
+	memoryBudgetStats.refusedCount = m_RefusedCount;
+
+	for (const auto& owner : m_Owners)
+	{
+		memoryBudgetStats.owners.push_back({ owner.first.first, owner.first.second,
+											 owner.second.currentBytes, owner.second.peakBytes, owner.second.refusedCount });
+	}
+
+	return memoryBudgetStats;
+}
+
+uint64_t MemoryBudget::getChangesCount() const
+{
+	return m_ChangesCount.load(std::memory_order_acquire);
+}
+
+size_t MemoryBudget::getBytes(const cv::Mat& mat)
+{
+	if (mat.u == nullptr)
+		return 0;
+
+	return mat.total() * mat.elemSize();
+}
+
+// Rows are pitched on the device, the padding is allocated too
+size_t MemoryBudget::getBytes(const cv::cuda::GpuMat& gpuMat)
+{
+	if (gpuMat.empty())
+		return 0;
+
+	return gpuMat.step * gpuMat.rows;
+}
+
+void MemoryBudget::changeBytes(const OwnerKey& ownerKey, size_t previousBytes, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_OwnersMutex);
+
+	OwnerUsage& ownerUsage = m_Owners[ownerKey];
+	ownerUsage.currentBytes = ownerUsage.currentBytes - previousBytes + bytes;
+	ownerUsage.peakBytes = std::max(ownerUsage.peakBytes, ownerUsage.currentBytes);
+
+	m_UsedBytes = m_UsedBytes - previousBytes + bytes;
+	m_PeakBytes = std::max(m_PeakBytes, m_UsedBytes);
+	m_ChangesCount.fetch_add(1, std::memory_order_release);
+}
+
+bool MemoryBudget::requestBytes(const OwnerKey& ownerKey, size_t additionalBytes)
+{
+	std::lock_guard<std::mutex> lock(m_OwnersMutex);
+
+	if (m_LimitBytes == 0 || m_UsedBytes + additionalBytes <= m_LimitBytes)
+		return true;
+
+	m_Owners[ownerKey].refusedCount++;
+	m_RefusedCount++;
+
+	return false;
+}
+
+void MemoryBudget::collectMetrics() const
+{
+	MemoryBudgetStats memoryBudgetStats = getStats();
+
+	MetricsRegistry& metricsRegistry = MetricsRegistry::getInstance();
+	const char* ownerHelp = "Bytes of frame-sized buffers held by an owner";
+	const char* budgetHelp = "Bytes of frame-sized buffers of the whole process";
+
+	for (const MemoryOwnerUsage& ownerUsage : memoryBudgetStats.owners)
+	{
+		MetricLabels currentLabels = getOwnerLabels(ownerUsage.stream, ownerUsage.owner);
+		MetricLabels peakLabels = currentLabels;
+
+		currentLabels.push_back({ "state", "current" });
+		peakLabels.push_back({ "state", "peak" });
+
+		metricsRegistry.getGauge("webcam_memory_bytes", ownerHelp, currentLabels).set(static_cast<double>(ownerUsage.currentBytes));
+		metricsRegistry.getGauge("webcam_memory_bytes", ownerHelp, peakLabels).set(static_cast<double>(ownerUsage.peakBytes));
+	}
+
+	metricsRegistry.getGauge("webcam_memory_budget_bytes", budgetHelp, { { "state", "used" } }).set(static_cast<double>(memoryBudgetStats.usedBytes));
+	metricsRegistry.getGauge("webcam_memory_budget_bytes", budgetHelp, { { "state", "peak" } }).set(static_cast<double>(memoryBudgetStats.peakBytes));
+	metricsRegistry.getGauge("webcam_memory_budget_bytes", budgetHelp, { { "state", "limit" } }).set(static_cast<double>(memoryBudgetStats.limitBytes));
+}
+
+MemoryAccount::MemoryAccount(std::string owner, std::string stream) :
+	m_OwnerKey(std::move(stream), std::move(owner)),
+	m_Bytes(0),
+	m_RefusedMetric(MetricsRegistry::getInstance().getCounter("webcam_memory_refused_total", "Allocations refused by the memory budget",
+															  getOwnerLabels(m_OwnerKey.first, m_OwnerKey.second)))
+{
+}
+
+MemoryAccount::~MemoryAccount()
+{
+	setBytes(0);
+}
+
+void MemoryAccount::setBytes(size_t bytes)
+{
+	if (bytes == m_Bytes)
+		return;
+
+	MemoryBudget::getInstance().changeBytes(m_OwnerKey, m_Bytes, bytes);
+	m_Bytes = bytes;
+}
+
+size_t MemoryAccount::getBytes() const
+{
+	return m_Bytes;
+}
+
+bool MemoryAccount::request(size_t additionalBytes)
+{
+	if (MemoryBudget::getInstance().requestBytes(m_OwnerKey, additionalBytes))
+		return true;
+
+	m_RefusedMetric.add();
+	return false;
+}
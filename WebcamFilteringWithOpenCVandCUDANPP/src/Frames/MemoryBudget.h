@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv4/opencv2/core/cuda.hpp>
+
+#include "Metrics/MetricsRegistry.h"
+
+
+struct MemoryOwnerUsage
+{
+	// Empty for owners that belong to no stream, e.g. the view and the sinks
+	std::string stream;
+	std::string owner;
+
+	size_t currentBytes;
+	size_t peakBytes;
+	uint64_t refusedCount;
+};
+
+struct MemoryBudgetStats
+{
+	// 0 is unlimited
+	size_t limitBytes;
+	size_t usedBytes;
+	size_t peakBytes;
+	uint64_t refusedCount;
+
+	std::vector<MemoryOwnerUsage> owners;
+};
+
+// Process-wide accounting of the frame-sized buffers, CPU and GPU alike, by the stream and the owner holding them.
+// Owners report what they hold through a MemoryAccount and ask for the bytes before they allocate a new output.
+// Past the limit the new output is refused, buffers already held are never taken away.
+class MemoryBudget
+{
+public:
+	static MemoryBudget& getInstance();
+
+	void setLimit(size_t limitBytes);
+	size_t getLimit() const;
+
+	MemoryBudgetStats getStats() const;
+
+	// Changes with the limit and with every change of the used bytes, without a lock.
+	// An owner that was refused only asks again once it differs.
+	uint64_t getChangesCount() const;
+
+	// External memory, e.g. a mapped recording, is not owned by the header and counts as nothing
+	static size_t getBytes(const cv::Mat& mat);
+	static size_t getBytes(const cv::cuda::GpuMat& gpuMat);
+
+private:
+	friend class MemoryAccount;
+
+	// Stream and owner
+	using OwnerKey = std::pair<std::string, std::string>;
+
+	struct OwnerUsage
+	{
+		size_t currentBytes = 0;
+		size_t peakBytes = 0;
+		uint64_t refusedCount = 0;
+	};
+
+	MemoryBudget();
+
+	void changeBytes(const OwnerKey& ownerKey, size_t previousBytes, size_t bytes);
+	bool requestBytes(const OwnerKey& ownerKey, size_t additionalBytes);
+
+	void collectMetrics() const;
+
+	mutable std::mutex m_OwnersMutex;
+	// Owners stay listed once their buffers are gone, their peak is still of interest
+	std::map<OwnerKey, OwnerUsage> m_Owners;
+	size_t m_LimitBytes;
+	size_t m_UsedBytes;
+	size_t m_PeakBytes;
+	uint64_t m_RefusedCount;
+	std::atomic<uint64_t> m_ChangesCount;
+
+	// Declared last, so it is unregistered before the owners go away
+	MetricsCollector m_MetricsCollector;
+};
+
+// The bytes one owner holds, e.g. the Sobel output of a stream. The owner sets them whenever its buffers may have changed,
+// they are given back when the account goes away. Accounts of the same stream and owner add up.
+class MemoryAccount
+{
+public:
+	explicit MemoryAccount(std::string owner, std::string stream = "");
+	~MemoryAccount();
+
+	MemoryAccount(const MemoryAccount&) = delete;
+	MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+	void setBytes(size_t bytes);
+	size_t getBytes() const;
+
+	// Whether the owner may allocate that much more, a refusal is counted for the owner
+	bool request(size_t additionalBytes);
+
+private:
+	MemoryBudget::OwnerKey m_OwnerKey;
+	size_t m_Bytes;
+
+	// Looked up once, a refusal only adds to it
+	MetricsCounter& m_RefusedMetric;
+};
@@ -0,0 +1,123 @@
+#include "YuvFrame.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <nppi_color_conversion.h>
+
+#include <opencv4/opencv2/cudaarithm.hpp>
+
+
+YuvFrame::YuvFrame() :
+	m_Size(0, 0)
+{
+}
+
+void YuvFrame::create(const cv::Size& frameSize)
+{
+	m_Size = frameSize;
+
+	cv::Size chromaSize((frameSize.width + 1) / 2, (frameSize.height + 1) / 2);
+
+	m_Luma.create(frameSize, CV_8UC1);
+	m_ChromaU.create(chromaSize, CV_8UC1);
+	m_ChromaV.create(chromaSize, CV_8UC1);
+}
+
+void YuvFrame::release()
+{
+	m_Size = cv::Size(0, 0);
+
+	m_Luma.release();
+	m_ChromaU.release();
+	m_ChromaV.release();
+}
+
+bool YuvFrame::empty() const
+{
+	return m_Luma.empty();
+}
+
+bool YuvFrame::fromBGR(const cv::cuda::GpuMat& bgrFrame)
+{
+	if (bgrFrame.size() != m_Size)
+		create(bgrFrame.size());
+
+	Npp8u* planes[3] = { m_Luma.ptr(), m_ChromaU.ptr(), m_ChromaV.ptr() };
+	int planeSteps[3] = { static_cast<int>(m_Luma.step), static_cast<int>(m_ChromaU.step), static_cast<int>(m_ChromaV.step) };
+
+	NppStatus status = nppiBGRToYCbCr420_8u_C3P3R(bgrFrame.ptr(), static_cast<int>(bgrFrame.step),
+												  planes, planeSteps,
+												  { m_Size.width, m_Size.height });
+	if (status != NPP_SUCCESS)
+	{
+		std::cerr << "Error converting BGR to YCbCr420: " << status << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool YuvFrame::toBGR(cv::cuda::GpuMat& bgrFrame)
+{
+	return toBGR(bgrFrame, cv::Rect(0, 0, m_Size.width, m_Size.height));
+}
+
+bool YuvFrame::toBGR(cv::cuda::GpuMat& bgrFrame, const cv::Rect& area)
+{
+	bgrFrame.create(m_Size, CV_8UC3);
+
+	int left = area.x & ~1;
+	int top = area.y & ~1;
+	int right = std::min(area.x + area.width + (area.x + area.width) % 2, m_Size.width);
+	int bottom = std::min(area.y + area.height + (area.y + area.height) % 2, m_Size.height);
+
+	if (right <= left || bottom <= top)
+		return true;
+
+	const Npp8u* planes[3] = {
+		m_Luma.ptr(top) + left,
+		m_ChromaU.ptr(top / 2) + left / 2,
+		m_ChromaV.ptr(top / 2) + left / 2
+	};
+	int planeSteps[3] = { static_cast<int>(m_Luma.step), static_cast<int>(m_ChromaU.step), static_cast<int>(m_ChromaV.step) };
+
+	NppStatus status = nppiYCbCr420ToBGR_8u_P3C3R(planes, planeSteps,
+												  bgrFrame.ptr(top) + left * 3, static_cast<int>(bgrFrame.step),
+												  { right - left, bottom - top });
+	if (status != NPP_SUCCESS)
+	{
+		std::cerr << "Error converting YCbCr420 to BGR: " << status << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// Chroma planes are flipped at quarter resolution
+void YuvFrame::flipHorizontal()
+{
+	cv::cuda::flip(m_Luma, m_Luma, 1);
+	cv::cuda::flip(m_ChromaU, m_ChromaU, 1);
+	cv::cuda::flip(m_ChromaV, m_ChromaV, 1);
+}
+
+cv::Size YuvFrame::getSize() const
+{
+	return m_Size;
+}
+
+cv::cuda::GpuMat& YuvFrame::getLuma()
+{
+	return m_Luma;
+}
+
+cv::cuda::GpuMat& YuvFrame::getChromaU()
+{
+	return m_ChromaU;
+}
+
+cv::cuda::GpuMat& YuvFrame::getChromaV()
+{
+	return m_ChromaV;
+}
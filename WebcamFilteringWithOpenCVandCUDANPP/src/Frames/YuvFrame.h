@@ -0,0 +1,36 @@
+#pragma once
+
+#include <opencv4/opencv2/core/cuda.hpp>
+
+
+// Planar YCbCr 4:2:0 (I420) frame kept on the GPU.
+// Luma is full resolution, both chroma planes are quarter resolution.
+class YuvFrame
+{
+public:
+	YuvFrame();
+
+	void create(const cv::Size& frameSize);
+	void release();
+	bool empty() const;
+
+	bool fromBGR(const cv::cuda::GpuMat& bgrFrame);
+	bool toBGR(cv::cuda::GpuMat& bgrFrame);
+	// Converts only the given area, widened to even coordinates for the chroma planes
+	bool toBGR(cv::cuda::GpuMat& bgrFrame, const cv::Rect& area);
+
+	void flipHorizontal();
+
+	cv::Size getSize() const;
+
+	cv::cuda::GpuMat& getLuma();
+	cv::cuda::GpuMat& getChromaU();
+	cv::cuda::GpuMat& getChromaV();
+
+private:
+	cv::Size m_Size;
+
+	cv::cuda::GpuMat m_Luma;
+	cv::cuda::GpuMat m_ChromaU;
+	cv::cuda::GpuMat m_ChromaV;
+};
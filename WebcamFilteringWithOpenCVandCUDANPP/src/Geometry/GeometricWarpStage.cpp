@@ -0,0 +1,52 @@
+#include "GeometricWarpStage.h"
+
+
+GeometricWarpStage::GeometricWarpStage(WorkerPool& workerPool) :
+	m_WorkerPool(workerPool),
+	m_Enabled(false)
+{
+}
+
+void GeometricWarpStage::configure(const WarpParameters& warpParameters)
+{
+	m_WarpParameters = warpParameters;
+	m_Enabled = true;
+
+	// Resolved on the next frame, when the frame size is known
+	m_RemapTable.reset();
+}
+
+void GeometricWarpStage::disable()
+{
+	m_Enabled = false;
+	m_RemapTable.reset();
+}
+
+bool GeometricWarpStage::isEnabled() const
+{
+	return m_Enabled;
+}
+
+const WarpParameters& GeometricWarpStage::getWarpParameters() const
+{
+	return m_WarpParameters;
+}
+
+void GeometricWarpStage::apply(const cv::Mat& frame, cv::Mat& warpedFrame)
+{
+	if (m_RemapTable == nullptr || m_RemapTable->getSize() != frame.size())
+		m_RemapTable = m_RemapTableCache.get(m_WarpParameters, frame.size());
+
+	m_RemapTable->apply(frame, warpedFrame, m_WorkerPool);
+}
+
+void GeometricWarpStage::prewarm(const cv::Size& frameSize)
+{
+	if (m_Enabled && (m_RemapTable == nullptr || m_RemapTable->getSize() != frameSize))
+		m_RemapTable = m_RemapTableCache.get(m_WarpParameters, frameSize);
+}
+
+const RemapTableCache& GeometricWarpStage::getRemapTableCache() const
+{
+	return m_RemapTableCache;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "RemapTableCache.h"
+#include "WarpParameters.h"
+
+class WorkerPool;
+
+
+// Applies lens undistortion and the perspective warp to captured frames.
+// The remap table is resolved once per configuration and frame size, every frame is a table lookup
+// with fixed-point bilinear interpolation.
+class GeometricWarpStage
+{
+public:
+	explicit GeometricWarpStage(WorkerPool& workerPool);
+
+	void configure(const WarpParameters& warpParameters);
+	void disable();
+
+	bool isEnabled() const;
+	const WarpParameters& getWarpParameters() const;
+
+	void apply(const cv::Mat& frame, cv::Mat& warpedFrame);
+	// Resolves the table before the first frame of that size arrives
+	void prewarm(const cv::Size& frameSize);
+
+	const RemapTableCache& getRemapTableCache() const;
+
+private:
+	WorkerPool& m_WorkerPool;
+
+	bool m_Enabled;
+	WarpParameters m_WarpParameters;
+
+	RemapTableCache m_RemapTableCache;
+	std::shared_ptr<const RemapTable> m_RemapTable;
+};
@@ -0,0 +1,51 @@
+#include "RegionOfInterest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+
+namespace RegionOfInterest
+{
+	bool parse(const std::string& regionValues, cv::Rect2d& regionOfInterest)
+	{
+		std::stringstream values(regionValues);
+		std::string value;
+		double parsedValues[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+		for (double& parsedValue : parsedValues)
+		{
+			if (!std::getline(values, value, ','))
+				return false;
+
+			char* valueEnd = nullptr;
+			parsedValue = std::strtod(value.c_str(), &valueEnd);
+			if (valueEnd == value.c_str() || parsedValue < 0.0 || parsedValue > 1.0)
+				return false;
+		}
+
+		regionOfInterest = cv::Rect2d(parsedValues[0], parsedValues[1], parsedValues[2], parsedValues[3]);
+
+		return regionOfInterest.width > 0.0 && regionOfInterest.height > 0.0;
+	}
+
+	cv::Rect getFrameRect(const cv::Rect2d& regionOfInterest, const cv::Size& frameSize)
+	{
+		int width = std::clamp(static_cast<int>(regionOfInterest.width * frameSize.width) & ~1, 16, frameSize.width & ~1);
+		int height = std::clamp(static_cast<int>(regionOfInterest.height * frameSize.height) & ~1, 16, frameSize.height & ~1);
+		int x = std::clamp(static_cast<int>(regionOfInterest.x * frameSize.width) & ~1, 0, (frameSize.width - width) & ~1);
+		int y = std::clamp(static_cast<int>(regionOfInterest.y * frameSize.height) & ~1, 0, (frameSize.height - height) & ~1);
+
+		return cv::Rect(x, y, width, height);
+	}
+
+	cv::Rect getProcessingRect(const cv::Rect& regionOfInterestRect, const cv::Size& frameSize, int halo)
+	{
+		int evenHalo = (halo + 1) & ~1;
+
+		cv::Rect processingRect(regionOfInterestRect.x - evenHalo, regionOfInterestRect.y - evenHalo,
+								regionOfInterestRect.width + 2 * evenHalo, regionOfInterestRect.height + 2 * evenHalo);
+
+		return processingRect & cv::Rect(0, 0, frameSize.width & ~1, frameSize.height & ~1);
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include <opencv4/opencv2/core/types.hpp>
+
+
+// Region the filters are limited to, given relative to the frame so it survives resolution changes
+namespace RegionOfInterest
+{
+	// x,y,width,height relative to the frame
+	bool parse(const std::string& regionValues, cv::Rect2d& regionOfInterest);
+
+	// In pixels of a frame of that size, on even pixels for the chroma planes
+	cv::Rect getFrameRect(const cv::Rect2d& regionOfInterest, const cv::Size& frameSize);
+	// Grown by the halo of the filters, so kernels at the border see real neighbours
+	cv::Rect getProcessingRect(const cv::Rect& regionOfInterestRect, const cv::Size& frameSize, int halo);
+}
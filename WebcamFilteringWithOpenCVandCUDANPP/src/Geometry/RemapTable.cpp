@@ -0,0 +1,236 @@
+#include "RemapTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+#include "Simd/SimdConfig.h"
+#include "Threading/WorkerPool.h"
+
+
+namespace
+{
+	constexpr int weightShift = 2 * RemapTable::fractionBits;
+	constexpr int weightRounding = 1 << (weightShift - 1);
+
+	inline void interpolatePixelScalar(const uint8_t* top, const uint8_t* bottom, int fractionX, int fractionY, uint8_t* output)
+	{
+		const int weightTopLeft = (RemapTable::fractionScale - fractionX) * (RemapTable::fractionScale - fractionY);
+		const int weightTopRight = fractionX * (RemapTable::fractionScale - fractionY);
+		const int weightBottomLeft = (RemapTable::fractionScale - fractionX) * fractionY;
+		const int weightBottomRight = fractionX * fractionY;
+
+		for (int channel = 0; channel < 3; channel++)
+		{
+			int value = top[channel] * weightTopLeft + top[channel + 3] * weightTopRight +
+				bottom[channel] * weightBottomLeft + bottom[channel + 3] * weightBottomRight;
+
+			output[channel] = static_cast<uint8_t>((value + weightRounding) >> weightShift);
+		}
+	}
+}
+
+
+RemapTable::RemapTable()
+{
+}
+
+void RemapTable::build(const WarpParameters& warpParameters, const cv::Size& frameSize)
+{
+	m_Size = frameSize;
+	m_Entries.resize(static_cast<size_t>(frameSize.width) * frameSize.height);
+
+	const double focal = warpParameters.focalLength * frameSize.width;
+	const double centerX = (frameSize.width - 1) * 0.5;
+	const double centerY = (frameSize.height - 1) * 0.5;
+	const auto& h = warpParameters.perspective;
+
+	for (int y = 0; y < frameSize.height; y++)
+	{
+		Entry* entries = m_Entries.data() + static_cast<size_t>(y) * frameSize.width;
+
+		for (int x = 0; x < frameSize.width; x++)
+		{
+			int outputX = warpParameters.mirrorHorizontally ? frameSize.width - 1 - x : x;
+
+			double u = (outputX - centerX) / focal;
+			double v = (y - centerY) / focal;
+
+			// Output position on the undistorted image plane
+			double w = h[6] * u + h[7] * v + h[8];
+			double undistortedX = (h[0] * u + h[1] * v + h[2]) / w;
+			double undistortedY = (h[3] * u + h[4] * v + h[5]) / w;
+
+			// Where the lens put that point on the sensor
+			double r2 = undistortedX * undistortedX + undistortedY * undistortedY;
+			double radial = 1.0 + r2 * (warpParameters.k1 + r2 * (warpParameters.k2 + r2 * warpParameters.k3));
+			double distortedX = undistortedX * radial + 2.0 * warpParameters.p1 * undistortedX * undistortedY +
+				warpParameters.p2 * (r2 + 2.0 * undistortedX * undistortedX);
+			double distortedY = undistortedY * radial + warpParameters.p1 * (r2 + 2.0 * undistortedY * undistortedY) +
+				2.0 * warpParameters.p2 * undistortedX * undistortedY;
+
+			double sourceX = distortedX * focal + centerX;
+			double sourceY = distortedY * focal + centerY;
+
+			Entry& entry = entries[x];
+
+			if (w <= 0.0 || !(sourceX >= 0.0 && sourceY >= 0.0 && sourceX <= frameSize.width - 1 && sourceY <= frameSize.height - 1))
+			{
+				entry = { -1, 0, 0, 0 };
+				continue;
+			}
+
+			// The right and bottom neighbours must exist, the last column and row get a full weight instead
+			int sourceColumn = std::min(static_cast<int>(sourceX), frameSize.width - 2);
+			int sourceRow = std::min(static_cast<int>(sourceY), frameSize.height - 2);
+
+			entry.x = static_cast<int16_t>(sourceColumn);
+			entry.y = static_cast<int16_t>(sourceRow);
+			entry.fractionX = static_cast<uint8_t>(std::lround((sourceX - sourceColumn) * fractionScale));
+			entry.fractionY = static_cast<uint8_t>(std::lround((sourceY - sourceRow) * fractionScale));
+		}
+	}
+}
+
+void RemapTable::apply(const cv::Mat& source, cv::Mat& destination, WorkerPool& workerPool) const
+{
+	// Frames the table was not built for pass through unchanged
+	if (source.type() != CV_8UC3 || source.size() != m_Size)
+	{
+		source.copyTo(destination);
+		return;
+	}
+
+	destination.create(m_Size, CV_8UC3);
+
+	workerPool.parallelFor(0, m_Size.height, [&](int rowBegin, int rowEnd)
+	{
+		applyRows(source, destination, rowBegin, rowEnd);
+	});
+}
+
+void RemapTable::apply(const cv::Mat& source, cv::Mat& destination) const
+{
+	if (source.type() != CV_8UC3 || source.size() != m_Size)
+	{
+		source.copyTo(destination);
+		return;
+	}
+
+	destination.create(m_Size, CV_8UC3);
+
+	applyRows(source, destination, 0, m_Size.height);
+}
+
+void RemapTable::applyRows(const cv::Mat& source, cv::Mat& destination, int rowBegin, int rowEnd) const
+{
+	const size_t sourceStep = source.step;
+
+	// 8 byte loads read two bytes past the right neighbour, only the very end of the frame needs the scalar path
+	const uint8_t* sourceEnd = source.ptr(m_Size.height - 1) + m_Size.width * 3;
+
+#if SIMD_SSE2_AVAILABLE
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi32(weightRounding);
+#endif
+
+	for (int y = rowBegin; y < rowEnd; y++)
+	{
+		const Entry* entries = m_Entries.data() + static_cast<size_t>(y) * m_Size.width;
+		uint8_t* output = destination.ptr(y);
+
+		for (int x = 0; x < m_Size.width; x++, output += 3)
+		{
+			const Entry& entry = entries[x];
+
+			if (entry.x < 0)
+			{
+				output[0] = output[1] = output[2] = 0;
+				continue;
+			}
+
+			const uint8_t* top = source.data + entry.y * sourceStep + entry.x * 3;
+			const uint8_t* bottom = top + sourceStep;
+
+#if SIMD_SSE2_AVAILABLE
+			if (bottom + 8 <= sourceEnd)
+			{
+				// Both pixels of a row side by side as 16 bit: B0 G0 R0 B1 G1 R1
+				__m128i topPixels = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(top)), zero);
+				__m128i bottomPixels = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bottom)), zero);
+
+				const __m128i weightRight = _mm_set1_epi16(entry.fractionX);
+				const __m128i weightLeft = _mm_set1_epi16(static_cast<short>(fractionScale - entry.fractionX));
+
+				__m128i topRow = _mm_add_epi16(_mm_mullo_epi16(topPixels, weightLeft), _mm_mullo_epi16(_mm_srli_si128(topPixels, 6), weightRight));
+				__m128i bottomRow = _mm_add_epi16(_mm_mullo_epi16(bottomPixels, weightLeft), _mm_mullo_epi16(_mm_srli_si128(bottomPixels, 6), weightRight));
+
+				// Vertical blend of interleaved top/bottom pairs in 32 bit
+				const __m128i weightsVertical = _mm_set1_epi32((entry.fractionY << 16) | (fractionScale - entry.fractionY));
+				__m128i blended = _mm_madd_epi16(_mm_unpacklo_epi16(topRow, bottomRow), weightsVertical);
+				blended = _mm_srli_epi32(_mm_add_epi32(blended, rounding), weightShift);
+
+				blended = _mm_packs_epi32(blended, blended);
+				blended = _mm_packus_epi16(blended, blended);
+
+				uint32_t pixel = static_cast<uint32_t>(_mm_cvtsi128_si32(blended));
+				std::memcpy(output, &pixel, 3);
+				continue;
+			}
+#endif
+
+			interpolatePixelScalar(top, bottom, entry.fractionX, entry.fractionY, output);
+		}
+	}
+}
+
+bool RemapTable::write(std::ostream& stream) const
+{
+	int32_t size[2] = { m_Size.width, m_Size.height };
+
+	stream.write(reinterpret_cast<const char*>(size), sizeof(size));
+	stream.write(reinterpret_cast<const char*>(m_Entries.data()), m_Entries.size() * sizeof(Entry));
+
+	return stream.good();
+}
+
+bool RemapTable::read(std::istream& stream, const cv::Size& frameSize)
+{
+	int32_t size[2] = { 0, 0 };
+
+	stream.read(reinterpret_cast<char*>(size), sizeof(size));
+	if (!stream || size[0] != frameSize.width || size[1] != frameSize.height)
+		return false;
+
+	m_Size = frameSize;
+	m_Entries.resize(static_cast<size_t>(frameSize.width) * frameSize.height);
+
+	stream.read(reinterpret_cast<char*>(m_Entries.data()), m_Entries.size() * sizeof(Entry));
+	if (!stream)
+		return false;
+
+	// A damaged file must not send the interpolation outside the source frame
+	for (const Entry& entry : m_Entries)
+	{
+		if (entry.x == -1)
+			continue;
+
+		if (entry.x < 0 || entry.x > frameSize.width - 2 || entry.y < 0 || entry.y > frameSize.height - 2 ||
+			entry.fractionX > fractionScale || entry.fractionY > fractionScale)
+			return false;
+	}
+
+	return true;
+}
+
+cv::Size RemapTable::getSize() const
+{
+	return m_Size;
+}
+
+size_t RemapTable::getMemorySize() const
+{
+	return m_Entries.size() * sizeof(Entry);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "WarpParameters.h"
+
+class WorkerPool;
+
+
+// Fixed-point source position of every output pixel.
+// Positions keep 5 fractional bits, the bilinear weights of a pixel always add up to 32 * 32.
+class RemapTable
+{
+public:
+	static constexpr int fractionBits = 5;
+	static constexpr int fractionScale = 1 << fractionBits;
+
+	struct Entry
+	{
+		// Top left source pixel, x is -1 when the source lies outside the frame
+		int16_t x;
+		int16_t y;
+		uint8_t fractionX;
+		uint8_t fractionY;
+	};
+
+	RemapTable();
+
+	void build(const WarpParameters& warpParameters, const cv::Size& frameSize);
+
+	// Source frames are CV_8UC3 and of the size the table was built for, pixels without source are black
+	void apply(const cv::Mat& source, cv::Mat& destination, WorkerPool& workerPool) const;
+	// All rows on the calling thread, for callers that already run one frame per worker
+	void apply(const cv::Mat& source, cv::Mat& destination) const;
+
+	bool write(std::ostream& stream) const;
+	bool read(std::istream& stream, const cv::Size& frameSize);
+
+	cv::Size getSize() const;
+	size_t getMemorySize() const;
+
+private:
+	void applyRows(const cv::Mat& source, cv::Mat& destination, int rowBegin, int rowEnd) const;
+
+	cv::Size m_Size;
+	std::vector<Entry> m_Entries;
+};
@@ -0,0 +1,179 @@
+#include "RemapTableCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+
+namespace
+{
+	constexpr char fileMagic[4] = { 'R', 'M', 'A', 'P' };
+	constexpr uint32_t fileVersion = 1;
+
+	uint64_t hashCacheKey(const std::string& cacheKey)
+	{
+		// FNV-1a, stable across runs and compilers unlike std::hash
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned char character : cacheKey)
+		{
+			hash ^= character;
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+}
+
+
+RemapTableCache::RemapTableCache(std::filesystem::path directory, size_t maxTablesInMemory) :
+	m_Directory(std::move(directory)),
+	m_MaxTablesInMemory(maxTablesInMemory),
+	m_MemoryHitsCount(0),
+	m_DiskHitsCount(0),
+	m_BuildsCount(0)
+{
+}
+
+std::shared_ptr<const RemapTable> RemapTableCache::get(const WarpParameters& warpParameters, const cv::Size& frameSize)
+{
+	const std::string cacheKey = warpParameters.getCacheKey(frameSize);
+
+	{
+		std::lock_guard<std::mutex> lock(m_TablesMutex);
+
+		auto table = m_Tables.find(cacheKey);
+		if (table != m_Tables.end())
+		{
+			m_MemoryHitsCount++;
+			return table->second;
+		}
+	}
+
+	std::shared_ptr<RemapTable> remapTable = loadFromDisk(cacheKey, frameSize);
+
+	if (remapTable != nullptr)
+	{
+		std::lock_guard<std::mutex> lock(m_TablesMutex);
+		m_DiskHitsCount++;
+	}
+	else
+	{
+		remapTable = std::make_shared<RemapTable>();
+		remapTable->build(warpParameters, frameSize);
+
+		saveToDisk(cacheKey, *remapTable);
+
+		std::lock_guard<std::mutex> lock(m_TablesMutex);
+		m_BuildsCount++;
+	}
+
+	keepInMemory(cacheKey, remapTable);
+
+	return remapTable;
+}
+
+void RemapTableCache::keepInMemory(const std::string& cacheKey, std::shared_ptr<const RemapTable> remapTable)
+{
+	std::lock_guard<std::mutex> lock(m_TablesMutex);
+
+	if (m_Tables.emplace(cacheKey, std::move(remapTable)).second)
+		m_TablesOrder.push_back(cacheKey);
+
+	// Tables still in use stay alive through their shared_ptr
+	while (m_TablesOrder.size() > m_MaxTablesInMemory)
+	{
+		m_Tables.erase(m_TablesOrder.front());
+		m_TablesOrder.pop_front();
+	}
+}
+
+std::filesystem::path RemapTableCache::getFilePath(const std::string& cacheKey) const
+{
+	std::ostringstream fileName;
+	fileName << std::hex << std::setw(16) << std::setfill('0') << hashCacheKey(cacheKey) << ".remap";
+
+	return m_Directory / fileName.str();
+}
+
+std::shared_ptr<RemapTable> RemapTableCache::loadFromDisk(const std::string& cacheKey, const cv::Size& frameSize) const
+{
+	std::ifstream file(getFilePath(cacheKey), std::ios::binary);
+	if (!file)
+		return nullptr;
+
+	char magic[4] = {};
+	uint32_t version = 0;
+	uint32_t keyLength = 0;
+
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+
+	if (!file || std::memcmp(magic, fileMagic, sizeof(magic)) != 0 || version != fileVersion || keyLength != cacheKey.size())
+		return nullptr;
+
+	// The full key is stored to rule out hash collisions
+	std::string storedKey(keyLength, '\0');
+	file.read(storedKey.data(), keyLength);
+	if (!file || storedKey != cacheKey)
+		return nullptr;
+
+	auto remapTable = std::make_shared<RemapTable>();
+	if (!remapTable->read(file, frameSize))
+		return nullptr;
+
+	return remapTable;
+}
+
+void RemapTableCache::saveToDisk(const std::string& cacheKey, const RemapTable& remapTable) const
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(m_Directory, errorCode);
+
+	const std::filesystem::path filePath = getFilePath(cacheKey);
+	std::filesystem::path temporaryPath = filePath;
+	temporaryPath += ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+
+		uint32_t keyLength = static_cast<uint32_t>(cacheKey.size());
+
+		file.write(fileMagic, sizeof(fileMagic));
+		file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+		file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+		file.write(cacheKey.data(), keyLength);
+
+		if (!remapTable.write(file))
+		{
+			std::cout << "Warning: Could not write remap table cache " << temporaryPath.string() << "\n";
+			file.close();
+			std::filesystem::remove(temporaryPath, errorCode);
+			return;
+		}
+	}
+
+	// Readers never see a partially written table
+	std::filesystem::rename(temporaryPath, filePath, errorCode);
+}
+
+uint64_t RemapTableCache::getMemoryHitsCount() const
+{
+	std::lock_guard<std::mutex> lock(m_TablesMutex);
+	return m_MemoryHitsCount;
+}
+
+uint64_t RemapTableCache::getDiskHitsCount() const
+{
+	std::lock_guard<std::mutex> lock(m_TablesMutex);
+	return m_DiskHitsCount;
+}
+
+uint64_t RemapTableCache::getBuildsCount() const
+{
+	std::lock_guard<std::mutex> lock(m_TablesMutex);
+	return m_BuildsCount;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "RemapTable.h"
+
+
+// Remap tables are expensive to build, they are kept in memory and in a directory on disk,
+// keyed by the warp parameters and the frame size.
+class RemapTableCache
+{
+public:
+	explicit RemapTableCache(std::filesystem::path directory = "remap_cache", size_t maxTablesInMemory = 4);
+
+	std::shared_ptr<const RemapTable> get(const WarpParameters& warpParameters, const cv::Size& frameSize);
+
+	uint64_t getMemoryHitsCount() const;
+	uint64_t getDiskHitsCount() const;
+	uint64_t getBuildsCount() const;
+
+private:
+	std::filesystem::path getFilePath(const std::string& cacheKey) const;
+
+	std::shared_ptr<RemapTable> loadFromDisk(const std::string& cacheKey, const cv::Size& frameSize) const;
+	void saveToDisk(const std::string& cacheKey, const RemapTable& remapTable) const;
+
+	void keepInMemory(const std::string& cacheKey, std::shared_ptr<const RemapTable> remapTable);
+
+	std::filesystem::path m_Directory;
+	size_t m_MaxTablesInMemory;
+
+	mutable std::mutex m_TablesMutex;
+	std::unordered_map<std::string, std::shared_ptr<const RemapTable>> m_Tables;
+	std::deque<std::string> m_TablesOrder;
+
+	uint64_t m_MemoryHitsCount;
+	uint64_t m_DiskHitsCount;
+	uint64_t m_BuildsCount;
+};
@@ -0,0 +1,51 @@
+#include "WarpParameters.h"
+
+#include <cstdlib>
+#include <sstream>
+
+
+bool WarpParameters::parse(const std::string& warpValues, WarpParameters& warpParameters)
+{
+	std::stringstream values(warpValues);
+	std::string value;
+	double parsedValues[3] = { 0.0, 0.0, 0.0 };
+
+	for (double& parsedValue : parsedValues)
+	{
+		if (!std::getline(values, value, ','))
+			return false;
+
+		char* valueEnd = nullptr;
+		parsedValue = std::strtod(value.c_str(), &valueEnd);
+		if (valueEnd == value.c_str())
+			return false;
+	}
+
+	warpParameters.k1 = parsedValues[0];
+	warpParameters.k2 = parsedValues[1];
+	warpParameters.setKeystone(parsedValues[2]);
+
+	return true;
+}
+
+std::string WarpParameters::getCacheKey(const cv::Size& frameSize) const
+{
+	std::ostringstream cacheKey;
+
+	// Hex floats keep the key exact, two parameter sets never share a table by rounding
+	cacheKey << std::hexfloat
+		<< frameSize.width << 'x' << frameSize.height
+		<< ";k=" << k1 << ',' << k2 << ',' << k3
+		<< ";p=" << p1 << ',' << p2
+		<< ";f=" << focalLength
+		<< ";h=";
+
+	for (double value : perspective)
+	{
+		cacheKey << value << ',';
+	}
+
+	cacheKey << ";m=" << mirrorHorizontally;
+
+	return cacheKey.str();
+}
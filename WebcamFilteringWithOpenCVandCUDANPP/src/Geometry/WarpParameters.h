@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <opencv4/opencv2/core/types.hpp>
+
+
+// Lens and perspective correction applied to camera frames before filtering.
+// Coordinates are normalized: centred on the frame and divided by the focal length,
+// so the same parameters work for every resolution.
+struct WarpParameters
+{
+	// Brown-Conrady distortion coefficients of the lens
+	double k1 = 0.0;
+	double k2 = 0.0;
+	double k3 = 0.0;
+	double p1 = 0.0;
+	double p2 = 0.0;
+
+	// Focal length relative to the frame width
+	double focalLength = 1.0;
+
+	// Homography from output coordinates to undistorted coordinates, row major
+	std::array<double, 9> perspective = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+
+	bool mirrorHorizontally = false;
+
+	// Vertical keystone correction, positive values widen the top of the frame
+	void setKeystone(double vertical)
+	{
+		perspective = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, vertical, 1.0 };
+	}
+
+	// k1,k2,keystone as given on the command line
+	static bool parse(const std::string& warpValues, WarpParameters& warpParameters);
+
+	// Identifies the remap table built from these parameters for one frame size
+	std::string getCacheKey(const cv::Size& frameSize) const;
+};
@@ -0,0 +1,691 @@
+#include "HeadlessRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "Capture/FrameSourceFactory.h"
+#include "Control/ConsoleCommandReader.h"
+#include "Events/ViewEvents/ActivateCombinedFilter.h"
+#include "Events/ViewEvents/AttachFrameSink.h"
+#include "Events/ViewEvents/ChangeCannyThresholds.h"
+#include "Events/ViewEvents/ChangeGeometricWarp.h"
+#include "Events/ViewEvents/ChangeQualityGovernor.h"
+#include "Events/ViewEvents/ChangeRegionOfInterest.h"
+#include "Events/ViewEvents/ViewChangeFilterEvents/ChangeActiveFilters.h"
+#include "Events/ViewEvents/ViewChangeFilterEvents/ChangeActiveFiltersOnCombinedFilter.h"
+#include "Filters/FilterNames.h"
+#include "Filters/FilterTraits.h"
+#include "Frames/MemoryBudget.h"
+#include "Geometry/RegionOfInterest.h"
+#include "Metrics/MetricsFileWriter.h"
+#include "Network/MetricsHttpServer.h"
+#include "Output/MjpegHttpSink.h"
+#include "Output/RecordingSink.h"
+#include "Output/ReplayBufferSink.h"
+#include "Output/SharedMemorySink.h"
+
+
+HeadlessRunner::HeadlessRunner(int argc, char* argv[]) :
+	m_PrintPlan(false),
+	m_QualityGovernorEnabled(false),
+	m_WarpEnabled(false),
+	m_RegionOfInterestEnabled(false),
+	m_RegionOfInterestCrop(false),
+	m_PresentFps(60.0),
+	m_ReplaySeconds(0.0),
+	m_MetricsIntervalSeconds(1.0),
+	m_ComparePlacement(false),
+	m_ArgumentsValid(parseArguments(argc, argv)),
+	m_WorkerPool(m_SessionPlan.getWorkerThreadsCount()),
+	m_AutoTuner(m_WorkerPool)
+{
+}
+
+// Files play once and as fast as they are consumed unless the arguments say otherwise
+bool HeadlessRunner::parseArguments(int argc, char* argv[])
+{
+	SessionConfig sessionConfig;
+	sessionConfig.repeatCount = 1;
+	sessionConfig.playbackFps = 0.0;
+	sessionConfig.headless = true;
+
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (std::string(argv[i]) == "--config")
+			sessionConfig.loadFile(argv[++i], m_Errors);
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--headless")
+		{
+			// The streams may come from --sources or the configuration instead
+			if (hasValue && std::string(argv[i + 1]).rfind("--", 0) != 0)
+				sessionConfig.parseArgument("--sources", argv[++i], m_Errors);
+		}
+		else if (argument == "--config" && hasValue)
+		{
+			i++;
+		}
+		else if (argument == "--plan")
+		{
+			m_PrintPlan = true;
+		}
+		else if (SessionConfig::isFlagArgument(argument))
+		{
+			sessionConfig.parseArgument(argument, "", m_Errors);
+		}
+		else if (argument == "--governor" && hasValue)
+		{
+			if (!QualityGovernor::parseLadder(argv[++i], m_QualityLadder))
+				m_Errors.push_back("Invalid --governor ladder");
+
+			m_QualityGovernorEnabled = true;
+		}
+		else if (argument == "--warp" && hasValue)
+		{
+			if (!WarpParameters::parse(argv[++i], m_WarpParameters))
+				m_Errors.push_back("Invalid --warp parameters");
+
+			m_WarpEnabled = true;
+		}
+		else if (argument == "--roi" && hasValue)
+		{
+			if (!RegionOfInterest::parse(argv[++i], m_RegionOfInterest))
+				m_Errors.push_back("Invalid --roi region");
+
+			m_RegionOfInterestEnabled = true;
+		}
+		else if (argument == "--roi-crop")
+		{
+			m_RegionOfInterestCrop = true;
+		}
+		else if (argument == "--replay" && hasValue)
+		{
+			m_ReplaySeconds = std::atof(argv[++i]);
+			if (m_ReplaySeconds <= 0.0)
+				m_Errors.push_back("Invalid --replay seconds");
+		}
+		else if (argument == "--present-fps" && hasValue)
+		{
+			m_PresentFps = std::atof(argv[++i]);
+			if (m_PresentFps <= 0.0)
+				m_Errors.push_back("Invalid --present-fps rate");
+		}
+		else if (argument == "--metrics-json" && hasValue)
+		{
+			m_MetricsJsonPath = argv[++i];
+		}
+		else if (argument == "--metrics-interval" && hasValue)
+		{
+			m_MetricsIntervalSeconds = std::atof(argv[++i]);
+			if (m_MetricsIntervalSeconds <= 0.0)
+				m_Errors.push_back("Invalid --metrics-interval seconds");
+		}
+		else if (argument == "--pin-compare")
+		{
+			m_ComparePlacement = true;
+		}
+		else if (!hasValue || !sessionConfig.parseArgument(argument, argv[++i], m_Errors))
+		{
+			m_Errors.push_back("Unknown argument " + argument);
+		}
+	}
+
+	if (sessionConfig.filters.empty())
+		sessionConfig.filters = { FilterTypeEnum::None, FilterTypeEnum::Grayscale, FilterTypeEnum::Sobel };
+
+	if (m_ComparePlacement && sessionConfig.threadPlacements.isDefault())
+		m_Errors.push_back("--pin-compare needs a thread placement");
+
+	if (m_Errors.empty())
+		SessionPlan::compile(sessionConfig, m_SessionPlan, m_Errors);
+
+	return m_Errors.empty();
+}
+
+void HeadlessRunner::printUsage() const
+{
+	for (const std::string& error : m_Errors)
+	{
+		std::cout << "Error: " << error << "\n";
+	}
+
+	std::cout
+		<< "Usage: --headless [<stream.mjpeg>[,<stream.mjpeg>...]] [session settings] [--governor cpu-filters,resolution,combined]\n"
+		<< "       [--warp k1,k2,keystone] [--roi x,y,w,h [--roi-crop]] [--replay <seconds>]\n"
+		<< "       [--metrics-json <file.json> [--metrics-interval <seconds>]] [--present-fps F] [--pin-compare]\n"
+		<< SessionConfig::getUsage()
+		<< "Filters:";
+
+	for (const FilterTraits& filterTraits : filterTraitsList)
+	{
+		std::cout << (filterTraits.filterType == FilterTypeEnum::None ? " " : ", ") << filterTraits.name;
+	}
+
+	std::cout << "\n";
+}
+
+int HeadlessRunner::run()
+{
+	if (!m_ArgumentsValid)
+	{
+		printUsage();
+		return 1;
+	}
+
+	if (m_PrintPlan)
+	{
+		m_SessionPlan.print(std::cout);
+		return 0;
+	}
+
+	for (const std::string& warning : m_SessionPlan.getWarnings())
+	{
+		std::cout << "Warning: " << warning << "\n";
+	}
+
+	const SessionConfig& sessionConfig = m_SessionPlan.getConfig();
+
+	MemoryBudget::getInstance().setLimit(sessionConfig.memoryBudgetBytes);
+
+	FrameTimeTracker frameTimeTracker;
+
+	if (!m_ComparePlacement)
+		return runBenchmark(sessionConfig.threadPlacements, frameTimeTracker);
+
+	// Same streams and arguments twice, the placement is the only difference
+	std::cout << "Run 1 of 2: threads placed by the system\n";
+
+	if (runBenchmark(ThreadPlacements(), frameTimeTracker) != 0)
+		return 1;
+
+	FrameTimeStats unpinnedStats = frameTimeTracker.getStats();
+
+	std::cout << "\nRun 2 of 2: threads placed as configured\n";
+
+	FrameTimeTracker pinnedFrameTimeTracker;
+	if (runBenchmark(sessionConfig.threadPlacements, pinnedFrameTimeTracker) != 0)
+		return 1;
+
+	printFrameTimeComparison(unpinnedStats, pinnedFrameTimeTracker.getStats());
+
+	return 0;
+}
+
+int HeadlessRunner::runBenchmark(const ThreadPlacements& threadPlacements, FrameTimeTracker& frameTimeTracker)
+{
+	const SessionConfig& sessionConfig = m_SessionPlan.getConfig();
+
+	m_VideoStreams.clear();
+
+	// Workers move before the sources open, decoded frames are allocated on their node
+	m_WorkerPool.setThreadPlacement(threadPlacements.workers);
+
+	for (const StreamPlan& streamPlan : m_SessionPlan.getStreams())
+	{
+		m_VideoStreams.push_back(std::make_unique<VideoStream>(streamPlan.sourceName, m_WorkerPool,
+			FrameSourceFactory::createFrameSource(streamPlan.sourceName, m_WorkerPool, &m_FrameBufferPool, sessionConfig.decodeScale,
+												  sessionConfig.repeatCount, sessionConfig.playbackFps, sessionConfig.captureSettings)));
+	}
+
+	for (FilterTypeEnum filterType : sessionConfig.filters)
+	{
+		std::shared_ptr<ChangeActiveFilters> changeActiveFilters = std::make_shared<ChangeActiveFilters>();
+		changeActiveFilters->setActiveFilterType(filterType, true);
+
+		pushEventToAllStreams(changeActiveFilters);
+	}
+
+	std::shared_ptr<ChangeCannyThresholds> changeCannyThresholds = std::make_shared<ChangeCannyThresholds>();
+	changeCannyThresholds->setCannyThresholds(sessionConfig.cannyThresholds);
+
+	pushEventToAllStreams(changeCannyThresholds);
+
+	if (m_WarpEnabled)
+	{
+		std::shared_ptr<ChangeGeometricWarp> changeGeometricWarp = std::make_shared<ChangeGeometricWarp>();
+		changeGeometricWarp->setGeometricWarp(true, m_WarpParameters);
+
+		pushEventToAllStreams(changeGeometricWarp);
+	}
+
+	if (m_RegionOfInterestEnabled)
+	{
+		std::shared_ptr<ChangeRegionOfInterest> changeRegionOfInterest = std::make_shared<ChangeRegionOfInterest>();
+		changeRegionOfInterest->setRegionOfInterest(true, m_RegionOfInterest, m_RegionOfInterestCrop);
+
+		pushEventToAllStreams(changeRegionOfInterest);
+	}
+
+	if (m_QualityGovernorEnabled)
+	{
+		std::shared_ptr<ChangeQualityGovernor> changeQualityGovernor = std::make_shared<ChangeQualityGovernor>();
+		changeQualityGovernor->setQualityGovernor(true, m_QualityLadder);
+
+		pushEventToAllStreams(changeQualityGovernor);
+	}
+
+	std::shared_ptr<RecordingSink> recordingSink;
+	if (!sessionConfig.recordingPath.empty())
+	{
+		RecordingFormatEnum recordingFormat = RecordingSink::getFormatOfPath(sessionConfig.recordingPath);
+
+		// Unpaced streams have no frame rate of their own
+		double recordingFps = m_SessionPlan.getStreams().front().frameSourceProbe.framesPerSecond;
+		if (recordingFps <= 0.0)
+			recordingFps = 30.0;
+
+		recordingSink = std::make_shared<RecordingSink>(sessionConfig.recordingPath, recordingFormat, recordingFps);
+
+		// Raw frames are the decoded input, to be replayed without decoding
+		if (recordingFormat == RecordingFormatEnum::RawFrames)
+		{
+
+			FrameSinkSource capturedSinkSource;
+			capturedSinkSource.captured = true;
+
+			attachFrameSink(capturedSinkSource, recordingSink);
+		}
+		else
+		{
+			attachFrameSink(recordingSink);
+		}
+	}
+
+	// "replay [path]" on the standard input saves the buffered seconds while the stream runs
+	std::shared_ptr<ReplayBufferSink> replaySink;
+	ConsoleCommandReader consoleCommandReader;
+	if (m_ReplaySeconds > 0.0)
+	{
+		replaySink = std::make_shared<ReplayBufferSink>(m_WorkerPool, m_ReplaySeconds);
+
+		attachFrameSink(replaySink);
+
+		consoleCommandReader.addCommand("replay", [&replaySink](const std::string& path)
+		{
+			if (!replaySink->dump(path.empty() ? "replay.mjpeg" : path))
+				std::cout << "A replay is still being saved\n";
+		});
+		consoleCommandReader.start();
+	}
+
+	std::shared_ptr<SharedMemorySink> sharedMemorySink;
+	if (!sessionConfig.sharedMemoryName.empty())
+	{
+		sharedMemorySink = std::make_shared<SharedMemorySink>(sessionConfig.sharedMemoryName);
+
+		attachFrameSink(sharedMemorySink);
+	}
+
+	std::shared_ptr<MjpegHttpServer> mjpegHttpServer;
+	if (sessionConfig.httpPort > 0)
+	{
+		mjpegHttpServer = std::make_shared<MjpegHttpServer>();
+		if (!mjpegHttpServer->start(static_cast<uint16_t>(sessionConfig.httpPort)))
+			return 1;
+
+		std::vector<FrameSinkSource> frameSinkSources;
+		for (FilterTypeEnum filterType : sessionConfig.filters)
+		{
+			frameSinkSources.push_back({ false, filterType });
+		}
+
+		if (sessionConfig.sinkSource.combined)
+			frameSinkSources.push_back(sessionConfig.sinkSource);
+
+		for (const FrameSinkSource& frameSinkSource : frameSinkSources)
+		{
+			attachFrameSink(frameSinkSource, std::make_shared<MjpegHttpSink>(mjpegHttpServer, m_WorkerPool,
+																			 MjpegHttpSink::getStreamName(frameSinkSource)));
+		}
+
+		std::cout << "Serving MJPEG streams on http://<host>:" << sessionConfig.httpPort << "/\n";
+	}
+
+	if (sessionConfig.combinedFilters.empty() == false)
+		activateCombinedFilters();
+
+	MetricsHttpServer metricsHttpServer;
+	if (sessionConfig.metricsPort > 0)
+	{
+		if (!metricsHttpServer.start(static_cast<uint16_t>(sessionConfig.metricsPort)))
+			return 1;
+
+		std::cout << "Serving metrics on http://127.0.0.1:" << sessionConfig.metricsPort << "/metrics\n";
+	}
+
+	MetricsFileWriter metricsFileWriter;
+	if (!m_MetricsJsonPath.empty())
+		metricsFileWriter.start(m_MetricsJsonPath, m_MetricsIntervalSeconds);
+
+	// Sources open, tune and prewarm on their capture threads, the elapsed time includes the startup.
+	// Streams of the same size share one calibration.
+	auto startTime = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < m_VideoStreams.size(); i++)
+	{
+		WebcamController& webcamController = m_VideoStreams[i]->getWebcamController();
+
+		webcamController.setKernelTuningsProvider([this](const cv::Size& frameSize) { return m_AutoTuner.getTunings(frameSize, m_SessionPlan.getConfig().tuneKernels); });
+		webcamController.setPrewarmFilters(sessionConfig.prewarmFilters.empty() ? sessionConfig.filters : sessionConfig.prewarmFilters);
+		webcamController.setThreadPlacement(threadPlacements.capture.forThread(i, m_VideoStreams.size()));
+		webcamController.startVideoCapture();
+	}
+
+	StreamLatencyTrackers streamLatencyTrackers(std::to_string(m_VideoStreams.front()->getWebcamController().getSchedulingLane()));
+	std::jthread presentThread([this, &streamLatencyTrackers, renderPlacement = threadPlacements.render.forThread(0, 1)](std::stop_token stopToken)
+	{
+		ThreadPlacementControl::applyToCurrentThread("render", renderPlacement);
+		presentFrames(stopToken, streamLatencyTrackers);
+	});
+
+	for (auto& videoStream : m_VideoStreams)
+	{
+		videoStream->getWebcamController().waitForVideoCaptureEnd();
+	}
+
+	presentThread.request_stop();
+	presentThread.join();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	if (recordingSink != nullptr)
+		recordingSink->stop();
+
+	// Writes the final snapshot
+	metricsFileWriter.stop();
+
+	uint64_t capturedFrames = 0;
+	uint64_t processedFrames = 0;
+	uint64_t skippedFrames = 0;
+	double tileSkipRatio = 0.0;
+
+	for (auto& videoStream : m_VideoStreams)
+	{
+		WebcamController& webcamController = videoStream->getWebcamController();
+
+		capturedFrames += webcamController.getCapturedFramesCount();
+		processedFrames += webcamController.getProcessedFramesCount();
+		skippedFrames += webcamController.getSkippedFramesCount();
+		tileSkipRatio += webcamController.getTileSkipRatio() / m_VideoStreams.size();
+	}
+
+	std::cout
+		<< "\n-----------------------------------------\n"
+		<< "Headless run finished\n"
+		<< "Worker threads: " << m_WorkerPool.getThreadCount() << "\n"
+		<< "Streams: " << m_VideoStreams.size() << "\n"
+		<< "Captured frames: " << capturedFrames << "\n"
+		<< "Processed frames: " << processedFrames << "\n"
+		<< "Unchanged frames: " << skippedFrames << "\n"
+		<< "Unchanged tiles: " << tileSkipRatio * 100.0 << " %\n"
+		<< "Elapsed: " << elapsed.count() << " s\n"
+		<< "Throughput: " << (elapsed.count() > 0.0 ? processedFrames / elapsed.count() : 0.0) << " fps\n"
+		<< "-----------------------------------------\n";
+
+	if (m_QualityGovernorEnabled)
+	{
+		for (size_t i = 0; i < m_VideoStreams.size(); i++)
+		{
+			const QualityGovernor& qualityGovernor = m_VideoStreams[i]->getWebcamController().getQualityGovernor();
+
+			std::cout
+				<< "Stream " << i << " quality: level " << qualityGovernor.getLevel() << " of " << qualityGovernor.getLevelsCount() - 1 << ", "
+				<< qualityGovernor.getTransitionsCount() << " transitions, "
+				<< static_cast<int>(qualityGovernor.getLoadRatio() * 100.0) << "% load\n";
+		}
+	}
+
+	printStartupStats();
+	printLatencyStats(streamLatencyTrackers);
+	printMemoryStats();
+
+	for (size_t i = 0; i < m_VideoStreams.size(); i++)
+	{
+		const FrameTimeTracker& streamFrameTimeTracker = m_VideoStreams[i]->getWebcamController().getFrameTimeTracker();
+		FrameTimeStats frameTimeStats = streamFrameTimeTracker.getStats();
+
+		std::cout
+			<< "Stream " << i << " frame time: p50 " << frameTimeStats.p50Seconds * 1000.0 << " ms, p99 " << frameTimeStats.p99Seconds * 1000.0
+			<< " ms, max " << frameTimeStats.maxSeconds * 1000.0 << " ms, jitter (p99 - p50) " << frameTimeStats.jitterSeconds * 1000.0 << " ms\n";
+
+		frameTimeTracker.merge(streamFrameTimeTracker);
+	}
+
+	if (m_VideoStreams.size() > 1)
+	{
+		for (size_t i = 0; i < m_VideoStreams.size(); i++)
+		{
+			WebcamController& webcamController = m_VideoStreams[i]->getWebcamController();
+			WorkerPoolLaneStats laneStats = m_WorkerPool.getLaneStats(webcamController.getSchedulingLane());
+
+			std::cout
+				<< "Stream " << i << " (" << m_VideoStreams[i]->getName() << "): "
+				<< webcamController.getProcessedFramesCount() << " frames, "
+				<< laneStats.busySeconds << " s worker time, "
+				<< laneStats.missedDeadlineTasksCount << " of " << laneStats.executedTasksCount << " tasks late\n";
+		}
+
+		FrameBufferPoolStats frameBufferPoolStats = m_FrameBufferPool.getStats();
+
+		std::cout
+			<< "Frame buffers: " << frameBufferPoolStats.allocatedBuffersCount << " allocated, "
+			<< frameBufferPoolStats.reusedBuffersCount << " reused, "
+			<< frameBufferPoolStats.pooledBytes / (1024.0 * 1024.0) << " MB pooled\n";
+	}
+
+	if (recordingSink != nullptr)
+	{
+		RecordingStats recordingStats = recordingSink->getStats();
+
+		std::cout
+			<< "Recorded frames: " << recordingStats.writtenFramesCount << "\n"
+			<< "Dropped frames: " << recordingStats.droppedFramesCount << "\n"
+			<< "Writer throughput: " << recordingStats.writeFramesPerSecond << " fps, "
+			<< recordingStats.writeMegabytesPerSecond << " MB/s\n";
+	}
+
+	if (sharedMemorySink != nullptr)
+	{
+		std::cout
+			<< "Shared memory frames: " << sharedMemorySink->getPublishedFramesCount() << " published, "
+			<< sharedMemorySink->getDroppedFramesCount() << " dropped\n";
+	}
+
+	if (mjpegHttpServer != nullptr)
+	{
+		MjpegHttpStats mjpegHttpStats = mjpegHttpServer->getStats();
+
+		std::cout
+			<< "HTTP frames: " << mjpegHttpStats.sentFramesCount << " sent, "
+			<< mjpegHttpStats.skippedFramesCount << " skipped by slow viewers, "
+			<< mjpegHttpStats.sentBytes / (1024.0 * 1024.0) << " MB\n";
+	}
+
+	if (replaySink != nullptr)
+	{
+		ReplayStats replayStats = replaySink->getStats();
+
+		std::cout
+			<< "Replay buffer: " << replayStats.bufferedFramesCount << " frames, "
+			<< replayStats.bufferedBytes / (1024.0 * 1024.0) << " MB, "
+			<< replayStats.droppedFramesCount << " dropped, "
+			<< replayStats.dumpsCount << " saved\n";
+	}
+
+	return 0;
+}
+
+void HeadlessRunner::printFrameTimeComparison(const FrameTimeStats& unpinnedStats, const FrameTimeStats& pinnedStats) const
+{
+	auto printFrameTimeStats = [](const char* name, const FrameTimeStats& frameTimeStats)
+	{
+		std::cout
+			<< name << frameTimeStats.framesCount << " frames, p50 " << frameTimeStats.p50Seconds * 1000.0 << " ms, p99 "
+			<< frameTimeStats.p99Seconds * 1000.0 << " ms, jitter " << frameTimeStats.jitterSeconds * 1000.0 << " ms\n";
+	};
+
+	std::cout
+		<< "\n-----------------------------------------\n"
+		<< "Frame time, all streams\n";
+
+	printFrameTimeStats("Unpinned: ", unpinnedStats);
+	printFrameTimeStats("Pinned:   ", pinnedStats);
+
+	if (unpinnedStats.jitterSeconds > 0.0)
+		std::cout << "Jitter change: " << (pinnedStats.jitterSeconds / unpinnedStats.jitterSeconds - 1.0) * 100.0 << " %\n";
+
+	std::cout << "-----------------------------------------\n";
+}
+
+void HeadlessRunner::pushEventToAllStreams(std::shared_ptr<ViewEvent> viewEvent)
+{
+	for (auto& videoStream : m_VideoStreams)
+	{
+		videoStream->getViewEventQueue().pushViewEvent(viewEvent);
+	}
+}
+
+void HeadlessRunner::activateCombinedFilters()
+{
+	std::shared_ptr<ActivateCombinedFilter> activateCombinedFilter = std::make_shared<ActivateCombinedFilter>();
+	activateCombinedFilter->setActivateCombinedFilter(true);
+
+	pushEventToAllStreams(activateCombinedFilter);
+
+	for (FilterTypeEnum filterType : m_SessionPlan.getConfig().combinedFilters)
+	{
+		std::shared_ptr<ChangeActiveFiltersOnCombinedFilter> changeActiveFiltersOnCombinedFilter = std::make_shared<ChangeActiveFiltersOnCombinedFilter>();
+		changeActiveFiltersOnCombinedFilter->setActiveFilterTypeOnCombined(filterType, true);
+
+		pushEventToAllStreams(changeActiveFiltersOnCombinedFilter);
+	}
+}
+
+void HeadlessRunner::attachFrameSink(std::shared_ptr<FrameSink> frameSink)
+{
+	attachFrameSink(m_SessionPlan.getConfig().sinkSource, std::move(frameSink));
+}
+
+void HeadlessRunner::attachFrameSink(const FrameSinkSource& frameSinkSource, std::shared_ptr<FrameSink> frameSink)
+{
+	std::shared_ptr<AttachFrameSink> attachFrameSinkEvent = std::make_shared<AttachFrameSink>();
+	attachFrameSinkEvent->setFrameSink(frameSinkSource, std::move(frameSink));
+
+	m_VideoStreams.front()->getViewEventQueue().pushViewEvent(attachFrameSinkEvent);
+}
+
+// Takes the latest outputs of the first stream at the display rate, outputs produced in between are never presented
+void HeadlessRunner::presentFrames(std::stop_token stopToken, StreamLatencyTrackers& streamLatencyTrackers)
+{
+	const auto presentInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_PresentFps));
+
+	WebcamController& webcamController = m_VideoStreams.front()->getWebcamController();
+	WebcamMats webcamMats;
+
+	auto presentTime = std::chrono::steady_clock::now();
+
+	while (!stopToken.stop_requested())
+	{
+		presentTime += presentInterval;
+		std::this_thread::sleep_until(presentTime);
+
+		webcamController.getMats(webcamMats);
+		streamLatencyTrackers.present(webcamMats, std::chrono::steady_clock::now());
+	}
+}
+
+void HeadlessRunner::printLatencyStats(StreamLatencyTrackers& streamLatencyTrackers) const
+{
+	const FrameSinkSource& sinkSource = m_SessionPlan.getConfig().sinkSource;
+
+	std::vector<FrameSinkSource> frameSinkSources;
+	for (FilterTypeEnum filterType : m_SessionPlan.getConfig().filters)
+	{
+		frameSinkSources.push_back({ false, filterType });
+	}
+
+	if (sinkSource.combined)
+		frameSinkSources.push_back(sinkSource);
+
+	for (const FrameSinkSource& frameSinkSource : frameSinkSources)
+	{
+		FrameLatencyTracker& frameLatencyTracker = frameSinkSource.combined ?
+			streamLatencyTrackers.getCombinedTracker() :
+			streamLatencyTrackers.getFilterTracker(frameSinkSource.filterType);
+
+		FrameLatencyStats frameLatencyStats = frameLatencyTracker.getStats();
+		if (frameLatencyStats.presentedFramesCount == 0)
+			continue;
+
+		bool isSinkSource = frameSinkSource.combined == sinkSource.combined &&
+			(frameSinkSource.combined || frameSinkSource.filterType == sinkSource.filterType);
+
+		std::cout
+			<< (frameSinkSource.combined ? "Combined" : getFilterTypeName(frameSinkSource.filterType))
+			<< (isSinkSource ? " (sink output)" : "") << " latency: "
+			<< frameLatencyStats.p50Seconds * 1000.0 << " / "
+			<< frameLatencyStats.p90Seconds * 1000.0 << " / "
+			<< frameLatencyStats.p99Seconds * 1000.0 << " / "
+			<< frameLatencyStats.maxSeconds * 1000.0 << " ms p50 / p90 / p99 / max, "
+			<< frameLatencyStats.presentedFramesCount << " presented, "
+			<< frameLatencyStats.unpresentedFramesCount << " never presented\n";
+	}
+}
+
+void HeadlessRunner::printStartupStats() const
+{
+	for (size_t i = 0; i < m_VideoStreams.size(); i++)
+	{
+		const StartupTimeline& startupTimeline = m_VideoStreams[i]->getWebcamController().getStartupTimeline();
+
+		std::cout << "Stream " << i << " startup:";
+		const char* separator = " ";
+
+		for (StartupStageEnum stage : { StartupStageEnum::SourceOpened, StartupStageEnum::FirstFrame, StartupStageEnum::Prewarmed, StartupStageEnum::FirstFilteredFrame })
+		{
+			std::cout << separator << StartupTimeline::getStageName(stage) << " ";
+			separator = ", ";
+
+			if (startupTimeline.isReached(stage))
+				std::cout << startupTimeline.getSeconds(stage) * 1000.0 << " ms";
+			else
+				std::cout << "never";
+		}
+
+		std::cout << "\n";
+	}
+}
+
+// Peaks are kept since the start, a second run of --pin-compare includes the first one
+void HeadlessRunner::printMemoryStats() const
+{
+	MemoryBudgetStats memoryBudgetStats = MemoryBudget::getInstance().getStats();
+
+	std::cout << "Memory: " << memoryBudgetStats.usedBytes / (1024.0 * 1024.0) << " MB, peak " << memoryBudgetStats.peakBytes / (1024.0 * 1024.0) << " MB";
+
+	if (memoryBudgetStats.limitBytes != 0)
+		std::cout << " of " << memoryBudgetStats.limitBytes / (1024.0 * 1024.0) << " MB budget, " << memoryBudgetStats.refusedCount << " refused";
+
+	std::cout << "\n";
+
+	for (const MemoryOwnerUsage& ownerUsage : memoryBudgetStats.owners)
+	{
+		if (ownerUsage.peakBytes == 0 && ownerUsage.refusedCount == 0)
+			continue;
+
+		std::cout << "  " << (ownerUsage.stream.empty() ? "" : "Stream lane " + ownerUsage.stream + " ") << ownerUsage.owner << ": "
+			<< ownerUsage.currentBytes / (1024.0 * 1024.0) << " MB, peak " << ownerUsage.peakBytes / (1024.0 * 1024.0) << " MB";
+
+		if (ownerUsage.refusedCount != 0)
+			std::cout << ", " << ownerUsage.refusedCount << " refused";
+
+		std::cout << "\n";
+	}
+}
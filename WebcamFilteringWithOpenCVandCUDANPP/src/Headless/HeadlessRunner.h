@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Filters/FilterTypes.h"
+#include "Frames/FrameBufferPool.h"
+#include "Geometry/WarpParameters.h"
+#include "Metrics/FrameLatencyTracker.h"
+#include "Metrics/FrameTimeTracker.h"
+#include "Pipeline/QualityGovernor.h"
+#include "Output/FrameSink.h"
+#include "Session/SessionPlan.h"
+#include "Streams/VideoStream.h"
+#include "Threading/ThreadPlacement.h"
+#include "Threading/WorkerPool.h"
+#include "Tuning/AutoTuner.h"
+
+
+// Runs the filter pipeline without the SDL/ImGui view and reports throughput.
+// Every stream file, repeated up to --streams, runs as a stream of its own with the same filters; sinks take the first stream.
+// The quality governor needs paced streams, unpaced ones are always as slow as the processing.
+// Usage: --headless [<stream.mjpeg>[,<stream.mjpeg>...]] [session settings] [--governor cpu-filters,resolution,combined]
+//        [--warp k1,k2,keystone] [--roi x,y,w,h [--roi-crop]] [--replay <seconds>] [--metrics-json <file.json> [--metrics-interval <seconds>]]
+//        [--present-fps F] [--pin-compare]
+// The session settings are those of SessionConfig, the streams may be given with --sources or a --config file instead.
+class HeadlessRunner
+{
+public:
+	HeadlessRunner(int argc, char* argv[]);
+
+	int run();
+
+private:
+	bool parseArguments(int argc, char* argv[]);
+	void printUsage() const;
+
+	// One pass over the streams, the frame times of all streams are returned merged
+	int runBenchmark(const ThreadPlacements& threadPlacements, FrameTimeTracker& frameTimeTracker);
+	void printFrameTimeComparison(const FrameTimeStats& unpinnedStats, const FrameTimeStats& pinnedStats) const;
+
+	void pushEventToAllStreams(std::shared_ptr<ViewEvent> viewEvent);
+	void activateCombinedFilters();
+	void attachFrameSink(std::shared_ptr<FrameSink> frameSink);
+	void attachFrameSink(const FrameSinkSource& frameSinkSource, std::shared_ptr<FrameSink> frameSink);
+
+	void presentFrames(std::stop_token stopToken, StreamLatencyTrackers& streamLatencyTrackers);
+	void printStartupStats() const;
+	void printLatencyStats(StreamLatencyTrackers& streamLatencyTrackers) const;
+	void printMemoryStats() const;
+
+	// Sources, filters, sinks and threads shared with the view, checked and resolved
+	SessionPlan m_SessionPlan;
+	std::vector<std::string> m_Errors;
+	bool m_PrintPlan;
+
+	bool m_QualityGovernorEnabled;
+	std::vector<QualityStepEnum> m_QualityLadder;
+
+	bool m_WarpEnabled;
+	WarpParameters m_WarpParameters;
+
+	// Relative to the frame, cropped outputs are only the ROI
+	bool m_RegionOfInterestEnabled;
+	bool m_RegionOfInterestCrop;
+	cv::Rect2d m_RegionOfInterest;
+
+	// The outputs of the first stream are presented like the view does, at the display rate
+	double m_PresentFps;
+
+	double m_ReplaySeconds;
+
+	// A JSON snapshot of the metrics rewritten every interval
+	std::string m_MetricsJsonPath;
+	double m_MetricsIntervalSeconds;
+
+	// Runs the streams once without the configured thread placement first
+	bool m_ComparePlacement;
+
+	// Declared before the pool, its thread count comes from the plan
+	bool m_ArgumentsValid;
+
+	WorkerPool m_WorkerPool;
+	FrameBufferPool m_FrameBufferPool;
+	AutoTuner m_AutoTuner;
+
+	std::vector<std::unique_ptr<VideoStream>> m_VideoStreams;
+};
@@ -0,0 +1,63 @@
+#include "BucketHistogram.h"
+
+#include <algorithm>
+
+
+BucketHistogram::BucketHistogram(double bucketSeconds, size_t bucketsCount) :
+	m_BucketSeconds(bucketSeconds),
+	m_Buckets(bucketsCount + 1, 0),
+	m_MaxSeconds(0.0),
+	m_Count(0)
+{
+}
+
+void BucketHistogram::record(double seconds)
+{
+	size_t lastBucketIndex = m_Buckets.size() - 1;
+	size_t bucketIndex = std::min(static_cast<size_t>(std::max(0.0, seconds) / m_BucketSeconds), lastBucketIndex);
+
+	m_Buckets[bucketIndex]++;
+	m_MaxSeconds = std::max(m_MaxSeconds, seconds);
+	m_Count++;
+}
+
+void BucketHistogram::merge(const BucketHistogram& other)
+{
+	size_t bucketsCount = std::min(m_Buckets.size(), other.m_Buckets.size());
+
+	for (size_t i = 0; i < bucketsCount; i++)
+	{
+		m_Buckets[i] += other.m_Buckets[i];
+	}
+
+	m_MaxSeconds = std::max(m_MaxSeconds, other.m_MaxSeconds);
+	m_Count += other.m_Count;
+}
+
+uint64_t BucketHistogram::getCount() const
+{
+	return m_Count;
+}
+
+double BucketHistogram::getMaxSeconds() const
+{
+	return m_MaxSeconds;
+}
+
+double BucketHistogram::getPercentile(double ratio) const
+{
+	if (m_Count == 0)
+		return 0.0;
+
+	uint64_t rank = static_cast<uint64_t>(ratio * static_cast<double>(m_Count - 1)) + 1;
+	uint64_t count = 0;
+
+	for (size_t i = 0; i + 1 < m_Buckets.size(); i++)
+	{
+		count += m_Buckets[i];
+		if (count >= rank)
+			return std::min((i + 1) * m_BucketSeconds, m_MaxSeconds);
+	}
+
+	return m_MaxSeconds;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Durations in fixed-width buckets, percentiles are exact to the bucket width.
+// Not thread safe, the trackers hold a lock around it.
+class BucketHistogram
+{
+public:
+	// The last bucket holds everything above bucketsCount * bucketSeconds
+	BucketHistogram(double bucketSeconds, size_t bucketsCount);
+
+	void record(double seconds);
+
+	// Same bucket width and count only
+	void merge(const BucketHistogram& other);
+
+	uint64_t getCount() const;
+	double getMaxSeconds() const;
+
+	// Upper edge of the bucket holding the percentile, never above the largest recorded value
+	double getPercentile(double ratio) const;
+
+private:
+	double m_BucketSeconds;
+	std::vector<uint64_t> m_Buckets;
+	double m_MaxSeconds;
+	uint64_t m_Count;
+};
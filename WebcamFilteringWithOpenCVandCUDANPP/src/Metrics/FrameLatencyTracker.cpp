@@ -0,0 +1,102 @@
+#include "FrameLatencyTracker.h"
+
+#include <algorithm>
+
+#include "Filters/FilterNames.h"
+
+
+FrameLatencyTracker::FrameLatencyTracker(const std::string& streamName, const std::string& outputName) :
+	m_LatencyHistogram(0.00025, 8000),
+	m_UnpresentedFramesCount(0),
+	m_LastProducedCount(0),
+	m_LatencyMetric(MetricsRegistry::getInstance().getHistogram("webcam_present_latency_seconds",
+		"Time from capture to presentation", { { "stream", streamName }, { "output", outputName } })),
+	m_UnpresentedFramesMetric(MetricsRegistry::getInstance().getCounter("webcam_output_unpresented_frames_total",
+		"Frames produced but never presented because a newer one was", { { "stream", streamName }, { "output", outputName } }))
+{
+}
+
+void FrameLatencyTracker::present(const FrameStamp& frameStamp, std::chrono::steady_clock::time_point presentTime)
+{
+	if (frameStamp.sequence == 0)
+		return;
+
+	double latencySeconds = std::max(0.0, std::chrono::duration<double>(presentTime - frameStamp.captureTime).count());
+
+	{
+		std::lock_guard<std::mutex> lock(m_LatencyMutex);
+
+		if (frameStamp.producedCount <= m_LastProducedCount)
+			return;
+
+		uint64_t unpresentedFramesCount = m_LastProducedCount == 0 ? 0 : frameStamp.producedCount - m_LastProducedCount - 1;
+		m_LastProducedCount = frameStamp.producedCount;
+
+		m_LatencyHistogram.record(latencySeconds);
+		m_UnpresentedFramesCount += unpresentedFramesCount;
+
+		if (unpresentedFramesCount != 0)
+			m_UnpresentedFramesMetric.add(unpresentedFramesCount);
+	}
+
+	m_LatencyMetric.observe(latencySeconds);
+}
+
+void FrameLatencyTracker::restart()
+{
+	std::lock_guard<std::mutex> lock(m_LatencyMutex);
+	m_LastProducedCount = 0;
+}
+
+FrameLatencyStats FrameLatencyTracker::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_LatencyMutex);
+
+	FrameLatencyStats frameLatencyStats;
+	frameLatencyStats.presentedFramesCount = m_LatencyHistogram.getCount();
+	frameLatencyStats.unpresentedFramesCount = m_UnpresentedFramesCount;
+	frameLatencyStats.p50Seconds = m_LatencyHistogram.getPercentile(0.50);
+	frameLatencyStats.p90Seconds = m_LatencyHistogram.getPercentile(0.90);
+	frameLatencyStats.p99Seconds = m_LatencyHistogram.getPercentile(0.99);
+	frameLatencyStats.maxSeconds = m_LatencyHistogram.getMaxSeconds();
+
+	return frameLatencyStats;
+}
+
+StreamLatencyTrackers::StreamLatencyTrackers(const std::string& streamName) :
+	m_FilterTrackers(std::in_place, [&streamName](FilterTypeEnum filterType) { return FrameLatencyTracker(streamName, getFilterTypeName(filterType)); }),
+	m_CombinedTracker(streamName, "Combined")
+{
+}
+
+void StreamLatencyTrackers::present(const WebcamMats& webcamMats, std::chrono::steady_clock::time_point presentTime)
+{
+	for (const auto& filteredMat : webcamMats.m_filteredMatsMap)
+	{
+		if (filteredMat.second.empty() == false)
+			m_FilterTrackers[filteredMat.first].present(webcamMats.m_frameStampsMap[filteredMat.first], presentTime);
+	}
+
+	if (webcamMats.currentFiltersCombinedMat.empty() == false)
+		m_CombinedTracker.present(webcamMats.combinedFrameStamp, presentTime);
+}
+
+void StreamLatencyTrackers::restart()
+{
+	for (auto filterTracker : m_FilterTrackers)
+	{
+		filterTracker.second.restart();
+	}
+
+	m_CombinedTracker.restart();
+}
+
+FrameLatencyTracker& StreamLatencyTrackers::getFilterTracker(FilterTypeEnum filterType)
+{
+	return m_FilterTrackers[filterType];
+}
+
+FrameLatencyTracker& StreamLatencyTrackers::getCombinedTracker()
+{
+	return m_CombinedTracker;
+}
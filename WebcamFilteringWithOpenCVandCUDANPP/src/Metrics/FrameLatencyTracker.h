@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "BucketHistogram.h"
+#include "Filters/FilterTraits.h"
+#include "Frames/FrameStamp.h"
+#include "MetricsRegistry.h"
+#include "Webcam/WebcamMats.h"
+
+
+struct FrameLatencyStats
+{
+	uint64_t presentedFramesCount;
+	// Produced, but a newer frame of the output was presented instead
+	uint64_t unpresentedFramesCount;
+
+	double p50Seconds;
+	double p90Seconds;
+	double p99Seconds;
+	double maxSeconds;
+};
+
+// Capture-to-present latency of one output over the whole run.
+// Latencies go to 0.25 ms wide buckets up to 2 s, percentiles are exact to the bucket width.
+class FrameLatencyTracker
+{
+public:
+	FrameLatencyTracker(const std::string& streamName, const std::string& outputName);
+
+	// Presenting the same frame again is ignored
+	void present(const FrameStamp& frameStamp, std::chrono::steady_clock::time_point presentTime);
+
+	// The next presented frame starts a new run, the frames produced in between are not counted as unpresented
+	void restart();
+
+	FrameLatencyStats getStats() const;
+
+private:
+	mutable std::mutex m_LatencyMutex;
+
+	// One entry per presented frame, the last bucket holds everything above 2 s
+	BucketHistogram m_LatencyHistogram;
+
+	uint64_t m_UnpresentedFramesCount;
+	uint64_t m_LastProducedCount;
+
+	MetricsHistogram& m_LatencyMetric;
+	MetricsCounter& m_UnpresentedFramesMetric;
+};
+
+// Trackers of every output of a stream
+class StreamLatencyTrackers
+{
+public:
+	explicit StreamLatencyTrackers(const std::string& streamName);
+
+	// Records the outputs that hold a frame
+	void present(const WebcamMats& webcamMats, std::chrono::steady_clock::time_point presentTime);
+	void restart();
+
+	FrameLatencyTracker& getFilterTracker(FilterTypeEnum filterType);
+	FrameLatencyTracker& getCombinedTracker();
+
+private:
+	FilterTable<FrameLatencyTracker> m_FilterTrackers;
+	FrameLatencyTracker m_CombinedTracker;
+};
@@ -0,0 +1,36 @@
+#include "FrameTimeTracker.h"
+
+
+FrameTimeTracker::FrameTimeTracker() :
+	m_FrameTimeHistogram(0.00001, 25000)
+{
+}
+
+void FrameTimeTracker::record(double frameSeconds)
+{
+	std::lock_guard<std::mutex> lock(m_FrameTimeMutex);
+	m_FrameTimeHistogram.record(frameSeconds);
+}
+
+void FrameTimeTracker::merge(const FrameTimeTracker& other)
+{
+	if (&other == this)
+		return;
+
+	std::scoped_lock lock(m_FrameTimeMutex, other.m_FrameTimeMutex);
+	m_FrameTimeHistogram.merge(other.m_FrameTimeHistogram);
+}
+
+FrameTimeStats FrameTimeTracker::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_FrameTimeMutex);
+
+	FrameTimeStats frameTimeStats;
+	frameTimeStats.framesCount = m_FrameTimeHistogram.getCount();
+	frameTimeStats.p50Seconds = m_FrameTimeHistogram.getPercentile(0.50);
+	frameTimeStats.p99Seconds = m_FrameTimeHistogram.getPercentile(0.99);
+	frameTimeStats.maxSeconds = m_FrameTimeHistogram.getMaxSeconds();
+	frameTimeStats.jitterSeconds = frameTimeStats.p99Seconds - frameTimeStats.p50Seconds;
+
+	return frameTimeStats;
+}
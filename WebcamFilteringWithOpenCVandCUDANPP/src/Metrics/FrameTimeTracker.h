@@ -0,0 +1,39 @@
+#pragma once
+
+#include <mutex>
+
+#include "BucketHistogram.h"
+
+
+struct FrameTimeStats
+{
+	uint64_t framesCount;
+
+	double p50Seconds;
+	double p99Seconds;
+	double maxSeconds;
+
+	// How far the slow frames are from the typical one, p99 - p50
+	double jitterSeconds;
+};
+
+// Processing time of every frame of a capture loop over the whole run.
+// Times go to 10 us wide buckets up to 250 ms, percentiles are exact to the bucket width.
+class FrameTimeTracker
+{
+public:
+	FrameTimeTracker();
+
+	void record(double frameSeconds);
+
+	// Adds the frames of another tracker, e.g. to report all streams at once
+	void merge(const FrameTimeTracker& other);
+
+	FrameTimeStats getStats() const;
+
+private:
+	mutable std::mutex m_FrameTimeMutex;
+
+	// The last bucket holds everything above 250 ms
+	BucketHistogram m_FrameTimeHistogram;
+};
@@ -0,0 +1,84 @@
+#include "MetricsFileWriter.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "MetricsRegistry.h"
+
+
+MetricsFileWriter::MetricsFileWriter() :
+	m_IntervalSeconds(1.0)
+{
+}
+
+MetricsFileWriter::~MetricsFileWriter()
+{
+	stop();
+}
+
+void MetricsFileWriter::start(std::filesystem::path filePath, double intervalSeconds)
+{
+	stop();
+
+	m_FilePath = std::move(filePath);
+	m_IntervalSeconds = intervalSeconds;
+
+	m_WriterThread = std::jthread([this](std::stop_token stopToken) { writeSnapshots(stopToken); });
+}
+
+void MetricsFileWriter::stop()
+{
+	if (!isRunning())
+		return;
+
+	m_WriterThread.request_stop();
+	m_WriterThread.join();
+	m_WriterThread = std::jthread();
+
+	// The last snapshot has the final counts of the run
+	writeSnapshot();
+}
+
+bool MetricsFileWriter::isRunning() const
+{
+	return m_WriterThread.joinable();
+}
+
+void MetricsFileWriter::writeSnapshots(std::stop_token stopToken)
+{
+	const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(m_IntervalSeconds));
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_WriterMutex);
+
+			// Only a stop request ends the wait early
+			if (m_WriterCondition.wait_for(lock, stopToken, interval, [&stopToken] { return stopToken.stop_requested(); }))
+				return;
+		}
+
+		writeSnapshot();
+	}
+}
+
+void MetricsFileWriter::writeSnapshot() const
+{
+	std::filesystem::path temporaryPath = m_FilePath;
+	temporaryPath += ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file << MetricsRegistry::getInstance().formatJson();
+
+		if (!file)
+		{
+			std::cout << "Warning: Could not write metrics to " << temporaryPath.string() << "\n";
+			return;
+		}
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryPath, m_FilePath, errorCode);
+}
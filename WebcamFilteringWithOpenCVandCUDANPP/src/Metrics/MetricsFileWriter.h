@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+
+// Rewrites a JSON snapshot of the metrics registry every interval, and once more when stopped.
+// The file is replaced atomically, readers never see a partially written snapshot.
+class MetricsFileWriter
+{
+public:
+	MetricsFileWriter();
+	~MetricsFileWriter();
+
+	MetricsFileWriter(const MetricsFileWriter&) = delete;
+	MetricsFileWriter& operator=(const MetricsFileWriter&) = delete;
+
+	void start(std::filesystem::path filePath, double intervalSeconds);
+	void stop();
+
+	bool isRunning() const;
+
+private:
+	void writeSnapshots(std::stop_token stopToken);
+	void writeSnapshot() const;
+
+	std::filesystem::path m_FilePath;
+	double m_IntervalSeconds;
+
+	std::mutex m_WriterMutex;
+	std::condition_variable_any m_WriterCondition;
+
+	std::jthread m_WriterThread;
+};
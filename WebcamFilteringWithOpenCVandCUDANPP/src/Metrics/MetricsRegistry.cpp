@@ -0,0 +1,382 @@
+#include "MetricsRegistry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+
+namespace
+{
+	std::atomic<size_t> nextMetricShardIndex = 0;
+
+	std::string escapeLabelValue(const std::string& value)
+	{
+		std::string escapedValue;
+
+		for (char character : value)
+		{
+			if (character == '\\' || character == '"')
+				escapedValue += '\\';
+
+			if (character == '\n')
+				escapedValue += "\\n";
+			else
+				escapedValue += character;
+		}
+
+		return escapedValue;
+	}
+
+	// {name="value",...}, with an optional extra label for histogram buckets
+	std::string formatPrometheusLabels(const MetricLabels& labels, const std::string& extraLabel = "")
+	{
+		if (labels.empty() && extraLabel.empty())
+			return "";
+
+		std::string formattedLabels = "{";
+
+		for (const auto& label : labels)
+		{
+			if (formattedLabels.size() > 1)
+				formattedLabels += ',';
+
+			formattedLabels += label.first + "=\"" + escapeLabelValue(label.second) + "\"";
+		}
+
+		if (!extraLabel.empty())
+		{
+			if (formattedLabels.size() > 1)
+				formattedLabels += ',';
+
+			formattedLabels += extraLabel;
+		}
+
+		return formattedLabels + "}";
+	}
+
+	std::string formatJsonLabels(const MetricLabels& labels)
+	{
+		std::string formattedLabels = "{";
+
+		for (const auto& label : labels)
+		{
+			if (formattedLabels.size() > 1)
+				formattedLabels += ',';
+
+			formattedLabels += "\"" + label.first + "\":\"" + escapeLabelValue(label.second) + "\"";
+		}
+
+		return formattedLabels + "}";
+	}
+
+	// JSON has no infinity or NaN
+	std::string formatNumber(double value)
+	{
+		if (!std::isfinite(value))
+			return "0";
+
+		std::ostringstream formattedNumber;
+		formattedNumber.precision(9);
+		formattedNumber << value;
+
+		return formattedNumber.str();
+	}
+}
+
+
+// Threads get shards round robin the first time they touch a metric
+size_t getMetricShardIndex()
+{
+	thread_local size_t shardIndex = nextMetricShardIndex.fetch_add(1, std::memory_order_relaxed) % MetricShardsCount;
+	return shardIndex;
+}
+
+void MetricsCounter::add(uint64_t value)
+{
+	m_Shards[getMetricShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t MetricsCounter::getValue() const
+{
+	uint64_t value = 0;
+
+	for (const auto& shard : m_Shards)
+	{
+		value += shard.value.load(std::memory_order_relaxed);
+	}
+
+	return value;
+}
+
+void MetricsGauge::set(double value)
+{
+	m_Value.store(value, std::memory_order_relaxed);
+}
+
+double MetricsGauge::getValue() const
+{
+	return m_Value.load(std::memory_order_relaxed);
+}
+
+MetricsHistogram::MetricsHistogram(std::vector<double> bucketBounds) :
+	m_BucketBounds(std::move(bucketBounds))
+{
+	if (m_BucketBounds.size() > MaxBucketsCount)
+		m_BucketBounds.resize(MaxBucketsCount);
+}
+
+void MetricsHistogram::observe(double value)
+{
+	size_t bucketIndex = std::lower_bound(m_BucketBounds.begin(), m_BucketBounds.end(), value) - m_BucketBounds.begin();
+
+	Shard& shard = m_Shards[getMetricShardIndex()];
+	shard.bucketCounts[bucketIndex].fetch_add(1, std::memory_order_relaxed);
+	shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+MetricsHistogramSnapshot MetricsHistogram::getSnapshot() const
+{
+	MetricsHistogramSnapshot histogramSnapshot;
+	histogramSnapshot.bucketBounds = m_BucketBounds;
+	histogramSnapshot.cumulativeCounts.assign(m_BucketBounds.size() + 1, 0);
+	histogramSnapshot.sum = 0.0;
+
+	for (const auto& shard : m_Shards)
+	{
+		for (size_t i = 0; i <= m_BucketBounds.size(); i++)
+		{
+			histogramSnapshot.cumulativeCounts[i] += shard.bucketCounts[i].load(std::memory_order_relaxed);
+		}
+
+		histogramSnapshot.sum += shard.sum.load(std::memory_order_relaxed);
+	}
+
+	for (size_t i = 1; i < histogramSnapshot.cumulativeCounts.size(); i++)
+	{
+		histogramSnapshot.cumulativeCounts[i] += histogramSnapshot.cumulativeCounts[i - 1];
+	}
+
+	histogramSnapshot.count = histogramSnapshot.cumulativeCounts.back();
+
+	return histogramSnapshot;
+}
+
+MetricsHistogram::ScopedTimer::ScopedTimer(MetricsHistogram& histogram) :
+	m_Histogram(histogram),
+	m_StartTime(std::chrono::steady_clock::now())
+{
+}
+
+MetricsHistogram::ScopedTimer::~ScopedTimer()
+{
+	m_Histogram.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count());
+}
+
+MetricsCollector::MetricsCollector(std::function<void()> collect) :
+	m_Collect(std::move(collect))
+{
+	MetricsRegistry::getInstance().addCollector(this);
+}
+
+// Waits for a collection in progress, so the collect function never outlives its owner
+MetricsCollector::~MetricsCollector()
+{
+	MetricsRegistry::getInstance().removeCollector(this);
+}
+
+void MetricsCollector::collect() const
+{
+	m_Collect();
+}
+
+MetricsRegistry& MetricsRegistry::getInstance()
+{
+	static MetricsRegistry metricsRegistry;
+	return metricsRegistry;
+}
+
+std::vector<double> MetricsRegistry::getLatencyBucketBounds()
+{
+	return { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.0167, 0.025, 0.0333, 0.05, 0.1, 0.25, 0.5, 1.0 };
+}
+
+MetricsCounter& MetricsRegistry::getCounter(const std::string& name, const std::string& help, const MetricLabels& labels)
+{
+	std::lock_guard<std::mutex> lock(m_FamiliesMutex);
+
+	std::unique_ptr<MetricsCounter>& counter = getFamily(name, MetricTypeEnum::Counter, help).counters[labels];
+	if (counter == nullptr)
+		counter = std::make_unique<MetricsCounter>();
+
+	return *counter;
+}
+
+MetricsGauge& MetricsRegistry::getGauge(const std::string& name, const std::string& help, const MetricLabels& labels)
+{
+	std::lock_guard<std::mutex> lock(m_FamiliesMutex);
+
+	std::unique_ptr<MetricsGauge>& gauge = getFamily(name, MetricTypeEnum::Gauge, help).gauges[labels];
+	if (gauge == nullptr)
+		gauge = std::make_unique<MetricsGauge>();
+
+	return *gauge;
+}
+
+MetricsHistogram& MetricsRegistry::getHistogram(const std::string& name, const std::string& help, const MetricLabels& labels,
+												const std::vector<double>& bucketBounds)
+{
+	std::lock_guard<std::mutex> lock(m_FamiliesMutex);
+
+	std::unique_ptr<MetricsHistogram>& histogram = getFamily(name, MetricTypeEnum::Histogram, help).histograms[labels];
+	if (histogram == nullptr)
+		histogram = std::make_unique<MetricsHistogram>(bucketBounds);
+
+	return *histogram;
+}
+
+void MetricsRegistry::addCollector(const MetricsCollector* collector)
+{
+	std::lock_guard<std::mutex> lock(m_CollectorsMutex);
+	m_Collectors.push_back(collector);
+}
+
+void MetricsRegistry::removeCollector(const MetricsCollector* collector)
+{
+	std::lock_guard<std::mutex> lock(m_CollectorsMutex);
+	std::erase(m_Collectors, collector);
+}
+
+std::string MetricsRegistry::formatPrometheus()
+{
+	runCollectors();
+
+	std::ostringstream text;
+
+	std::lock_guard<std::mutex> lock(m_FamiliesMutex);
+
+	for (const auto& [name, family] : m_Families)
+	{
+		text << "# HELP " << name << " " << family.help << "\n";
+
+		switch (family.type)
+		{
+			case MetricTypeEnum::Counter:
+			{
+				text << "# TYPE " << name << " counter\n";
+
+				for (const auto& [labels, counter] : family.counters)
+				{
+					text << name << formatPrometheusLabels(labels) << " " << counter->getValue() << "\n";
+				}
+				break;
+			}
+			case MetricTypeEnum::Gauge:
+			{
+				text << "# TYPE " << name << " gauge\n";
+
+				for (const auto& [labels, gauge] : family.gauges)
+				{
+					text << name << formatPrometheusLabels(labels) << " " << formatNumber(gauge->getValue()) << "\n";
+				}
+				break;
+			}
+			case MetricTypeEnum::Histogram:
+			{
+				text << "# TYPE " << name << " histogram\n";
+
+				for (const auto& [labels, histogram] : family.histograms)
+				{
+					MetricsHistogramSnapshot histogramSnapshot = histogram->getSnapshot();
+
+					for (size_t i = 0; i < histogramSnapshot.bucketBounds.size(); i++)
+					{
+						text << name << "_bucket" << formatPrometheusLabels(labels, "le=\"" + formatNumber(histogramSnapshot.bucketBounds[i]) + "\"")
+							 << " " << histogramSnapshot.cumulativeCounts[i] << "\n";
+					}
+
+					text << name << "_bucket" << formatPrometheusLabels(labels, "le=\"+Inf\"") << " " << histogramSnapshot.count << "\n";
+					text << name << "_sum" << formatPrometheusLabels(labels) << " " << formatNumber(histogramSnapshot.sum) << "\n";
+					text << name << "_count" << formatPrometheusLabels(labels) << " " << histogramSnapshot.count << "\n";
+				}
+				break;
+			}
+		}
+	}
+
+	return text.str();
+}
+
+std::string MetricsRegistry::formatJson()
+{
+	runCollectors();
+
+	auto now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch());
+
+	std::ostringstream json;
+	json << "{\n\"timestamp\": " << formatNumber(now.count()) << ",\n\"metrics\": [";
+
+	const char* separator = "\n";
+
+	std::lock_guard<std::mutex> lock(m_FamiliesMutex);
+
+	for (const auto& [name, family] : m_Families)
+	{
+		for (const auto& [labels, counter] : family.counters)
+		{
+			json << separator << "{\"name\": \"" << name << "\", \"type\": \"counter\", \"labels\": " << formatJsonLabels(labels)
+				 << ", \"value\": " << counter->getValue() << "}";
+			separator = ",\n";
+		}
+
+		for (const auto& [labels, gauge] : family.gauges)
+		{
+			json << separator << "{\"name\": \"" << name << "\", \"type\": \"gauge\", \"labels\": " << formatJsonLabels(labels)
+				 << ", \"value\": " << formatNumber(gauge->getValue()) << "}";
+			separator = ",\n";
+		}
+
+		for (const auto& [labels, histogram] : family.histograms)
+		{
+			MetricsHistogramSnapshot histogramSnapshot = histogram->getSnapshot();
+
+			json << separator << "{\"name\": \"" << name << "\", \"type\": \"histogram\", \"labels\": " << formatJsonLabels(labels)
+				 << ", \"count\": " << histogramSnapshot.count << ", \"sum\": " << formatNumber(histogramSnapshot.sum) << ", \"buckets\": [";
+
+			for (size_t i = 0; i < histogramSnapshot.bucketBounds.size(); i++)
+			{
+				json << (i == 0 ? "" : ", ") << "[" << formatNumber(histogramSnapshot.bucketBounds[i]) << ", " << histogramSnapshot.cumulativeCounts[i] << "]";
+			}
+
+			json << "]}";
+			separator = ",\n";
+		}
+	}
+
+	json << "\n]\n}\n";
+
+	return json.str();
+}
+
+// A name keeps the type and help it was first registered with
+MetricsRegistry::MetricFamily& MetricsRegistry::getFamily(const std::string& name, MetricTypeEnum type, const std::string& help)
+{
+	auto familyItr = m_Families.find(name);
+	if (familyItr != m_Families.end())
+		return familyItr->second;
+
+	MetricFamily& family = m_Families[name];
+	family.type = type;
+	family.help = help;
+
+	return family;
+}
+
+void MetricsRegistry::runCollectors()
+{
+	std::lock_guard<std::mutex> lock(m_CollectorsMutex);
+
+	for (const MetricsCollector* collector : m_Collectors)
+	{
+		collector->collect();
+	}
+}
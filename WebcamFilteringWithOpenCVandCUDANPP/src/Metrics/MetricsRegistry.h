@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// Hot metrics are split into cache-line sized shards, each thread adds to its own shard and readers merge them
+constexpr size_t MetricShardsCount = 16;
+
+size_t getMetricShardIndex();
+
+class MetricsCounter
+{
+public:
+	void add(uint64_t value = 1);
+	uint64_t getValue() const;
+
+private:
+	struct alignas(64) Shard
+	{
+		std::atomic<uint64_t> value{ 0 };
+	};
+
+	std::array<Shard, MetricShardsCount> m_Shards;
+};
+
+// Levels that are set as a whole: queue depths, pool bytes, quality level
+class MetricsGauge
+{
+public:
+	void set(double value);
+	double getValue() const;
+
+private:
+	std::atomic<double> m_Value{ 0.0 };
+};
+
+struct MetricsHistogramSnapshot
+{
+	std::vector<double> bucketBounds;
+	// Cumulative like Prometheus, the last one is +Inf and equals count
+	std::vector<uint64_t> cumulativeCounts;
+	double sum;
+	uint64_t count;
+};
+
+class MetricsHistogram
+{
+public:
+	static constexpr size_t MaxBucketsCount = 16;
+
+	// Upper bounds in ascending order, values above the last one only go to +Inf
+	explicit MetricsHistogram(std::vector<double> bucketBounds);
+
+	void observe(double value);
+	MetricsHistogramSnapshot getSnapshot() const;
+
+	// Observes the seconds from construction to destruction
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(MetricsHistogram& histogram);
+		~ScopedTimer();
+
+	private:
+		MetricsHistogram& m_Histogram;
+		std::chrono::steady_clock::time_point m_StartTime;
+	};
+
+private:
+	struct alignas(64) Shard
+	{
+		std::array<std::atomic<uint64_t>, MaxBucketsCount + 1> bucketCounts{};
+		std::atomic<double> sum{ 0.0 };
+	};
+
+	std::vector<double> m_BucketBounds;
+	std::array<Shard, MetricShardsCount> m_Shards;
+};
+
+// Runs right before the metrics are read, for values that are cheaper to pull than to keep up to date
+class MetricsCollector
+{
+public:
+	explicit MetricsCollector(std::function<void()> collect);
+	~MetricsCollector();
+
+	MetricsCollector(const MetricsCollector&) = delete;
+	MetricsCollector& operator=(const MetricsCollector&) = delete;
+
+	void collect() const;
+
+private:
+	std::function<void()> m_Collect;
+};
+
+// Process-wide, metrics live as long as the process so the references handed out stay valid.
+// Lookups take a lock, callers keep the reference instead of looking it up per frame.
+class MetricsRegistry
+{
+public:
+	static MetricsRegistry& getInstance();
+
+	// Stage latencies from 0.1 ms to 1 s
+	static std::vector<double> getLatencyBucketBounds();
+
+	MetricsCounter& getCounter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+	MetricsGauge& getGauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+	MetricsHistogram& getHistogram(const std::string& name, const std::string& help, const MetricLabels& labels = {},
+								   const std::vector<double>& bucketBounds = getLatencyBucketBounds());
+
+	void addCollector(const MetricsCollector* collector);
+	void removeCollector(const MetricsCollector* collector);
+
+	// Prometheus text exposition format 0.0.4
+	std::string formatPrometheus();
+	std::string formatJson();
+
+private:
+	MetricsRegistry() = default;
+
+	enum class MetricTypeEnum
+	{
+		Counter,
+		Gauge,
+		Histogram
+	};
+
+	struct MetricFamily
+	{
+		MetricTypeEnum type;
+		std::string help;
+
+		std::map<MetricLabels, std::unique_ptr<MetricsCounter>> counters;
+		std::map<MetricLabels, std::unique_ptr<MetricsGauge>> gauges;
+		std::map<MetricLabels, std::unique_ptr<MetricsHistogram>> histograms;
+	};
+
+	MetricFamily& getFamily(const std::string& name, MetricTypeEnum type, const std::string& help);
+	void runCollectors();
+
+	std::mutex m_FamiliesMutex;
+	std::map<std::string, MetricFamily> m_Families;
+
+	std::mutex m_CollectorsMutex;
+	std::vector<const MetricsCollector*> m_Collectors;
+};
@@ -0,0 +1,89 @@
+#include "PipelineMetrics.h"
+
+#include "Filters/FilterNames.h"
+
+
+OutputMetrics::OutputMetrics(const std::string& streamName, const std::string& outputName) :
+	processedFrames(MetricsRegistry::getInstance().getCounter("webcam_output_processed_frames_total",
+		"Frames an output was computed for", { { "stream", streamName }, { "output", outputName } })),
+	droppedFrames(MetricsRegistry::getInstance().getCounter("webcam_output_dropped_frames_total",
+		"Frames an output skipped to shed load", { { "stream", streamName }, { "output", outputName } })),
+	publishedFrames(MetricsRegistry::getInstance().getCounter("webcam_output_published_frames_total",
+		"Output frames handed to the view or a sink", { { "stream", streamName }, { "output", outputName } })),
+	generateSeconds(MetricsRegistry::getInstance().getHistogram("webcam_output_generate_seconds",
+		"Time to compute an output", { { "stream", streamName }, { "output", outputName } }))
+{
+}
+
+PipelineMetrics::PipelineMetrics(const std::string& streamName) :
+	capturedFrames(MetricsRegistry::getInstance().getCounter("webcam_captured_frames_total",
+		"Frames grabbed from the frame source", { { "stream", streamName } })),
+	processedFrames(MetricsRegistry::getInstance().getCounter("webcam_processed_frames_total",
+		"Frames run through the active filters", { { "stream", streamName } })),
+	unchangedFrames(MetricsRegistry::getInstance().getCounter("webcam_unchanged_frames_total",
+		"Frames skipped because no tile changed", { { "stream", streamName } })),
+	viewEventQueueDepth(MetricsRegistry::getInstance().getGauge("webcam_view_event_queue_depth",
+		"View events waiting for the capture loop", { { "stream", streamName } })),
+	qualityLevel(MetricsRegistry::getInstance().getGauge("webcam_quality_level",
+		"Steps taken down the quality ladder", { { "stream", streamName } })),
+	m_StageSeconds(std::in_place, [&streamName](PipelineStageEnum stage)
+	{
+		return &MetricsRegistry::getInstance().getHistogram("webcam_stage_seconds",
+			"Time spent in a stage of the capture loop", { { "stream", streamName }, { "stage", getStageName(stage) } });
+	}),
+	m_FilterMetrics(std::in_place, [&streamName](FilterTypeEnum filterType) { return OutputMetrics(streamName, getFilterTypeName(filterType)); }),
+	m_CombinedMetrics(streamName, "Combined")
+{
+}
+
+const char* PipelineMetrics::getStageName(PipelineStageEnum stage)
+{
+	switch (stage)
+	{
+		case PipelineStageEnum::Capture:
+			return "capture";
+		case PipelineStageEnum::Events:
+			return "events";
+		case PipelineStageEnum::Warp:
+			return "warp";
+		case PipelineStageEnum::Resize:
+			return "resize";
+		case PipelineStageEnum::TileDetection:
+			return "tile-detection";
+		case PipelineStageEnum::Upload:
+			return "upload";
+		case PipelineStageEnum::Filters:
+			return "filters";
+		case PipelineStageEnum::Combined:
+			return "combined";
+		case PipelineStageEnum::Present:
+			return "present";
+		case PipelineStageEnum::Sinks:
+			return "sinks";
+		case PipelineStageEnum::Frame:
+			return "frame";
+	}
+
+	return "unknown";
+}
+
+MetricsCounter& PipelineMetrics::getSinkDroppedFrames(const std::string& sinkName)
+{
+	return MetricsRegistry::getInstance().getCounter("webcam_sink_dropped_frames_total",
+		"Frames a sink dropped instead of blocking the capture loop", { { "sink", sinkName } });
+}
+
+MetricsHistogram& PipelineMetrics::getStageSeconds(PipelineStageEnum stage)
+{
+	return *m_StageSeconds[stage];
+}
+
+OutputMetrics& PipelineMetrics::getFilterMetrics(FilterTypeEnum filterType)
+{
+	return m_FilterMetrics[filterType];
+}
+
+OutputMetrics& PipelineMetrics::getCombinedMetrics()
+{
+	return m_CombinedMetrics;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+
+#include "Containers/EnumTable.h"
+#include "Filters/FilterTraits.h"
+#include "MetricsRegistry.h"
+
+
+enum class PipelineStageEnum
+{
+	Capture,
+	Events,
+	Warp,
+	Resize,
+	TileDetection,
+	Upload,
+	Filters,
+	Combined,
+	Present,
+	Sinks,
+	Frame
+};
+
+inline constexpr size_t pipelineStagesCount = static_cast<size_t>(PipelineStageEnum::Frame) + 1;
+
+// Metrics of one output of a stream, a filter or the combined view
+struct OutputMetrics
+{
+	OutputMetrics(const std::string& streamName, const std::string& outputName);
+
+	MetricsCounter& processedFrames;
+	// Skipped by the quality governor
+	MetricsCounter& droppedFrames;
+	// Handed to the view or a sink
+	MetricsCounter& publishedFrames;
+	MetricsHistogram& generateSeconds;
+};
+
+// The metrics of one stream's capture loop, looked up once so the loop only touches sharded atomics
+class PipelineMetrics
+{
+public:
+	explicit PipelineMetrics(const std::string& streamName);
+
+	static const char* getStageName(PipelineStageEnum stage);
+
+	// Frames a sink dropped or skipped instead of holding the capture loop
+	static MetricsCounter& getSinkDroppedFrames(const std::string& sinkName);
+
+	MetricsHistogram& getStageSeconds(PipelineStageEnum stage);
+	OutputMetrics& getFilterMetrics(FilterTypeEnum filterType);
+	OutputMetrics& getCombinedMetrics();
+
+	MetricsCounter& capturedFrames;
+	MetricsCounter& processedFrames;
+	// No tile changed, the outputs of the previous frame are kept
+	MetricsCounter& unchangedFrames;
+
+	MetricsGauge& viewEventQueueDepth;
+	MetricsGauge& qualityLevel;
+
+private:
+	EnumTable<PipelineStageEnum, MetricsHistogram*, pipelineStagesCount> m_StageSeconds;
+	FilterTable<OutputMetrics> m_FilterMetrics;
+	OutputMetrics m_CombinedMetrics;
+};
@@ -0,0 +1,50 @@
+#include "StartupTimeline.h"
+
+
+StartupTimeline::StartupTimeline(const std::string& streamName) :
+	m_StartTime(std::chrono::steady_clock::now())
+{
+	for (size_t i = 0; i < stagesCount; i++)
+	{
+		m_StageSeconds[i].store(-1.0, std::memory_order_relaxed);
+		m_StageGauges[i] = &MetricsRegistry::getInstance().getGauge("webcam_startup_seconds",
+			"Time from the creation of a stream to a stage of its startup", { { "stream", streamName }, { "stage", getStageName(static_cast<StartupStageEnum>(i)) } });
+	}
+}
+
+const char* StartupTimeline::getStageName(StartupStageEnum stage)
+{
+	switch (stage)
+	{
+		case StartupStageEnum::SourceOpened:
+			return "source_opened";
+		case StartupStageEnum::FirstFrame:
+			return "first_frame";
+		case StartupStageEnum::Prewarmed:
+			return "prewarmed";
+		case StartupStageEnum::FirstFilteredFrame:
+			return "first_filtered_frame";
+		default:
+			return "unknown";
+	}
+}
+
+void StartupTimeline::record(StartupStageEnum stage)
+{
+	size_t stageIndex = static_cast<size_t>(stage);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+
+	double notReached = -1.0;
+	if (m_StageSeconds[stageIndex].compare_exchange_strong(notReached, seconds, std::memory_order_relaxed))
+		m_StageGauges[stageIndex]->set(seconds);
+}
+
+bool StartupTimeline::isReached(StartupStageEnum stage) const
+{
+	return getSeconds(stage) >= 0.0;
+}
+
+double StartupTimeline::getSeconds(StartupStageEnum stage) const
+{
+	return m_StageSeconds[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+}
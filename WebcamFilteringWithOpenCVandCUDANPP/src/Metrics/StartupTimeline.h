@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "MetricsRegistry.h"
+
+
+enum class StartupStageEnum
+{
+	// The frame source is open and its frame size known
+	SourceOpened,
+	FirstFrame,
+	// Tunings, buffers and remap tables of the configured outputs are in place
+	Prewarmed,
+	// The first frame that ran through the active filters
+	FirstFilteredFrame
+};
+
+// Seconds from the creation of a stream to each stage of its startup, a stage is recorded the first time it is reached.
+// The capture thread records, the view and the headless report read.
+class StartupTimeline
+{
+public:
+	explicit StartupTimeline(const std::string& streamName);
+
+	static const char* getStageName(StartupStageEnum stage);
+
+	void record(StartupStageEnum stage);
+
+	bool isReached(StartupStageEnum stage) const;
+	// Negative until the stage is reached
+	double getSeconds(StartupStageEnum stage) const;
+
+private:
+	static constexpr size_t stagesCount = 4;
+
+	std::chrono::steady_clock::time_point m_StartTime;
+	std::array<std::atomic<double>, stagesCount> m_StageSeconds;
+	std::array<MetricsGauge*, stagesCount> m_StageGauges;
+};
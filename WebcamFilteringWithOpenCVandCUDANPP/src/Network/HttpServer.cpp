@@ -0,0 +1,327 @@
+#include "HttpServer.h"
+
+#include <iostream>
+#include <sstream>
+
+
+namespace
+{
+	constexpr size_t maxRequestSize = 8192;
+
+	// New data ends the wait early, the timeout only bounds how late a stop is noticed
+	constexpr int serveTimeoutMilliseconds = 100;
+}
+
+
+HttpServer::HttpServer(std::string serverName, size_t maxConnectionsCount) :
+	m_ServerName(std::move(serverName)),
+	m_MaxConnectionsCount(maxConnectionsCount),
+	m_ListenSocket(SocketPlatform::invalidSocket),
+	m_Port(0),
+	m_ConnectionsCount(0),
+	m_SentBytes(0)
+{
+}
+
+HttpServer::~HttpServer()
+{
+	stop();
+}
+
+bool HttpServer::start(uint16_t port, const std::string& bindAddress)
+{
+	if (isRunning() || !SocketPlatform::initialize())
+		return false;
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+
+	if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1)
+	{
+		std::cout << "Error: Invalid " << m_ServerName << " bind address " << bindAddress << "\n";
+		return false;
+	}
+
+	m_ListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (m_ListenSocket == SocketPlatform::invalidSocket)
+		return false;
+
+	int reuseAddress = 1;
+	setsockopt(m_ListenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuseAddress), sizeof(reuseAddress));
+
+	if (bind(m_ListenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+		listen(m_ListenSocket, SOMAXCONN) != 0 ||
+		!SocketPlatform::setNonBlocking(m_ListenSocket) ||
+		!m_SocketPoller.add(m_ListenSocket, false))
+	{
+		std::cout << "Error: Could not listen for " << m_ServerName << " on " << bindAddress << ":" << port << "\n";
+
+		SocketPlatform::closeSocket(m_ListenSocket);
+		m_ListenSocket = SocketPlatform::invalidSocket;
+		return false;
+	}
+
+	m_Port = port;
+	m_ServerThread = std::jthread([this](std::stop_token stopToken) { serve(stopToken); });
+
+	return true;
+}
+
+void HttpServer::stop()
+{
+	if (!isRunning())
+		return;
+
+	m_ServerThread.request_stop();
+	m_SocketPoller.wake();
+	m_ServerThread.join();
+
+	while (m_Connections.empty() == false)
+	{
+		closeConnection(m_Connections.begin()->first);
+	}
+
+	m_SocketPoller.remove(m_ListenSocket);
+	SocketPlatform::closeSocket(m_ListenSocket);
+	m_ListenSocket = SocketPlatform::invalidSocket;
+}
+
+bool HttpServer::isRunning() const
+{
+	return m_ListenSocket != SocketPlatform::invalidSocket;
+}
+
+uint16_t HttpServer::getPort() const
+{
+	return m_Port;
+}
+
+std::string HttpServer::buildResponse(const std::string& status, const std::string& contentType, const std::string& body)
+{
+	std::ostringstream response;
+	response
+		<< "HTTP/1.1 " << status << "\r\n"
+		<< "Content-Type: " << contentType << "\r\n"
+		<< "Content-Length: " << body.size() << "\r\n"
+		<< "Cache-Control: no-cache\r\n"
+		<< "Connection: close\r\n\r\n"
+		<< body;
+
+	return response.str();
+}
+
+void HttpServer::update()
+{
+}
+
+bool HttpServer::sendBody(Connection&)
+{
+	return false;
+}
+
+bool HttpServer::hasPendingBody(const Connection&) const
+{
+	return false;
+}
+
+void HttpServer::onConnectionClosed(const Connection&)
+{
+}
+
+long HttpServer::sendNonBlocking(Connection& connection, const char* data, size_t size)
+{
+	long sentSize = SocketPlatform::sendNonBlocking(connection.socketHandle, data, size);
+
+	if (sentSize < 0)
+		connection.canSend = false;
+	else
+		m_SentBytes.fetch_add(sentSize, std::memory_order_relaxed);
+
+	return sentSize;
+}
+
+void HttpServer::wake()
+{
+	m_SocketPoller.wake();
+}
+
+size_t HttpServer::getConnectionsCount() const
+{
+	return m_ConnectionsCount.load(std::memory_order_relaxed);
+}
+
+uint64_t HttpServer::getSentBytes() const
+{
+	return m_SentBytes.load(std::memory_order_relaxed);
+}
+
+void HttpServer::serve(std::stop_token stopToken)
+{
+	std::vector<SocketPoller::Event> events;
+	std::vector<SocketPlatform::SocketHandle> finishedConnections;
+
+	while (!stopToken.stop_requested())
+	{
+		m_SocketPoller.wait(events, serveTimeoutMilliseconds);
+
+		for (const auto& event : events)
+		{
+			if (event.socketHandle == m_ListenSocket)
+			{
+				acceptConnections();
+				continue;
+			}
+
+			auto connectionItr = m_Connections.find(event.socketHandle);
+			if (connectionItr == m_Connections.end())
+				continue;
+
+			Connection& connection = connectionItr->second;
+
+			if ((event.readable && !receiveFromConnection(connection)) || event.closed)
+			{
+				closeConnection(event.socketHandle);
+				continue;
+			}
+
+			if (event.writable)
+				connection.canSend = true;
+		}
+
+		update();
+
+		finishedConnections.clear();
+
+		for (auto& [socketHandle, connection] : m_Connections)
+		{
+			if (connection.canSend && !sendToConnection(connection))
+			{
+				finishedConnections.push_back(socketHandle);
+				continue;
+			}
+
+			// Only connections with unsent data are woken by writability
+			bool hasPendingData = connection.responseOffset < connection.response.size() || hasPendingBody(connection);
+			if (hasPendingData != connection.watchingWritable)
+			{
+				m_SocketPoller.modify(socketHandle, hasPendingData);
+				connection.watchingWritable = hasPendingData;
+			}
+		}
+
+		for (SocketPlatform::SocketHandle socketHandle : finishedConnections)
+		{
+			closeConnection(socketHandle);
+		}
+	}
+}
+
+void HttpServer::acceptConnections()
+{
+	while (true)
+	{
+		SocketPlatform::SocketHandle socketHandle = accept(m_ListenSocket, nullptr, nullptr);
+		if (socketHandle == SocketPlatform::invalidSocket)
+			return;
+
+		if (m_Connections.size() >= m_MaxConnectionsCount ||
+			!SocketPlatform::setNonBlocking(socketHandle) ||
+			!m_SocketPoller.add(socketHandle, false))
+		{
+			SocketPlatform::closeSocket(socketHandle);
+			continue;
+		}
+
+		Connection connection;
+		connection.socketHandle = socketHandle;
+
+		m_Connections.emplace(socketHandle, std::move(connection));
+		m_ConnectionsCount = m_Connections.size();
+	}
+}
+
+// Returns false when the connection has to be closed
+bool HttpServer::receiveFromConnection(Connection& connection)
+{
+	char buffer[2048];
+
+	while (true)
+	{
+		long receivedSize = SocketPlatform::receiveNonBlocking(connection.socketHandle, buffer, sizeof(buffer));
+
+		if (receivedSize == 0)
+			return false;
+
+		if (receivedSize < 0)
+		{
+			if (SocketPlatform::isWouldBlockError())
+				break;
+
+			return false;
+		}
+
+		// Anything sent after the request is ignored
+		if (!connection.requestHandled)
+			connection.request.append(buffer, receivedSize);
+	}
+
+	if (connection.requestHandled)
+		return true;
+
+	if (connection.request.find("\r\n\r\n") == std::string::npos)
+		return connection.request.size() <= maxRequestSize;
+
+	connection.requestHandled = true;
+	connection.canSend = true;
+
+	std::istringstream requestLine(connection.request.substr(0, connection.request.find("\r\n")));
+	std::string method;
+	std::string path;
+	requestLine >> method >> path;
+
+	if (method != "GET")
+	{
+		connection.response = buildResponse("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+		return true;
+	}
+
+	handleRequest(connection, path.substr(0, path.find('?')));
+
+	return true;
+}
+
+// Sends until the socket would block, returns false when the connection has to be closed
+bool HttpServer::sendToConnection(Connection& connection)
+{
+	while (connection.responseOffset < connection.response.size())
+	{
+		long sentSize = sendNonBlocking(connection, connection.response.data() + connection.responseOffset,
+										connection.response.size() - connection.responseOffset);
+		if (sentSize < 0)
+			return SocketPlatform::isWouldBlockError();
+
+		connection.responseOffset += sentSize;
+	}
+
+	if (connection.closeAfterResponse || !sendBody(connection))
+		return false;
+
+	connection.canSend = false;
+	return true;
+}
+
+void HttpServer::closeConnection(SocketPlatform::SocketHandle socketHandle)
+{
+	auto connectionItr = m_Connections.find(socketHandle);
+	if (connectionItr == m_Connections.end())
+		return;
+
+	onConnectionClosed(connectionItr->second);
+
+	m_SocketPoller.remove(socketHandle);
+	SocketPlatform::closeSocket(socketHandle);
+
+	m_Connections.erase(connectionItr);
+	m_ConnectionsCount = m_Connections.size();
+}
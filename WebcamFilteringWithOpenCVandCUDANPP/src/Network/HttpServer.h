@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SocketPlatform.h"
+#include "SocketPoller.h"
+
+
+// Non-blocking HTTP/1.1 listener shared by the servers. Connections are accepted, read and written on one server thread
+// that never blocks on a socket. Each connection sends one request, the derived server routes it to a response and may
+// keep the connection open to stream a body after it. Derived servers call stop() in their destructor, the server
+// thread calls into them.
+class HttpServer
+{
+public:
+	virtual ~HttpServer();
+
+	HttpServer(const HttpServer&) = delete;
+	HttpServer& operator=(const HttpServer&) = delete;
+
+	bool start(uint16_t port, const std::string& bindAddress);
+	void stop();
+
+	bool isRunning() const;
+	uint16_t getPort() const;
+
+protected:
+	struct Connection
+	{
+		SocketPlatform::SocketHandle socketHandle;
+		std::string request;
+		bool requestHandled = false;
+
+		// Whole response, or the header of a streamed body
+		std::string response;
+		size_t responseOffset = 0;
+		bool closeAfterResponse = true;
+
+		bool canSend = false;
+		bool watchingWritable = false;
+	};
+
+	// The server name only appears in errors, e.g. "metrics"
+	HttpServer(std::string serverName, size_t maxConnectionsCount);
+
+	static std::string buildResponse(const std::string& status, const std::string& contentType, const std::string& body);
+
+	// Fills the response to a GET of the path. Clearing closeAfterResponse keeps the connection open for sendBody.
+	virtual void handleRequest(Connection& connection, const std::string& path) = 0;
+	// Once per wake-up of the server thread, before the pending data is sent
+	virtual void update();
+	// Sends the body after the response until the socket would block, false when the connection has to be closed
+	virtual bool sendBody(Connection& connection);
+	virtual bool hasPendingBody(const Connection& connection) const;
+	virtual void onConnectionClosed(const Connection& connection);
+
+	// Counts the sent bytes. A socket that would block clears canSend, the poller sets it again once it is writable.
+	long sendNonBlocking(Connection& connection, const char* data, size_t size);
+
+	// Ends the wait of the server thread early, e.g. for new data to stream
+	void wake();
+
+	size_t getConnectionsCount() const;
+	uint64_t getSentBytes() const;
+
+private:
+	void serve(std::stop_token stopToken);
+
+	void acceptConnections();
+	bool receiveFromConnection(Connection& connection);
+	bool sendToConnection(Connection& connection);
+	void closeConnection(SocketPlatform::SocketHandle socketHandle);
+
+	std::string m_ServerName;
+	size_t m_MaxConnectionsCount;
+
+	SocketPlatform::SocketHandle m_ListenSocket;
+	uint16_t m_Port;
+
+	SocketPoller m_SocketPoller;
+
+	// Only touched on the server thread
+	std::unordered_map<SocketPlatform::SocketHandle, Connection> m_Connections;
+
+	std::atomic<size_t> m_ConnectionsCount;
+	std::atomic<uint64_t> m_SentBytes;
+
+	std::jthread m_ServerThread;
+};
@@ -0,0 +1,33 @@
+#include "MetricsHttpServer.h"
+
+#include "Metrics/MetricsRegistry.h"
+
+
+namespace
+{
+	constexpr size_t maxConnectionsCount = 16;
+}
+
+
+MetricsHttpServer::MetricsHttpServer() :
+	HttpServer("metrics", maxConnectionsCount)
+{
+}
+
+MetricsHttpServer::~MetricsHttpServer()
+{
+	stop();
+}
+
+bool MetricsHttpServer::start(uint16_t port, const std::string& bindAddress)
+{
+	return HttpServer::start(port, bindAddress);
+}
+
+void MetricsHttpServer::handleRequest(Connection& connection, const std::string& path)
+{
+	if (path == "/metrics")
+		connection.response = buildResponse("200 OK", "text/plain; version=0.0.4", MetricsRegistry::getInstance().formatPrometheus());
+	else
+		connection.response = buildResponse("404 Not Found", "text/plain", "Metrics are served at /metrics\n");
+}
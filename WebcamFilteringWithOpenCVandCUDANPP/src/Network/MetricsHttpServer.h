@@ -0,0 +1,19 @@
+#pragma once
+
+#include "HttpServer.h"
+
+
+// Serves the metrics registry at /metrics in the Prometheus text format.
+// Binds to the loopback interface by default, the metrics are meant for a scraper on the same host.
+class MetricsHttpServer :
+	public HttpServer
+{
+public:
+	MetricsHttpServer();
+	~MetricsHttpServer() override;
+
+	bool start(uint16_t port, const std::string& bindAddress = "127.0.0.1");
+
+private:
+	void handleRequest(Connection& connection, const std::string& path) override;
+};
@@ -0,0 +1,251 @@
+#include "MjpegHttpServer.h"
+
+#include <sstream>
+
+
+namespace
+{
+	constexpr size_t maxConnectionsCount = 256;
+
+	const char* const boundary = "mjpegframe";
+}
+
+
+MjpegHttpServer::MjpegHttpServer() :
+	HttpServer("HTTP", maxConnectionsCount),
+	m_SentFramesCount(0),
+	m_SkippedFramesCount(0)
+{
+}
+
+MjpegHttpServer::~MjpegHttpServer()
+{
+	stop();
+}
+
+bool MjpegHttpServer::start(uint16_t port, const std::string& bindAddress)
+{
+	return HttpServer::start(port, bindAddress);
+}
+
+int MjpegHttpServer::addStream(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_StreamsMutex);
+
+	for (size_t i = 0; i < m_Streams.size(); i++)
+	{
+		if (m_Streams[i]->name == name)
+			return static_cast<int>(i);
+	}
+
+	auto stream = std::make_unique<Stream>();
+	stream->name = name;
+	stream->publishedFramesCount = 0;
+	stream->viewersCount = 0;
+
+	m_Streams.push_back(std::move(stream));
+
+	return static_cast<int>(m_Streams.size() - 1);
+}
+
+bool MjpegHttpServer::hasViewers(int streamIndex) const
+{
+	std::lock_guard<std::mutex> lock(m_StreamsMutex);
+
+	return m_Streams.at(streamIndex)->viewersCount.load(std::memory_order_relaxed) > 0;
+}
+
+void MjpegHttpServer::publishFrame(int streamIndex, std::vector<unsigned char> jpeg)
+{
+	// The part header is built once here, viewers send it straight from the shared frame
+	auto streamFrame = std::make_shared<StreamFrame>();
+
+	std::ostringstream partHeader;
+	partHeader
+		<< "--" << boundary << "\r\n"
+		<< "Content-Type: image/jpeg\r\n"
+		<< "Content-Length: " << jpeg.size() << "\r\n\r\n";
+
+	streamFrame->partHeader = partHeader.str();
+	streamFrame->jpeg = std::move(jpeg);
+
+	{
+		std::lock_guard<std::mutex> lock(m_StreamsMutex);
+
+		Stream& stream = *m_Streams.at(streamIndex);
+		streamFrame->sequence = ++stream.publishedFramesCount;
+		stream.latestFrame = std::move(streamFrame);
+	}
+
+	wake();
+}
+
+MjpegHttpStats MjpegHttpServer::getStats() const
+{
+	MjpegHttpStats mjpegHttpStats;
+
+	mjpegHttpStats.clientsCount = getConnectionsCount();
+	mjpegHttpStats.sentFramesCount = m_SentFramesCount.load(std::memory_order_relaxed);
+	mjpegHttpStats.skippedFramesCount = m_SkippedFramesCount.load(std::memory_order_relaxed);
+	mjpegHttpStats.sentBytes = getSentBytes();
+
+	return mjpegHttpStats;
+}
+
+void MjpegHttpServer::handleRequest(Connection& connection, const std::string& path)
+{
+	if (path == "/")
+	{
+		connection.response = buildResponse("200 OK", "text/html", buildIndexPage());
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_StreamsMutex);
+
+	for (size_t i = 0; i < m_Streams.size(); i++)
+	{
+		if (path.empty() || path.compare(1, std::string::npos, m_Streams[i]->name) != 0)
+			continue;
+
+		m_Streams[i]->viewersCount.fetch_add(1, std::memory_order_relaxed);
+		Viewer viewer;
+		viewer.connection = &connection;
+		viewer.streamIndex = static_cast<int>(i);
+
+		m_Viewers[connection.socketHandle] = std::move(viewer);
+
+		std::ostringstream responseHeader;
+		responseHeader
+			<< "HTTP/1.1 200 OK\r\n"
+			<< "Content-Type: multipart/x-mixed-replace; boundary=" << boundary << "\r\n"
+			<< "Cache-Control: no-cache, no-store\r\n"
+			<< "Pragma: no-cache\r\n"
+			<< "Connection: close\r\n\r\n";
+
+		connection.response = responseHeader.str();
+		connection.closeAfterResponse = false;
+		return;
+	}
+
+	connection.response = buildResponse("404 Not Found", "text/plain", "No stream at " + path + "\n");
+}
+
+// Viewers that finished their previous frame move on to the latest one, the frames in between are skipped
+void MjpegHttpServer::update()
+{
+	m_LatestFrames.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_StreamsMutex);
+
+		for (const auto& stream : m_Streams)
+		{
+			m_LatestFrames.push_back(stream->latestFrame);
+		}
+	}
+
+	for (auto& [socketHandle, viewer] : m_Viewers)
+	{
+		if (viewer.sendingFrame != nullptr)
+			continue;
+
+		const std::shared_ptr<const StreamFrame>& latestFrame = m_LatestFrames[viewer.streamIndex];
+		if (latestFrame == nullptr || latestFrame->sequence == viewer.sentSequence)
+			continue;
+
+		if (viewer.sentSequence != 0)
+			m_SkippedFramesCount.fetch_add(latestFrame->sequence - viewer.sentSequence - 1, std::memory_order_relaxed);
+
+		viewer.sendingFrame = latestFrame;
+		viewer.sendingFrameOffset = 0;
+		viewer.sentSequence = latestFrame->sequence;
+		viewer.connection->canSend = true;
+	}
+}
+
+bool MjpegHttpServer::sendBody(Connection& connection)
+{
+	Viewer& viewer = m_Viewers.at(connection.socketHandle);
+
+	while (viewer.sendingFrame != nullptr)
+	{
+		const StreamFrame& frame = *viewer.sendingFrame;
+
+		// The frame goes out as part header, JPEG and the line break before the next boundary
+		size_t headerSize = frame.partHeader.size();
+		size_t jpegEnd = headerSize + frame.jpeg.size();
+		size_t offset = viewer.sendingFrameOffset;
+
+		const char* data;
+		size_t size;
+
+		if (offset < headerSize)
+		{
+			data = frame.partHeader.data() + offset;
+			size = headerSize - offset;
+		}
+		else if (offset < jpegEnd)
+		{
+			data = reinterpret_cast<const char*>(frame.jpeg.data()) + (offset - headerSize);
+			size = jpegEnd - offset;
+		}
+		else
+		{
+			data = "\r\n" + (offset - jpegEnd);
+			size = 2 - (offset - jpegEnd);
+		}
+
+		long sentSize = sendNonBlocking(connection, data, size);
+		if (sentSize < 0)
+			return SocketPlatform::isWouldBlockError();
+
+		viewer.sendingFrameOffset += sentSize;
+
+		if (viewer.sendingFrameOffset == jpegEnd + 2)
+		{
+			viewer.sendingFrame = nullptr;
+			m_SentFramesCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return true;
+}
+
+bool MjpegHttpServer::hasPendingBody(const Connection& connection) const
+{
+	auto viewerItr = m_Viewers.find(connection.socketHandle);
+
+	return viewerItr != m_Viewers.end() && viewerItr->second.sendingFrame != nullptr;
+}
+
+void MjpegHttpServer::onConnectionClosed(const Connection& connection)
+{
+	auto viewerItr = m_Viewers.find(connection.socketHandle);
+	if (viewerItr == m_Viewers.end())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_StreamsMutex);
+		m_Streams[viewerItr->second.streamIndex]->viewersCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	m_Viewers.erase(viewerItr);
+}
+
+std::string MjpegHttpServer::buildIndexPage() const
+{
+	std::ostringstream page;
+	page << "<!DOCTYPE html>\n<html><head><title>Webcam Filters</title></head><body>\n";
+
+	std::lock_guard<std::mutex> lock(m_StreamsMutex);
+
+	for (const auto& stream : m_Streams)
+	{
+		page
+			<< "<figure style=\"display:inline-block\"><img src=\"/" << stream->name << "\" style=\"max-width:640px\">"
+			<< "<figcaption><a href=\"/" << stream->name << "\">" << stream->name << "</a></figcaption></figure>\n";
+	}
+
+	page << "</body></html>\n";
+
+	return page.str();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "HttpServer.h"
+
+
+struct MjpegHttpStats
+{
+	size_t clientsCount;
+	uint64_t sentFramesCount;
+	uint64_t skippedFramesCount;
+	uint64_t sentBytes;
+};
+
+// Serves JPEG streams as multipart/x-mixed-replace to browsers, one stream per path, with an index page at "/".
+// A published frame is shared by every viewer of its stream. Each viewer holds at most the frame it is sending,
+// a viewer that is still sending when newer frames arrive skips straight to the latest one.
+class MjpegHttpServer :
+	public HttpServer
+{
+public:
+	MjpegHttpServer();
+	~MjpegHttpServer() override;
+
+	bool start(uint16_t port, const std::string& bindAddress = "0.0.0.0");
+
+	// Served at /<name>, adding an existing name returns its index
+	int addStream(const std::string& name);
+
+	// Lets publishers skip encoding while nobody watches
+	bool hasViewers(int streamIndex) const;
+	void publishFrame(int streamIndex, std::vector<unsigned char> jpeg);
+
+	MjpegHttpStats getStats() const;
+
+private:
+	struct StreamFrame
+	{
+		std::string partHeader;
+		std::vector<unsigned char> jpeg;
+		uint64_t sequence;
+	};
+
+	struct Stream
+	{
+		std::string name;
+		std::shared_ptr<const StreamFrame> latestFrame;
+		uint64_t publishedFramesCount;
+		std::atomic<int> viewersCount;
+	};
+
+	// Stream state of a connection that asked for a stream
+	struct Viewer
+	{
+		Connection* connection = nullptr;
+		int streamIndex = 0;
+
+		std::shared_ptr<const StreamFrame> sendingFrame;
+		size_t sendingFrameOffset = 0;
+		uint64_t sentSequence = 0;
+	};
+
+	void handleRequest(Connection& connection, const std::string& path) override;
+	void update() override;
+	bool sendBody(Connection& connection) override;
+	bool hasPendingBody(const Connection& connection) const override;
+	void onConnectionClosed(const Connection& connection) override;
+
+	std::string buildIndexPage() const;
+
+	mutable std::mutex m_StreamsMutex;
+	std::vector<std::unique_ptr<Stream>> m_Streams;
+
+	// Only touched on the server thread
+	std::unordered_map<SocketPlatform::SocketHandle, Viewer> m_Viewers;
+	std::vector<std::shared_ptr<const StreamFrame>> m_LatestFrames;
+
+	std::atomic<uint64_t> m_SentFramesCount;
+	std::atomic<uint64_t> m_SkippedFramesCount;
+};
@@ -0,0 +1,73 @@
+#include "SocketPlatform.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace SocketPlatform
+{
+	bool initialize()
+	{
+#ifdef _WIN32
+		static const bool initialized = []()
+		{
+			WSADATA wsaData;
+			return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+		}();
+
+		return initialized;
+#else
+		return true;
+#endif
+	}
+
+	void closeSocket(SocketHandle socketHandle)
+	{
+#ifdef _WIN32
+		closesocket(socketHandle);
+#else
+		close(socketHandle);
+#endif
+	}
+
+	bool setNonBlocking(SocketHandle socketHandle)
+	{
+#ifdef _WIN32
+		u_long nonBlocking = 1;
+		return ioctlsocket(socketHandle, FIONBIO, &nonBlocking) == 0;
+#else
+		int flags = fcntl(socketHandle, F_GETFL, 0);
+		return flags != -1 && fcntl(socketHandle, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+	}
+
+	bool isWouldBlockError()
+	{
+#ifdef _WIN32
+		return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+		return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+	}
+
+	long sendNonBlocking(SocketHandle socketHandle, const char* data, size_t size)
+	{
+#ifdef _WIN32
+		return send(socketHandle, data, static_cast<int>(size), 0);
+#else
+		return static_cast<long>(send(socketHandle, data, size, MSG_NOSIGNAL));
+#endif
+	}
+
+	long receiveNonBlocking(SocketHandle socketHandle, char* data, size_t size)
+	{
+#ifdef _WIN32
+		return recv(socketHandle, data, static_cast<int>(size), 0);
+#else
+		return static_cast<long>(recv(socketHandle, data, size, 0));
+#endif
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+
+// The few socket calls that differ between Winsock and POSIX
+namespace SocketPlatform
+{
+#ifdef _WIN32
+	using SocketHandle = SOCKET;
+	constexpr SocketHandle invalidSocket = INVALID_SOCKET;
+#else
+	using SocketHandle = int;
+	constexpr SocketHandle invalidSocket = -1;
+#endif
+
+	// Winsock has to be initialized once per process, it is a no-op elsewhere
+	bool initialize();
+
+	void closeSocket(SocketHandle socketHandle);
+	bool setNonBlocking(SocketHandle socketHandle);
+
+	// True when the last failed call would have blocked
+	bool isWouldBlockError();
+
+	// Never raises SIGPIPE, returns the bytes sent or -1
+	long sendNonBlocking(SocketHandle socketHandle, const char* data, size_t size);
+	long receiveNonBlocking(SocketHandle socketHandle, char* data, size_t size);
+}
@@ -0,0 +1,180 @@
+#include "SocketPoller.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <poll.h>
+#endif
+
+
+namespace
+{
+#ifndef __linux__
+	// Without a wake descriptor to poll, a wake is noticed within this time
+	constexpr int maxPollMilliseconds = 5;
+#endif
+}
+
+
+#ifdef __linux__
+
+SocketPoller::SocketPoller()
+{
+	m_EpollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	m_WakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	epoll_event wakeEvent = {};
+	wakeEvent.events = EPOLLIN;
+	wakeEvent.data.fd = m_WakeDescriptor;
+	epoll_ctl(m_EpollDescriptor, EPOLL_CTL_ADD, m_WakeDescriptor, &wakeEvent);
+}
+
+SocketPoller::~SocketPoller()
+{
+	close(m_WakeDescriptor);
+	close(m_EpollDescriptor);
+}
+
+bool SocketPoller::add(SocketPlatform::SocketHandle socketHandle, bool watchWritable)
+{
+	epoll_event socketEvent = {};
+	socketEvent.events = EPOLLIN | EPOLLRDHUP | (watchWritable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+	socketEvent.data.fd = socketHandle;
+
+	return epoll_ctl(m_EpollDescriptor, EPOLL_CTL_ADD, socketHandle, &socketEvent) == 0;
+}
+
+void SocketPoller::modify(SocketPlatform::SocketHandle socketHandle, bool watchWritable)
+{
+	epoll_event socketEvent = {};
+	socketEvent.events = EPOLLIN | EPOLLRDHUP | (watchWritable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+	socketEvent.data.fd = socketHandle;
+
+	epoll_ctl(m_EpollDescriptor, EPOLL_CTL_MOD, socketHandle, &socketEvent);
+}
+
+void SocketPoller::remove(SocketPlatform::SocketHandle socketHandle)
+{
+	epoll_ctl(m_EpollDescriptor, EPOLL_CTL_DEL, socketHandle, nullptr);
+}
+
+void SocketPoller::wake()
+{
+	uint64_t wakeCount = 1;
+	[[maybe_unused]] ssize_t written = write(m_WakeDescriptor, &wakeCount, sizeof(wakeCount));
+}
+
+void SocketPoller::wait(std::vector<Event>& events, int timeoutMilliseconds)
+{
+	events.clear();
+
+	epoll_event readyEvents[64];
+	int readyCount = epoll_wait(m_EpollDescriptor, readyEvents, 64, timeoutMilliseconds);
+
+	for (int i = 0; i < readyCount; i++)
+	{
+		if (readyEvents[i].data.fd == m_WakeDescriptor)
+		{
+			uint64_t wakeCount;
+			[[maybe_unused]] ssize_t readBytes = read(m_WakeDescriptor, &wakeCount, sizeof(wakeCount));
+			continue;
+		}
+
+		uint32_t readyFlags = readyEvents[i].events;
+		events.push_back({ readyEvents[i].data.fd,
+						   (readyFlags & EPOLLIN) != 0,
+						   (readyFlags & EPOLLOUT) != 0,
+						   (readyFlags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0 });
+	}
+}
+
+#else
+
+SocketPoller::SocketPoller() :
+	m_WakeRequested(false)
+{
+}
+
+SocketPoller::~SocketPoller()
+{
+}
+
+bool SocketPoller::add(SocketPlatform::SocketHandle socketHandle, bool watchWritable)
+{
+	m_PolledSockets.push_back({ socketHandle, watchWritable });
+	return true;
+}
+
+void SocketPoller::modify(SocketPlatform::SocketHandle socketHandle, bool watchWritable)
+{
+	for (auto& polledSocket : m_PolledSockets)
+	{
+		if (polledSocket.socketHandle == socketHandle)
+			polledSocket.watchWritable = watchWritable;
+	}
+}
+
+void SocketPoller::remove(SocketPlatform::SocketHandle socketHandle)
+{
+	std::erase_if(m_PolledSockets, [socketHandle](const PolledSocket& polledSocket) { return polledSocket.socketHandle == socketHandle; });
+}
+
+void SocketPoller::wake()
+{
+	std::lock_guard<std::mutex> lock(m_WakeMutex);
+	m_WakeRequested = true;
+}
+
+void SocketPoller::wait(std::vector<Event>& events, int timeoutMilliseconds)
+{
+	events.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		if (m_WakeRequested)
+		{
+			m_WakeRequested = false;
+			timeoutMilliseconds = 0;
+		}
+	}
+
+	std::vector<pollfd> pollDescriptors;
+	pollDescriptors.reserve(m_PolledSockets.size());
+
+	for (const auto& polledSocket : m_PolledSockets)
+	{
+		pollfd pollDescriptor = {};
+		pollDescriptor.fd = polledSocket.socketHandle;
+		pollDescriptor.events = POLLIN | (polledSocket.watchWritable ? POLLOUT : 0);
+		pollDescriptors.push_back(pollDescriptor);
+	}
+
+	int pollTimeout = timeoutMilliseconds < 0 ? maxPollMilliseconds : std::min(timeoutMilliseconds, maxPollMilliseconds);
+
+#ifdef _WIN32
+	int readyCount = pollDescriptors.empty() ? (Sleep(pollTimeout), 0) :
+		WSAPoll(pollDescriptors.data(), static_cast<ULONG>(pollDescriptors.size()), pollTimeout);
+#else
+	int readyCount = poll(pollDescriptors.data(), pollDescriptors.size(), pollTimeout);
+#endif
+
+	if (readyCount <= 0)
+		return;
+
+	for (const auto& pollDescriptor : pollDescriptors)
+	{
+		if (pollDescriptor.revents == 0)
+			continue;
+
+		events.push_back({ static_cast<SocketPlatform::SocketHandle>(pollDescriptor.fd),
+						   (pollDescriptor.revents & POLLIN) != 0,
+						   (pollDescriptor.revents & POLLOUT) != 0,
+						   (pollDescriptor.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 });
+	}
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "SocketPlatform.h"
+
+#ifndef __linux__
+#include <mutex>
+#endif
+
+
+// Readiness notification for many non-blocking sockets: epoll on Linux, poll/WSAPoll elsewhere.
+// Sockets are added, changed and removed on the thread that waits, wake may be called from any thread.
+class SocketPoller
+{
+public:
+	struct Event
+	{
+		SocketPlatform::SocketHandle socketHandle;
+		bool readable;
+		bool writable;
+		bool closed;
+	};
+
+	SocketPoller();
+	~SocketPoller();
+
+	SocketPoller(const SocketPoller&) = delete;
+	SocketPoller& operator=(const SocketPoller&) = delete;
+
+	bool add(SocketPlatform::SocketHandle socketHandle, bool watchWritable);
+	void modify(SocketPlatform::SocketHandle socketHandle, bool watchWritable);
+	void remove(SocketPlatform::SocketHandle socketHandle);
+
+	// Ends the current wait early
+	void wake();
+
+	// Fills events with the ready sockets, wake-ups are not reported
+	void wait(std::vector<Event>& events, int timeoutMilliseconds);
+
+private:
+#ifdef __linux__
+	int m_EpollDescriptor;
+	int m_WakeDescriptor;
+#else
+	struct PolledSocket
+	{
+		SocketPlatform::SocketHandle socketHandle;
+		bool watchWritable;
+	};
+
+	std::vector<PolledSocket> m_PolledSockets;
+	bool m_WakeRequested;
+	std::mutex m_WakeMutex;
+#endif
+};
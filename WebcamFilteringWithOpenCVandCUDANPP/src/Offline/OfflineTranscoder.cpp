@@ -0,0 +1,648 @@
+#include "OfflineTranscoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <opencv4/opencv2/imgcodecs.hpp>
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include "Filters/FilterNames.h"
+#include "Filters/FilterTraits.h"
+#include "Filters/Stages/FilterStageFactory.h"
+#include "Geometry/RegionOfInterest.h"
+
+
+namespace
+{
+	bool hasExtension(const std::string& path, const std::string& extension)
+	{
+		return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+	}
+
+	// "frames/%05d.png" into "frames/", 5 and ".png", the width is 0 for "%d"
+	bool splitImageSequencePath(const std::string& path, std::string& prefix, int& indexWidth, std::string& suffix)
+	{
+		size_t percentPosition = path.find('%');
+		if (percentPosition == std::string::npos)
+			return false;
+
+		size_t indexEnd = path.find('d', percentPosition);
+		if (indexEnd == std::string::npos)
+			return false;
+
+		std::string widthDigits = path.substr(percentPosition + 1, indexEnd - percentPosition - 1);
+		if (widthDigits.find_first_not_of("0123456789") != std::string::npos)
+			return false;
+
+		prefix = path.substr(0, percentPosition);
+		indexWidth = widthDigits.empty() ? 0 : std::atoi(widthDigits.c_str());
+		suffix = path.substr(indexEnd + 1);
+
+		return suffix.find('%') == std::string::npos;
+	}
+}
+
+
+OfflineTranscoder::OfflineTranscoder(int argc, char* argv[]) :
+	m_OutputFormat(OutputFormatEnum::Video),
+	m_CpuLumaFilterSelected(false),
+	m_WarpEnabled(false),
+	m_RegionOfInterestEnabled(false),
+	m_MaxFramesInFlight(0),
+	m_FramesPerSecond(0.0),
+	m_ImageSequence(false),
+	m_ImageIndexWidth(0),
+	m_NextImageIndex(0),
+	m_FailedFramesCount(0),
+	m_FramesInFlight(0),
+	m_WriterOpened(false),
+	m_WriteFailed(false),
+	m_WrittenFramesCount(0)
+{
+	m_ArgumentsValid = parseArguments(argc, argv);
+
+	// Enough frames to keep every worker busy while the in-order stages wait for a slow frame
+	if (m_MaxFramesInFlight == 0)
+		m_MaxFramesInFlight = m_WorkerPool.getThreadCount() * 4;
+}
+
+bool OfflineTranscoder::parseArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--transcode" && hasValue)
+		{
+			m_InputPath = argv[++i];
+		}
+		else if (argument == "--to" && hasValue)
+		{
+			m_OutputPath = argv[++i];
+		}
+		else if (argument == "--filters" && hasValue)
+		{
+			if (!parseFilterTypeList(argv[++i], m_FilterTypes) || m_FilterTypes.empty())
+				return false;
+		}
+		else if (argument == "--warp" && hasValue)
+		{
+			if (!WarpParameters::parse(argv[++i], m_WarpParameters))
+				return false;
+
+			m_WarpEnabled = true;
+		}
+		else if (argument == "--roi" && hasValue)
+		{
+			if (!RegionOfInterest::parse(argv[++i], m_RegionOfInterest))
+				return false;
+
+			m_RegionOfInterestEnabled = true;
+		}
+		else if (argument == "--frames-in-flight" && hasValue)
+		{
+			m_MaxFramesInFlight = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+		}
+		else if (argument == "--fps" && hasValue)
+		{
+			m_FramesPerSecond = std::atof(argv[++i]);
+			if (m_FramesPerSecond <= 0.0)
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	if (m_FilterTypes.empty())
+		m_FilterTypes = { FilterTypeEnum::None };
+
+	m_CpuLumaFilterSelected = std::any_of(m_FilterTypes.begin(), m_FilterTypes.end(),
+										  [](FilterTypeEnum filterType) { return getFilterTraits(filterType).cpuLuma; });
+
+	if (hasExtension(m_OutputPath, ".mjpeg"))
+		m_OutputFormat = OutputFormatEnum::Mjpeg;
+	else if (hasExtension(m_OutputPath, ".y4m"))
+		m_OutputFormat = OutputFormatEnum::Y4m;
+
+	return m_InputPath.empty() == false && m_OutputPath.empty() == false;
+}
+
+void OfflineTranscoder::printUsage() const
+{
+	std::cout
+		<< "Usage: --transcode <video|frames/%05d.png|stream.mjpeg> --to <output.mjpeg|output.y4m|output.avi>\n"
+		<< "       [--filters <filter>[,<filter>...]] [--warp k1,k2,keystone] [--roi x,y,w,h] [--frames-in-flight N] [--fps F]\n"
+		<< "Filters:";
+
+	for (const FilterTraits& filterTraits : filterTraitsList)
+	{
+		std::cout << (filterTraits.filterType == FilterTypeEnum::None ? " " : ", ") << filterTraits.name;
+	}
+
+	std::cout << "\n";
+}
+
+int OfflineTranscoder::run()
+{
+	if (!m_ArgumentsValid)
+	{
+		printUsage();
+		return 1;
+	}
+
+	if (!openInput())
+		return 1;
+
+	// The workers create the stateless stages with their filter contexts
+	for (FilterTypeEnum filterType : m_FilterTypes)
+	{
+		m_CpuLumaFilterStages.push_back(getFilterTraits(filterType).cpuLuma ? FilterStageFactory::createFilterStage(filterType, m_WorkerPool) : nullptr);
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::jthread filterStageThread([this]() { runFilterStage(); });
+	std::jthread writerStageThread([this]() { runWriterStage(); });
+
+	uint64_t readFramesCount = 0;
+
+	while (true)
+	{
+		// A new Mat every time, capture backends may write the next frame into the buffer of the previous one
+		cv::Mat inputFrame;
+		if (!readInputFrame(inputFrame))
+			break;
+
+		acquireFrameSlot();
+
+		uint64_t sequence = readFramesCount++;
+		m_WorkerPool.submit([this, sequence, inputFrame]()
+		{
+			OfflineFrame offlineFrame;
+			bool prepared = false;
+
+			bool stepDone = runFrameStep(sequence, [&]()
+			{
+				// A context lost to an exception is simply not reused
+				std::unique_ptr<FrameFilterContext> filterContext = acquireFilterContext();
+				prepared = prepareFrame(decode(inputFrame), *filterContext, offlineFrame);
+				releaseFilterContext(std::move(filterContext));
+			});
+
+			if (stepDone && !prepared)
+				reportFailedFrame(sequence, "A filter stage failed");
+
+			m_PreparedFrames.push(sequence, prepared ? std::move(offlineFrame) : OfflineFrame());
+		});
+	}
+
+	m_PreparedFrames.setItemsCount(readFramesCount);
+
+	filterStageThread.join();
+	writerStageThread.join();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	std::cout
+		<< "\n-----------------------------------------\n"
+		<< "Transcoding finished\n"
+		<< "Worker threads: " << m_WorkerPool.getThreadCount() << "\n"
+		<< "Frames in flight: " << m_MaxFramesInFlight << "\n"
+		<< "Read frames: " << readFramesCount << "\n"
+		<< "Written frames: " << m_WrittenFramesCount << "\n"
+		<< "Failed frames: " << m_FailedFramesCount << "\n"
+		<< "Reorder depth: " << m_PreparedFrames.getPeakSize() << " prepared, " << m_EncodedFrames.getPeakSize() << " encoded\n"
+		<< "Elapsed: " << elapsed.count() << " s\n"
+		<< "Throughput: " << (elapsed.count() > 0.0 ? m_WrittenFramesCount / elapsed.count() : 0.0) << " fps\n"
+		<< "-----------------------------------------\n";
+
+	return m_WriteFailed || m_FailedFramesCount > 0 ? 1 : 0;
+}
+
+// MJPEG streams and image sequences are decoded on the workers, videos are decoded by the capture backend while reading
+bool OfflineTranscoder::openInput()
+{
+	if (hasExtension(m_InputPath, ".mjpeg") || hasExtension(m_InputPath, ".mjpg"))
+	{
+		m_MjpegSource = std::make_unique<MjpegFileSource>(m_InputPath);
+		if (!m_MjpegSource->open())
+			return false;
+	}
+	else if (splitImageSequencePath(m_InputPath, m_ImagePathPrefix, m_ImageIndexWidth, m_ImagePathSuffix))
+	{
+		// Sequences start at 0 or 1 like the image sequence backend
+		m_ImageSequence = true;
+		m_NextImageIndex = std::filesystem::exists(getImagePath(0)) ? 0 : 1;
+
+		if (!std::filesystem::exists(getImagePath(m_NextImageIndex)))
+		{
+			std::cout << "Error: Could not open " << m_InputPath << "\n";
+			return false;
+		}
+	}
+	else if (!m_VideoCapture.open(m_InputPath))
+	{
+		std::cout << "Error: Could not open " << m_InputPath << "\n";
+		return false;
+	}
+
+	if (m_FramesPerSecond <= 0.0)
+		m_FramesPerSecond = m_VideoCapture.isOpened() ? m_VideoCapture.get(cv::CAP_PROP_FPS) : 0.0;
+
+	if (m_FramesPerSecond <= 0.0)
+		m_FramesPerSecond = 30.0;
+
+	return true;
+}
+
+// Compressed frames are only read here, the sequence ends at the first missing image
+bool OfflineTranscoder::readInputFrame(cv::Mat& inputFrame)
+{
+	if (m_MjpegSource != nullptr)
+		return m_MjpegSource->grabCompressedFrame(inputFrame);
+
+	if (!m_ImageSequence)
+		return m_VideoCapture.read(inputFrame);
+
+	std::ifstream imageFile(getImagePath(m_NextImageIndex), std::ios::binary | std::ios::ate);
+	if (!imageFile)
+		return false;
+
+	std::streamsize imageBytes = imageFile.tellg();
+	if (imageBytes <= 0)
+		return false;
+
+	imageFile.seekg(0);
+
+	inputFrame.create(1, static_cast<int>(imageBytes), CV_8U);
+	if (!imageFile.read(reinterpret_cast<char*>(inputFrame.data), imageBytes))
+		return false;
+
+	m_NextImageIndex++;
+	return true;
+}
+
+std::string OfflineTranscoder::getImagePath(int imageIndex) const
+{
+	std::ostringstream imagePath;
+	imagePath << m_ImagePathPrefix << std::setfill('0') << std::setw(m_ImageIndexWidth) << imageIndex << m_ImagePathSuffix;
+
+	return imagePath.str();
+}
+
+cv::Mat OfflineTranscoder::decode(const cv::Mat& inputFrame) const
+{
+	if (m_MjpegSource == nullptr && !m_ImageSequence)
+		return inputFrame;
+
+	cv::Mat frame = cv::imdecode(inputFrame, cv::IMREAD_COLOR);
+	if (frame.empty())
+		throw std::runtime_error("Could not decode the frame");
+
+	return frame;
+}
+
+// Warp, ROI, upload, conversion and the stateless stages like the live pipeline, on the buffers of one worker.
+// Every output is downloaded into buffers of the frame, the context is free for the next frame afterwards.
+bool OfflineTranscoder::prepareFrame(const cv::Mat& decodedFrame, FrameFilterContext& filterContext, OfflineFrame& offlineFrame)
+{
+	cv::Mat frame = decodedFrame;
+
+	// Unlike the live view the warp does not mirror either
+	if (m_WarpEnabled)
+	{
+		getRemapTable(frame.size())->apply(frame, filterContext.warpedFrame);
+		frame = filterContext.warpedFrame;
+	}
+
+	// Even sizes keep the chroma planes exact
+	cv::Rect processingRect(0, 0, frame.cols & ~1, frame.rows & ~1);
+	cv::Rect outputRect(cv::Point(), processingRect.size());
+
+	if (m_RegionOfInterestEnabled)
+	{
+		cv::Rect regionOfInterestRect = RegionOfInterest::getFrameRect(m_RegionOfInterest, frame.size());
+
+		processingRect = RegionOfInterest::getProcessingRect(regionOfInterestRect, frame.size(), getFiltersHalo());
+		outputRect = regionOfInterestRect - processingRect.tl();
+	}
+
+	if (processingRect.size() != filterContext.frameSize)
+	{
+		filterContext.frameSize = processingRect.size();
+		filterContext.changedRects = { cv::Rect(cv::Point(), processingRect.size()) };
+
+		for (const auto& filterStage : filterContext.filterStages)
+		{
+			if (filterStage != nullptr)
+				filterStage->allocate(processingRect.size());
+		}
+	}
+
+	filterContext.frameUpload.upload(frame(processingRect));
+
+	if (!filterContext.frameYuv.fromBGR(filterContext.frameUpload))
+		return false;
+
+	if (m_CpuLumaFilterSelected)
+		filterContext.frameYuv.getLuma().download(offlineFrame.luma);
+
+	FilterStageInput filterStageInput = { filterContext.frameYuv, offlineFrame.luma, filterContext.changedRects };
+	offlineFrame.filterOutputs.resize(m_FilterTypes.size());
+	offlineFrame.outputRect = outputRect;
+
+	for (size_t i = 0; i < filterContext.filterStages.size(); i++)
+	{
+		FilterStage* filterStage = filterContext.filterStages[i].get();
+		if (filterStage == nullptr)
+			continue;
+
+		if (!filterStage->generate(filterStageInput, false))
+			return false;
+
+		filterStage->getGpuOutput().download(offlineFrame.filterOutputs[i]);
+	}
+
+	return true;
+}
+
+// Tiled in filter order like the combined output, luma outputs are expanded to BGR
+void OfflineTranscoder::encodeFrame(OfflineFrame& offlineFrame) const
+{
+	const cv::Rect& outputRect = offlineFrame.outputRect;
+
+	if (offlineFrame.filterOutputs.size() == 1)
+	{
+		offlineFrame.frame = offlineFrame.filterOutputs.front()(outputRect);
+	}
+	else
+	{
+		offlineFrame.frame.create(outputRect.height, outputRect.width * static_cast<int>(offlineFrame.filterOutputs.size()), CV_8UC3);
+
+		for (size_t i = 0; i < offlineFrame.filterOutputs.size(); i++)
+		{
+			int place = static_cast<int>(i);
+			cv::Mat framePlace = offlineFrame.frame.colRange(outputRect.width * place, outputRect.width * (place + 1));
+			cv::Mat filterOutput = offlineFrame.filterOutputs[i](outputRect);
+
+			if (filterOutput.channels() == 1)
+				cv::cvtColor(filterOutput, framePlace, cv::COLOR_GRAY2BGR);
+			else
+				filterOutput.copyTo(framePlace);
+		}
+
+		offlineFrame.filterOutputs.clear();
+	}
+
+	offlineFrame.luma.release();
+
+	// The video writer encodes on the writer thread, the other formats are written as they are encoded here
+	if (m_OutputFormat == OutputFormatEnum::Mjpeg)
+		cv::imencode(".jpg", offlineFrame.frame, offlineFrame.encodedFrame, { cv::IMWRITE_JPEG_QUALITY, 90 });
+	else if (m_OutputFormat == OutputFormatEnum::Y4m)
+		Y4mWriter::packFrame(offlineFrame.frame, offlineFrame.encodedFrame);
+}
+
+void OfflineTranscoder::runFilterStage()
+{
+	uint64_t sequence = 0;
+	OfflineFrame offlineFrame;
+
+	while (m_PreparedFrames.popNext(offlineFrame))
+	{
+		if (m_CpuLumaFilterSelected && offlineFrame.filterOutputs.empty() == false)
+		{
+			bool filtered = false;
+
+			if (runFrameStep(sequence, [&]() { filtered = generateCpuLumaOutputs(offlineFrame); }) && !filtered)
+				reportFailedFrame(sequence, "A filter stage failed");
+
+			if (!filtered)
+				offlineFrame = OfflineFrame();
+		}
+
+		if (offlineFrame.filterOutputs.empty())
+		{
+			m_EncodedFrames.push(sequence, std::move(offlineFrame));
+		}
+		else
+		{
+			m_WorkerPool.submit([this, sequence, preparedFrame = std::move(offlineFrame)]() mutable
+			{
+				OfflineFrame encodedFrame;
+				if (runFrameStep(sequence, [&]() { encodeFrame(preparedFrame); }))
+					encodedFrame = std::move(preparedFrame);
+
+				m_EncodedFrames.push(sequence, std::move(encodedFrame));
+			});
+		}
+
+		offlineFrame = OfflineFrame();
+		sequence++;
+	}
+
+	m_EncodedFrames.setItemsCount(sequence);
+}
+
+// The stateful filters see every frame in input order, each splits it over the workers itself
+bool OfflineTranscoder::generateCpuLumaOutputs(OfflineFrame& offlineFrame)
+{
+	// Stateful filters start over at a new size
+	if (offlineFrame.luma.size() != m_CpuLumaFrameSize)
+	{
+		m_CpuLumaFrameSize = offlineFrame.luma.size();
+		m_CpuLumaChangedRects = { cv::Rect(cv::Point(), m_CpuLumaFrameSize) };
+
+		for (const auto& filterStage : m_CpuLumaFilterStages)
+		{
+			if (filterStage != nullptr)
+				filterStage->allocate(m_CpuLumaFrameSize);
+		}
+	}
+
+	FilterStageInput filterStageInput = { m_UnusedYuvFrame, offlineFrame.luma, m_CpuLumaChangedRects };
+
+	for (size_t i = 0; i < m_CpuLumaFilterStages.size(); i++)
+	{
+		FilterStage* filterStage = m_CpuLumaFilterStages[i].get();
+		if (filterStage == nullptr)
+			continue;
+
+		if (!filterStage->generate(filterStageInput, false))
+			return false;
+
+		// The filter reuses its output buffer for the next frame
+		offlineFrame.filterOutputs[i] = filterStage->getHostOutput().clone();
+	}
+
+	return true;
+}
+
+std::unique_ptr<OfflineTranscoder::FrameFilterContext> OfflineTranscoder::acquireFilterContext()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_FilterContextsMutex);
+
+		if (m_FreeFilterContexts.empty() == false)
+		{
+			std::unique_ptr<FrameFilterContext> filterContext = std::move(m_FreeFilterContexts.back());
+			m_FreeFilterContexts.pop_back();
+
+			return filterContext;
+		}
+	}
+
+	// At most one per worker, the stages allocate their buffers on the first frame
+	auto filterContext = std::make_unique<FrameFilterContext>();
+
+	for (FilterTypeEnum filterType : m_FilterTypes)
+	{
+		filterContext->filterStages.push_back(getFilterTraits(filterType).cpuLuma ? nullptr : FilterStageFactory::createFilterStage(filterType, m_WorkerPool));
+	}
+
+	return filterContext;
+}
+
+void OfflineTranscoder::releaseFilterContext(std::unique_ptr<FrameFilterContext> filterContext)
+{
+	std::lock_guard<std::mutex> lock(m_FilterContextsMutex);
+	m_FreeFilterContexts.push_back(std::move(filterContext));
+}
+
+// Held while a table is built, so the workers do not build the same one at once
+std::shared_ptr<const RemapTable> OfflineTranscoder::getRemapTable(const cv::Size& frameSize)
+{
+	std::lock_guard<std::mutex> lock(m_RemapTableMutex);
+
+	if (m_RemapTable == nullptr || m_RemapTable->getSize() != frameSize)
+		m_RemapTable = m_RemapTableCache.get(m_WarpParameters, frameSize);
+
+	return m_RemapTable;
+}
+
+int OfflineTranscoder::getFiltersHalo() const
+{
+	int halo = 0;
+
+	for (FilterTypeEnum filterType : m_FilterTypes)
+	{
+		halo = std::max(halo, getFilterTraits(filterType).halo);
+	}
+
+	return halo;
+}
+
+bool OfflineTranscoder::runFrameStep(uint64_t sequence, const std::function<void()>& frameStep)
+{
+	try
+	{
+		frameStep();
+		return true;
+	}
+	catch (const std::exception& exception)
+	{
+		reportFailedFrame(sequence, exception.what());
+	}
+	catch (...)
+	{
+		reportFailedFrame(sequence, "Unknown error");
+	}
+
+	return false;
+}
+
+// Called from the workers, the message is written at once so lines do not interleave
+void OfflineTranscoder::reportFailedFrame(uint64_t sequence, const std::string& reason)
+{
+	m_FailedFramesCount.fetch_add(1, std::memory_order_relaxed);
+
+	std::cout << ("Error: Frame " + std::to_string(sequence) + " failed: " + reason + "\n");
+}
+
+void OfflineTranscoder::runWriterStage()
+{
+	OfflineFrame offlineFrame;
+
+	while (m_EncodedFrames.popNext(offlineFrame))
+	{
+		// Frames are still drained after a failed write so the reader is never left waiting for a slot
+		if (!m_WriteFailed && writeFrame(offlineFrame))
+			m_WrittenFramesCount++;
+
+		releaseFrameSlot();
+	}
+
+	m_MjpegFile.close();
+	m_Y4mWriter.release();
+	m_VideoWriter.release();
+}
+
+bool OfflineTranscoder::writeFrame(const OfflineFrame& offlineFrame)
+{
+	if (m_OutputFormat == OutputFormatEnum::Mjpeg)
+	{
+		if (offlineFrame.encodedFrame.empty())
+			return false;
+
+		if (!m_WriterOpened)
+		{
+			m_MjpegFile.open(m_OutputPath, std::ios::binary | std::ios::trunc);
+			m_WriterOpened = true;
+		}
+
+		m_MjpegFile.write(reinterpret_cast<const char*>(offlineFrame.encodedFrame.data()), offlineFrame.encodedFrame.size());
+		m_WriteFailed = !m_MjpegFile;
+	}
+	else
+	{
+		const cv::Mat& frame = offlineFrame.frame;
+		if (frame.empty())
+			return false;
+
+		if (!m_WriterOpened)
+		{
+			m_WriteFailed = m_OutputFormat == OutputFormatEnum::Y4m ?
+				!m_Y4mWriter.open(m_OutputPath, frame.size(), frame.type(), m_FramesPerSecond) :
+				!m_VideoWriter.open(m_OutputPath, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), m_FramesPerSecond, frame.size(), frame.channels() == 3);
+			m_WriterOpened = true;
+		}
+
+		if (!m_WriteFailed && m_OutputFormat == OutputFormatEnum::Y4m)
+			m_WriteFailed = m_Y4mWriter.writePacked(offlineFrame.encodedFrame) == 0;
+		else if (!m_WriteFailed)
+			m_VideoWriter.write(frame);
+	}
+
+	if (m_WriteFailed)
+		std::cout << "Error: Could not write " << m_OutputPath << "\n";
+
+	return !m_WriteFailed;
+}
+
+void OfflineTranscoder::acquireFrameSlot()
+{
+	std::unique_lock<std::mutex> lock(m_FramesInFlightMutex);
+	m_FramesInFlightCondition.wait(lock, [this]() { return m_FramesInFlight < m_MaxFramesInFlight; });
+
+	m_FramesInFlight++;
+}
+
+void OfflineTranscoder::releaseFrameSlot()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_FramesInFlightMutex);
+		m_FramesInFlight--;
+	}
+
+	m_FramesInFlightCondition.notify_one();
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <opencv4/opencv2/core/cuda.hpp>
+#include <opencv4/opencv2/videoio.hpp>
+
+#include "Capture/MjpegFileSource.h"
+#include "Filters/FilterTypes.h"
+#include "Filters/Stages/FilterStage.h"
+#include "Frames/YuvFrame.h"
+#include "Geometry/RemapTableCache.h"
+#include "Geometry/WarpParameters.h"
+#include "Output/Y4mWriter.h"
+#include "ReorderBuffer.h"
+#include "Threading/WorkerPool.h"
+
+
+// Reprocesses a video file, an image sequence ("frames/%05d.png") or an MJPEG stream into a file, as fast as possible.
+// Usage: --transcode <input> --to <output.mjpeg|output.y4m|output.avi> [--filters <filter>[,<filter>...]]
+//        [--warp k1,k2,keystone] [--roi x,y,w,h] [--frames-in-flight N] [--fps F]
+// The frames go through the same warp and filter stages as the live view. Decoding, the warp, the upload and the
+// GPU stages run on many frames at once, each task with its own buffers and stages. Only the stateful CPU stages
+// see every frame in input order (strip-parallel inside). Tiling and JPEG or Y4M encoding are frame-parallel
+// again and the writer restores the input order. Several filters are written side by side like the combined output.
+// Unlike the live view the frames are not mirrored.
+class OfflineTranscoder
+{
+public:
+	OfflineTranscoder(int argc, char* argv[]);
+
+	int run();
+
+private:
+	enum class OutputFormatEnum
+	{
+		Mjpeg,
+		Y4m,
+		Video
+	};
+
+	struct OfflineFrame
+	{
+		// Output of every filter in filter order, the CPU ones are filled in input order. Empty once the frame failed.
+		std::vector<cv::Mat> filterOutputs;
+		// Read by the CPU filters
+		cv::Mat luma;
+		// Part of the outputs that is written
+		cv::Rect outputRect;
+
+		// Written frame, and as a JPEG or Y4M frame unless the video writer encodes it
+		cv::Mat frame;
+		std::vector<uchar> encodedFrame;
+	};
+
+	// Buffers and stateless stages of the frame a worker filters, the next frame on a worker reuses a free one
+	struct FrameFilterContext
+	{
+		// Null for the CPU filters
+		std::vector<std::unique_ptr<FilterStage>> filterStages;
+		cv::Size frameSize;
+		cv::Mat warpedFrame;
+		cv::cuda::GpuMat frameUpload;
+		YuvFrame frameYuv;
+		std::vector<cv::Rect> changedRects;
+	};
+
+	bool parseArguments(int argc, char* argv[]);
+	void printUsage() const;
+
+	bool openInput();
+	bool readInputFrame(cv::Mat& inputFrame);
+	std::string getImagePath(int imageIndex) const;
+
+	// Frame-parallel stages
+	cv::Mat decode(const cv::Mat& inputFrame) const;
+	bool prepareFrame(const cv::Mat& decodedFrame, FrameFilterContext& filterContext, OfflineFrame& offlineFrame);
+	void encodeFrame(OfflineFrame& offlineFrame) const;
+
+	// In-order stages, each on its own thread
+	void runFilterStage();
+	void runWriterStage();
+
+	bool generateCpuLumaOutputs(OfflineFrame& offlineFrame);
+
+	std::unique_ptr<FrameFilterContext> acquireFilterContext();
+	void releaseFilterContext(std::unique_ptr<FrameFilterContext> filterContext);
+	std::shared_ptr<const RemapTable> getRemapTable(const cv::Size& frameSize);
+
+	int getFiltersHalo() const;
+
+	// False when the step threw. The frame is then passed on empty, so the in-order stages never wait for it.
+	bool runFrameStep(uint64_t sequence, const std::function<void()>& frameStep);
+	void reportFailedFrame(uint64_t sequence, const std::string& reason);
+
+	bool writeFrame(const OfflineFrame& offlineFrame);
+
+	void acquireFrameSlot();
+	void releaseFrameSlot();
+
+	bool m_ArgumentsValid;
+
+	std::string m_InputPath;
+	std::string m_OutputPath;
+	OutputFormatEnum m_OutputFormat;
+	std::vector<FilterTypeEnum> m_FilterTypes;
+	bool m_CpuLumaFilterSelected;
+	bool m_WarpEnabled;
+	WarpParameters m_WarpParameters;
+	bool m_RegionOfInterestEnabled;
+	cv::Rect2d m_RegionOfInterest;
+	size_t m_MaxFramesInFlight;
+	double m_FramesPerSecond;
+
+	WorkerPool m_WorkerPool;
+
+	// Compressed frames are decoded on the workers, videos by the capture backend while reading
+	std::unique_ptr<MjpegFileSource> m_MjpegSource;
+	bool m_ImageSequence;
+	std::string m_ImagePathPrefix;
+	std::string m_ImagePathSuffix;
+	int m_ImageIndexWidth;
+	int m_NextImageIndex;
+	cv::VideoCapture m_VideoCapture;
+
+	std::mutex m_FilterContextsMutex;
+	std::vector<std::unique_ptr<FrameFilterContext>> m_FreeFilterContexts;
+
+	// Built once per frame size, shared by the workers
+	std::mutex m_RemapTableMutex;
+	RemapTableCache m_RemapTableCache;
+	std::shared_ptr<const RemapTable> m_RemapTable;
+
+	// Only used by the filter stage, null for the stateless filters
+	std::vector<std::unique_ptr<FilterStage>> m_CpuLumaFilterStages;
+	cv::Size m_CpuLumaFrameSize;
+	YuvFrame m_UnusedYuvFrame;
+	std::vector<cv::Rect> m_CpuLumaChangedRects;
+
+	std::atomic<uint64_t> m_FailedFramesCount;
+
+	ReorderBuffer<OfflineFrame> m_PreparedFrames;
+	ReorderBuffer<OfflineFrame> m_EncodedFrames;
+
+	// Frames between reading and writing
+	std::mutex m_FramesInFlightMutex;
+	std::condition_variable m_FramesInFlightCondition;
+	size_t m_FramesInFlight;
+
+	// Only used by the writer stage
+	std::ofstream m_MjpegFile;
+	Y4mWriter m_Y4mWriter;
+	cv::VideoWriter m_VideoWriter;
+	bool m_WriterOpened;
+	bool m_WriteFailed;
+	uint64_t m_WrittenFramesCount;
+};
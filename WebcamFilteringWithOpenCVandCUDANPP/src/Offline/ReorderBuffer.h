@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+
+
+// Hands items out in sequence order, whatever order they are completed in.
+// The producer side announces the number of items once it knows it, the consumer stops after the last one.
+// Every sequence has to be pushed, a failed item as an empty one, or the consumer waits for it forever.
+template<typename Item>
+class ReorderBuffer
+{
+public:
+	void push(uint64_t sequence, Item item)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ItemsMutex);
+
+			m_Items.emplace(sequence, std::move(item));
+			m_PeakSize = std::max(m_PeakSize, m_Items.size());
+		}
+
+		m_ItemsCondition.notify_all();
+	}
+
+	void setItemsCount(uint64_t itemsCount)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ItemsMutex);
+			m_ItemsCount = itemsCount;
+		}
+
+		m_ItemsCondition.notify_all();
+	}
+
+	// Blocks until the next item in order is there, returns false after the last one
+	bool popNext(Item& item)
+	{
+		std::unique_lock<std::mutex> lock(m_ItemsMutex);
+		m_ItemsCondition.wait(lock, [this]()
+		{
+			return m_NextSequence == m_ItemsCount || (m_Items.empty() == false && m_Items.begin()->first == m_NextSequence);
+		});
+
+		if (m_NextSequence == m_ItemsCount)
+			return false;
+
+		item = std::move(m_Items.begin()->second);
+		m_Items.erase(m_Items.begin());
+		m_NextSequence++;
+
+		return true;
+	}
+
+	// Most items that waited for an earlier one at the same time
+	size_t getPeakSize() const
+	{
+		std::lock_guard<std::mutex> lock(m_ItemsMutex);
+		return m_PeakSize;
+	}
+
+private:
+	mutable std::mutex m_ItemsMutex;
+	std::condition_variable m_ItemsCondition;
+
+	std::map<uint64_t, Item> m_Items;
+	uint64_t m_NextSequence = 0;
+	uint64_t m_ItemsCount = std::numeric_limits<uint64_t>::max();
+	size_t m_PeakSize = 0;
+};
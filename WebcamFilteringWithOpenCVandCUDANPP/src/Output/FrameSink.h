@@ -0,0 +1,26 @@
+#pragma once
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "Filters/FilterTypes.h"
+
+
+// Which output of the pipeline a sink receives
+struct FrameSinkSource
+{
+	bool combined = false;
+	FilterTypeEnum filterType = FilterTypeEnum::None;
+	// The frame as the source delivered it, before the warp, the ROI and the mirroring, also without active filters
+	bool captured = false;
+};
+
+// Receives every output frame of the capture loop, also the unchanged ones.
+// pushFrame is called on the capture thread and must not block on I/O or encoding,
+// the frame is only valid during the call.
+class FrameSink
+{
+public:
+	virtual ~FrameSink() = default;
+
+	virtual void pushFrame(const cv::Mat& frame) = 0;
+};
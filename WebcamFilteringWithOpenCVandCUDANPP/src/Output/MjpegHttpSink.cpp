@@ -0,0 +1,74 @@
+#include "MjpegHttpSink.h"
+
+#include <opencv4/opencv2/imgcodecs.hpp>
+
+#include "Filters/FilterTraits.h"
+#include "Metrics/PipelineMetrics.h"
+#include "Threading/WorkerPool.h"
+
+
+MjpegHttpSink::MjpegHttpSink(std::shared_ptr<MjpegHttpServer> mjpegHttpServer, WorkerPool& workerPool, const std::string& streamName, int jpegQuality) :
+	m_MjpegHttpServer(std::move(mjpegHttpServer)),
+	m_WorkerPool(workerPool),
+	m_JpegQuality(jpegQuality),
+	m_EncodedFramesCount(0),
+	m_SkippedFramesCount(0),
+	m_SkippedFramesMetric(PipelineMetrics::getSinkDroppedFrames("http-" + streamName))
+{
+	m_StreamIndex = m_MjpegHttpServer->addStream(streamName);
+}
+
+MjpegHttpSink::~MjpegHttpSink()
+{
+	// The encode task refers to this sink
+	if (m_EncodingFrame.valid())
+		m_EncodingFrame.wait();
+}
+
+void MjpegHttpSink::pushFrame(const cv::Mat& frame)
+{
+	if (frame.empty() || !m_MjpegHttpServer->hasViewers(m_StreamIndex))
+		return;
+
+	if (m_EncodingFrame.valid())
+	{
+		if (m_EncodingFrame.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			m_SkippedFramesCount.fetch_add(1, std::memory_order_relaxed);
+			m_SkippedFramesMetric.add();
+			return;
+		}
+
+		m_EncodingFrame.get();
+	}
+
+	cv::Mat frameCopy = frame.clone();
+
+	m_EncodingFrame = m_WorkerPool.submit([this, frameCopy]()
+	{
+		std::vector<uchar> jpeg;
+		if (!cv::imencode(".jpg", frameCopy, jpeg, { cv::IMWRITE_JPEG_QUALITY, m_JpegQuality }))
+			return;
+
+		m_MjpegHttpServer->publishFrame(m_StreamIndex, std::move(jpeg));
+		m_EncodedFramesCount.fetch_add(1, std::memory_order_relaxed);
+	});
+}
+
+uint64_t MjpegHttpSink::getEncodedFramesCount() const
+{
+	return m_EncodedFramesCount.load(std::memory_order_relaxed);
+}
+
+uint64_t MjpegHttpSink::getSkippedFramesCount() const
+{
+	return m_SkippedFramesCount.load(std::memory_order_relaxed);
+}
+
+std::string MjpegHttpSink::getStreamName(const FrameSinkSource& frameSinkSource)
+{
+	if (frameSinkSource.combined)
+		return "combined";
+
+	return getFilterTraits(frameSinkSource.filterType).streamName;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+
+#include "FrameSink.h"
+#include "Metrics/MetricsRegistry.h"
+#include "Network/MjpegHttpServer.h"
+
+class WorkerPool;
+
+
+// Publishes an output as one stream of the MJPEG HTTP server.
+// Frames are only encoded while someone watches, once per frame on the worker pool, whatever the number of viewers.
+// A frame arriving while the previous one is still encoding is skipped.
+class MjpegHttpSink :
+	public FrameSink
+{
+public:
+	MjpegHttpSink(std::shared_ptr<MjpegHttpServer> mjpegHttpServer, WorkerPool& workerPool, const std::string& streamName, int jpegQuality = 80);
+	~MjpegHttpSink() override;
+
+	void pushFrame(const cv::Mat& frame) override;
+
+	uint64_t getEncodedFramesCount() const;
+	uint64_t getSkippedFramesCount() const;
+
+	// URL path of an output, e.g. "sobel" or "combined"
+	static std::string getStreamName(const FrameSinkSource& frameSinkSource);
+
+private:
+	std::shared_ptr<MjpegHttpServer> m_MjpegHttpServer;
+	WorkerPool& m_WorkerPool;
+
+	int m_StreamIndex;
+	int m_JpegQuality;
+
+	std::future<void> m_EncodingFrame;
+
+	std::atomic<uint64_t> m_EncodedFramesCount;
+	std::atomic<uint64_t> m_SkippedFramesCount;
+	MetricsCounter& m_SkippedFramesMetric;
+};
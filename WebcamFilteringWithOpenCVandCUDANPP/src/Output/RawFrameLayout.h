@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Container of uncompressed frames written by RawFrameWriter and mapped by RawFrameFileSource:
+// a header page, the frames each starting on a page boundary, then an index of frame offsets and timestamps.
+// All frames have the size, type and row stride given in the header.
+namespace RawFrameLayout
+{
+	// "RAWFRAME" read as a little-endian integer
+	constexpr uint64_t fileMagic = 0x454D415246574152ull;
+	constexpr uint32_t fileVersion = 1;
+
+	// Large enough for the 4 KiB pages of x86 and the 16 KiB pages of Apple silicon
+	constexpr uint64_t pageSize = 16384;
+
+	struct FileHeader
+	{
+		uint64_t magic;
+		uint32_t version;
+		// OpenCV type of the frames, e.g. CV_8UC3
+		int32_t type;
+		int32_t width;
+		int32_t height;
+		uint64_t rowStride;
+		// Bytes of a frame and distance between the starts of two frames
+		uint64_t frameSize;
+		uint64_t frameStride;
+		double framesPerSecond;
+		// Written when the file is closed, both are 0 in a recording that was not closed
+		uint64_t frameCount;
+		uint64_t indexOffset;
+	};
+
+	struct FrameIndexEntry
+	{
+		uint64_t offset;
+		// Since the first frame of the recording
+		uint64_t timestampNanoseconds;
+	};
+
+	constexpr uint64_t alignToPage(uint64_t size)
+	{
+		return (size + pageSize - 1) & ~(pageSize - 1);
+	}
+}
@@ -0,0 +1,97 @@
+#include "RawFrameWriter.h"
+
+#include <cstring>
+
+
+RawFrameWriter::RawFrameWriter() :
+	m_FileHeader()
+{
+}
+
+RawFrameWriter::~RawFrameWriter()
+{
+	release();
+}
+
+bool RawFrameWriter::open(const std::string& path, const cv::Size& frameSize, int frameType, double framesPerSecond)
+{
+	release();
+
+	m_File.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_File)
+		return false;
+
+	const uint64_t rowStride = static_cast<uint64_t>(frameSize.width) * CV_ELEM_SIZE(frameType);
+
+	m_FileHeader = RawFrameLayout::FileHeader();
+	m_FileHeader.magic = RawFrameLayout::fileMagic;
+	m_FileHeader.version = RawFrameLayout::fileVersion;
+	m_FileHeader.type = frameType;
+	m_FileHeader.width = frameSize.width;
+	m_FileHeader.height = frameSize.height;
+	m_FileHeader.rowStride = rowStride;
+	m_FileHeader.frameSize = rowStride * frameSize.height;
+	m_FileHeader.frameStride = RawFrameLayout::alignToPage(m_FileHeader.frameSize);
+	m_FileHeader.framesPerSecond = framesPerSecond;
+
+	m_FrameIndex.clear();
+	m_Padding.assign(m_FileHeader.frameStride - m_FileHeader.frameSize, 0);
+
+	// The header takes the first page, the first frame starts on the second one
+	std::vector<char> headerPage(RawFrameLayout::pageSize, 0);
+	std::memcpy(headerPage.data(), &m_FileHeader, sizeof(m_FileHeader));
+	m_File.write(headerPage.data(), headerPage.size());
+
+	return static_cast<bool>(m_File);
+}
+
+void RawFrameWriter::release()
+{
+	if (!m_File.is_open())
+		return;
+
+	m_FileHeader.frameCount = m_FrameIndex.size();
+	m_FileHeader.indexOffset = RawFrameLayout::pageSize + m_FileHeader.frameCount * m_FileHeader.frameStride;
+
+	m_File.write(reinterpret_cast<const char*>(m_FrameIndex.data()), m_FrameIndex.size() * sizeof(RawFrameLayout::FrameIndexEntry));
+
+	m_File.seekp(0);
+	m_File.write(reinterpret_cast<const char*>(&m_FileHeader), sizeof(m_FileHeader));
+
+	m_File.close();
+	m_FrameIndex.clear();
+}
+
+bool RawFrameWriter::isOpened() const
+{
+	return m_File.is_open();
+}
+
+size_t RawFrameWriter::write(const cv::Mat& frame, uint64_t timestampNanoseconds)
+{
+	if (frame.cols != m_FileHeader.width || frame.rows != m_FileHeader.height || frame.type() != m_FileHeader.type)
+		return 0;
+
+	const uint64_t offset = RawFrameLayout::pageSize + m_FrameIndex.size() * m_FileHeader.frameStride;
+
+	if (frame.isContinuous())
+	{
+		m_File.write(reinterpret_cast<const char*>(frame.data), m_FileHeader.frameSize);
+	}
+	else
+	{
+		for (int y = 0; y < frame.rows; y++)
+		{
+			m_File.write(reinterpret_cast<const char*>(frame.ptr(y)), m_FileHeader.rowStride);
+		}
+	}
+
+	m_File.write(m_Padding.data(), m_Padding.size());
+
+	if (!m_File)
+		return 0;
+
+	m_FrameIndex.push_back({ offset, timestampNanoseconds });
+
+	return m_FileHeader.frameSize;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "RawFrameLayout.h"
+
+
+// Writes frames unchanged into a RawFrameLayout container, replayed by RawFrameFileSource without decoding.
+// The index and the frame count are written on release, a file that was not released still has its frames.
+class RawFrameWriter
+{
+public:
+	RawFrameWriter();
+	~RawFrameWriter();
+
+	bool open(const std::string& path, const cv::Size& frameSize, int frameType, double framesPerSecond);
+	void release();
+	bool isOpened() const;
+
+	// Returns the bytes written, 0 when the frame does not match the file
+	size_t write(const cv::Mat& frame, uint64_t timestampNanoseconds);
+
+private:
+	std::ofstream m_File;
+
+	RawFrameLayout::FileHeader m_FileHeader;
+	std::vector<RawFrameLayout::FrameIndexEntry> m_FrameIndex;
+
+	// Zeros up to the next page boundary after a frame
+	std::vector<char> m_Padding;
+};
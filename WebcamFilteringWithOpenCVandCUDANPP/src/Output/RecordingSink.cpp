@@ -0,0 +1,282 @@
+#include "RecordingSink.h"
+
+#include <iostream>
+
+#include <opencv4/opencv2/imgproc.hpp>
+
+#include "Metrics/PipelineMetrics.h"
+
+
+RecordingSink::RecordingSink(const std::string& path, RecordingFormatEnum format, double framesPerSecond, size_t maxQueuedFrames) :
+	m_Path(path),
+	m_Format(format),
+	m_FramesPerSecond(framesPerSecond),
+	m_MaxQueuedFrames(maxQueuedFrames),
+	m_WriterOpened(false),
+	m_FrameType(-1),
+	m_OtherTypeReported(false),
+	m_Stopped(false),
+	m_MemoryAccount("recording"),
+	m_WrittenFramesCount(0),
+	m_DroppedFramesCount(0),
+	m_WrittenBytesCount(0),
+	m_WritingMicroseconds(0),
+	m_DroppedFramesMetric(PipelineMetrics::getSinkDroppedFrames("recording")),
+	m_MetricsCollector([this]() { collectMetrics(); })
+{
+	m_WriterThread = std::jthread([this](std::stop_token stopToken) { writerThread(stopToken); });
+}
+
+RecordingSink::~RecordingSink()
+{
+	stop();
+}
+
+// Only the capture thread pushes, the queue can only shrink while the frame is copied
+void RecordingSink::pushFrame(const cv::Mat& frame)
+{
+	if (frame.empty())
+		return;
+
+	QueuedFrame queuedFrame;
+	queuedFrame.pushTime = std::chrono::steady_clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+
+		if (m_Stopped || m_QueuedFrames.size() >= m_MaxQueuedFrames)
+		{
+			m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+			m_DroppedFramesMetric.add();
+			return;
+		}
+
+		if (!m_FreeFrames.empty())
+		{
+			queuedFrame.frame = std::move(m_FreeFrames.back());
+			m_FreeFrames.pop_back();
+		}
+	}
+
+	size_t bufferBytes = MemoryBudget::getBytes(queuedFrame.frame);
+	size_t frameBytes = frame.total() * frame.elemSize();
+
+	if (frameBytes > bufferBytes && !m_MemoryAccount.request(frameBytes - bufferBytes))
+	{
+		m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+		m_DroppedFramesMetric.add();
+
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		if (queuedFrame.frame.empty() == false)
+			m_FreeFrames.push_back(std::move(queuedFrame.frame));
+
+		return;
+	}
+
+	frame.copyTo(queuedFrame.frame);
+	m_MemoryAccount.setBytes(m_MemoryAccount.getBytes() - bufferBytes + MemoryBudget::getBytes(queuedFrame.frame));
+
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		m_QueuedFrames.push_back(std::move(queuedFrame));
+	}
+
+	m_QueueCondition.notify_one();
+}
+
+void RecordingSink::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		m_Stopped = true;
+	}
+
+	if (m_WriterThread.joinable())
+	{
+		m_WriterThread.request_stop();
+		m_WriterThread.join();
+	}
+}
+
+RecordingStats RecordingSink::getStats() const
+{
+	RecordingStats recordingStats;
+
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		recordingStats.queuedFramesCount = m_QueuedFrames.size();
+	}
+
+	recordingStats.maxQueuedFramesCount = m_MaxQueuedFrames;
+	recordingStats.writtenFramesCount = m_WrittenFramesCount.load(std::memory_order_relaxed);
+	recordingStats.droppedFramesCount = m_DroppedFramesCount.load(std::memory_order_relaxed);
+
+	double writingSeconds = m_WritingMicroseconds.load(std::memory_order_relaxed) / 1e6;
+	double writtenMegabytes = m_WrittenBytesCount.load(std::memory_order_relaxed) / (1024.0 * 1024.0);
+
+	recordingStats.writeFramesPerSecond = writingSeconds > 0.0 ? recordingStats.writtenFramesCount / writingSeconds : 0.0;
+	recordingStats.writeMegabytesPerSecond = writingSeconds > 0.0 ? writtenMegabytes / writingSeconds : 0.0;
+
+	return recordingStats;
+}
+
+const std::string& RecordingSink::getPath() const
+{
+	return m_Path;
+}
+
+RecordingFormatEnum RecordingSink::getFormatOfPath(const std::string& path)
+{
+	auto hasExtension = [&path](const std::string& extension)
+	{
+		return path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+	};
+
+	if (hasExtension(".y4m"))
+		return RecordingFormatEnum::Y4m;
+
+	if (hasExtension(".rawframes"))
+		return RecordingFormatEnum::RawFrames;
+
+	return RecordingFormatEnum::Video;
+}
+
+// Keeps writing after a stop request until the queue is empty
+void RecordingSink::writerThread(std::stop_token stopToken)
+{
+	while (true)
+	{
+		QueuedFrame queuedFrame;
+
+		{
+			std::unique_lock<std::mutex> lock(m_QueueMutex);
+			m_QueueCondition.wait(lock, stopToken, [this]() { return m_QueuedFrames.empty() == false; });
+
+			if (m_QueuedFrames.empty())
+				break;
+
+			queuedFrame = std::move(m_QueuedFrames.front());
+			m_QueuedFrames.pop_front();
+		}
+
+		auto writeStartTime = std::chrono::steady_clock::now();
+
+		size_t writtenBytes = writeFrame(queuedFrame);
+
+		auto writeTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - writeStartTime);
+		m_WritingMicroseconds.fetch_add(writeTime.count(), std::memory_order_relaxed);
+
+		if (writtenBytes != 0)
+		{
+			m_WrittenFramesCount.fetch_add(1, std::memory_order_relaxed);
+			m_WrittenBytesCount.fetch_add(writtenBytes, std::memory_order_relaxed);
+		}
+		else
+		{
+			m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+			m_DroppedFramesMetric.add();
+		}
+
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		m_FreeFrames.push_back(std::move(queuedFrame.frame));
+	}
+
+	closeWriter();
+}
+
+// The file is opened with the first frame, its size and type are fixed from then on
+bool RecordingSink::openWriter(const cv::Mat& frame)
+{
+	m_FrameSize = frame.size();
+	m_FrameType = frame.type();
+
+	if (m_Format == RecordingFormatEnum::Y4m)
+	{
+		m_WriterOpened = m_Y4mWriter.open(m_Path, m_FrameSize, m_FrameType, m_FramesPerSecond);
+	}
+	else if (m_Format == RecordingFormatEnum::RawFrames)
+	{
+		m_WriterOpened = m_RawFrameWriter.open(m_Path, m_FrameSize, m_FrameType, m_FramesPerSecond);
+	}
+	else
+	{
+		m_WriterOpened = m_VideoWriter.open(m_Path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), m_FramesPerSecond,
+											m_FrameSize, frame.channels() == 3);
+	}
+
+	if (!m_WriterOpened)
+		std::cout << "Error: Could not open recording " << m_Path << "\n";
+
+	return m_WriterOpened;
+}
+
+// Returns the frame bytes written, 0 when the frame was not written
+size_t RecordingSink::writeFrame(const QueuedFrame& queuedFrame)
+{
+	if (m_FrameType == -1)
+	{
+		m_FirstPushTime = queuedFrame.pushTime;
+
+		if (!openWriter(queuedFrame.frame))
+			return 0;
+	}
+
+	if (!m_WriterOpened)
+		return 0;
+
+	// Counted as dropped, an output does not change its type
+	if (queuedFrame.frame.type() != m_FrameType)
+	{
+		if (!m_OtherTypeReported)
+			std::cout << "Error: Recording " << m_Path << " drops frames of another type than the first one\n";
+
+		m_OtherTypeReported = true;
+		return 0;
+	}
+
+	// Outputs may be resized while recording, e.g. by the ROI or the combined tiles, the file keeps its first size
+	const cv::Mat* frame = &queuedFrame.frame;
+
+	if (frame->size() != m_FrameSize)
+	{
+		if (frame->size() != m_ScaledFromSize)
+		{
+			std::cout << "Recording " << m_Path << ": frames of " << frame->cols << "x" << frame->rows << " are scaled to "
+				<< m_FrameSize.width << "x" << m_FrameSize.height << "\n";
+			m_ScaledFromSize = frame->size();
+		}
+
+		cv::resize(*frame, m_ScaledFrame, m_FrameSize, 0.0, 0.0, cv::INTER_LINEAR);
+		frame = &m_ScaledFrame;
+	}
+
+	if (m_Format == RecordingFormatEnum::Y4m)
+		return m_Y4mWriter.write(*frame);
+
+	if (m_Format == RecordingFormatEnum::RawFrames)
+	{
+		auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(queuedFrame.pushTime - m_FirstPushTime);
+		return m_RawFrameWriter.write(*frame, static_cast<uint64_t>(timestamp.count()));
+	}
+
+	m_VideoWriter.write(*frame);
+
+	return frame->total() * frame->elemSize();
+}
+
+void RecordingSink::closeWriter()
+{
+	m_Y4mWriter.release();
+	m_RawFrameWriter.release();
+	m_VideoWriter.release();
+
+	m_WriterOpened = false;
+}
+
+void RecordingSink::collectMetrics() const
+{
+	std::lock_guard<std::mutex> lock(m_QueueMutex);
+
+	MetricsRegistry::getInstance().getGauge("webcam_sink_queued_frames", "Frames waiting in a sink's queue", { { "sink", "recording" } })
+		.set(static_cast<double>(m_QueuedFrames.size()));
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv4/opencv2/videoio.hpp>
+
+#include "FrameSink.h"
+#include "Frames/MemoryBudget.h"
+#include "Metrics/MetricsRegistry.h"
+#include "RawFrameWriter.h"
+#include "Y4mWriter.h"
+
+
+enum class RecordingFormatEnum
+{
+	// Motion JPEG through cv::VideoWriter
+	Video,
+	// Uncompressed YUV4MPEG2
+	Y4m,
+	// Frames as they are, page aligned with their timestamps, for RawFrameFileSource
+	RawFrames
+};
+
+struct RecordingStats
+{
+	size_t queuedFramesCount;
+	size_t maxQueuedFramesCount;
+
+	uint64_t writtenFramesCount;
+	uint64_t droppedFramesCount;
+
+	// Throughput of the writer thread over the time it spent writing
+	double writeFramesPerSecond;
+	double writeMegabytesPerSecond;
+};
+
+// Copies pushed frames into a bounded queue and writes them to a file on its own thread.
+// The file keeps the size of the first frame, later frames of another size are scaled to it.
+// A full queue drops the frame instead of waiting, the capture loop never blocks on the disk.
+// So does a new queue buffer the memory budget does not allow.
+class RecordingSink :
+	public FrameSink
+{
+public:
+	RecordingSink(const std::string& path, RecordingFormatEnum format, double framesPerSecond, size_t maxQueuedFrames = 8);
+	~RecordingSink() override;
+
+	void pushFrame(const cv::Mat& frame) override;
+
+	// Writes the frames still queued and closes the file, later frames are dropped
+	void stop();
+
+	RecordingStats getStats() const;
+	const std::string& getPath() const;
+
+	// By the extension: ".y4m", ".rawframes", anything else is a video
+	static RecordingFormatEnum getFormatOfPath(const std::string& path);
+
+private:
+	struct QueuedFrame
+	{
+		cv::Mat frame;
+		std::chrono::steady_clock::time_point pushTime;
+	};
+
+	void writerThread(std::stop_token stopToken);
+
+	bool openWriter(const cv::Mat& frame);
+	size_t writeFrame(const QueuedFrame& queuedFrame);
+	void closeWriter();
+
+	void collectMetrics() const;
+
+	std::string m_Path;
+	RecordingFormatEnum m_Format;
+	double m_FramesPerSecond;
+	size_t m_MaxQueuedFrames;
+
+	cv::VideoWriter m_VideoWriter;
+	Y4mWriter m_Y4mWriter;
+	RawFrameWriter m_RawFrameWriter;
+	bool m_WriterOpened;
+	std::chrono::steady_clock::time_point m_FirstPushTime;
+	cv::Size m_FrameSize;
+	int m_FrameType;
+	// Frames of another size are scaled to the first one, only touched on the writer thread
+	cv::Mat m_ScaledFrame;
+	cv::Size m_ScaledFromSize;
+	bool m_OtherTypeReported;
+
+	mutable std::mutex m_QueueMutex;
+	std::condition_variable_any m_QueueCondition;
+	std::deque<QueuedFrame> m_QueuedFrames;
+	// Written frames are kept to reuse their buffers
+	std::vector<cv::Mat> m_FreeFrames;
+	bool m_Stopped;
+	// Every queue buffer, queued, being written or free. Only the capture thread allocates them.
+	MemoryAccount m_MemoryAccount;
+
+	std::atomic<uint64_t> m_WrittenFramesCount;
+	std::atomic<uint64_t> m_DroppedFramesCount;
+	std::atomic<uint64_t> m_WrittenBytesCount;
+	std::atomic<uint64_t> m_WritingMicroseconds;
+	MetricsCounter& m_DroppedFramesMetric;
+
+	std::jthread m_WriterThread;
+
+	// Declared last, so it is unregistered before the queue goes away
+	MetricsCollector m_MetricsCollector;
+};
@@ -0,0 +1,172 @@
+#include "ReplayBufferSink.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <opencv4/opencv2/imgcodecs.hpp>
+
+#include "Metrics/PipelineMetrics.h"
+#include "Threading/WorkerPool.h"
+
+
+ReplayBufferSink::ReplayBufferSink(WorkerPool& workerPool, double bufferSeconds, size_t maxBufferedBytes, int jpegQuality) :
+	m_WorkerPool(workerPool),
+	m_BufferDuration(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(bufferSeconds))),
+	m_MaxBufferedBytes(maxBufferedBytes),
+	m_JpegQuality(jpegQuality),
+	m_MaxEncodingFrames(workerPool.getThreadCount()),
+	m_BufferedBytes(0),
+	m_MemoryAccount("replay"),
+	m_DroppedFramesCount(0),
+	m_DumpsCount(0),
+	m_DroppedFramesMetric(PipelineMetrics::getSinkDroppedFrames("replay")),
+	m_DumpInProgress(false)
+{
+}
+
+ReplayBufferSink::~ReplayBufferSink()
+{
+	// Encode tasks own their frame copies, only the dump thread has to finish
+	std::lock_guard<std::mutex> lock(m_DumpThreadMutex);
+
+	if (m_DumpThread.joinable())
+		m_DumpThread.join();
+}
+
+void ReplayBufferSink::pushFrame(const cv::Mat& frame)
+{
+	if (frame.empty())
+		return;
+
+	collectEncodedFrames();
+
+	// Encoding that cannot keep up loses frames instead of holding the capture loop
+	if (m_EncodingFrames.size() >= m_MaxEncodingFrames)
+	{
+		m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+		m_DroppedFramesMetric.add();
+		return;
+	}
+
+	cv::Mat frameCopy = frame.clone();
+	int jpegQuality = m_JpegQuality;
+
+	std::future<EncodedJpeg> jpeg = m_WorkerPool.submit([frameCopy, jpegQuality]() -> EncodedJpeg
+	{
+		auto encodedJpeg = std::make_shared<std::vector<uchar>>();
+		if (!cv::imencode(".jpg", frameCopy, *encodedJpeg, { cv::IMWRITE_JPEG_QUALITY, jpegQuality }))
+			return nullptr;
+
+		return encodedJpeg;
+	});
+
+	m_EncodingFrames.push_back({ Clock::now(), std::move(jpeg) });
+}
+
+void ReplayBufferSink::collectEncodedFrames()
+{
+	std::lock_guard<std::mutex> lock(m_BufferMutex);
+
+	while (m_EncodingFrames.empty() == false &&
+		   m_EncodingFrames.front().jpeg.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		EncodingFrame& encodingFrame = m_EncodingFrames.front();
+		EncodedJpeg jpeg = encodingFrame.jpeg.get();
+
+		if (jpeg != nullptr)
+		{
+			m_BufferedBytes += jpeg->size();
+			m_BufferedFrames.push_back({ encodingFrame.pushTime, std::move(jpeg) });
+		}
+		else
+		{
+			m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+			m_DroppedFramesMetric.add();
+		}
+
+		m_EncodingFrames.pop_front();
+	}
+
+	trimBuffer(Clock::now());
+}
+
+// Called with m_BufferMutex held
+void ReplayBufferSink::trimBuffer(Clock::time_point now)
+{
+	while (m_BufferedFrames.empty() == false &&
+		   (now - m_BufferedFrames.front().pushTime > m_BufferDuration || m_BufferedBytes > m_MaxBufferedBytes))
+	{
+		m_BufferedBytes -= m_BufferedFrames.front().jpeg->size();
+		m_BufferedFrames.pop_front();
+	}
+
+	m_MemoryAccount.setBytes(m_BufferedBytes);
+}
+
+bool ReplayBufferSink::dump(const std::string& path)
+{
+	if (m_DumpInProgress.exchange(true))
+		return false;
+
+	// The JPEGs are shared with the buffer, the snapshot only copies pointers
+	std::vector<BufferedFrame> frames;
+	{
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+		frames.assign(m_BufferedFrames.begin(), m_BufferedFrames.end());
+	}
+
+	// The previous dump may still be leaving its thread when the flag is already cleared
+	std::lock_guard<std::mutex> lock(m_DumpThreadMutex);
+
+	if (m_DumpThread.joinable())
+		m_DumpThread.join();
+
+	m_DumpThread = std::jthread([this, path, frames = std::move(frames)]()
+	{
+		writeDump(path, frames);
+
+		m_DumpsCount.fetch_add(1, std::memory_order_relaxed);
+		m_DumpInProgress = false;
+	});
+
+	return true;
+}
+
+void ReplayBufferSink::writeDump(const std::string& path, const std::vector<BufferedFrame>& frames)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	for (const auto& frame : frames)
+	{
+		file.write(reinterpret_cast<const char*>(frame.jpeg->data()), frame.jpeg->size());
+	}
+
+	if (!file)
+	{
+		std::cout << "Error: Could not write replay " << path << "\n";
+		return;
+	}
+
+	std::cout << "Replay of " << frames.size() << " frames written to " << path << "\n";
+}
+
+ReplayStats ReplayBufferSink::getStats() const
+{
+	ReplayStats replayStats;
+
+	{
+		std::lock_guard<std::mutex> lock(m_BufferMutex);
+
+		replayStats.bufferedFramesCount = m_BufferedFrames.size();
+		replayStats.bufferedBytes = m_BufferedBytes;
+		replayStats.bufferedSeconds = m_BufferedFrames.empty() ? 0.0 :
+			std::chrono::duration<double>(m_BufferedFrames.back().pushTime - m_BufferedFrames.front().pushTime).count();
+	}
+
+	replayStats.maxBufferedBytes = m_MaxBufferedBytes;
+	replayStats.droppedFramesCount = m_DroppedFramesCount.load(std::memory_order_relaxed);
+	replayStats.dumpsCount = m_DumpsCount.load(std::memory_order_relaxed);
+	replayStats.dumpInProgress = m_DumpInProgress.load();
+
+	return replayStats;
+}
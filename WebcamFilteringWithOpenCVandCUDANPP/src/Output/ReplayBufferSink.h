@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameSink.h"
+#include "Frames/MemoryBudget.h"
+#include "Metrics/MetricsRegistry.h"
+
+class WorkerPool;
+
+
+struct ReplayStats
+{
+	size_t bufferedFramesCount;
+	double bufferedSeconds;
+	size_t bufferedBytes;
+	size_t maxBufferedBytes;
+
+	uint64_t droppedFramesCount;
+	uint64_t dumpsCount;
+	bool dumpInProgress;
+};
+
+// Keeps the last seconds of an output as JPEG in memory, encoded on the worker pool.
+// A dump writes them as an MJPEG stream on its own thread, the stream can be replayed with --headless.
+class ReplayBufferSink :
+	public FrameSink
+{
+public:
+	ReplayBufferSink(WorkerPool& workerPool, double bufferSeconds = 10.0, size_t maxBufferedBytes = 256 * 1024 * 1024, int jpegQuality = 85);
+	~ReplayBufferSink() override;
+
+	void pushFrame(const cv::Mat& frame) override;
+
+	// Returns false while the previous dump is still being written
+	bool dump(const std::string& path);
+
+	ReplayStats getStats() const;
+
+private:
+	using EncodedJpeg = std::shared_ptr<const std::vector<uchar>>;
+	using Clock = std::chrono::steady_clock;
+
+	struct BufferedFrame
+	{
+		Clock::time_point pushTime;
+		EncodedJpeg jpeg;
+	};
+
+	struct EncodingFrame
+	{
+		Clock::time_point pushTime;
+		std::future<EncodedJpeg> jpeg;
+	};
+
+	void collectEncodedFrames();
+	void trimBuffer(Clock::time_point now);
+
+	void writeDump(const std::string& path, const std::vector<BufferedFrame>& frames);
+
+	WorkerPool& m_WorkerPool;
+
+	Clock::duration m_BufferDuration;
+	size_t m_MaxBufferedBytes;
+	int m_JpegQuality;
+
+	// Only touched on the capture thread, frames leave it in push order
+	std::deque<EncodingFrame> m_EncodingFrames;
+	size_t m_MaxEncodingFrames;
+
+	mutable std::mutex m_BufferMutex;
+	std::deque<BufferedFrame> m_BufferedFrames;
+	size_t m_BufferedBytes;
+	MemoryAccount m_MemoryAccount;
+
+	std::atomic<uint64_t> m_DroppedFramesCount;
+	std::atomic<uint64_t> m_DumpsCount;
+	MetricsCounter& m_DroppedFramesMetric;
+	std::atomic<bool> m_DumpInProgress;
+
+	std::mutex m_DumpThreadMutex;
+	std::jthread m_DumpThread;
+};
@@ -0,0 +1,124 @@
+#include "SharedMemorySink.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "Metrics/PipelineMetrics.h"
+
+
+SharedMemorySink::SharedMemorySink(const std::string& name, uint32_t slotCount) :
+	m_Name(name),
+	m_SlotCount(slotCount),
+	m_RingCreationFailed(false),
+	m_MemoryAccount("shared memory"),
+	m_RefusedRingBytes(0),
+	m_RefusedBudgetChangesCount(0),
+	m_PublishedFramesCount(0),
+	m_DroppedFramesCount(0),
+	m_DroppedFramesMetric(PipelineMetrics::getSinkDroppedFrames("shared-memory"))
+{
+}
+
+void SharedMemorySink::pushFrame(const cv::Mat& frame)
+{
+	SharedFrameRing::FrameFormatEnum frameFormat = SharedFrameRing::FrameFormatEnum::None;
+
+	if (frame.type() == CV_8UC1)
+		frameFormat = SharedFrameRing::FrameFormatEnum::Gray8;
+	else if (frame.type() == CV_8UC3)
+		frameFormat = SharedFrameRing::FrameFormatEnum::Bgr8;
+
+	if (frame.empty() || frameFormat == SharedFrameRing::FrameFormatEnum::None || m_RingCreationFailed)
+	{
+		m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+		m_DroppedFramesMetric.add();
+		return;
+	}
+
+	// The capacity is 0 before the first ring, slots only grow
+	if (frame.total() * frame.elemSize() > m_RingWriter.getSlotCapacity() && !openRing(frame))
+	{
+		m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+		m_DroppedFramesMetric.add();
+		return;
+	}
+
+	auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+
+	bool isPublished = m_RingWriter.publish(frame.data, frame.step, static_cast<uint32_t>(frame.cols), static_cast<uint32_t>(frame.rows),
+											static_cast<uint32_t>(frame.elemSize()), frameFormat, static_cast<uint64_t>(timestamp.count()));
+
+	if (isPublished)
+	{
+		m_PublishedFramesCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		m_DroppedFramesCount.fetch_add(1, std::memory_order_relaxed);
+		m_DroppedFramesMetric.add();
+	}
+}
+
+// The bytes of the current ring are accounted already, only the growth is asked for
+bool SharedMemorySink::openRing(const cv::Mat& frame)
+{
+	uint32_t slotCapacity = static_cast<uint32_t>(frame.total() * frame.elemSize());
+	size_t ringBytes = static_cast<size_t>(slotCapacity) * m_SlotCount;
+
+	if (!requestRingBytes(ringBytes - m_MemoryAccount.getBytes()))
+		return false;
+
+	bool isResize = m_RingWriter.isOpen();
+
+	if (!m_RingWriter.create(m_Name, m_SlotCount, slotCapacity))
+	{
+		std::cout << "Error: Could not create shared memory " << m_Name << "\n";
+		m_RingCreationFailed = true;
+		m_MemoryAccount.setBytes(0);
+		return false;
+	}
+
+	m_MemoryAccount.setBytes(ringBytes);
+
+	if (isResize)
+	{
+		std::cout << "Shared memory " << m_Name << " resized for " << frame.cols << "x" << frame.rows << " frames, layout "
+			<< m_RingWriter.getLayoutSequence() << "\n";
+	}
+
+	return true;
+}
+
+bool SharedMemorySink::requestRingBytes(size_t additionalBytes)
+{
+	uint64_t budgetChangesCount = MemoryBudget::getInstance().getChangesCount();
+
+	if (additionalBytes == m_RefusedRingBytes && budgetChangesCount == m_RefusedBudgetChangesCount)
+		return false;
+
+	if (m_MemoryAccount.request(additionalBytes))
+	{
+		m_RefusedRingBytes = 0;
+		return true;
+	}
+
+	m_RefusedRingBytes = additionalBytes;
+	m_RefusedBudgetChangesCount = budgetChangesCount;
+
+	return false;
+}
+
+const std::string& SharedMemorySink::getName() const
+{
+	return m_Name;
+}
+
+uint64_t SharedMemorySink::getPublishedFramesCount() const
+{
+	return m_PublishedFramesCount.load(std::memory_order_relaxed);
+}
+
+uint64_t SharedMemorySink::getDroppedFramesCount() const
+{
+	return m_DroppedFramesCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include <SharedFrameRing/SharedFrameRingWriter.h>
+
+#include "FrameSink.h"
+#include "Frames/MemoryBudget.h"
+#include "Metrics/MetricsRegistry.h"
+
+
+// Publishes an output into a shared-memory frame ring for other processes on the host.
+// The ring is created with the first frame and sized for it. A larger frame, e.g. after a tile is added to the combined
+// frame or the ROI crop is turned off, replaces it with larger slots under the same name, readers see the old one closed.
+// Frames are dropped while a ring of their size does not fit in the memory budget.
+// The frame is copied once, straight into the ring slot, readers use it in place.
+class SharedMemorySink :
+	public FrameSink
+{
+public:
+	explicit SharedMemorySink(const std::string& name, uint32_t slotCount = 4);
+
+	void pushFrame(const cv::Mat& frame) override;
+
+	const std::string& getName() const;
+	uint64_t getPublishedFramesCount() const;
+	uint64_t getDroppedFramesCount() const;
+
+private:
+	bool openRing(const cv::Mat& frame);
+	bool requestRingBytes(size_t additionalBytes);
+
+	std::string m_Name;
+	uint32_t m_SlotCount;
+
+	SharedFrameRing::SharedFrameRingWriter m_RingWriter;
+	bool m_RingCreationFailed;
+	MemoryAccount m_MemoryAccount;
+	// The last refusal, the same size is not asked again until the budget changes
+	size_t m_RefusedRingBytes;
+	uint64_t m_RefusedBudgetChangesCount;
+
+	std::atomic<uint64_t> m_PublishedFramesCount;
+	std::atomic<uint64_t> m_DroppedFramesCount;
+	MetricsCounter& m_DroppedFramesMetric;
+};
@@ -0,0 +1,108 @@
+#include "Y4mWriter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv4/opencv2/imgproc.hpp>
+
+
+Y4mWriter::Y4mWriter() :
+	m_FrameType(-1)
+{
+}
+
+bool Y4mWriter::open(const std::string& path, const cv::Size& frameSize, int frameType, double framesPerSecond)
+{
+	if (frameType != CV_8UC1 && frameType != CV_8UC3)
+		return false;
+
+	m_File.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_File)
+		return false;
+
+	m_FrameSize = frameSize;
+	m_FrameType = frameType;
+
+	// Frame rate as a fraction with millisecond precision
+	long frameRateNumerator = std::lround(framesPerSecond * 1000.0);
+
+	m_File << "YUV4MPEG2 W" << frameSize.width << " H" << frameSize.height
+		<< " F" << frameRateNumerator << ":1000 Ip A1:1 "
+		<< (frameType == CV_8UC1 ? "Cmono" : "C444") << "\n";
+
+	return static_cast<bool>(m_File);
+}
+
+void Y4mWriter::release()
+{
+	if (m_File.is_open())
+		m_File.close();
+}
+
+bool Y4mWriter::isOpened() const
+{
+	return m_File.is_open();
+}
+
+size_t Y4mWriter::write(const cv::Mat& frame)
+{
+	if (frame.size() != m_FrameSize || frame.type() != m_FrameType)
+		return 0;
+
+	packFrame(frame, m_Planes);
+
+	return writePacked(m_Planes);
+}
+
+size_t Y4mWriter::writePacked(const std::vector<uint8_t>& packedFrame)
+{
+	const size_t frameBytes = static_cast<size_t>(m_FrameSize.width) * m_FrameSize.height * (m_FrameType == CV_8UC1 ? 1 : 3);
+	if (packedFrame.size() != frameBytes)
+		return 0;
+
+	m_File << "FRAME\n";
+	m_File.write(reinterpret_cast<const char*>(packedFrame.data()), packedFrame.size());
+
+	return packedFrame.size();
+}
+
+void Y4mWriter::packFrame(const cv::Mat& frame, std::vector<uint8_t>& packedFrame)
+{
+	const int width = frame.cols;
+	const int height = frame.rows;
+	const size_t planeSize = static_cast<size_t>(width) * height;
+
+	if (frame.type() == CV_8UC1)
+	{
+		packedFrame.resize(planeSize);
+
+		for (int y = 0; y < height; y++)
+		{
+			std::copy_n(frame.ptr(y), width, packedFrame.data() + static_cast<size_t>(y) * width);
+		}
+
+		return;
+	}
+
+	cv::Mat yuvFrame;
+	cv::cvtColor(frame, yuvFrame, cv::COLOR_BGR2YUV);
+
+	// Interleaved YUV to Y, U and V planes
+	packedFrame.resize(planeSize * 3);
+
+	uint8_t* planeY = packedFrame.data();
+	uint8_t* planeU = planeY + planeSize;
+	uint8_t* planeV = planeU + planeSize;
+
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t* yuv = yuvFrame.ptr(y);
+
+		for (int x = 0; x < width; x++, yuv += 3)
+		{
+			*planeY++ = yuv[0];
+			*planeU++ = yuv[1];
+			*planeV++ = yuv[2];
+		}
+	}
+}
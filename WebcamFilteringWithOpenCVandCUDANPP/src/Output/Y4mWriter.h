@@ -0,0 +1,36 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+
+// Uncompressed YUV4MPEG2 stream. Gray frames are written as mono, lossless,
+// BGR frames as planar 4:4:4 YUV without chroma subsampling.
+class Y4mWriter
+{
+public:
+	Y4mWriter();
+
+	bool open(const std::string& path, const cv::Size& frameSize, int frameType, double framesPerSecond);
+	void release();
+	bool isOpened() const;
+
+	// Returns the bytes written, 0 when the frame does not match the stream
+	size_t write(const cv::Mat& frame);
+	// A frame packed by packFrame, so the conversion can run on other threads
+	size_t writePacked(const std::vector<uint8_t>& packedFrame);
+
+	// The planes of one frame as they are written, CV_8UC1 or CV_8UC3 frames only
+	static void packFrame(const cv::Mat& frame, std::vector<uint8_t>& packedFrame);
+
+private:
+	std::ofstream m_File;
+
+	cv::Size m_FrameSize;
+	int m_FrameType;
+
+	std::vector<uint8_t> m_Planes;
+};
@@ -0,0 +1,167 @@
+#include "DirtyTileDetector.h"
+
+#include <algorithm>
+
+#include "Simd/SimdSad.h"
+#include "Threading/WorkerPool.h"
+
+
+DirtyTileDetector::DirtyTileDetector(WorkerPool& workerPool, int tileSize, int meanDifferenceThreshold) :
+	m_WorkerPool(workerPool),
+	m_TileSize(tileSize),
+	m_MeanDifferenceThreshold(meanDifferenceThreshold),
+	m_TileColumns(0),
+	m_TileRows(0),
+	m_CheckedTilesCount(0),
+	m_SkippedTilesCount(0),
+	m_SkippedFramesCount(0)
+{
+}
+
+void DirtyTileDetector::reset()
+{
+	m_ReferenceFrame.release();
+}
+
+int DirtyTileDetector::detect(const cv::Mat& frame)
+{
+	if (m_ReferenceFrame.size() != frame.size() || m_ReferenceFrame.type() != frame.type())
+	{
+		m_TileColumns = (frame.cols + m_TileSize - 1) / m_TileSize;
+		m_TileRows = (frame.rows + m_TileSize - 1) / m_TileSize;
+		m_DirtyTiles.assign(static_cast<size_t>(m_TileColumns) * m_TileRows, 1);
+
+		frame.copyTo(m_ReferenceFrame);
+
+		m_CheckedTilesCount += m_DirtyTiles.size();
+
+		return getTilesCount();
+	}
+
+	const int pixelSize = static_cast<int>(frame.elemSize());
+	std::atomic<int> dirtyTilesCount = 0;
+
+	m_WorkerPool.parallelFor(0, m_TileRows, m_KernelTuning.stripsCount, [&](int tileRowBegin, int tileRowEnd)
+	{
+		int stripDirtyTilesCount = 0;
+
+		for (int tileRow = tileRowBegin; tileRow < tileRowEnd; tileRow++)
+		{
+			for (int tileColumn = 0; tileColumn < m_TileColumns; tileColumn++)
+			{
+				cv::Rect tileRect = getTileRect(tileColumn, tileRow);
+
+				int widthBytes = tileRect.width * pixelSize;
+				uint32_t sadLimit = static_cast<uint32_t>(widthBytes * tileRect.height * m_MeanDifferenceThreshold);
+
+				uint32_t sad = computeSadUntil(frame.ptr(tileRect.y) + tileRect.x * pixelSize, frame.step,
+											   m_ReferenceFrame.ptr(tileRect.y) + tileRect.x * pixelSize, m_ReferenceFrame.step,
+											   widthBytes, tileRect.height, sadLimit, m_KernelTuning.simdVariant);
+
+				bool isDirty = sad > sadLimit;
+				m_DirtyTiles[tileRow * m_TileColumns + tileColumn] = isDirty;
+
+				if (isDirty)
+				{
+					frame(tileRect).copyTo(m_ReferenceFrame(tileRect));
+					stripDirtyTilesCount++;
+				}
+			}
+		}
+
+		dirtyTilesCount += stripDirtyTilesCount;
+	});
+
+	m_CheckedTilesCount += m_DirtyTiles.size();
+	m_SkippedTilesCount += m_DirtyTiles.size() - dirtyTilesCount;
+
+	if (dirtyTilesCount == 0)
+		m_SkippedFramesCount++;
+
+	return dirtyTilesCount;
+}
+
+std::vector<cv::Rect> DirtyTileDetector::getDirtyRects(int halo) const
+{
+	std::vector<cv::Rect> dirtyRects;
+	cv::Rect frameRect(0, 0, m_ReferenceFrame.cols, m_ReferenceFrame.rows);
+
+	for (int tileRow = 0; tileRow < m_TileRows; tileRow++)
+	{
+		int tileColumn = 0;
+		while (tileColumn < m_TileColumns)
+		{
+			if (m_DirtyTiles[tileRow * m_TileColumns + tileColumn] == 0)
+			{
+				tileColumn++;
+				continue;
+			}
+
+			int runBegin = tileColumn;
+			while (tileColumn < m_TileColumns && m_DirtyTiles[tileRow * m_TileColumns + tileColumn] != 0)
+			{
+				tileColumn++;
+			}
+
+			cv::Rect runRect = getTileRect(runBegin, tileRow) | getTileRect(tileColumn - 1, tileRow);
+
+			// Runs spanning the same columns as a run on the previous tile row are merged vertically
+			auto sameColumns = std::find_if(dirtyRects.begin(), dirtyRects.end(), [&runRect](const cv::Rect& dirtyRect)
+			{
+				return dirtyRect.x == runRect.x && dirtyRect.width == runRect.width && dirtyRect.y + dirtyRect.height == runRect.y;
+			});
+
+			if (sameColumns != dirtyRects.end())
+				sameColumns->height += runRect.height;
+			else
+				dirtyRects.push_back(runRect);
+		}
+	}
+
+	if (halo > 0)
+	{
+		for (auto& dirtyRect : dirtyRects)
+		{
+			dirtyRect = cv::Rect(dirtyRect.x - halo, dirtyRect.y - halo, dirtyRect.width + 2 * halo, dirtyRect.height + 2 * halo) & frameRect;
+		}
+	}
+
+	return dirtyRects;
+}
+
+void DirtyTileDetector::setKernelTuning(const KernelTuning& kernelTuning)
+{
+	m_KernelTuning = kernelTuning;
+}
+
+int DirtyTileDetector::getTileSize() const
+{
+	return m_TileSize;
+}
+
+int DirtyTileDetector::getTilesCount() const
+{
+	return m_TileColumns * m_TileRows;
+}
+
+double DirtyTileDetector::getTileSkipRatio() const
+{
+	uint64_t checkedTilesCount = m_CheckedTilesCount.load();
+
+	return checkedTilesCount == 0 ? 0.0 : static_cast<double>(m_SkippedTilesCount.load()) / checkedTilesCount;
+}
+
+uint64_t DirtyTileDetector::getSkippedFramesCount() const
+{
+	return m_SkippedFramesCount.load();
+}
+
+cv::Rect DirtyTileDetector::getTileRect(int tileColumn, int tileRow) const
+{
+	int x = tileColumn * m_TileSize;
+	int y = tileRow * m_TileSize;
+
+	return cv::Rect(x, y,
+					std::min(m_TileSize, m_ReferenceFrame.cols - x),
+					std::min(m_TileSize, m_ReferenceFrame.rows - y));
+}
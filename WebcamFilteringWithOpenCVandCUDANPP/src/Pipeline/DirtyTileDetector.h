@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "Tuning/KernelTuning.h"
+
+class WorkerPool;
+
+
+// Compares each tile of a frame with the last content committed for that tile.
+// Only tiles whose mean absolute difference goes above the threshold are marked dirty,
+// so slow drift accumulates until it becomes visible instead of being lost.
+class DirtyTileDetector
+{
+public:
+	DirtyTileDetector(WorkerPool& workerPool, int tileSize = 32, int meanDifferenceThreshold = 3);
+
+	void reset();
+
+	// Returns the number of dirty tiles, every tile is dirty for the first frame
+	int detect(const cv::Mat& frame);
+
+	// Dirty tiles merged into rectangles, grown by halo pixels and clipped to the frame
+	std::vector<cv::Rect> getDirtyRects(int halo = 0) const;
+
+	// Not thread safe, set it between frames
+	void setKernelTuning(const KernelTuning& kernelTuning);
+
+	int getTileSize() const;
+	int getTilesCount() const;
+
+	// Share of tiles that did not need recomputing since the start
+	double getTileSkipRatio() const;
+	uint64_t getSkippedFramesCount() const;
+
+private:
+	cv::Rect getTileRect(int tileColumn, int tileRow) const;
+
+	WorkerPool& m_WorkerPool;
+
+	int m_TileSize;
+	int m_MeanDifferenceThreshold;
+	KernelTuning m_KernelTuning;
+
+	cv::Mat m_ReferenceFrame;
+
+	int m_TileColumns;
+	int m_TileRows;
+	std::vector<uint8_t> m_DirtyTiles;
+
+	std::atomic<uint64_t> m_CheckedTilesCount;
+	std::atomic<uint64_t> m_SkippedTilesCount;
+	std::atomic<uint64_t> m_SkippedFramesCount;
+};
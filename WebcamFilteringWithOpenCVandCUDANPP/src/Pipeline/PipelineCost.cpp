@@ -0,0 +1,179 @@
+#include "PipelineCost.h"
+
+#include "Filters/FilterTraits.h"
+
+
+namespace
+{
+	size_t getLumaBytes(const cv::Size& frameSize)
+	{
+		return static_cast<size_t>(frameSize.area());
+	}
+
+	size_t getFrameBytes(const cv::Size& frameSize, int frameType)
+	{
+		return getLumaBytes(frameSize) * CV_ELEM_SIZE(frameType);
+	}
+
+	size_t getOutputBytes(FilterTypeEnum filterType, const cv::Size& frameSize)
+	{
+		return getLumaBytes(frameSize) * getFilterTraits(filterType).outputChannels;
+	}
+
+	// What the stage of the filter allocates, as listed in its traits
+	std::vector<PlannedBuffer> getStageBuffers(FilterTypeEnum filterType, const cv::Size& frameSize)
+	{
+		std::vector<PlannedBuffer> buffers;
+
+		for (const FilterBufferTraits& stageBuffer : getFilterTraits(filterType).stageBuffers)
+		{
+			buffers.push_back({ stageBuffer.name, stageBuffer.device ? BufferLocationEnum::Device : BufferLocationEnum::Host,
+								getLumaBytes(frameSize) * stageBuffer.bytesPerPixel });
+		}
+
+		return buffers;
+	}
+}
+
+
+size_t FrameTraffic::getTotalBytes() const
+{
+	return uploadBytes + downloadBytes + deviceBytes + hostBytes;
+}
+
+FrameTraffic& FrameTraffic::operator+=(const FrameTraffic& frameTraffic)
+{
+	uploadBytes += frameTraffic.uploadBytes;
+	downloadBytes += frameTraffic.downloadBytes;
+	deviceBytes += frameTraffic.deviceBytes;
+	hostBytes += frameTraffic.hostBytes;
+
+	return *this;
+}
+
+namespace PipelineCost
+{
+	std::vector<PlannedBuffer> getCaptureBuffers(const cv::Size& frameSize, int frameType)
+	{
+		size_t lumaBytes = getLumaBytes(frameSize);
+		size_t frameBytes = getFrameBytes(frameSize, frameType);
+
+		return {
+			{ "upload", BufferLocationEnum::Device, frameBytes },
+			{ "YUV planes", BufferLocationEnum::Device, lumaBytes * 3 / 2 }
+		};
+	}
+
+	PlannedBuffer getCpuLumaBuffer(const cv::Size& frameSize)
+	{
+		return { "downloaded luma", BufferLocationEnum::Host, getLumaBytes(frameSize) };
+	}
+
+	std::vector<PlannedBuffer> getOutputBuffers(FilterTypeEnum filterType, const cv::Size& frameSize, bool onCombined, bool viewTextures)
+	{
+		const FilterTraits& filterTraits = getFilterTraits(filterType);
+		size_t outputBytes = getOutputBytes(filterType, frameSize);
+
+		std::vector<PlannedBuffer> buffers = getStageBuffers(filterType, frameSize);
+
+		buffers.push_back({ "output", BufferLocationEnum::Host, outputBytes });
+
+		if (onCombined && filterTraits.cpuLuma)
+			buffers.push_back({ "combined upload", BufferLocationEnum::Device, outputBytes });
+
+		// Color textures are stored as RGBA
+		if (viewTextures)
+			buffers.push_back({ "view texture", BufferLocationEnum::Device, filterTraits.outputChannels == 1 ? getLumaBytes(frameSize) : getLumaBytes(frameSize) * 4 });
+
+		return buffers;
+	}
+
+	std::vector<PlannedBuffer> getCombinedBuffers(const cv::Size& frameSize, int frameType, int tilesCount, bool viewTextures)
+	{
+		size_t tilesBytes = getFrameBytes(frameSize, frameType) * tilesCount;
+
+		std::vector<PlannedBuffer> buffers = {
+			{ "combined frame", BufferLocationEnum::Device, tilesBytes },
+			{ "output", BufferLocationEnum::Host, tilesBytes }
+		};
+
+		if (viewTextures)
+			buffers.push_back({ "view texture", BufferLocationEnum::Device, getLumaBytes(frameSize) * 4 * tilesCount });
+
+		return buffers;
+	}
+
+	FrameTraffic getCaptureTraffic(const cv::Size& frameSize, int frameType, bool decoded)
+	{
+		FrameTraffic frameTraffic;
+		frameTraffic.hostBytes = decoded ? getFrameBytes(frameSize, frameType) : 0;
+		frameTraffic.uploadBytes = getFrameBytes(frameSize, frameType);
+		frameTraffic.deviceBytes = getLumaBytes(frameSize) * 3 / 2;
+
+		return frameTraffic;
+	}
+
+	FrameTraffic getCpuLumaTraffic(const cv::Size& frameSize)
+	{
+		FrameTraffic frameTraffic;
+		frameTraffic.downloadBytes = getLumaBytes(frameSize);
+
+		return frameTraffic;
+	}
+
+	// The output is copied once more for the view, or for the thread presenting a run without one
+	FrameTraffic getOutputTraffic(FilterTypeEnum filterType, const cv::Size& frameSize, bool onCombined, bool viewTextures)
+	{
+		size_t outputBytes = getOutputBytes(filterType, frameSize);
+		size_t stageBytes = getTotalBytes(getStageBuffers(filterType, frameSize));
+
+		FrameTraffic frameTraffic;
+		frameTraffic.hostBytes = outputBytes;
+
+		if (viewTextures)
+			frameTraffic.uploadBytes += outputBytes;
+
+		// GPU outputs are written by kernels into the stage's buffers and downloaded
+		if (!getFilterTraits(filterType).cpuLuma)
+		{
+			frameTraffic.deviceBytes += stageBytes;
+			frameTraffic.downloadBytes += outputBytes;
+			return frameTraffic;
+		}
+
+		// CPU outputs are written with their history and copied out
+		frameTraffic.hostBytes += stageBytes + outputBytes;
+
+		if (onCombined)
+			frameTraffic.uploadBytes += outputBytes;
+
+		return frameTraffic;
+	}
+
+	FrameTraffic getCombinedTraffic(const cv::Size& frameSize, int frameType, int tilesCount, bool viewTextures)
+	{
+		size_t tilesBytes = getFrameBytes(frameSize, frameType) * tilesCount;
+
+		FrameTraffic frameTraffic;
+		frameTraffic.deviceBytes = tilesBytes;
+		frameTraffic.downloadBytes = tilesBytes;
+		frameTraffic.hostBytes = tilesBytes;
+
+		if (viewTextures)
+			frameTraffic.uploadBytes = tilesBytes;
+
+		return frameTraffic;
+	}
+
+	size_t getTotalBytes(const std::vector<PlannedBuffer>& buffers)
+	{
+		size_t totalBytes = 0;
+
+		for (const PlannedBuffer& buffer : buffers)
+		{
+			totalBytes += buffer.bytes;
+		}
+
+		return totalBytes;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "Filters/FilterTypes.h"
+
+
+enum class BufferLocationEnum
+{
+	Host,
+	// GPU memory, the view's textures included
+	Device
+};
+
+struct PlannedBuffer
+{
+	std::string name;
+	BufferLocationEnum location;
+	size_t bytes;
+};
+
+// Bytes a frame moves
+struct FrameTraffic
+{
+	size_t uploadBytes = 0;
+	size_t downloadBytes = 0;
+	// Written by kernels into GPU memory
+	size_t deviceBytes = 0;
+	// Written by the CPU: decoding, CPU filters and the copies handed to the view
+	size_t hostBytes = 0;
+
+	size_t getTotalBytes() const;
+	FrameTraffic& operator+=(const FrameTraffic& frameTraffic);
+};
+
+// Buffers the pipeline allocates and bytes it moves at a frame size, for the session plan and the memory budget's estimates.
+// Traffic is that of a frame whose tiles all changed, an unchanged tile moves nothing.
+// The view's textures are counted with the output they show, a run without a view has none.
+namespace PipelineCost
+{
+	// The upload and the YUV planes, allocated with the first output
+	std::vector<PlannedBuffer> getCaptureBuffers(const cv::Size& frameSize, int frameType);
+	// The luma plane downloaded once for all CPU filters
+	PlannedBuffer getCpuLumaBuffer(const cv::Size& frameSize);
+	// The buffers of the filter's stage, as listed in its traits, and the output handed to the view.
+	// A CPU output tiled in the combined frame is uploaded again.
+	std::vector<PlannedBuffer> getOutputBuffers(FilterTypeEnum filterType, const cv::Size& frameSize, bool onCombined, bool viewTextures);
+	std::vector<PlannedBuffer> getCombinedBuffers(const cv::Size& frameSize, int frameType, int tilesCount, bool viewTextures);
+
+	// Raw frames are mapped, not decoded
+	FrameTraffic getCaptureTraffic(const cv::Size& frameSize, int frameType, bool decoded);
+	FrameTraffic getCpuLumaTraffic(const cv::Size& frameSize);
+	FrameTraffic getOutputTraffic(FilterTypeEnum filterType, const cv::Size& frameSize, bool onCombined, bool viewTextures);
+	FrameTraffic getCombinedTraffic(const cv::Size& frameSize, int frameType, int tilesCount, bool viewTextures);
+
+	size_t getTotalBytes(const std::vector<PlannedBuffer>& buffers);
+}
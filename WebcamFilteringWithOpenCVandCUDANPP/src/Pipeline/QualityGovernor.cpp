@@ -0,0 +1,186 @@
+#include "QualityGovernor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+
+namespace
+{
+	constexpr double overloadRatio = 0.9;
+	constexpr double headroomRatio = 0.6;
+
+	// Frames for the smoothed load to reflect a new level before it is judged again
+	constexpr int settleFramesCount = 30;
+	constexpr int minStepUpHoldFramesCount = 120;
+	constexpr int maxStepUpHoldFramesCount = 1920;
+}
+
+
+QualityGovernor::QualityGovernor(std::string name) :
+	m_Name(std::move(name)),
+	m_Ladder(getDefaultLadder()),
+	m_FramesSinceTransition(0),
+	m_StepUpHoldFramesCount(minStepUpHoldFramesCount),
+	m_LastTransitionWasStepUp(false),
+	m_Enabled(false),
+	m_Level(0),
+	m_LevelsCount(static_cast<int>(m_Ladder.size()) + 1),
+	m_LoadRatio(0.0),
+	m_TransitionsCount(0)
+{
+}
+
+// Cheapest loss of quality first, the combined view is the last thing to freeze
+std::vector<QualityStepEnum> QualityGovernor::getDefaultLadder()
+{
+	return { QualityStepEnum::HalveCpuFilterRate, QualityStepEnum::HalveResolution, QualityStepEnum::PauseCombinedRefresh };
+}
+
+bool QualityGovernor::parseLadder(const std::string& ladderString, std::vector<QualityStepEnum>& ladder)
+{
+	ladder.clear();
+
+	std::stringstream ladderStream(ladderString);
+	std::string stepName;
+
+	while (std::getline(ladderStream, stepName, ','))
+	{
+		if (stepName == "cpu-filters")
+			ladder.push_back(QualityStepEnum::HalveCpuFilterRate);
+		else if (stepName == "resolution")
+			ladder.push_back(QualityStepEnum::HalveResolution);
+		else if (stepName == "combined")
+			ladder.push_back(QualityStepEnum::PauseCombinedRefresh);
+		else
+			return false;
+	}
+
+	return ladder.empty() == false;
+}
+
+const char* QualityGovernor::getStepName(QualityStepEnum qualityStep)
+{
+	switch (qualityStep)
+	{
+		case QualityStepEnum::HalveCpuFilterRate:
+			return "CPU filters on every other frame";
+		case QualityStepEnum::HalveResolution:
+			return "half resolution";
+		case QualityStepEnum::PauseCombinedRefresh:
+			return "combined view paused";
+	}
+
+	return "";
+}
+
+void QualityGovernor::configure(bool isEnabled, const std::vector<QualityStepEnum>& ladder)
+{
+	setLevel(0);
+
+	m_Ladder = ladder;
+	m_StepUpHoldFramesCount = minStepUpHoldFramesCount;
+	m_LoadRatio = 0.0;
+
+	m_LevelsCount = static_cast<int>(m_Ladder.size()) + 1;
+	m_Enabled = isEnabled;
+}
+
+bool QualityGovernor::update(double processingSeconds, double frameIntervalSeconds)
+{
+	if (!m_Enabled || frameIntervalSeconds <= 0.0)
+		return false;
+
+	double loadRatio = processingSeconds / frameIntervalSeconds;
+	double smoothedLoadRatio = m_LoadRatio.load(std::memory_order_relaxed);
+	smoothedLoadRatio = smoothedLoadRatio == 0.0 ? loadRatio : smoothedLoadRatio * 0.9 + loadRatio * 0.1;
+	m_LoadRatio.store(smoothedLoadRatio, std::memory_order_relaxed);
+
+	m_FramesSinceTransition++;
+
+	if (m_FramesSinceTransition < settleFramesCount)
+		return false;
+
+	int level = m_Level.load(std::memory_order_relaxed);
+
+	if (smoothedLoadRatio > overloadRatio && level < static_cast<int>(m_Ladder.size()))
+	{
+		// The level above could not hold, wait longer before trying it again
+		if (m_LastTransitionWasStepUp && m_FramesSinceTransition < m_StepUpHoldFramesCount)
+			m_StepUpHoldFramesCount = std::min(m_StepUpHoldFramesCount * 2, maxStepUpHoldFramesCount);
+
+		m_LastTransitionWasStepUp = false;
+		setLevel(level + 1);
+
+		return true;
+	}
+
+	if (smoothedLoadRatio < headroomRatio && level > 0 && m_FramesSinceTransition >= m_StepUpHoldFramesCount)
+	{
+		m_LastTransitionWasStepUp = true;
+		setLevel(level - 1);
+
+		return true;
+	}
+
+	// A step up that held for a whole hold period resets the backoff
+	if (m_LastTransitionWasStepUp && m_FramesSinceTransition >= m_StepUpHoldFramesCount)
+		m_StepUpHoldFramesCount = minStepUpHoldFramesCount;
+
+	return false;
+}
+
+bool QualityGovernor::isStepActive(QualityStepEnum qualityStep) const
+{
+	int level = m_Level.load(std::memory_order_relaxed);
+
+	for (int step = 0; step < level; step++)
+	{
+		if (m_Ladder[step] == qualityStep)
+			return true;
+	}
+
+	return false;
+}
+
+bool QualityGovernor::isEnabled() const
+{
+	return m_Enabled.load(std::memory_order_relaxed);
+}
+
+int QualityGovernor::getLevel() const
+{
+	return m_Level.load(std::memory_order_relaxed);
+}
+
+int QualityGovernor::getLevelsCount() const
+{
+	return m_LevelsCount.load(std::memory_order_relaxed);
+}
+
+double QualityGovernor::getLoadRatio() const
+{
+	return m_LoadRatio.load(std::memory_order_relaxed);
+}
+
+uint64_t QualityGovernor::getTransitionsCount() const
+{
+	return m_TransitionsCount.load(std::memory_order_relaxed);
+}
+
+void QualityGovernor::setLevel(int level)
+{
+	int previousLevel = m_Level.exchange(level);
+	m_FramesSinceTransition = 0;
+
+	if (previousLevel == level)
+		return;
+
+	m_TransitionsCount.fetch_add(1, std::memory_order_relaxed);
+
+	QualityStepEnum changedStep = m_Ladder[std::min(previousLevel, level)];
+
+	std::cout << m_Name << ": quality level " << previousLevel << " -> " << level
+			  << (level > previousLevel ? ", added " : ", removed ") << getStepName(changedStep)
+			  << " (load " << static_cast<int>(getLoadRatio() * 100.0) << "%)\n";
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+
+// Ways to shed load, applied in the order of the ladder
+enum class QualityStepEnum
+{
+	HalveCpuFilterRate,
+	HalveResolution,
+	PauseCombinedRefresh
+};
+
+// Compares the processing time of every frame with the interval between frames.
+// Above the overload ratio it steps down the ladder, below the headroom ratio it steps back up after a longer hold.
+// Level 0 is full quality, level N has the first N steps of the ladder active.
+class QualityGovernor
+{
+public:
+	explicit QualityGovernor(std::string name);
+
+	static std::vector<QualityStepEnum> getDefaultLadder();
+	// Comma separated "cpu-filters", "resolution" and "combined"
+	static bool parseLadder(const std::string& ladderString, std::vector<QualityStepEnum>& ladder);
+	static const char* getStepName(QualityStepEnum qualityStep);
+
+	// Disabling goes back to full quality
+	void configure(bool isEnabled, const std::vector<QualityStepEnum>& ladder);
+
+	// Returns true when the level changed
+	bool update(double processingSeconds, double frameIntervalSeconds);
+
+	bool isStepActive(QualityStepEnum qualityStep) const;
+
+	// Readable from any thread
+	bool isEnabled() const;
+	int getLevel() const;
+	int getLevelsCount() const;
+	double getLoadRatio() const;
+	uint64_t getTransitionsCount() const;
+
+private:
+	void setLevel(int level);
+
+	std::string m_Name;
+	std::vector<QualityStepEnum> m_Ladder;
+
+	int m_FramesSinceTransition;
+	// Doubles every time a step up had to be taken back right away
+	int m_StepUpHoldFramesCount;
+	bool m_LastTransitionWasStepUp;
+
+	std::atomic<bool> m_Enabled;
+	std::atomic<int> m_Level;
+	std::atomic<int> m_LevelsCount;
+	std::atomic<double> m_LoadRatio;
+	std::atomic<uint64_t> m_TransitionsCount;
+};
@@ -0,0 +1,373 @@
+#include "SessionConfig.h"
+
+#include <cstdlib>
+#include <sstream>
+
+#include <opencv4/opencv2/core/persistence.hpp>
+
+#include "Filters/FilterNames.h"
+
+
+namespace
+{
+	const char* const sessionArguments[] = {
+		"--sources", "--streams", "--camera-size", "--camera-fps", "--fourcc", "--capture-backend", "--decode-scale", "--repeat", "--fps",
+		"--filters", "--combined", "--canny-thresholds", "--output", "--record", "--shm", "--http", "--metrics-port", "--workers", "--affinity", "--priority", "--numa",
+		"--memory-budget", "--prewarm", "--tune"
+	};
+
+	bool parseInteger(const std::string& value, long minimum, long maximum, long& integer)
+	{
+		char* valueEnd = nullptr;
+		integer = std::strtol(value.c_str(), &valueEnd, 10);
+
+		return valueEnd != value.c_str() && *valueEnd == '\0' && integer >= minimum && integer <= maximum;
+	}
+
+	bool parseReal(const std::string& value, double minimum, double& real)
+	{
+		char* valueEnd = nullptr;
+		real = std::strtod(value.c_str(), &valueEnd);
+
+		return valueEnd != value.c_str() && *valueEnd == '\0' && real >= minimum;
+	}
+
+	bool parsePort(const std::string& value, int& port)
+	{
+		long parsedPort = 0;
+		if (!parseInteger(value, 0, 65535, parsedPort))
+			return false;
+
+		port = static_cast<int>(parsedPort);
+		return true;
+	}
+
+	std::vector<std::string> splitList(const std::string& list)
+	{
+		std::stringstream items(list);
+		std::string item;
+		std::vector<std::string> splitItems;
+
+		while (std::getline(items, item, ','))
+		{
+			item.erase(0, item.find_first_not_of(' '));
+			item.erase(item.find_last_not_of(' ') + 1);
+
+			splitItems.push_back(item);
+		}
+
+		return splitItems;
+	}
+
+	bool parseDecodeScale(const std::string& scaleName, DecodeScaleEnum& decodeScale)
+	{
+		if (scaleName == "1")
+			decodeScale = DecodeScaleEnum::Full;
+		else if (scaleName == "2")
+			decodeScale = DecodeScaleEnum::Half;
+		else if (scaleName == "4")
+			decodeScale = DecodeScaleEnum::Quarter;
+		else if (scaleName == "8")
+			decodeScale = DecodeScaleEnum::Eighth;
+		else
+			return false;
+
+		return true;
+	}
+
+	// Width x height, e.g. 1280x720
+	bool parseFrameSize(const std::string& frameSizeValue, int& width, int& height)
+	{
+		size_t separator = frameSizeValue.find('x');
+		if (separator == std::string::npos)
+			return false;
+
+		long parsedWidth = 0;
+		long parsedHeight = 0;
+		if (!parseInteger(frameSizeValue.substr(0, separator), 1, 16384, parsedWidth) ||
+			!parseInteger(frameSizeValue.substr(separator + 1), 1, 16384, parsedHeight))
+		{
+			return false;
+		}
+
+		width = static_cast<int>(parsedWidth);
+		height = static_cast<int>(parsedHeight);
+
+		return true;
+	}
+
+	// Low and high, e.g. 40,100
+	bool parseCannyThresholds(const std::string& value, CannyThresholds& cannyThresholds)
+	{
+		std::vector<std::string> thresholds = splitList(value);
+		long low = 0;
+		long high = 0;
+
+		if (thresholds.size() != 2 || !parseInteger(thresholds[0], 0, 65535, low) || !parseInteger(thresholds[1], 0, 65535, high))
+			return false;
+
+		CannyThresholds parsedThresholds;
+		parsedThresholds.low = static_cast<int>(low);
+		parsedThresholds.high = static_cast<int>(high);
+
+		if (!parsedThresholds.isValid())
+			return false;
+
+		cannyThresholds = parsedThresholds;
+		return true;
+	}
+
+	bool parseFlag(const std::string& value, bool& flag)
+	{
+		if (value.empty() || value == "1" || value == "true" || value == "yes")
+			flag = true;
+		else if (value == "0" || value == "false" || value == "no")
+			flag = false;
+		else
+			return false;
+
+		return true;
+	}
+
+	bool parseSetting(SessionConfig& sessionConfig, const std::string& argument, const std::string& value)
+	{
+		long integer = 0;
+
+		if (argument == "--sources")
+		{
+			sessionConfig.sources = splitList(value);
+			return sessionConfig.sources.empty() == false;
+		}
+
+		if (argument == "--streams")
+		{
+			if (!parseInteger(value, 1, 1024, integer))
+				return false;
+
+			sessionConfig.streamsCount = static_cast<int>(integer);
+			return true;
+		}
+
+		if (argument == "--camera-size")
+			return parseFrameSize(value, sessionConfig.captureSettings.width, sessionConfig.captureSettings.height);
+
+		if (argument == "--camera-fps")
+			return parseReal(value, 0.0, sessionConfig.captureSettings.fps) && sessionConfig.captureSettings.fps > 0.0;
+
+		if (argument == "--fourcc")
+		{
+			if (value.size() != 4)
+				return false;
+
+			sessionConfig.captureSettings.fourcc = value;
+			return true;
+		}
+
+		if (argument == "--capture-backend")
+			return CaptureSettings::parseBackend(value, sessionConfig.captureSettings.backend);
+
+		if (argument == "--decode-scale")
+			return parseDecodeScale(value, sessionConfig.decodeScale);
+
+		if (argument == "--repeat")
+		{
+			if (!parseInteger(value, 0, 1000000, integer))
+				return false;
+
+			sessionConfig.repeatCount = static_cast<int>(integer);
+			return true;
+		}
+
+		if (argument == "--fps")
+			return parseReal(value, 0.0, sessionConfig.playbackFps);
+
+		if (argument == "--filters")
+			return parseFilterTypeList(value, sessionConfig.filters);
+
+		if (argument == "--combined")
+			return parseFilterTypeList(value, sessionConfig.combinedFilters);
+
+		if (argument == "--canny-thresholds")
+			return parseCannyThresholds(value, sessionConfig.cannyThresholds);
+
+		if (argument == "--output")
+		{
+			sessionConfig.sinkSource = FrameSinkSource();
+
+			if (value == "Combined")
+			{
+				sessionConfig.sinkSource.combined = true;
+				return true;
+			}
+
+			return parseFilterType(value, sessionConfig.sinkSource.filterType);
+		}
+
+		if (argument == "--record")
+		{
+			sessionConfig.recordingPath = value;
+			return true;
+		}
+
+		if (argument == "--shm")
+		{
+			sessionConfig.sharedMemoryName = value;
+			return true;
+		}
+
+		if (argument == "--http")
+			return parsePort(value, sessionConfig.httpPort);
+
+		if (argument == "--metrics-port")
+			return parsePort(value, sessionConfig.metricsPort);
+
+		if (argument == "--workers")
+		{
+			if (!parseInteger(value, 1, 1024, integer))
+				return false;
+
+			sessionConfig.workerThreadsCount = static_cast<unsigned int>(integer);
+			return true;
+		}
+
+		if (ThreadPlacements::isPlacementArgument(argument))
+			return sessionConfig.threadPlacements.parseArgument(argument, value);
+
+		if (argument == "--memory-budget")
+		{
+			if (!parseInteger(value, 0, 1024 * 1024, integer))
+				return false;
+
+			sessionConfig.memoryBudgetBytes = static_cast<size_t>(integer) * 1024 * 1024;
+			return true;
+		}
+
+		if (argument == "--prewarm")
+			return parseFilterTypeList(value, sessionConfig.prewarmFilters);
+
+		if (argument == "--tune")
+			return parseFlag(value, sessionConfig.tuneKernels);
+
+		return false;
+	}
+
+	// Numbers as they were written, sequences as a comma separated list
+	std::string getNodeValue(const cv::FileNode& node)
+	{
+		if (node.isString())
+			return node.string();
+
+		if (node.isInt())
+			return std::to_string(static_cast<int>(node));
+
+		if (node.isReal())
+		{
+			std::ostringstream real;
+			real << static_cast<double>(node);
+			return real.str();
+		}
+
+		if (node.isSeq())
+		{
+			std::string list;
+			for (size_t i = 0; i < node.size(); i++)
+			{
+				list += (i > 0 ? "," : "") + getNodeValue(node[static_cast<int>(i)]);
+			}
+
+			return list;
+		}
+
+		return "";
+	}
+}
+
+
+bool SessionConfig::loadFile(const std::string& path, std::vector<std::string>& errors)
+{
+	cv::FileStorage fileStorage;
+	size_t previousErrorsCount = errors.size();
+
+	// The parser throws on malformed files
+	try
+	{
+		if (!fileStorage.open(path, cv::FileStorage::READ))
+		{
+			errors.push_back("Could not open the configuration " + path);
+			return false;
+		}
+	}
+	catch (const cv::Exception& exception)
+	{
+		errors.push_back("Could not parse the configuration " + path + ": " + exception.what());
+		return false;
+	}
+
+	cv::FileNode root = fileStorage.root();
+
+	for (const std::string& key : root.keys())
+	{
+		cv::FileNode node = root[key];
+		std::string argument = "--" + key;
+
+		if (!isSessionArgument(argument))
+		{
+			errors.push_back(path + ": unknown setting " + key);
+			continue;
+		}
+
+		// One placement per role
+		if (node.isMap() && ThreadPlacements::isPlacementArgument(argument))
+		{
+			for (const std::string& role : node.keys())
+			{
+				parseArgument(argument, role + "=" + getNodeValue(node[role]), errors);
+			}
+
+			continue;
+		}
+
+		parseArgument(argument, getNodeValue(node), errors);
+	}
+
+	return errors.size() == previousErrorsCount;
+}
+
+bool SessionConfig::parseArgument(const std::string& argument, const std::string& value, std::vector<std::string>& errors)
+{
+	if (!isSessionArgument(argument))
+		return false;
+
+	if (!parseSetting(*this, argument, value))
+		errors.push_back("Invalid value \"" + value + "\" for " + argument);
+
+	return true;
+}
+
+bool SessionConfig::isSessionArgument(const std::string& argument)
+{
+	for (const char* sessionArgument : sessionArguments)
+	{
+		if (argument == sessionArgument)
+			return true;
+	}
+
+	return false;
+}
+
+bool SessionConfig::isFlagArgument(const std::string& argument)
+{
+	return argument == "--tune";
+}
+
+std::string SessionConfig::getUsage()
+{
+	return
+		"Session: [--config <file.yml|file.json>] [--plan] [--sources <list>] [--streams N]\n"
+		"         [--camera-size WxH] [--camera-fps F] [--fourcc MJPG|YUYV|...] [--capture-backend any|dshow|msmf|v4l2|gstreamer|ffmpeg|avfoundation]\n"
+		"         [--decode-scale 1|2|4|8] [--repeat N] [--fps F] [--filters <list>] [--combined <list>] [--canny-thresholds <low>,<high>]\n"
+		"         [--output <filter>|Combined] [--record <file.avi|file.y4m|file.rawframes>] [--shm <name>] [--http <port>] [--metrics-port <port>]\n"
+		"         [--workers N] [--affinity <role>=<cpus>] [--priority <role>=low|normal|high|realtime] [--numa <role>=<node>]\n"
+		"         [--memory-budget <MB>] [--prewarm <list>] [--tune]\n"
+		"Roles: capture, workers, render. CPUs: e.g. 2-5,8\n";
+}
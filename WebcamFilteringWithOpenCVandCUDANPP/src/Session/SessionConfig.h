@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Capture/CaptureSettings.h"
+#include "Capture/DecodeScale.h"
+#include "Filters/Edges/CannyEdgeFilter.h"
+#include "Filters/FilterTypes.h"
+#include "Output/FrameSink.h"
+#include "Threading/ThreadPlacement.h"
+
+
+// Sources, filters, sinks, threads and backends of a run. A configuration file is read first and the command line
+// overrides it, both use the same names: "--camera-size 640x480" is "camera-size: 640x480" in the file.
+// The defaults are the view's, the headless run changes a few before reading.
+struct SessionConfig
+{
+	// Camera indices, MJPEG streams and raw frame recordings, each one becomes a stream
+	std::vector<std::string> sources;
+	// The sources are repeated up to this many streams
+	int streamsCount = 0;
+
+	CaptureSettings captureSettings;
+	DecodeScaleEnum decodeScale = DecodeScaleEnum::Full;
+	// Pre-recorded streams: 0 loops forever, without a playback rate frames are read as fast as they are consumed
+	int repeatCount = 0;
+	double playbackFps = 60.0;
+
+	std::vector<FilterTypeEnum> filters;
+	// Outputs tiled in the combined frame, "--output Combined" alone tiles every filter
+	std::vector<FilterTypeEnum> combinedFilters;
+	// Starting thresholds of every stream, the view changes them live
+	CannyThresholds cannyThresholds;
+
+	// Output taken by the recording and shared memory sinks
+	FrameSinkSource sinkSource;
+	std::string recordingPath;
+	std::string sharedMemoryName;
+	int httpPort = 0;
+	int metricsPort = 0;
+
+	// 0 is one per hardware thread
+	unsigned int workerThreadsCount = 0;
+	ThreadPlacements threadPlacements;
+	// 0 is unlimited
+	size_t memoryBudgetBytes = 0;
+	std::vector<FilterTypeEnum> prewarmFilters;
+	bool tuneKernels = false;
+
+	// Set by the headless run, there are no textures to plan for
+	bool headless = false;
+
+	// YAML, JSON or XML read with cv::FileStorage. Lists are sequences or comma separated strings,
+	// placements are maps of roles, e.g. "affinity: { workers: 4-15 }".
+	bool loadFile(const std::string& path, std::vector<std::string>& errors);
+
+	// False for an argument that is not a session setting. An invalid value is reported in the errors.
+	bool parseArgument(const std::string& argument, const std::string& value, std::vector<std::string>& errors);
+	static bool isSessionArgument(const std::string& argument);
+	// Flags like --tune are given alone on the command line
+	static bool isFlagArgument(const std::string& argument);
+
+	static std::string getUsage();
+};
@@ -0,0 +1,378 @@
+#include "SessionPlan.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "Capture/RawFrameFileSource.h"
+#include "Filters/FilterNames.h"
+#include "Filters/FilterTraits.h"
+
+
+namespace
+{
+	std::string formatMegabytes(size_t bytes)
+	{
+		std::ostringstream megabytes;
+		megabytes << std::fixed << std::setprecision(2) << bytes / (1024.0 * 1024.0) << " MB";
+
+		return megabytes.str();
+	}
+
+	std::string formatFilterList(const std::vector<FilterTypeEnum>& filterTypes)
+	{
+		if (filterTypes.empty())
+			return "none";
+
+		std::string filterList;
+		for (FilterTypeEnum filterType : filterTypes)
+		{
+			filterList += (filterList.empty() ? "" : ", ") + getFilterTypeName(filterType);
+		}
+
+		return filterList;
+	}
+
+	bool containsFilter(const std::vector<FilterTypeEnum>& filterTypes, FilterTypeEnum filterType)
+	{
+		return std::find(filterTypes.begin(), filterTypes.end(), filterType) != filterTypes.end();
+	}
+
+	std::string describeSource(const StreamPlan& streamPlan, const SessionConfig& sessionConfig)
+	{
+		const FrameSourceProbe& frameSourceProbe = streamPlan.frameSourceProbe;
+		std::ostringstream description;
+
+		switch (frameSourceProbe.kind)
+		{
+			case FrameSourceKindEnum::Camera:
+				description << "camera, " << frameSourceProbe.frameSize.width << "x" << frameSourceProbe.frameSize.height
+					<< " @ " << frameSourceProbe.framesPerSecond << " fps requested, " << sessionConfig.captureSettings.fourcc
+					<< " via " << CaptureSettings::getBackendName(sessionConfig.captureSettings.backend);
+				return description.str();
+			case FrameSourceKindEnum::MjpegFile:
+				description << "MJPEG stream, ";
+				break;
+			case FrameSourceKindEnum::RawFrames:
+				description << "raw frames, ";
+				break;
+		}
+
+		description << frameSourceProbe.frameSize.width << "x" << frameSourceProbe.frameSize.height;
+
+		if (frameSourceProbe.framesPerSecond > 0.0)
+			description << " paced at " << frameSourceProbe.framesPerSecond << " fps";
+		else
+			description << " unpaced";
+
+		return description.str();
+	}
+}
+
+
+size_t StreamPlan::getBufferBytes(BufferLocationEnum location) const
+{
+	size_t bufferBytes = 0;
+
+	for (const PlannedOutput& plannedOutput : outputs)
+	{
+		for (const PlannedBuffer& buffer : plannedOutput.buffers)
+		{
+			if (buffer.location == location)
+				bufferBytes += buffer.bytes;
+		}
+	}
+
+	return bufferBytes;
+}
+
+size_t StreamPlan::getBuffersCount() const
+{
+	size_t buffersCount = 0;
+
+	for (const PlannedOutput& plannedOutput : outputs)
+	{
+		buffersCount += plannedOutput.buffers.size();
+	}
+
+	return buffersCount;
+}
+
+FrameTraffic StreamPlan::getFrameTraffic() const
+{
+	FrameTraffic frameTraffic;
+
+	for (const PlannedOutput& plannedOutput : outputs)
+	{
+		frameTraffic += plannedOutput.frameTraffic;
+	}
+
+	return frameTraffic;
+}
+
+SessionPlan::SessionPlan() :
+	m_WorkerThreadsCount(0)
+{
+}
+
+bool SessionPlan::compile(const SessionConfig& sessionConfig, SessionPlan& sessionPlan, std::vector<std::string>& errors)
+{
+	size_t previousErrorsCount = errors.size();
+
+	SessionPlan compiledPlan;
+	SessionConfig& config = compiledPlan.m_SessionConfig;
+	config = sessionConfig;
+
+	if (config.sources.empty())
+		errors.push_back("No sources");
+
+	if (config.sinkSource.combined && config.combinedFilters.empty())
+		config.combinedFilters = config.filters;
+
+	for (FilterTypeEnum filterType : config.combinedFilters)
+	{
+		if (!containsFilter(config.filters, filterType))
+			errors.push_back(getFilterTypeName(filterType) + " is tiled in the combined frame but is not one of the filters");
+	}
+
+	// Raw frames are recorded as captured, every other sink takes the output
+	bool sinkTakesOutput = !config.sharedMemoryName.empty() ||
+		(!config.recordingPath.empty() && !RawFrameFileSource::isRawFramePath(config.recordingPath));
+
+	if (sinkTakesOutput && config.sinkSource.combined && config.combinedFilters.empty())
+		errors.push_back("The sinks take the combined frame, but it has no filters");
+	else if (sinkTakesOutput && !config.sinkSource.combined && !containsFilter(config.filters, config.sinkSource.filterType))
+		errors.push_back("The sinks take " + getFilterTypeName(config.sinkSource.filterType) + ", which is not one of the filters");
+
+	if (config.httpPort != 0 && config.httpPort == config.metricsPort)
+		errors.push_back("The HTTP streams and the metrics cannot share port " + std::to_string(config.httpPort));
+
+	unsigned int hardwareThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+	compiledPlan.m_WorkerThreadsCount = config.workerThreadsCount != 0 ? config.workerThreadsCount : hardwareThreadsCount;
+
+	if (compiledPlan.m_WorkerThreadsCount > hardwareThreadsCount)
+	{
+		compiledPlan.m_Warnings.push_back(std::to_string(compiledPlan.m_WorkerThreadsCount) + " workers on " +
+										  std::to_string(hardwareThreadsCount) + " hardware threads");
+	}
+
+	for (const ThreadPlacement* threadPlacement : { &config.threadPlacements.capture, &config.threadPlacements.workers, &config.threadPlacements.render })
+	{
+		if (!threadPlacement->cpus.empty() && threadPlacement->cpus.back() >= static_cast<int>(hardwareThreadsCount))
+		{
+			compiledPlan.m_Warnings.push_back("CPU " + std::to_string(threadPlacement->cpus.back()) + " of a placement is not one of the " +
+											  std::to_string(hardwareThreadsCount) + " CPUs");
+		}
+	}
+
+	size_t streamsCount = config.sources.empty() ? 0 : std::max<size_t>(config.streamsCount, config.sources.size());
+
+	for (size_t i = 0; i < streamsCount; i++)
+	{
+		StreamPlan streamPlan;
+		streamPlan.sourceName = config.sources[i % config.sources.size()];
+
+		if (!FrameSourceFactory::probeFrameSource(streamPlan.sourceName, config.captureSettings, config.decodeScale, config.playbackFps,
+												  streamPlan.frameSourceProbe))
+		{
+			// Repeated sources are reported once
+			if (i < config.sources.size())
+				errors.push_back("Cannot read the source " + streamPlan.sourceName);
+
+			continue;
+		}
+
+		if (streamPlan.frameSourceProbe.kind == FrameSourceKindEnum::RawFrames && config.decodeScale != DecodeScaleEnum::Full && i < config.sources.size())
+			compiledPlan.m_Warnings.push_back("The decode scale does not apply to the raw frames of " + streamPlan.sourceName);
+
+		// The view has one set of textures, for the stream selected first
+		compiledPlan.planStream(streamPlan, !config.headless && i == 0);
+		compiledPlan.m_Streams.push_back(std::move(streamPlan));
+	}
+
+	if (config.memoryBudgetBytes != 0 && compiledPlan.getBufferBytes() > config.memoryBudgetBytes)
+	{
+		compiledPlan.m_Warnings.push_back("The plan needs " + formatMegabytes(compiledPlan.getBufferBytes()) + ", outputs past the " +
+										  formatMegabytes(config.memoryBudgetBytes) + " budget will be refused");
+	}
+
+	if (errors.size() != previousErrorsCount)
+		return false;
+
+	sessionPlan = std::move(compiledPlan);
+	return true;
+}
+
+// Outputs are planned in the order the controller runs them
+void SessionPlan::planStream(StreamPlan& streamPlan, bool viewTextures) const
+{
+	const SessionConfig& config = m_SessionConfig;
+	const cv::Size& frameSize = streamPlan.frameSourceProbe.frameSize;
+	int frameType = streamPlan.frameSourceProbe.frameType;
+
+	if (config.filters.empty())
+		return;
+
+	bool decoded = streamPlan.frameSourceProbe.kind != FrameSourceKindEnum::RawFrames;
+	streamPlan.outputs.push_back({ "capture", PipelineCost::getCaptureBuffers(frameSize, frameType),
+								   PipelineCost::getCaptureTraffic(frameSize, frameType, decoded) });
+
+	bool cpuLumaActive = std::any_of(config.filters.begin(), config.filters.end(),
+									 [](FilterTypeEnum filterType) { return getFilterTraits(filterType).cpuLuma; });
+
+	if (cpuLumaActive)
+		streamPlan.outputs.push_back({ "CPU luma", { PipelineCost::getCpuLumaBuffer(frameSize) }, PipelineCost::getCpuLumaTraffic(frameSize) });
+
+	for (FilterTypeEnum filterType : allFilterTypes)
+	{
+		if (!containsFilter(config.filters, filterType))
+			continue;
+
+		bool onCombined = containsFilter(config.combinedFilters, filterType);
+
+		streamPlan.outputs.push_back({ getFilterTypeName(filterType),
+									   PipelineCost::getOutputBuffers(filterType, frameSize, onCombined, viewTextures),
+									   PipelineCost::getOutputTraffic(filterType, frameSize, onCombined, viewTextures) });
+	}
+
+	if (config.combinedFilters.empty())
+		return;
+
+	int tilesCount = 0;
+	for (FilterTypeEnum filterType : allFilterTypes)
+	{
+		if (containsFilter(config.combinedFilters, filterType))
+			tilesCount++;
+	}
+
+	streamPlan.outputs.push_back({ "Combined", PipelineCost::getCombinedBuffers(frameSize, frameType, tilesCount, viewTextures),
+								   PipelineCost::getCombinedTraffic(frameSize, frameType, tilesCount, viewTextures) });
+}
+
+const SessionConfig& SessionPlan::getConfig() const
+{
+	return m_SessionConfig;
+}
+
+const std::vector<StreamPlan>& SessionPlan::getStreams() const
+{
+	return m_Streams;
+}
+
+unsigned int SessionPlan::getWorkerThreadsCount() const
+{
+	return m_WorkerThreadsCount;
+}
+
+const std::vector<std::string>& SessionPlan::getWarnings() const
+{
+	return m_Warnings;
+}
+
+size_t SessionPlan::getBufferBytes() const
+{
+	size_t bufferBytes = 0;
+
+	for (const StreamPlan& streamPlan : m_Streams)
+	{
+		bufferBytes += streamPlan.getBufferBytes(BufferLocationEnum::Host) + streamPlan.getBufferBytes(BufferLocationEnum::Device);
+	}
+
+	return bufferBytes;
+}
+
+void SessionPlan::print(std::ostream& output) const
+{
+	const SessionConfig& config = m_SessionConfig;
+
+	output
+		<< "-----------------------------------------\n"
+		<< "Session plan\n"
+		<< "Workers: " << m_WorkerThreadsCount << " threads" << (config.threadPlacements.isDefault() ? "" : ", placed as configured") << "\n"
+		<< "Filters: " << formatFilterList(config.filters) << "\n"
+		<< "Combined: " << formatFilterList(config.combinedFilters) << "\n";
+
+	if (containsFilter(config.filters, FilterTypeEnum::Canny))
+		output << "Canny thresholds: " << config.cannyThresholds.low << ", " << config.cannyThresholds.high << "\n";
+
+	std::string sinkOutput = config.sinkSource.combined ? "Combined" : getFilterTypeName(config.sinkSource.filterType);
+
+	if (!config.recordingPath.empty())
+		output << "Recording: " << config.recordingPath << " (" << (RawFrameFileSource::isRawFramePath(config.recordingPath) ? "captured" : sinkOutput) << ")\n";
+
+	if (!config.sharedMemoryName.empty())
+		output << "Shared memory: " << config.sharedMemoryName << " (" << sinkOutput << ")\n";
+
+	if (config.httpPort != 0)
+		output << "HTTP streams: port " << config.httpPort << "\n";
+
+	if (config.metricsPort != 0)
+		output << "Metrics: port " << config.metricsPort << "\n";
+
+	FrameTraffic totalFrameTraffic;
+	double totalBytesPerSecond = 0.0;
+
+	for (size_t i = 0; i < m_Streams.size(); i++)
+	{
+		const StreamPlan& streamPlan = m_Streams[i];
+		FrameTraffic frameTraffic = streamPlan.getFrameTraffic();
+
+		output << "Stream " << i << " (" << streamPlan.sourceName << "): " << describeSource(streamPlan, config) << "\n";
+
+		for (const PlannedOutput& plannedOutput : streamPlan.outputs)
+		{
+			output << "  " << std::left << std::setw(24) << plannedOutput.name << std::right
+				<< formatMegabytes(PipelineCost::getTotalBytes(plannedOutput.buffers)) << " in";
+
+			for (const PlannedBuffer& buffer : plannedOutput.buffers)
+			{
+				output << (&buffer == &plannedOutput.buffers.front() ? " " : ", ") << buffer.name
+					<< (buffer.location == BufferLocationEnum::Device ? " (GPU)" : "");
+			}
+
+			output << "\n";
+		}
+
+		output
+			<< "  Buffers: " << streamPlan.getBuffersCount() << ", "
+			<< formatMegabytes(streamPlan.getBufferBytes(BufferLocationEnum::Device)) << " GPU, "
+			<< formatMegabytes(streamPlan.getBufferBytes(BufferLocationEnum::Host)) << " host\n"
+			<< "  Per frame: " << formatMegabytes(frameTraffic.uploadBytes) << " uploaded, "
+			<< formatMegabytes(frameTraffic.downloadBytes) << " downloaded, "
+			<< formatMegabytes(frameTraffic.deviceBytes) << " written on the GPU, "
+			<< formatMegabytes(frameTraffic.hostBytes) << " written on the host";
+
+		double framesPerSecond = streamPlan.frameSourceProbe.framesPerSecond;
+		if (framesPerSecond > 0.0)
+		{
+			double bytesPerSecond = frameTraffic.getTotalBytes() * framesPerSecond;
+			totalBytesPerSecond += bytesPerSecond;
+
+			output << ", " << formatMegabytes(static_cast<size_t>(bytesPerSecond)) << "/s at " << framesPerSecond << " fps";
+		}
+
+		output << "\n";
+
+		totalFrameTraffic += frameTraffic;
+	}
+
+	output
+		<< "Total: " << m_Streams.size() << " streams, " << formatMegabytes(getBufferBytes()) << " of buffers, "
+		<< formatMegabytes(totalFrameTraffic.getTotalBytes()) << " moved per frame of every stream";
+
+	if (totalBytesPerSecond > 0.0)
+		output << ", " << formatMegabytes(static_cast<size_t>(totalBytesPerSecond)) << "/s for the paced streams";
+
+	output << "\n";
+
+	if (config.memoryBudgetBytes != 0)
+		output << "Memory budget: " << formatMegabytes(config.memoryBudgetBytes) << "\n";
+
+	for (const std::string& warning : m_Warnings)
+	{
+		output << "Warning: " << warning << "\n";
+	}
+
+	output << "-----------------------------------------\n";
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Capture/FrameSourceFactory.h"
+#include "Pipeline/PipelineCost.h"
+#include "SessionConfig.h"
+
+
+// An output of a stream, or the capture and combined buffers it shares
+struct PlannedOutput
+{
+	std::string name;
+	std::vector<PlannedBuffer> buffers;
+	FrameTraffic frameTraffic;
+};
+
+struct StreamPlan
+{
+	std::string sourceName;
+	FrameSourceProbe frameSourceProbe;
+	std::vector<PlannedOutput> outputs;
+
+	size_t getBufferBytes(BufferLocationEnum location) const;
+	size_t getBuffersCount() const;
+	FrameTraffic getFrameTraffic() const;
+};
+
+// A session configuration checked and resolved once at startup: the streams with the frame size of their source,
+// and the buffers and traffic of their outputs. Printed, it is the cost estimate of the run.
+// Outputs the budget refuses and tiles that do not change cost less than planned.
+class SessionPlan
+{
+public:
+	SessionPlan();
+
+	// False with the reasons when the session cannot run as configured. Sources are probed, not opened.
+	static bool compile(const SessionConfig& sessionConfig, SessionPlan& sessionPlan, std::vector<std::string>& errors);
+
+	// With the combined filters resolved
+	const SessionConfig& getConfig() const;
+	const std::vector<StreamPlan>& getStreams() const;
+	unsigned int getWorkerThreadsCount() const;
+
+	// Settings that are accepted but may not do what was meant
+	const std::vector<std::string>& getWarnings() const;
+
+	size_t getBufferBytes() const;
+
+	void print(std::ostream& output) const;
+
+private:
+	void planStream(StreamPlan& streamPlan, bool viewTextures) const;
+
+	SessionConfig m_SessionConfig;
+	std::vector<StreamPlan> m_Streams;
+	unsigned int m_WorkerThreadsCount;
+	std::vector<std::string> m_Warnings;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// SSE2 is part of the x86-64 baseline, MSVC does not define __SSE2__ for x64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2_AVAILABLE 1
+#include <emmintrin.h>
+#else
+#define SIMD_SSE2_AVAILABLE 0
+#endif
+
+// Kernels with a vector path can still take their scalar one, which the compiler may vectorize better for the target
+enum class SimdVariantEnum
+{
+	Scalar,
+	Sse2
+};
+
+constexpr SimdVariantEnum defaultSimdVariant = SIMD_SSE2_AVAILABLE ? SimdVariantEnum::Sse2 : SimdVariantEnum::Scalar;
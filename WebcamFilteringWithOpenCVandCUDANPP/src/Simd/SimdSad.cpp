@@ -0,0 +1,92 @@
+#include "SimdSad.h"
+
+#include <cstdlib>
+
+
+namespace
+{
+	inline uint32_t computeRowSad(const uint8_t* first, const uint8_t* second, int widthBytes, SimdVariantEnum simdVariant)
+	{
+		uint32_t sad = 0;
+		int x = 0;
+
+#if SIMD_SSE2_AVAILABLE
+		__m128i sadAccumulator = _mm_setzero_si128();
+		for (; simdVariant == SimdVariantEnum::Sse2 && x + 16 <= widthBytes; x += 16)
+		{
+			__m128i firstBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + x));
+			__m128i secondBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + x));
+
+			// psadbw leaves two 16-bit partial sums, one per 64-bit half
+			sadAccumulator = _mm_add_epi64(sadAccumulator, _mm_sad_epu8(firstBytes, secondBytes));
+		}
+
+		sad += static_cast<uint32_t>(_mm_cvtsi128_si32(sadAccumulator) + _mm_cvtsi128_si32(_mm_srli_si128(sadAccumulator, 8)));
+#else
+		(void)simdVariant;
+#endif
+
+		for (; x < widthBytes; x++)
+		{
+			sad += static_cast<uint32_t>(std::abs(static_cast<int>(first[x]) - static_cast<int>(second[x])));
+		}
+
+		return sad;
+	}
+}
+
+
+uint32_t computeSad(const uint8_t* first, size_t firstStep,
+					const uint8_t* second, size_t secondStep,
+					int widthBytes, int height,
+					SimdVariantEnum simdVariant)
+{
+	uint32_t sad = 0;
+
+	for (int y = 0; y < height; y++)
+	{
+		sad += computeRowSad(first + y * firstStep, second + y * secondStep, widthBytes, simdVariant);
+	}
+
+	return sad;
+}
+
+uint32_t computeSadUntil(const uint8_t* first, size_t firstStep,
+						 const uint8_t* second, size_t secondStep,
+						 int widthBytes, int height,
+						 uint32_t limit,
+						 SimdVariantEnum simdVariant)
+{
+	uint32_t sad = 0;
+
+	for (int y = 0; y < height && sad <= limit; y++)
+	{
+		sad += computeRowSad(first + y * firstStep, second + y * secondStep, widthBytes, simdVariant);
+	}
+
+	return sad;
+}
+
+uint32_t computeSad16x16(const uint8_t* first, size_t firstStep,
+						 const uint8_t* second, size_t secondStep,
+						 SimdVariantEnum simdVariant)
+{
+#if SIMD_SSE2_AVAILABLE
+	if (simdVariant == SimdVariantEnum::Scalar)
+		return computeSad(first, firstStep, second, secondStep, 16, 16, SimdVariantEnum::Scalar);
+
+	__m128i sadAccumulator = _mm_setzero_si128();
+
+	for (int y = 0; y < 16; y++)
+	{
+		__m128i firstBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + y * firstStep));
+		__m128i secondBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + y * secondStep));
+
+		sadAccumulator = _mm_add_epi64(sadAccumulator, _mm_sad_epu8(firstBytes, secondBytes));
+	}
+
+	return static_cast<uint32_t>(_mm_cvtsi128_si32(sadAccumulator) + _mm_cvtsi128_si32(_mm_srli_si128(sadAccumulator, 8)));
+#else
+	return computeSad(first, firstStep, second, secondStep, 16, 16, simdVariant);
+#endif
+}
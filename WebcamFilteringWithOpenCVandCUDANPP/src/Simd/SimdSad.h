@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SimdConfig.h"
+
+
+// Sum of absolute differences between two 8-bit blocks, widthBytes counts bytes not pixels
+uint32_t computeSad(const uint8_t* first, size_t firstStep,
+					const uint8_t* second, size_t secondStep,
+					int widthBytes, int height,
+					SimdVariantEnum simdVariant = defaultSimdVariant);
+
+// Stops as soon as the running sum goes above the limit and returns the partial sum
+uint32_t computeSadUntil(const uint8_t* first, size_t firstStep,
+						 const uint8_t* second, size_t secondStep,
+						 int widthBytes, int height,
+						 uint32_t limit,
+						 SimdVariantEnum simdVariant = defaultSimdVariant);
+
+// 16x16 block of single channel bytes, one psadbw per row
+uint32_t computeSad16x16(const uint8_t* first, size_t firstStep,
+						 const uint8_t* second, size_t secondStep,
+						 SimdVariantEnum simdVariant = defaultSimdVariant);
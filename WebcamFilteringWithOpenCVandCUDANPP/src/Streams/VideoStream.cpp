@@ -0,0 +1,23 @@
+#include "VideoStream.h"
+
+
+VideoStream::VideoStream(const std::string& name, WorkerPool& workerPool, std::unique_ptr<FrameSource> frameSource) :
+	m_Name(name),
+	m_WebcamController(m_ViewEventQueue, workerPool, std::move(frameSource))
+{
+}
+
+const std::string& VideoStream::getName() const
+{
+	return m_Name;
+}
+
+ViewEventQueue& VideoStream::getViewEventQueue()
+{
+	return m_ViewEventQueue;
+}
+
+WebcamController& VideoStream::getWebcamController()
+{
+	return m_WebcamController;
+}
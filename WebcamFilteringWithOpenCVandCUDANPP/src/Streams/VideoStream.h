@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Capture/FrameSource.h"
+#include "EventQueues/ViewEventQueue.h"
+#include "Webcam/WebcamController.h"
+
+class WorkerPool;
+
+
+// One source with its own filter configuration, capture thread and event queue.
+// Streams of a process share the worker pool, each one on its own scheduling lane.
+class VideoStream
+{
+public:
+	VideoStream(const std::string& name, WorkerPool& workerPool, std::unique_ptr<FrameSource> frameSource);
+
+	const std::string& getName() const;
+
+	ViewEventQueue& getViewEventQueue();
+	WebcamController& getWebcamController();
+
+private:
+	std::string m_Name;
+
+	ViewEventQueue m_ViewEventQueue;
+	WebcamController m_WebcamController;
+};
@@ -3,6 +3,9 @@
 ImageTexture::ImageTexture()
 {
 	binded = false;
+	width = 0;
+	height = 0;
+	channels = 0;
 }
 
 ImageTexture::~ImageTexture()
@@ -22,23 +25,97 @@ void ImageTexture::release()
 }
 
 void ImageTexture::setImage(const cv::Mat* frame)
+{
+	// GL counts the row length in whole pixels, a stride that is not one is uploaded from a copy
+	cv::Mat continuousFrame;
+	if (frame->step % frame->elemSize() != 0)
+	{
+		continuousFrame = frame->clone();
+		frame = &continuousFrame;
+	}
+
+	if (binded && frame->cols == width && frame->rows == height && frame->channels() == channels)
+	{
+		updateTexture(frame);
+		return;
+	}
+
+	release();
+	createTexture(frame);
+}
+
+bool ImageTexture::isBinded() const
+{
+	return binded;
+}
+
+void ImageTexture::createTexture(const cv::Mat* frame)
 {
 	width = frame->cols;
 	height = frame->rows;
+	channels = frame->channels();
 
 	glGenTextures(1, &m_opengl_texture);
 	glBindTexture(GL_TEXTURE_2D, m_opengl_texture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	setUnpackLayout(frame);
+
+	if (channels == 1)
+	{
+		// Single plane (luma) frames are shown as gray without expanding them to BGR on the CPU
+		GLint swizzleMask[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
 
-	// Some environments do not support GP_BGR
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
-				 GL_BGR, GL_UNSIGNED_BYTE, frame->data);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0,
+					 GL_RED, GL_UNSIGNED_BYTE, frame->data);
+	}
+	else
+	{
+		// Some environments do not support GP_BGR
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+					 GL_BGR, GL_UNSIGNED_BYTE, frame->data);
+	}
+
+	resetUnpackLayout();
 
 	binded = true;
 }
 
+// Replaces the pixels without reallocating the texture storage
+void ImageTexture::updateTexture(const cv::Mat* frame)
+{
+	glBindTexture(GL_TEXTURE_2D, m_opengl_texture);
+	setUnpackLayout(frame);
+
+	if (channels == 1)
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+						GL_RED, GL_UNSIGNED_BYTE, frame->data);
+	}
+	else
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+						GL_BGR, GL_UNSIGNED_BYTE, frame->data);
+	}
+
+	resetUnpackLayout();
+}
+
+// BGR rows are rarely a multiple of 4 bytes and ROI crops keep the stride of the full frame
+void ImageTexture::setUnpackLayout(const cv::Mat* frame)
+{
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(frame->step / frame->elemSize()));
+}
+
+// Other uploads, e.g. the ImGui font atlas, expect the defaults
+void ImageTexture::resetUnpackLayout()
+{
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 void* ImageTexture::getOpenglTexture()
 {
 	return (void*)(intptr_t)m_opengl_texture;
@@ -48,3 +125,11 @@ ImVec2 ImageTexture::getSize()
 {
 	return ImVec2(static_cast<float>(width), static_cast<float>(height));
 }
+
+size_t ImageTexture::getBytes() const
+{
+	if (!binded)
+		return 0;
+
+	return static_cast<size_t>(width) * height * (channels == 1 ? 1 : 4);
+}
@@ -11,16 +11,31 @@ public:
 	ImageTexture();
 	~ImageTexture();
 
+	ImageTexture(const ImageTexture&) = delete;
+	ImageTexture& operator=(const ImageTexture&) = delete;
+
 	void release();
 
+	// A frame of the same size and format is uploaded into the texture it already has
 	void setImage(const cv::Mat* frame);
+	bool isBinded() const;
 
 	void* getOpenglTexture();
 	ImVec2 getSize();
+	// Storage on the GPU, color is stored as RGBA
+	size_t getBytes() const;
 
 private:
+	void createTexture(const cv::Mat* frame);
+	void updateTexture(const cv::Mat* frame);
+
+	// Rows are read with the stride of the frame, whatever their width or alignment
+	static void setUnpackLayout(const cv::Mat* frame);
+	static void resetUnpackLayout();
+
 	bool binded;
 	int width, height;
+	int channels;
 	GLuint m_opengl_texture;
 };
 
@@ -0,0 +1,366 @@
+#include "ThreadPlacement.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+#ifdef __linux__
+	// From linux/mempolicy.h, which is not installed everywhere
+	constexpr int memoryPolicyPreferred = 1;
+	constexpr unsigned long maxNumaNodes = 1024;
+
+	// Nice values of the priorities below realtime
+	int getNiceValue(ThreadPriorityEnum priority)
+	{
+		switch (priority)
+		{
+		case ThreadPriorityEnum::Low:
+			return 10;
+		case ThreadPriorityEnum::High:
+			return -10;
+		default:
+			return 0;
+		}
+	}
+#endif
+
+	const char* getPriorityName(ThreadPriorityEnum priority)
+	{
+		switch (priority)
+		{
+		case ThreadPriorityEnum::Low:
+			return "low";
+		case ThreadPriorityEnum::High:
+			return "high";
+		case ThreadPriorityEnum::Realtime:
+			return "realtime";
+		default:
+			return "normal";
+		}
+	}
+
+	bool parsePriority(const std::string& priorityName, ThreadPriorityEnum& priority)
+	{
+		for (ThreadPriorityEnum candidate : { ThreadPriorityEnum::Low, ThreadPriorityEnum::Normal, ThreadPriorityEnum::High, ThreadPriorityEnum::Realtime })
+		{
+			if (priorityName == getPriorityName(candidate))
+			{
+				priority = candidate;
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+
+bool ThreadPlacement::isDefault() const
+{
+	return cpus.empty() && priority == ThreadPriorityEnum::Normal && numaNode < 0;
+}
+
+ThreadPlacement ThreadPlacement::forThread(size_t threadIndex, size_t threadsCount) const
+{
+	ThreadPlacement threadPlacement = *this;
+
+	if (threadPlacement.cpus.empty() && numaNode >= 0)
+		threadPlacement.cpus = ThreadPlacementControl::getNumaNodeCpus(numaNode);
+
+	if (threadsCount > 1 && threadPlacement.cpus.size() >= threadsCount)
+		threadPlacement.cpus = { threadPlacement.cpus[threadIndex % threadPlacement.cpus.size()] };
+
+	return threadPlacement;
+}
+
+bool ThreadPlacements::isDefault() const
+{
+	return capture.isDefault() && workers.isDefault() && render.isDefault();
+}
+
+bool ThreadPlacements::parseArgument(const std::string& argument, const std::string& value)
+{
+	size_t separator = value.find('=');
+	if (!isPlacementArgument(argument) || separator == std::string::npos)
+		return false;
+
+	std::string roleName = value.substr(0, separator);
+	std::string roleValue = value.substr(separator + 1);
+
+	ThreadPlacement* threadPlacement = nullptr;
+	if (roleName == "capture")
+		threadPlacement = &capture;
+	else if (roleName == "workers")
+		threadPlacement = &workers;
+	else if (roleName == "render")
+		threadPlacement = &render;
+	else
+		return false;
+
+	if (argument == "--affinity")
+		return ThreadPlacementControl::parseCpuList(roleValue, threadPlacement->cpus);
+
+	if (argument == "--priority")
+		return parsePriority(roleValue, threadPlacement->priority);
+
+	char* valueEnd = nullptr;
+	long numaNode = std::strtol(roleValue.c_str(), &valueEnd, 10);
+	if (valueEnd == roleValue.c_str() || numaNode < 0)
+		return false;
+
+	threadPlacement->numaNode = static_cast<int>(numaNode);
+
+	return true;
+}
+
+bool ThreadPlacements::isPlacementArgument(const std::string& argument)
+{
+	return argument == "--affinity" || argument == "--priority" || argument == "--numa";
+}
+
+namespace ThreadPlacementControl
+{
+	void applyToCurrentThread(const std::string& threadName, const ThreadPlacement& threadPlacement)
+	{
+		if (threadPlacement.isDefault())
+			return;
+
+		std::vector<int> cpus = threadPlacement.cpus;
+		if (cpus.empty() && threadPlacement.numaNode >= 0)
+			cpus = getNumaNodeCpus(threadPlacement.numaNode);
+
+		std::ostringstream report;
+		report << "Thread " << threadName << ":";
+
+#ifdef _WIN32
+		HANDLE thread = GetCurrentThread();
+
+		// Windows schedules a thread within one processor group, CPUs of other groups are left out
+		if (cpus.empty() == false)
+		{
+			GROUP_AFFINITY groupAffinity = {};
+			groupAffinity.Group = static_cast<WORD>(cpus.front() / 64);
+
+			for (int cpu : cpus)
+			{
+				if (cpu / 64 == groupAffinity.Group)
+					groupAffinity.Mask |= KAFFINITY(1) << (cpu % 64);
+			}
+
+			if (!SetThreadGroupAffinity(thread, &groupAffinity, nullptr))
+				report << " affinity refused,";
+		}
+
+		int threadPriority = THREAD_PRIORITY_NORMAL;
+		if (threadPlacement.priority == ThreadPriorityEnum::Low)
+			threadPriority = THREAD_PRIORITY_BELOW_NORMAL;
+		else if (threadPlacement.priority == ThreadPriorityEnum::High)
+			threadPriority = THREAD_PRIORITY_ABOVE_NORMAL;
+		else if (threadPlacement.priority == ThreadPriorityEnum::Realtime)
+			threadPriority = THREAD_PRIORITY_TIME_CRITICAL;
+
+		if (!SetThreadPriority(thread, threadPriority))
+			report << " priority refused,";
+
+		// Memory comes from the node of the CPU that first touches it, pinning to the node's CPUs places the buffers
+		GROUP_AFFINITY effectiveAffinity = {};
+		GetThreadGroupAffinity(thread, &effectiveAffinity);
+
+		std::vector<int> effectiveCpus;
+		for (int bit = 0; bit < 64; bit++)
+		{
+			if (effectiveAffinity.Mask & (KAFFINITY(1) << bit))
+				effectiveCpus.push_back(effectiveAffinity.Group * 64 + bit);
+		}
+
+		report << " cpus " << formatCpuList(effectiveCpus) << ", priority " << GetThreadPriority(thread);
+#elif defined(__linux__)
+		pthread_t thread = pthread_self();
+		pid_t threadId = static_cast<pid_t>(syscall(SYS_gettid));
+
+		if (cpus.empty() == false)
+		{
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+
+			for (int cpu : cpus)
+			{
+				if (cpu < CPU_SETSIZE)
+					CPU_SET(cpu, &cpuSet);
+			}
+
+			if (pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet) != 0)
+				report << " affinity refused,";
+		}
+
+		if (threadPlacement.priority == ThreadPriorityEnum::Realtime)
+		{
+			sched_param schedulingParameters = {};
+			schedulingParameters.sched_priority = sched_get_priority_min(SCHED_FIFO) + 9;
+
+			if (pthread_setschedparam(thread, SCHED_FIFO, &schedulingParameters) != 0)
+				report << " realtime priority refused,";
+		}
+		else if (setpriority(PRIO_PROCESS, static_cast<id_t>(threadId), getNiceValue(threadPlacement.priority)) != 0)
+		{
+			report << " priority refused,";
+		}
+
+		// Pages are placed when first touched, the policy applies to buffers the thread allocates and fills from now on
+		if (threadPlacement.numaNode >= 0)
+		{
+			std::vector<unsigned long> nodeMask(maxNumaNodes / (8 * sizeof(unsigned long)), 0);
+			const size_t bitsPerWord = 8 * sizeof(unsigned long);
+
+			if (static_cast<size_t>(threadPlacement.numaNode) < maxNumaNodes)
+				nodeMask[threadPlacement.numaNode / bitsPerWord] |= 1ul << (threadPlacement.numaNode % bitsPerWord);
+
+			if (syscall(SYS_set_mempolicy, memoryPolicyPreferred, nodeMask.data(), maxNumaNodes + 1) != 0)
+				report << " memory node refused,";
+		}
+
+		cpu_set_t effectiveCpuSet;
+		std::vector<int> effectiveCpus;
+		if (pthread_getaffinity_np(thread, sizeof(effectiveCpuSet), &effectiveCpuSet) == 0)
+		{
+			for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			{
+				if (CPU_ISSET(cpu, &effectiveCpuSet))
+					effectiveCpus.push_back(cpu);
+			}
+		}
+
+		int schedulingPolicy = SCHED_OTHER;
+		sched_param schedulingParameters = {};
+		pthread_getschedparam(thread, &schedulingPolicy, &schedulingParameters);
+
+		report << " cpus " << formatCpuList(effectiveCpus);
+
+		if (schedulingPolicy == SCHED_FIFO)
+			report << ", SCHED_FIFO " << schedulingParameters.sched_priority;
+		else
+			report << ", nice " << getpriority(PRIO_PROCESS, static_cast<id_t>(threadId));
+
+		if (threadPlacement.numaNode >= 0)
+		{
+			int memoryPolicy = 0;
+			std::vector<unsigned long> nodeMask(maxNumaNodes / (8 * sizeof(unsigned long)), 0);
+
+			if (syscall(SYS_get_mempolicy, &memoryPolicy, nodeMask.data(), maxNumaNodes + 1, nullptr, 0) == 0 && memoryPolicy == memoryPolicyPreferred)
+				report << ", memory node " << threadPlacement.numaNode;
+			else
+				report << ", memory from any node";
+		}
+#else
+		report << " placement is not supported on this platform, requested " << formatCpuList(cpus)
+			<< " at " << getPriorityName(threadPlacement.priority) << " priority";
+#endif
+
+		report << "\n";
+		std::cout << report.str();
+	}
+
+	std::vector<int> getNumaNodeCpus(int numaNode)
+	{
+		std::vector<int> cpus;
+
+#ifdef _WIN32
+		GROUP_AFFINITY groupAffinity = {};
+		if (GetNumaNodeProcessorMaskEx(static_cast<USHORT>(numaNode), &groupAffinity))
+		{
+			for (int bit = 0; bit < 64; bit++)
+			{
+				if (groupAffinity.Mask & (KAFFINITY(1) << bit))
+					cpus.push_back(groupAffinity.Group * 64 + bit);
+			}
+		}
+#else
+		std::ifstream cpuListFile("/sys/devices/system/node/node" + std::to_string(numaNode) + "/cpulist");
+		std::string cpuList;
+
+		if (std::getline(cpuListFile, cpuList))
+			parseCpuList(cpuList, cpus);
+#endif
+
+		return cpus;
+	}
+
+	// Consecutive CPUs as ranges, e.g. 0-3,8
+	std::string formatCpuList(const std::vector<int>& cpus)
+	{
+		if (cpus.empty())
+			return "none";
+
+		std::ostringstream cpuList;
+
+		for (size_t i = 0; i < cpus.size(); i++)
+		{
+			size_t rangeEnd = i;
+			while (rangeEnd + 1 < cpus.size() && cpus[rangeEnd + 1] == cpus[rangeEnd] + 1)
+			{
+				rangeEnd++;
+			}
+
+			if (i > 0)
+				cpuList << ",";
+
+			cpuList << cpus[i];
+			if (rangeEnd > i)
+				cpuList << "-" << cpus[rangeEnd];
+
+			i = rangeEnd;
+		}
+
+		return cpuList.str();
+	}
+
+	bool parseCpuList(const std::string& cpuList, std::vector<int>& cpus)
+	{
+		std::stringstream ranges(cpuList);
+		std::string range;
+
+		cpus.clear();
+
+		while (std::getline(ranges, range, ','))
+		{
+			char* valueEnd = nullptr;
+			long first = std::strtol(range.c_str(), &valueEnd, 10);
+			if (valueEnd == range.c_str() || first < 0)
+				return false;
+
+			long last = first;
+			if (*valueEnd == '-')
+			{
+				const char* lastStart = valueEnd + 1;
+				last = std::strtol(lastStart, &valueEnd, 10);
+				if (valueEnd == lastStart || last < first)
+					return false;
+			}
+
+			for (long cpu = first; cpu <= last; cpu++)
+			{
+				cpus.push_back(static_cast<int>(cpu));
+			}
+		}
+
+		std::sort(cpus.begin(), cpus.end());
+		cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+		return cpus.empty() == false;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+enum class ThreadRoleEnum
+{
+	// One capture thread per stream
+	Capture,
+	// The worker pool
+	Workers,
+	// The SDL/ImGui loop of the view, the presenting thread of the headless run
+	Render
+};
+
+enum class ThreadPriorityEnum
+{
+	Low,
+	Normal,
+	High,
+	// SCHED_FIFO on Linux, time critical on Windows
+	Realtime
+};
+
+// CPUs, scheduling priority and memory node of the threads of one role.
+// A default placement leaves the threads as the system starts them.
+struct ThreadPlacement
+{
+	// Empty is every CPU, or every CPU of the NUMA node when one is given
+	std::vector<int> cpus;
+	ThreadPriorityEnum priority = ThreadPriorityEnum::Normal;
+	// Frame buffers allocated by the threads prefer this node, -1 is the system's choice
+	int numaNode = -1;
+
+	bool isDefault() const;
+
+	// Several threads of a role get a CPU each while there are enough, otherwise they share all of them. A single thread gets all of them.
+	ThreadPlacement forThread(size_t threadIndex, size_t threadsCount) const;
+};
+
+struct ThreadPlacements
+{
+	ThreadPlacement capture;
+	ThreadPlacement workers;
+	ThreadPlacement render;
+
+	bool isDefault() const;
+
+	// "--affinity <role>=<cpus>" with cpus like 2-5,8, "--priority <role>=low|normal|high|realtime" and "--numa <role>=<node>",
+	// a role is capture, workers or render. Returns false for another argument or an invalid value.
+	bool parseArgument(const std::string& argument, const std::string& value);
+	static bool isPlacementArgument(const std::string& argument);
+};
+
+namespace ThreadPlacementControl
+{
+	// Moves the calling thread and prints the CPUs, priority and memory node it actually got, a default placement does nothing.
+	// Settings the system refuses, e.g. a raised priority without the privilege, are reported and the rest is kept.
+	void applyToCurrentThread(const std::string& threadName, const ThreadPlacement& threadPlacement);
+
+	std::vector<int> getNumaNodeCpus(int numaNode);
+	std::string formatCpuList(const std::vector<int>& cpus);
+	bool parseCpuList(const std::string& cpuList, std::vector<int>& cpus);
+}
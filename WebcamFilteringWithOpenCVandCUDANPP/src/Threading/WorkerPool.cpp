@@ -0,0 +1,296 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+
+namespace
+{
+	// A lane may run deadline tasks ahead of the others by at most this much worker time
+	constexpr double maxDeadlineLeadSeconds = 0.050;
+
+	thread_local int threadLane = 0;
+	thread_local WorkerPool::Clock::time_point threadDeadline = WorkerPool::Clock::time_point::max();
+
+	MetricsCounter& getMissedDeadlinesCounter(int lane)
+	{
+		return MetricsRegistry::getInstance().getCounter("webcam_worker_missed_deadline_tasks_total",
+			"Tasks that finished after their stream's frame deadline", { { "lane", std::to_string(lane) } });
+	}
+}
+
+
+WorkerPool::WorkerPool(unsigned int threadCount) :
+	m_Lanes(1),
+	m_QueuedTasksCount(0),
+	m_ThreadPlacementVersion(0),
+	m_MetricsCollector([this]() { collectMetrics(); })
+{
+	if (threadCount == 0)
+		threadCount = 1;
+
+	m_Lanes[0].missedDeadlinesCounter = &getMissedDeadlinesCounter(0);
+
+	m_Workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_Workers.emplace_back([this, i](std::stop_token stopToken) { workerThread(stopToken, i); });
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	for (auto& worker : m_Workers)
+	{
+		worker.request_stop();
+	}
+
+	m_TasksCondition.notify_all();
+}
+
+unsigned int WorkerPool::getThreadCount() const
+{
+	return static_cast<unsigned int>(m_Workers.size());
+}
+
+void WorkerPool::setThreadPlacement(const ThreadPlacement& threadPlacement)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_TasksMutex);
+
+		m_ThreadPlacement = threadPlacement;
+		m_ThreadPlacementVersion++;
+	}
+
+	m_TasksCondition.notify_all();
+}
+
+int WorkerPool::createLane()
+{
+	std::lock_guard<std::mutex> lock(m_TasksMutex);
+
+	m_Lanes.emplace_back();
+	m_Lanes.back().missedDeadlinesCounter = &getMissedDeadlinesCounter(static_cast<int>(m_Lanes.size() - 1));
+
+	return static_cast<int>(m_Lanes.size() - 1);
+}
+
+WorkerPoolLaneStats WorkerPool::getLaneStats(int lane) const
+{
+	std::lock_guard<std::mutex> lock(m_TasksMutex);
+
+	return m_Lanes.at(lane).stats;
+}
+
+void WorkerPool::setThreadLane(int lane)
+{
+	threadLane = lane;
+}
+
+int WorkerPool::getThreadLane()
+{
+	return threadLane;
+}
+
+void WorkerPool::setThreadDeadline(Clock::time_point deadline)
+{
+	threadDeadline = deadline;
+}
+
+WorkerPool::ScopedLane::ScopedLane(int lane) :
+	m_PreviousLane(threadLane),
+	m_PreviousDeadline(threadDeadline)
+{
+	threadLane = lane;
+	threadDeadline = Clock::time_point::max();
+}
+
+WorkerPool::ScopedLane::~ScopedLane()
+{
+	threadLane = m_PreviousLane;
+	threadDeadline = m_PreviousDeadline;
+}
+
+void WorkerPool::parallelFor(int begin, int end, const std::function<void(int stripBegin, int stripEnd)>& stripFunction)
+{
+	parallelFor(begin, end, 0, stripFunction);
+}
+
+void WorkerPool::parallelFor(int begin, int end, int stripsCount, const std::function<void(int stripBegin, int stripEnd)>& stripFunction)
+{
+	int count = end - begin;
+	if (count <= 0)
+		return;
+
+	int stripCount = std::min(count, stripsCount > 0 ? stripsCount : static_cast<int>(getThreadCount()));
+	if (stripCount == 1)
+	{
+		stripFunction(begin, end);
+		return;
+	}
+
+	std::vector<std::future<void>> strips;
+	strips.reserve(stripCount - 1);
+
+	for (int strip = 1; strip < stripCount; strip++)
+	{
+		int stripBegin = begin + count * strip / stripCount;
+		int stripEnd = begin + count * (strip + 1) / stripCount;
+
+		strips.push_back(submit([&stripFunction, stripBegin, stripEnd]() { stripFunction(stripBegin, stripEnd); }));
+	}
+
+	// The calling thread takes the first strip instead of idling
+	stripFunction(begin, begin + count / stripCount);
+
+	for (auto& strip : strips)
+	{
+		strip.get();
+	}
+}
+
+void WorkerPool::pushTask(std::function<void()> function)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_TasksMutex);
+
+		// Lanes are numbered per pool. A thread on a lane of another pool, e.g. a stream's capture thread submitting
+		// to the tuner's pool, queues on lane 0 here and its deadline is not one of this pool's either.
+		bool ownLane = threadLane >= 0 && static_cast<size_t>(threadLane) < m_Lanes.size();
+		int laneIndex = ownLane ? threadLane : 0;
+		Clock::time_point deadline = ownLane ? threadDeadline : Clock::time_point::max();
+
+		Lane& lane = m_Lanes[laneIndex];
+
+		// A lane coming back from idle starts level with the busy ones instead of cashing in its idle time
+		if (lane.tasks.empty())
+		{
+			double minVirtualSeconds = -1.0;
+			for (const Lane& otherLane : m_Lanes)
+			{
+				if (otherLane.tasks.empty() == false && (minVirtualSeconds < 0.0 || otherLane.virtualSeconds < minVirtualSeconds))
+					minVirtualSeconds = otherLane.virtualSeconds;
+			}
+
+			lane.virtualSeconds = std::max(lane.virtualSeconds, minVirtualSeconds);
+		}
+
+		lane.tasks.push_back({ std::move(function), laneIndex, deadline });
+		m_QueuedTasksCount++;
+	}
+
+	m_TasksCondition.notify_one();
+}
+
+// Called with m_TasksMutex held and at least one task queued
+WorkerPool::Task WorkerPool::popNextTask()
+{
+	Clock::time_point now = Clock::now();
+
+	Lane* fairestLane = nullptr;
+	for (Lane& lane : m_Lanes)
+	{
+		if (lane.tasks.empty() == false && (fairestLane == nullptr || lane.virtualSeconds < fairestLane->virtualSeconds))
+			fairestLane = &lane;
+	}
+
+	Lane* nextLane = fairestLane;
+	Clock::time_point earliestDeadline = Clock::time_point::max();
+
+	for (Lane& lane : m_Lanes)
+	{
+		if (lane.tasks.empty() || lane.virtualSeconds > fairestLane->virtualSeconds + maxDeadlineLeadSeconds)
+			continue;
+
+		Clock::time_point deadline = lane.tasks.front().deadline;
+		if (deadline >= now && deadline < earliestDeadline)
+		{
+			earliestDeadline = deadline;
+			nextLane = &lane;
+		}
+	}
+
+	Task task = std::move(nextLane->tasks.front());
+	nextLane->tasks.pop_front();
+	m_QueuedTasksCount--;
+
+	return task;
+}
+
+void WorkerPool::workerThread(std::stop_token stopToken, unsigned int workerIndex)
+{
+	uint64_t appliedPlacementVersion = 0;
+
+	while (true)
+	{
+		Task task;
+		ThreadPlacement threadPlacement;
+		bool placementChanged = false;
+
+		{
+			std::unique_lock<std::mutex> lock(m_TasksMutex);
+			m_TasksCondition.wait(lock, stopToken, [this, &appliedPlacementVersion]()
+			{
+				return m_QueuedTasksCount > 0 || m_ThreadPlacementVersion != appliedPlacementVersion;
+			});
+
+			if (m_ThreadPlacementVersion != appliedPlacementVersion)
+			{
+				appliedPlacementVersion = m_ThreadPlacementVersion;
+				threadPlacement = m_ThreadPlacement.forThread(workerIndex, m_Workers.size());
+				placementChanged = true;
+			}
+			// Pending tasks are still drained on shutdown so no future is left without a value
+			else if (m_QueuedTasksCount == 0)
+			{
+				return;
+			}
+			else
+			{
+				task = popNextTask();
+			}
+		}
+
+		if (placementChanged)
+		{
+			ThreadPlacementControl::applyToCurrentThread("worker " + std::to_string(workerIndex), threadPlacement);
+			continue;
+		}
+
+		threadLane = task.lane;
+		threadDeadline = task.deadline;
+
+		Clock::time_point startTime = Clock::now();
+		task.function();
+		Clock::time_point endTime = Clock::now();
+
+		{
+			std::lock_guard<std::mutex> lock(m_TasksMutex);
+
+			Lane& lane = m_Lanes[task.lane];
+			double taskSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+			lane.virtualSeconds += taskSeconds;
+			lane.stats.busySeconds += taskSeconds;
+			lane.stats.executedTasksCount++;
+
+			if (endTime > task.deadline)
+			{
+				lane.stats.missedDeadlineTasksCount++;
+				lane.missedDeadlinesCounter->add();
+			}
+		}
+	}
+}
+
+void WorkerPool::collectMetrics() const
+{
+	MetricsRegistry& metricsRegistry = MetricsRegistry::getInstance();
+
+	std::lock_guard<std::mutex> lock(m_TasksMutex);
+
+	for (size_t i = 0; i < m_Lanes.size(); i++)
+	{
+		metricsRegistry.getGauge("webcam_worker_queued_tasks", "Tasks waiting for a worker", { { "lane", std::to_string(i) } })
+			.set(static_cast<double>(m_Lanes[i].tasks.size()));
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Metrics/MetricsRegistry.h"
+#include "ThreadPlacement.h"
+
+
+struct WorkerPoolLaneStats
+{
+	double busySeconds;
+	uint64_t executedTasksCount;
+	uint64_t missedDeadlineTasksCount;
+};
+
+// Tasks are queued per lane, every stream sharing the pool gets its own lane.
+// A task belongs to the lane and deadline of the thread that submits it, so strips of a parallelFor
+// and tasks submitted from inside a task follow the stream that started them.
+// Tasks whose deadline can still be met run earliest deadline first, as long as their lane is not
+// ahead of its fair share of worker time. Everything else runs by fair share, so a stream that keeps
+// missing its deadlines cannot starve the others.
+class WorkerPool
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit WorkerPool(unsigned int threadCount = std::thread::hardware_concurrency());
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	template<typename Function>
+	std::future<std::invoke_result_t<Function>> submit(Function&& function);
+
+	// Splits [begin, end) into one strip per worker and blocks until all strips are done.
+	// Must not be called from a worker thread.
+	void parallelFor(int begin, int end, const std::function<void(int stripBegin, int stripEnd)>& stripFunction);
+	// Same with a given number of strips, 0 is one per worker, more strips than workers balance uneven rows
+	void parallelFor(int begin, int end, int stripsCount, const std::function<void(int stripBegin, int stripEnd)>& stripFunction);
+
+	unsigned int getThreadCount() const;
+
+	// Every worker moves itself before its next task, a worker gets a CPU of its own while the placement has enough
+	void setThreadPlacement(const ThreadPlacement& threadPlacement);
+
+	// Lane 0 is shared by threads that never set one, or whose lane belongs to another pool
+	int createLane();
+	WorkerPoolLaneStats getLaneStats(int lane) const;
+
+	// Sets the lane and deadline of tasks submitted by the calling thread
+	static void setThreadLane(int lane);
+	static int getThreadLane();
+	static void setThreadDeadline(Clock::time_point deadline);
+
+	// Switches the calling thread to a lane for the lifetime of the object
+	class ScopedLane
+	{
+	public:
+		explicit ScopedLane(int lane);
+		~ScopedLane();
+
+	private:
+		int m_PreviousLane;
+		Clock::time_point m_PreviousDeadline;
+	};
+
+private:
+	struct Task
+	{
+		std::function<void()> function;
+		int lane;
+		Clock::time_point deadline;
+	};
+
+	struct Lane
+	{
+		std::deque<Task> tasks;
+
+		// Worker time used so far, the lane with the least time is next in line
+		double virtualSeconds = 0.0;
+
+		WorkerPoolLaneStats stats = {};
+		MetricsCounter* missedDeadlinesCounter = nullptr;
+	};
+
+	void pushTask(std::function<void()> function);
+	Task popNextTask();
+
+	void workerThread(std::stop_token stopToken, unsigned int workerIndex);
+
+	void collectMetrics() const;
+
+	mutable std::mutex m_TasksMutex;
+	std::condition_variable_any m_TasksCondition;
+	std::vector<Lane> m_Lanes;
+	size_t m_QueuedTasksCount;
+
+	// Workers compare the version with the one they applied
+	ThreadPlacement m_ThreadPlacement;
+	uint64_t m_ThreadPlacementVersion;
+
+	std::vector<std::jthread> m_Workers;
+
+	// Declared last, so it is unregistered before the lanes go away
+	MetricsCollector m_MetricsCollector;
+};
+
+template<typename Function>
+std::future<std::invoke_result_t<Function>> WorkerPool::submit(Function&& function)
+{
+	using ResultType = std::invoke_result_t<Function>;
+
+	// packaged_task is move only, std::function needs a copyable target
+	auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+	std::future<ResultType> result = task->get_future();
+
+	pushTask([task]() { (*task)(); });
+
+	return result;
+}
@@ -0,0 +1,423 @@
+#include "AutoTuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <system_error>
+
+#include <opencv4/opencv2/imgproc.hpp>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "Filters/FilterNames.h"
+#include "Filters/FilterTraits.h"
+#include "Filters/Stages/FilterStageFactory.h"
+#include "Pipeline/DirtyTileDetector.h"
+#include "Threading/WorkerPool.h"
+
+
+namespace
+{
+	// Part of the cache key, bump it when a tuned kernel changes
+	constexpr int kernelsVersion = 2;
+
+	constexpr int warmupPassesCount = 2;
+	constexpr int measuredPassesCount = 7;
+
+	// A candidate has to beat the default by this much, timing noise alone does not change the configuration
+	constexpr double requiredSpeedup = 1.05;
+
+	const char* tileDetectionKernelName = "TileDetection";
+
+	uint64_t hashCacheKey(const std::string& cacheKey)
+	{
+		// FNV-1a, stable across runs and compilers unlike std::hash
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned char character : cacheKey)
+		{
+			hash ^= character;
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	const char* getSimdVariantName(SimdVariantEnum simdVariant)
+	{
+		return simdVariant == SimdVariantEnum::Sse2 ? "Sse2" : "Scalar";
+	}
+
+	bool parseSimdVariant(const std::string& variantName, SimdVariantEnum& simdVariant)
+	{
+		if (variantName == "Sse2")
+			simdVariant = SimdVariantEnum::Sse2;
+		else if (variantName == "Scalar")
+			simdVariant = SimdVariantEnum::Scalar;
+		else
+			return false;
+
+		// A cache written by a build with SSE2 is keyed apart, this only guards hand edited files
+		return simdVariant != SimdVariantEnum::Sse2 || SIMD_SSE2_AVAILABLE;
+	}
+
+	// Smooth noise, and the same moved by a few pixels, so block matching and tile detection have work on every pass
+	void makeCalibrationFrames(const cv::Size& frameSize, int type, cv::Mat (&frames)[2])
+	{
+		cv::Mat noise(frameSize, type);
+		cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(255));
+		cv::GaussianBlur(noise, frames[0], cv::Size(7, 7), 2.0);
+
+		frames[1] = frames[0].clone();
+
+		cv::Rect movedRect(3, 2, frameSize.width - 3, frameSize.height - 2);
+		frames[0](movedRect).copyTo(frames[1](cv::Rect(0, 0, movedRect.width, movedRect.height)));
+	}
+
+	// Fastest of the measured passes, slower ones were interrupted by something else
+	double measureBestPassSeconds(const std::function<void(int pass)>& runPass)
+	{
+		for (int pass = 0; pass < warmupPassesCount; pass++)
+		{
+			runPass(pass);
+		}
+
+		double bestSeconds = std::numeric_limits<double>::max();
+
+		for (int pass = 0; pass < measuredPassesCount; pass++)
+		{
+			auto passStartTime = std::chrono::steady_clock::now();
+			runPass(warmupPassesCount + pass);
+			bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - passStartTime).count());
+		}
+
+		return bestSeconds;
+	}
+}
+
+
+AutoTuner::AutoTuner(WorkerPool& workerPool, std::filesystem::path directory) :
+	m_WorkerPool(workerPool),
+	m_Directory(std::move(directory))
+{
+}
+
+KernelTunings AutoTuner::getTunings(const cv::Size& frameSize, bool tune)
+{
+	// Too small to hold the calibration frames
+	if (frameSize.width < 16 || frameSize.height < 16)
+		return KernelTunings();
+
+	const std::string cacheKey = getCacheKey(frameSize);
+
+	std::lock_guard<std::mutex> lock(m_TuningsMutex);
+
+	auto cachedTunings = m_Tunings.find(cacheKey);
+	if (cachedTunings != m_Tunings.end() && (!tune || cachedTunings->second.calibrated))
+		return cachedTunings->second.kernelTunings;
+
+	KernelTunings kernelTunings;
+
+	if (tune)
+	{
+		kernelTunings = calibrate(frameSize);
+		saveToDisk(cacheKey, kernelTunings);
+	}
+	else if (loadFromDisk(cacheKey, kernelTunings))
+	{
+		std::cout << "Loaded CPU kernel tunings for " << frameSize.width << "x" << frameSize.height << " from " << getFilePath(cacheKey).string() << "\n";
+	}
+
+	m_Tunings[cacheKey] = { kernelTunings, tune };
+
+	return kernelTunings;
+}
+
+std::string AutoTuner::getCpuModel()
+{
+	std::string cpuModel;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int registers[4] = {};
+	char brand[49] = {};
+
+	__cpuid(registers, 0x80000000);
+	if (static_cast<unsigned int>(registers[0]) >= 0x80000004)
+	{
+		for (int leaf = 0; leaf < 3; leaf++)
+		{
+			__cpuid(registers, 0x80000002 + leaf);
+			std::memcpy(brand + leaf * 16, registers, 16);
+		}
+	}
+
+	cpuModel = brand;
+#elif defined(__x86_64__) || defined(__i386__)
+	unsigned int registers[4] = {};
+	char brand[49] = {};
+
+	if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004)
+	{
+		for (unsigned int leaf = 0; leaf < 3; leaf++)
+		{
+			__get_cpuid(0x80000002 + leaf, &registers[0], &registers[1], &registers[2], &registers[3]);
+			std::memcpy(brand + leaf * 16, registers, 16);
+		}
+	}
+
+	cpuModel = brand;
+#else
+	// Other architectures name the CPU in /proc/cpuinfo on Linux
+	std::ifstream cpuInfo("/proc/cpuinfo");
+	std::string line;
+	while (cpuModel.empty() && std::getline(cpuInfo, line))
+	{
+		if (line.rfind("model name", 0) == 0 || line.rfind("Model", 0) == 0 || line.rfind("CPU part", 0) == 0)
+			cpuModel = line.substr(line.find(':') + 1);
+	}
+#endif
+
+	// The brand string is padded with spaces
+	cpuModel.erase(0, cpuModel.find_first_not_of(' '));
+	cpuModel.erase(cpuModel.find_last_not_of(' ') + 1);
+
+	return cpuModel.empty() ? "unknown" : cpuModel;
+}
+
+// Compiler, optimization and instruction set flags, what changes the generated kernels
+std::string AutoTuner::getBuildId()
+{
+	std::string buildId;
+
+#if defined(_MSC_FULL_VER)
+	buildId += "msvc " + std::to_string(_MSC_FULL_VER);
+#elif defined(__clang__)
+	buildId += "clang " __clang_version__;
+#elif defined(__GNUC__)
+	buildId += "gcc " __VERSION__;
+#else
+	buildId += "unknown compiler";
+#endif
+
+#if defined(NDEBUG)
+	buildId += " release";
+#else
+	buildId += " debug";
+#endif
+
+#if defined(__AVX2__)
+	buildId += " avx2";
+#elif defined(__AVX__)
+	buildId += " avx";
+#endif
+
+	buildId += SIMD_SSE2_AVAILABLE ? " sse2" : " scalar";
+
+	return buildId;
+}
+
+std::string AutoTuner::getCacheKey(const cv::Size& frameSize) const
+{
+	std::ostringstream cacheKey;
+	cacheKey << "v" << kernelsVersion << "|" << getCpuModel() << "|" << frameSize.width << "x" << frameSize.height
+			 << "|" << m_WorkerPool.getThreadCount() << " workers|" << getBuildId();
+
+	return cacheKey.str();
+}
+
+std::filesystem::path AutoTuner::getFilePath(const std::string& cacheKey) const
+{
+	std::ostringstream fileName;
+	fileName << std::hex << std::setw(16) << std::setfill('0') << hashCacheKey(cacheKey) << ".tuning";
+
+	return m_Directory / fileName.str();
+}
+
+// One line with the full key, then "<kernel> <strips count> <SIMD variant>" per tuned kernel
+bool AutoTuner::loadFromDisk(const std::string& cacheKey, KernelTunings& kernelTunings) const
+{
+	std::ifstream file(getFilePath(cacheKey));
+	if (!file)
+		return false;
+
+	// The full key is stored to rule out hash collisions
+	std::string storedKey;
+	if (!std::getline(file, storedKey) || storedKey != cacheKey)
+		return false;
+
+	KernelTunings loadedTunings;
+	std::string kernelName;
+	std::string variantName;
+	KernelTuning kernelTuning;
+
+	while (file >> kernelName >> kernelTuning.stripsCount >> variantName)
+	{
+		if (kernelTuning.stripsCount < 0 || !parseSimdVariant(variantName, kernelTuning.simdVariant))
+			return false;
+
+		FilterTypeEnum filterType;
+		if (kernelName == tileDetectionKernelName)
+			loadedTunings.tileDetectionTuning = kernelTuning;
+		else if (parseFilterType(kernelName, filterType))
+			loadedTunings.filterTunings[filterType] = kernelTuning;
+		else
+			return false;
+	}
+
+	if (!file.eof())
+		return false;
+
+	kernelTunings = loadedTunings;
+	return true;
+}
+
+void AutoTuner::saveToDisk(const std::string& cacheKey, const KernelTunings& kernelTunings) const
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(m_Directory, errorCode);
+
+	const std::filesystem::path filePath = getFilePath(cacheKey);
+	std::filesystem::path temporaryPath = filePath;
+	temporaryPath += ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::trunc);
+
+		file << cacheKey << "\n";
+		file << tileDetectionKernelName << " " << kernelTunings.tileDetectionTuning.stripsCount << " "
+			 << getSimdVariantName(kernelTunings.tileDetectionTuning.simdVariant) << "\n";
+
+		for (const auto& filterTuning : kernelTunings.filterTunings)
+		{
+			file << getFilterTypeName(filterTuning.first) << " " << filterTuning.second.stripsCount << " "
+				 << getSimdVariantName(filterTuning.second.simdVariant) << "\n";
+		}
+
+		if (!file)
+		{
+			std::cout << "Warning: Could not write kernel tunings " << temporaryPath.string() << "\n";
+			file.close();
+			std::filesystem::remove(temporaryPath, errorCode);
+			return;
+		}
+	}
+
+	// Readers never see a partially written file
+	std::filesystem::rename(temporaryPath, filePath, errorCode);
+}
+
+KernelTunings AutoTuner::calibrate(const cv::Size& frameSize)
+{
+	std::cout << "Tuning CPU kernels for " << frameSize.width << "x" << frameSize.height << " on " << getCpuModel()
+			  << ", " << m_WorkerPool.getThreadCount() << " workers\n";
+
+	// Tile detection sees the camera frame, the CPU filters its luma plane
+	cv::Mat cameraFrames[2];
+	cv::Mat lumaFrames[2];
+	makeCalibrationFrames(frameSize, CV_8UC3, cameraFrames);
+	makeCalibrationFrames(frameSize, CV_8UC1, lumaFrames);
+
+	KernelTunings kernelTunings;
+
+	kernelTunings.tileDetectionTuning = calibrateKernel(tileDetectionKernelName, [&](const KernelTuning& kernelTuning)
+	{
+		DirtyTileDetector dirtyTileDetector(m_WorkerPool);
+		dirtyTileDetector.setKernelTuning(kernelTuning);
+		dirtyTileDetector.detect(cameraFrames[1]);
+
+		return measureBestPassSeconds([&](int pass) { dirtyTileDetector.detect(cameraFrames[pass % 2]); });
+	});
+
+	// Only the CPU stages are tuned, they read nothing but the luma plane
+	YuvFrame unusedYuvFrame;
+	const std::vector<cv::Rect> wholeFrameRects = { cv::Rect(cv::Point(), frameSize) };
+	const FilterStageInput lumaInputs[2] = { { unusedYuvFrame, lumaFrames[0], wholeFrameRects }, { unusedYuvFrame, lumaFrames[1], wholeFrameRects } };
+
+	for (FilterTypeEnum filterType : allFilterTypes)
+	{
+		if (!getFilterTraits(filterType).cpuLuma)
+			continue;
+
+		kernelTunings.filterTunings[filterType] = calibrateKernel(getFilterTypeName(filterType), [&](const KernelTuning& kernelTuning)
+		{
+			std::unique_ptr<FilterStage> filterStage = FilterStageFactory::createFilterStage(filterType, m_WorkerPool);
+			filterStage->setKernelTuning(kernelTuning);
+			filterStage->generate(lumaInputs[1], false);
+
+			return measureBestPassSeconds([&](int pass) { filterStage->generate(lumaInputs[pass % 2], false); });
+		});
+	}
+
+	return kernelTunings;
+}
+
+KernelTuning AutoTuner::calibrateKernel(const std::string& kernelName, const std::function<double(const KernelTuning&)>& measureSeconds) const
+{
+	const KernelTuning defaultTuning;
+	const double defaultSeconds = measureSeconds(defaultTuning);
+
+	KernelTuning bestTuning = defaultTuning;
+	double bestSeconds = defaultSeconds / requiredSpeedup;
+
+	for (const KernelTuning& candidate : getCandidates())
+	{
+		double candidateSeconds = measureSeconds(candidate);
+
+		if (candidateSeconds < bestSeconds)
+		{
+			bestTuning = candidate;
+			bestSeconds = candidateSeconds;
+		}
+	}
+
+	if (bestTuning.stripsCount == defaultTuning.stripsCount && bestTuning.simdVariant == defaultTuning.simdVariant)
+		bestSeconds = defaultSeconds;
+
+	std::cout << "  " << kernelName << ": " << (bestTuning.stripsCount == 0 ? m_WorkerPool.getThreadCount() : bestTuning.stripsCount)
+			  << " strips, " << getSimdVariantName(bestTuning.simdVariant) << ", " << std::fixed << std::setprecision(2)
+			  << bestSeconds * 1000.0 << " ms (default " << defaultSeconds * 1000.0 << " ms)\n" << std::defaultfloat;
+
+	return bestTuning;
+}
+
+// Strip counts from the calling thread alone to several strips per worker, with every SIMD variant of the build
+std::vector<KernelTuning> AutoTuner::getCandidates() const
+{
+	const int threadCount = static_cast<int>(m_WorkerPool.getThreadCount());
+
+	std::vector<int> stripsCounts = { 1, threadCount / 2, threadCount, threadCount * 2, threadCount * 4 };
+	std::sort(stripsCounts.begin(), stripsCounts.end());
+	stripsCounts.erase(std::unique(stripsCounts.begin(), stripsCounts.end()), stripsCounts.end());
+
+	std::vector<SimdVariantEnum> simdVariants = { SimdVariantEnum::Scalar };
+	if (SIMD_SSE2_AVAILABLE)
+		simdVariants.push_back(SimdVariantEnum::Sse2);
+
+	std::vector<KernelTuning> candidates;
+
+	for (int stripsCount : stripsCounts)
+	{
+		if (stripsCount < 1)
+			continue;
+
+		for (SimdVariantEnum simdVariant : simdVariants)
+		{
+			// One strip per worker with the default variant is the default, measured already
+			if (stripsCount == threadCount && simdVariant == defaultSimdVariant)
+				continue;
+
+			candidates.push_back({ stripsCount, simdVariant });
+		}
+	}
+
+	return candidates;
+}
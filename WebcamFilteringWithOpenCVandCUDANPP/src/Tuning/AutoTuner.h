@@ -0,0 +1,56 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv4/opencv2/core/mat.hpp>
+
+#include "KernelTuning.h"
+
+class WorkerPool;
+
+
+// Picks the strip count and SIMD variant of every CPU kernel by timing short calibration passes
+// on synthetic frames of the capture size. The choice is cached in a directory, one file per CPU model,
+// frame size, worker count and build, so later startups load it instead of tuning again.
+class AutoTuner
+{
+public:
+	explicit AutoTuner(WorkerPool& workerPool, std::filesystem::path directory = "tuning_cache");
+
+	// Calibrates when asked to, otherwise returns the cached tunings, or the defaults when nothing is cached.
+	// Must not be called from a worker thread.
+	KernelTunings getTunings(const cv::Size& frameSize, bool tune);
+
+	static std::string getCpuModel();
+	static std::string getBuildId();
+
+private:
+	struct CachedTunings
+	{
+		KernelTunings kernelTunings;
+		bool calibrated;
+	};
+
+	std::string getCacheKey(const cv::Size& frameSize) const;
+	std::filesystem::path getFilePath(const std::string& cacheKey) const;
+
+	bool loadFromDisk(const std::string& cacheKey, KernelTunings& kernelTunings) const;
+	void saveToDisk(const std::string& cacheKey, const KernelTunings& kernelTunings) const;
+
+	KernelTunings calibrate(const cv::Size& frameSize);
+	// measureSeconds runs one pass with the given tuning and returns its time
+	KernelTuning calibrateKernel(const std::string& kernelName, const std::function<double(const KernelTuning&)>& measureSeconds) const;
+	std::vector<KernelTuning> getCandidates() const;
+
+	WorkerPool& m_WorkerPool;
+	std::filesystem::path m_Directory;
+
+	// Streams of the same size share the tunings of the first one
+	std::mutex m_TuningsMutex;
+	std::unordered_map<std::string, CachedTunings> m_Tunings;
+};
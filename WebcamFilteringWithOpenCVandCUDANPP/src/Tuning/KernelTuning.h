@@ -0,0 +1,28 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "Filters/FilterTypes.h"
+#include "Simd/SimdConfig.h"
+
+
+// How a CPU kernel is run, the auto-tuner picks it per machine and frame size
+struct KernelTuning
+{
+	// Strips a parallelFor is split into, 0 is one per worker thread and 1 stays on the calling thread
+	int stripsCount = 0;
+	SimdVariantEnum simdVariant = defaultSimdVariant;
+};
+
+// Tunings of the CPU filters and of the changed-tile detection, filters without one run with the defaults
+struct KernelTunings
+{
+	std::unordered_map<FilterTypeEnum, KernelTuning> filterTunings;
+	KernelTuning tileDetectionTuning;
+
+	KernelTuning getFilterTuning(FilterTypeEnum filterType) const
+	{
+		auto filterTuning = filterTunings.find(filterType);
+		return filterTuning != filterTunings.end() ? filterTuning->second : KernelTuning();
+	}
+};
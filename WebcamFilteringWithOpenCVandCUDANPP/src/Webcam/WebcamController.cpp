@@ -1,6 +1,8 @@
 #include "WebcamController.h"
 
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 #include <nppi_arithmetic_and_logical_operations.h>
 #include <nppi_color_conversion.h>
@@ -8,141 +10,606 @@
 
 #include <opencv4/opencv2/cudaarithm.hpp>
 #include <opencv4/opencv2/cudaimgproc.hpp>
+#include <opencv4/opencv2/imgproc.hpp>
 
+#include "Capture/FrameSourceFactory.h"
+#include "EventQueues/ViewEventQueue.h"
 #include "Events/ViewEvents/ActivateCombinedFilter.h"
+#include "Events/ViewEvents/AttachFrameSink.h"
+#include "Events/ViewEvents/DetachFrameSink.h"
+#include "Events/ViewEvents/ChangeCannyThresholds.h"
+#include "Events/ViewEvents/ChangeGeometricWarp.h"
+#include "Events/ViewEvents/ChangeQualityGovernor.h"
+#include "Events/ViewEvents/ChangeRegionOfInterest.h"
 #include "Events/ViewEvents/ViewChangeFilterEvents/ChangeActiveFilters.h"
 #include "Events/ViewEvents/ViewChangeFilterEvents/ChangeActiveFiltersOnCombinedFilter.h"
-
-#include "WebcamView.h"
-
-
-
-WebcamController::WebcamController(WebcamView* parentView) :
-	parentView(parentView)
+#include "Filters/Edges/CannyEdgeFilter.h"
+#include "Filters/FilterNames.h"
+#include "Filters/Stages/CpuLumaFilterStage.h"
+#include "Filters/Stages/FilterStageFactory.h"
+#include "Geometry/RegionOfInterest.h"
+#include "Metrics/MetricsRegistry.h"
+#include "Pipeline/PipelineCost.h"
+#include "Threading/WorkerPool.h"
+
+
+WebcamController::WebcamController(ViewEventQueue& viewEventQueue, WorkerPool& workerPool, std::unique_ptr<FrameSource> frameSource) :
+	viewEventQueue(viewEventQueue),
+	workerPool(workerPool),
+	schedulingLane(workerPool.createLane()),
+	frameIntervalSeconds(0.0),
+	qualityGovernor("Stream lane " + std::to_string(schedulingLane)),
+	pipelineMetrics(std::to_string(schedulingLane)),
+	outputVersionsCount(0),
+	regionOfInterestEnabled(false),
+	regionOfInterestCrops(false),
+	frameSource(std::move(frameSource)),
+	geometricWarpStage(workerPool),
+	dirtyTileDetector(workerPool),
+	filterStages(std::in_place, [&workerPool](FilterTypeEnum filterType) { return FilterStageFactory::createFilterStage(filterType, workerPool); }),
+	startupTimeline(std::to_string(schedulingLane)),
+	capturedFramesCount(0),
+	processedFramesCount(0),
+	captureMemoryAccount("capture", std::to_string(schedulingLane)),
+	combinedMemoryAccount("combined", std::to_string(schedulingLane)),
+	filterMemoryAccounts(std::in_place, [this](FilterTypeEnum filterType) { return MemoryAccount(getFilterTypeName(filterType), std::to_string(schedulingLane)); })
 {
 	initVariables();
-	initVideoCapture();
 }
 
 void WebcamController::initVariables()
 {
 	activeFiltersCount = 0;
-	activeFiltersMap = {
-		{ FilterTypeEnum::None, false },
-		{ FilterTypeEnum::Grayscale, false },
-		{ FilterTypeEnum::Sobel, false }
-	};
+	activeFiltersMap = FilterTable<bool>(false);
 
 	combinedFiltersActive = false;
 	combinedFiltersCount = 0;
-	combinedFilters = {
-		{ FilterTypeEnum::None, false },
-		{ FilterTypeEnum::Grayscale, false },
-		{ FilterTypeEnum::Sobel, false }
-	};
+	combinedFilters = FilterTable<bool>(false);
+
+	fullFrameUpdate = true;
+}
+
+// Runs on the capture thread, the first frame tells the frame size
+bool WebcamController::openVideoCapture()
+{
+	if (frameSource == nullptr)
+		frameSource = FrameSourceFactory::createFrameSource("0", workerPool);
+
+	if (!frameSource->open())
+		return false;
+
+	startupTimeline.record(StartupStageEnum::SourceOpened);
+
+	// Set the initial camera frame
+	if (!frameSource->grabFrame(currentCamFrame))
+	{
+		std::cout << "Error: Could not capture frame. \n";
+		return false;
+	}
 
-	videoCaptureCanBeStarted = false;
+	startupTimeline.record(StartupStageEnum::FirstFrame);
+	capturedFrameSize = currentCamFrame.size();
 
-	initGpuMatsAndMutexesMap();
+	return true;
 }
 
-void WebcamController::initGpuMatsAndMutexesMap()
+// Everything the first filtered frame would otherwise wait for, done once the frame size is known
+void WebcamController::prewarm()
 {
-	std::array<GPUMatTypesEnum, 7> gpuMatTypes = {
-		GPUMatTypesEnum::CamFrame,
-		GPUMatTypesEnum::GrayFrame,
-		GPUMatTypesEnum::GrayFrameRGB,
-		GPUMatTypesEnum::SobelFrame,
-		GPUMatTypesEnum::SobelGradXGpu,
-		GPUMatTypesEnum::SobelGradYGpu,
-		GPUMatTypesEnum::CurrentFiltersCombined
-	};
+	if (kernelTuningsProvider)
+		setKernelTunings(kernelTuningsProvider(capturedFrameSize));
 
-	for (auto& gpuMatType : gpuMatTypes)
+	// Events queued while the source opened apply now, their buffers are allocated at the size they are used at
+	processEvents();
+
+	for (FilterTypeEnum filterType : prewarmFilters)
 	{
-		gpuMatsMap[gpuMatType];
+		if (activeFiltersMap.at(filterType))
+			continue;
+
+		size_t requiredBytes = estimateOutputBytes(filterType);
+		if (!filterMemoryAccounts.at(filterType).request(requiredBytes))
+		{
+			std::cout << "Memory budget: " << getFilterTypeName(filterType) << " is not prewarmed on stream " << schedulingLane
+				<< ", it needs " << requiredBytes / (1024.0 * 1024.0) << " MB\n";
+			continue;
+		}
+
+		allocateFilterBuffers(filterType);
 	}
+
+	geometricWarpStage.prewarm(capturedFrameSize);
+
+	updateMemoryAccounts();
 }
 
-void WebcamController::initVideoCapture()
+// Buffers an output needs while it is active, create keeps buffers that already have the size
+void WebcamController::allocateFilterBuffers(FilterTypeEnum filterType)
 {
-	camCapture = cv::VideoCapture(0, cv::CAP_DSHOW);
+	cv::Size frameSize = getProcessingFrameSize();
 
-	int cameraWidth = 1280;
-	int cameraHeight = 720;
-	int cameraFps = 60;
+	gpuMatsMap.at(GPUMatTypesEnum::CamFrameUpload).create(frameSize, currentCamFrame.type());
+	camFrameYuv.create(frameSize);
 
-	camCapture.set(cv::CAP_PROP_FRAME_WIDTH, cameraWidth);
-	camCapture.set(cv::CAP_PROP_FRAME_HEIGHT, cameraHeight);
+	filterStages.at(filterType)->allocate(frameSize);
 
-	camCapture.set(cv::CAP_PROP_FPS, cameraFps);
+	if (isFullFrameFilter(filterType))
+		flippedLumaFrame.create(frameSize, CV_8UC1);
+}
 
-	camCapture.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G')); // MJPG
+// The first CUDA call creates the context and the first call of a kernel loads it, both take far longer than a frame.
+// Runs on the pool while the source opens.
+void WebcamController::warmUpDevice()
+{
+	cv::cuda::GpuMat bgr(64, 64, CV_8UC3, cv::Scalar::all(0));
+	YuvFrame yuvFrame;
 
-	if (!camCapture.isOpened())
-	{
-		std::cout << "Error: Could not open camera. \n";
-		return;
-	}
+	// The conversions and the flip every active output runs
+	yuvFrame.create(bgr.size());
+	yuvFrame.fromBGR(bgr);
+	yuvFrame.flipHorizontal();
+	yuvFrame.toBGR(bgr);
 
-	double actualWidth = camCapture.get(cv::CAP_PROP_FRAME_WIDTH);
-	double actualHeight = camCapture.get(cv::CAP_PROP_FRAME_HEIGHT);
-	double actualFps = camCapture.get(cv::CAP_PROP_FPS);
+	cv::cuda::GpuMat& luma = yuvFrame.getLuma();
+	cv::cuda::GpuMat gradX(luma.size(), CV_8UC1);
+	cv::cuda::GpuMat gradY(luma.size(), CV_8UC1);
 
-	std::cout
-		<< "Camera capture initialized!"
-		<< "-----------------------------------------\n"
-		<< "Actual capture resolution:\n"
-		<< actualWidth << "x" << actualHeight << " @ " << actualFps << " fps\n"
-		<< "-----------------------------------------";
+	// Sobel reads one pixel around the ROI
+	NppiSize roi = { luma.cols - 2, luma.rows - 2 };
+	const Npp8u* lumaPtr = static_cast<const Npp8u*>(luma.ptr(1)) + 1;
 
-	// Set the initial camera frame
-	camCapture >> currentCamFrame;
+	nppiFilterSobelHoriz_8u_C1R(lumaPtr, static_cast<Npp32s>(luma.step), gradX.ptr<Npp8u>(1) + 1, static_cast<Npp32s>(gradX.step), roi);
+	nppiFilterSobelVert_8u_C1R(lumaPtr, static_cast<Npp32s>(luma.step), gradY.ptr<Npp8u>(1) + 1, static_cast<Npp32s>(gradY.step), roi);
+	nppiAdd_8u_C1RSfs(gradX.ptr<Npp8u>(), static_cast<int>(gradX.step), gradY.ptr<Npp8u>(), static_cast<int>(gradY.step),
+					  luma.ptr<Npp8u>(), static_cast<int>(luma.step), { luma.cols, luma.rows }, 0);
+
+	cv::cuda::cvtColor(luma, bgr, cv::COLOR_GRAY2BGR);
+
+	cv::cuda::Stream::Null().waitForCompletion();
+}
+
+void WebcamController::setNewFrameCallback(std::function<void()> newFrameCallback)
+{
+	this->newFrameCallback = std::move(newFrameCallback);
+}
+
+void WebcamController::setKernelTuningsProvider(std::function<KernelTunings(const cv::Size&)> kernelTuningsProvider)
+{
+	this->kernelTuningsProvider = std::move(kernelTuningsProvider);
+}
+
+void WebcamController::setPrewarmFilters(const std::vector<FilterTypeEnum>& prewarmFilters)
+{
+	this->prewarmFilters = prewarmFilters;
+}
+
+void WebcamController::setKernelTunings(const KernelTunings& kernelTunings)
+{
+	dirtyTileDetector.setKernelTuning(kernelTunings.tileDetectionTuning);
 
-	if (currentCamFrame.empty())
+	for (const auto& filterStage : filterStages)
 	{
-		std::cout << "Error: Could not capture frame. \n";
-		return;
+		filterStage.second->setKernelTuning(kernelTunings.getFilterTuning(filterStage.first));
 	}
+}
 
-	videoCaptureCanBeStarted = true;
+void WebcamController::setThreadPlacement(const ThreadPlacement& threadPlacement)
+{
+	this->threadPlacement = threadPlacement;
 }
 
-// This function is used by only view
 void WebcamController::startVideoCapture()
 {
-	if (videoCaptureCanBeStarted)
-		videoCaptureThread = std::jthread(&WebcamController::startVideoCaptureThread, this);
+	videoCaptureThread = std::jthread(&WebcamController::startVideoCaptureThread, this);
+}
+
+// Returns once the frame source runs out of frames
+void WebcamController::waitForVideoCaptureEnd()
+{
+	if (videoCaptureThread.joinable())
+		videoCaptureThread.join();
+}
+
+const StartupTimeline& WebcamController::getStartupTimeline() const
+{
+	return startupTimeline;
+}
+
+uint64_t WebcamController::getCapturedFramesCount() const
+{
+	return capturedFramesCount.load(std::memory_order_relaxed);
+}
+
+uint64_t WebcamController::getProcessedFramesCount() const
+{
+	return processedFramesCount.load(std::memory_order_relaxed);
+}
+
+double WebcamController::getTileSkipRatio() const
+{
+	return dirtyTileDetector.getTileSkipRatio();
+}
+
+uint64_t WebcamController::getSkippedFramesCount() const
+{
+	return dirtyTileDetector.getSkippedFramesCount();
+}
+
+int WebcamController::getSchedulingLane() const
+{
+	return schedulingLane;
+}
+
+const QualityGovernor& WebcamController::getQualityGovernor() const
+{
+	return qualityGovernor;
+}
+
+const FrameTimeTracker& WebcamController::getFrameTimeTracker() const
+{
+	return frameTimeTracker;
 }
 
 // Thread function for capturing frames
 void WebcamController::startVideoCaptureThread()
 {
+	// Sources that decode on the pool pick up the lane of the thread opening them
+	WorkerPool::setThreadLane(schedulingLane);
+	ThreadPlacementControl::applyToCurrentThread("capture " + std::to_string(schedulingLane), threadPlacement);
+
+	std::future<void> deviceWarmUp = workerPool.submit(&WebcamController::warmUpDevice);
+
+	if (!openVideoCapture())
+		return;
+
+	prewarm();
+
+	deviceWarmUp.wait();
+	startupTimeline.record(StartupStageEnum::Prewarmed);
+
+	// The frame grabbed when the source opened is the first one processed
+	bool firstFramePending = true;
+
 	while (true)
 	{
-		camCapture >> currentCamFrame;
-		if (currentCamFrame.empty())
+		// The next frame is grabbed into the whole buffer, not into the ROI of it
+		if (uncroppedCamFrame.empty() == false)
+		{
+			currentCamFrame = uncroppedCamFrame;
+			uncroppedCamFrame.release();
+		}
+
+		if (firstFramePending)
+		{
+			firstFramePending = false;
+		}
+		else
 		{
-			std::cout << "Error: Could not capture frame. \n";
-			return;
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Capture));
+
+			if (!frameSource->grabFrame(currentCamFrame))
+			{
+				std::cout << "Error: Could not capture frame. \n";
+				return;
+			}
 		}
 
-		processEvents();
+		// Grabbing blocks until the source delivers, the frame is stamped as it arrives
+		capturedFrameStamp.sequence = capturedFramesCount.fetch_add(1, std::memory_order_relaxed) + 1;
+		capturedFrameStamp.captureTime = std::chrono::steady_clock::now();
+		pipelineMetrics.capturedFrames.add();
+		capturedFrameSize = currentCamFrame.size();
+
+		auto processingStartTime = std::chrono::steady_clock::now();
+
+		updateFrameDeadline();
+
+		{
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Events));
+
+			pipelineMetrics.viewEventQueueDepth.set(static_cast<double>(viewEventQueue.getSize()));
+			processEvents();
+		}
+
+		// Outputs downloaded for the first time last frame are counted here
+		updateMemoryAccounts();
+
+		pushCapturedFrameToSinks();
 
 		if (activeFiltersCount == 0)
 			continue;
 
-		flipCameraFrame();
+		if (geometricWarpStage.isEnabled())
+		{
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Warp));
+			warpCameraFrame();
+		}
+
+		if (qualityGovernor.isStepActive(QualityStepEnum::HalveResolution))
+		{
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Resize));
+			reduceCameraFrame();
+		}
+
+		if (regionOfInterestEnabled)
+			cropCameraFrame();
+
+		if (processingFrameSize != getProcessingFrameSize())
+			resizeFrameBuffers();
+
+		bool tilesChanged;
+		{
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::TileDetection));
+			tilesChanged = detectChangedTiles();
+		}
+
+		// An unchanged frame keeps the outputs of the stateless filters from the previous frame.
+		// Stateful filters see every frame, a still scene changes their output too.
+		bool filtersRun = tilesChanged || isCpuLumaFilterActive();
+
+		if (filtersRun)
+		{
+			{
+				MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Upload));
+				flipCameraFrame();
+			}
+
+			generateActiveFilters();
+			startupTimeline.record(StartupStageEnum::FirstFilteredFrame);
+
+			processedFramesCount.fetch_add(1, std::memory_order_relaxed);
+			pipelineMetrics.processedFrames.add();
+		}
+		else
+		{
+			stampUnchangedOutputs();
+			pipelineMetrics.unchangedFrames.add();
+		}
+
+		// The camera image around the ROI changes even when the ROI does not
+		if (regionOfInterestEnabled)
+		{
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Present));
+			presentRegionOfInterest();
+		}
+
+		{
+			MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Sinks));
+			pushFramesToSinks();
+		}
+
+		if (newFrameCallback && (filtersRun || regionOfInterestEnabled))
+			newFrameCallback();
+
+		updateQualityLevel(processingStartTime);
+	}
+}
+
+// The frame has to be done before the next one arrives, the interval is smoothed over the last frames
+void WebcamController::updateFrameDeadline()
+{
+	auto now = std::chrono::steady_clock::now();
+
+	if (lastFrameTime != std::chrono::steady_clock::time_point())
+	{
+		double intervalSeconds = std::chrono::duration<double>(now - lastFrameTime).count();
+		frameIntervalSeconds = frameIntervalSeconds == 0.0 ? intervalSeconds : frameIntervalSeconds * 0.9 + intervalSeconds * 0.1;
+
+		WorkerPool::setThreadDeadline(now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(frameIntervalSeconds)));
+	}
+
+	lastFrameTime = now;
+}
+
+// Outputs already computed for this frame are correct, the new level applies from the next frame
+void WebcamController::updateQualityLevel(std::chrono::steady_clock::time_point processingStartTime)
+{
+	double processingSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - processingStartTime).count();
+	pipelineMetrics.getStageSeconds(PipelineStageEnum::Frame).observe(processingSeconds);
+	frameTimeTracker.record(processingSeconds);
+
+	// Stepping back up leaves stale tiles in outputs that were skipped or paused
+	if (qualityGovernor.update(processingSeconds, frameIntervalSeconds))
+		fullFrameUpdate = true;
+
+	pipelineMetrics.qualityLevel.set(qualityGovernor.getLevel());
+}
+
+// The captured frame, halved at the resolution step
+cv::Size WebcamController::getScaledFrameSize() const
+{
+	if (!qualityGovernor.isStepActive(QualityStepEnum::HalveResolution))
+		return capturedFrameSize;
+
+	// Even sizes keep the chroma planes exact
+	return cv::Size((capturedFrameSize.width / 2) & ~1, (capturedFrameSize.height / 2) & ~1);
+}
+
+// Size of the frames the filters see
+cv::Size WebcamController::getProcessingFrameSize() const
+{
+	if (regionOfInterestEnabled)
+		return getRegionOfInterestProcessingRect().size();
+
+	return getScaledFrameSize();
+}
+
+void WebcamController::reduceCameraFrame()
+{
+	cv::resize(currentCamFrame, reducedCamFrame, getProcessingFrameSize(), 0.0, 0.0, cv::INTER_AREA);
+
+	std::swap(currentCamFrame, reducedCamFrame);
+
+	if (reducedCamFrame.u == nullptr)
+		reducedCamFrame.release();
+}
+
+// In output coordinates of the scaled frame, on even pixels for the chroma planes
+cv::Rect WebcamController::getRegionOfInterestRect() const
+{
+	return RegionOfInterest::getFrameRect(regionOfInterest, getScaledFrameSize());
+}
+
+// The ROI grown by the halo of the active filters, so kernels at the ROI border see real neighbours
+cv::Rect WebcamController::getRegionOfInterestProcessingRect() const
+{
+	return RegionOfInterest::getProcessingRect(getRegionOfInterestRect(), getScaledFrameSize(), getActiveFiltersHalo());
+}
+
+// Outputs are mirrored unless the warp already mirrored the frame
+cv::Rect WebcamController::toFrameRect(const cv::Rect& outputRect, int frameWidth) const
+{
+	if (geometricWarpStage.isEnabled())
+		return outputRect;
+
+	return cv::Rect(frameWidth - outputRect.x - outputRect.width, outputRect.y, outputRect.width, outputRect.height);
+}
+
+// Everything after this works on the ROI only, the whole frame is kept for the passthrough
+void WebcamController::cropCameraFrame()
+{
+	uncroppedCamFrame = currentCamFrame;
+	currentCamFrame = uncroppedCamFrame(toFrameRect(getRegionOfInterestProcessingRect(), uncroppedCamFrame.cols));
+}
+
+void WebcamController::presentRegionOfInterest()
+{
+	cv::Rect regionOfInterestRect = getRegionOfInterestRect();
+	cv::Rect processingRect = getRegionOfInterestProcessingRect();
+	cv::Rect innerRect = regionOfInterestRect - processingRect.tl();
+
+	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+
+	m_PresentedWebcamMats.activeMatsCount = m_ControllersWebcamMats.activeMatsCount;
+	m_ControllersWebcamMats.copyFrameStampsTo(m_PresentedWebcamMats);
+
+	// The camera image around the ROI is new on every frame, so every presented output gets a new version
+	for (const auto& processedMat : m_ControllersWebcamMats.m_filteredMatsMap)
+	{
+		presentMat(processedMat.second, m_PresentedWebcamMats.m_filteredMatsMap.at(processedMat.first), regionOfInterestRect, innerRect);
+		m_PresentedWebcamMats.m_frameStampsMap.at(processedMat.first).version = ++outputVersionsCount;
+	}
+
+	const cv::Mat& processedCombinedMat = m_ControllersWebcamMats.currentFiltersCombinedMat;
+	cv::Mat& presentedCombinedMat = m_PresentedWebcamMats.currentFiltersCombinedMat;
+
+	if (processedCombinedMat.empty())
+	{
+		presentedCombinedMat.release();
+		return;
+	}
+
+	// Every place of the mosaic is presented on its own
+	int placesCount = processedCombinedMat.cols / processingRect.width;
+	cv::Size placeSize = regionOfInterestCrops ? regionOfInterestRect.size() : uncroppedCamFrame.size();
+
+	presentedCombinedMat.create(placeSize.height, placeSize.width * placesCount, processedCombinedMat.type());
+
+	for (int place = 0; place < placesCount; place++)
+	{
+		cv::Mat presentedPlace = presentedCombinedMat.colRange(placeSize.width * place, placeSize.width * (place + 1));
+
+		presentMat(processedCombinedMat.colRange(processingRect.width * place, processingRect.width * (place + 1)), presentedPlace,
+				   regionOfInterestRect, innerRect);
+	}
+
+	m_PresentedWebcamMats.combinedFrameStamp.version = ++outputVersionsCount;
+}
+
+// Around the ROI the output shows the camera image, in gray for single channel outputs
+void WebcamController::presentMat(const cv::Mat& processedMat, cv::Mat& presentedMat, const cv::Rect& regionOfInterestRect, const cv::Rect& innerRect)
+{
+	if (processedMat.empty())
+	{
+		presentedMat.release();
+		return;
+	}
+
+	if (regionOfInterestCrops)
+	{
+		processedMat(innerRect).copyTo(presentedMat);
+		return;
+	}
+
+	cv::Size frameSize = uncroppedCamFrame.size();
+	presentedMat.create(frameSize, processedMat.type());
+
+	cv::Rect passthroughRects[] = {
+		cv::Rect(0, 0, frameSize.width, regionOfInterestRect.y),
+		cv::Rect(0, regionOfInterestRect.br().y, frameSize.width, frameSize.height - regionOfInterestRect.br().y),
+		cv::Rect(0, regionOfInterestRect.y, regionOfInterestRect.x, regionOfInterestRect.height),
+		cv::Rect(regionOfInterestRect.br().x, regionOfInterestRect.y, frameSize.width - regionOfInterestRect.br().x, regionOfInterestRect.height)
+	};
+
+	for (const auto& passthroughRect : passthroughRects)
+	{
+		if (passthroughRect.empty())
+			continue;
+
+		cv::Mat camFrameArea = uncroppedCamFrame(toFrameRect(passthroughRect, frameSize.width));
+		cv::Mat presentedArea = presentedMat(passthroughRect);
+
+		if (presentedMat.channels() == 1)
+		{
+			cv::cvtColor(camFrameArea, passthroughLumaArea, cv::COLOR_BGR2GRAY);
+			camFrameArea = passthroughLumaArea;
+		}
 
-		generateActiveFilters();
+		if (geometricWarpStage.isEnabled())
+			camFrameArea.copyTo(presentedArea);
+		else
+			cv::flip(camFrameArea, presentedArea, 1);
 	}
+
+	cv::Mat presentedRegionOfInterest = presentedMat(regionOfInterestRect);
+	processedMat(innerRect).copyTo(presentedRegionOfInterest);
+}
+
+// Everything sized by the processing size follows it, stateful filters start over
+void WebcamController::resizeFrameBuffers()
+{
+	processingFrameSize = getProcessingFrameSize();
+
+	if (activeFiltersCount != 0)
+	{
+		gpuMatsMap.at(GPUMatTypesEnum::CamFrameUpload).create(processingFrameSize, currentCamFrame.type());
+		camFrameYuv.create(processingFrameSize);
+	}
+
+	for (const auto& filterStage : filterStages)
+	{
+		if (activeFiltersMap[filterStage.first])
+			filterStage.second->allocate(processingFrameSize);
+	}
+
+	if (isCpuLumaFilterActive())
+		flippedLumaFrame.create(processingFrameSize, CV_8UC1);
+
+	{
+		std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+
+		// The view keeps the old mats, the new ones are downloaded whole
+		for (auto filteredMat : m_ControllersWebcamMats.m_filteredMatsMap)
+		{
+			if (filteredMat.second.empty() == false)
+				filteredMat.second.create(processingFrameSize, filteredMat.second.type());
+		}
+	}
+
+	combinedFrameInitOrDestroy();
+
+	dirtyTileDetector.reset();
+	fullFrameUpdate = true;
 }
 
 void WebcamController::processEvents()
 {
 	std::shared_ptr<ViewEvent> viewEvent;
-	while ((viewEvent = parentView->getEventFromQueue()) != nullptr)
+	while ((viewEvent = viewEventQueue.popViewEvent()) != nullptr)
 	{
+		// New or resized outputs have no cached content yet
+		fullFrameUpdate = true;
+
 		switch (viewEvent->getViewEventType())
 		{
 			case ViewEventTypesEnum::ActivateCombinedFilter:
@@ -154,13 +621,42 @@ void WebcamController::processEvents()
 			case ViewEventTypesEnum::ChangeActiveFiltersOnCombinedFilter:
 				processChangedActiveFiltersOnCombinedFilters(viewEvent);
 				break;
+			case ViewEventTypesEnum::ChangeCannyThresholds:
+				processChangedCannyThresholds(viewEvent);
+				break;
+			case ViewEventTypesEnum::ChangeGeometricWarp:
+				processChangedGeometricWarp(viewEvent);
+				break;
+			case ViewEventTypesEnum::ChangeQualityGovernor:
+				processChangedQualityGovernor(viewEvent);
+				break;
+			case ViewEventTypesEnum::ChangeRegionOfInterest:
+				processChangedRegionOfInterest(viewEvent);
+				break;
+			case ViewEventTypesEnum::AttachFrameSink:
+				processAttachFrameSink(viewEvent);
+				break;
+			case ViewEventTypesEnum::DetachFrameSink:
+				processDetachFrameSink(viewEvent);
+				break;
 		}
 	}
 }
 
 void WebcamController::processChangedCombinedFiltersActive(std::shared_ptr<ViewEvent> event)
 {
-	combinedFiltersActive = std::static_pointer_cast<ActivateCombinedFilter>(event)->getActivateCombinedFilter();
+	bool isActive = std::static_pointer_cast<ActivateCombinedFilter>(event)->getActivateCombinedFilter();
+
+	if (isActive && !combinedFiltersActive && !combinedMemoryAccount.request(estimateCombinedFrameBytes(combinedFiltersCount)))
+	{
+		std::cout << "Memory budget: combined output refused on stream " << schedulingLane << "\n";
+
+		std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+		refusedOutputs.combinedFrame = true;
+		return;
+	}
+
+	combinedFiltersActive = isActive;
 
 	combinedFrameInitOrDestroy();
 }
@@ -176,33 +672,24 @@ void WebcamController::processChangedActiveFilters(std::shared_ptr<ViewEvent> ev
 	if (refActive == isActive)
 		return;
 
+	// Outputs already running keep their buffers, a new one has to fit next to them
+	size_t requiredBytes = isActive ? estimateOutputBytes(filterType) : 0;
+	if (isActive && !filterMemoryAccounts.at(filterType).request(requiredBytes))
+	{
+		std::cout << "Memory budget: " << getFilterTypeName(filterType) << " refused on stream " << schedulingLane
+			<< ", it needs " << requiredBytes / (1024.0 * 1024.0) << " MB\n";
+
+		std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+		refusedOutputs.filters.push_back(filterType);
+		return;
+	}
+
 	if (refActive = isActive)
 	{
 		activeFiltersCount++;
 
-		if (activeFiltersCount == 1)
-		{
-			gpuMatsMap.at(GPUMatTypesEnum::CamFrame).create(currentCamFrame.size(), currentCamFrame.type());
-		}
-
-		switch (filterType)
-		{
-			case FilterTypeEnum::Grayscale:
-			{
-				gpuMatsMap.at(GPUMatTypesEnum::GrayFrame).create(currentCamFrame.size(), CV_8UC1);
-				gpuMatsMap.at(GPUMatTypesEnum::GrayFrameRGB).create(currentCamFrame.size(), currentCamFrame.type());
-				break;
-			}
-			case FilterTypeEnum::Sobel:
-			{
-				gpuMatsMap.at(GPUMatTypesEnum::SobelFrame).create(currentCamFrame.size(), currentCamFrame.type());
-				gpuMatsMap.at(GPUMatTypesEnum::SobelGradXGpu).create(currentCamFrame.size(), currentCamFrame.type());
-				gpuMatsMap.at(GPUMatTypesEnum::SobelGradYGpu).create(currentCamFrame.size(), currentCamFrame.type());
-				break;
-			}
-			default:
-				break;
-		}
+		// Prewarmed buffers are kept
+		allocateFilterBuffers(filterType);
 	}
 	else
 	{
@@ -214,24 +701,10 @@ void WebcamController::processChangedActiveFilters(std::shared_ptr<ViewEvent> ev
 
 		activeFiltersCount--;
 
-		switch (filterType)
-		{
-			case FilterTypeEnum::Grayscale:
-			{
-				gpuMatsMap.at(GPUMatTypesEnum::GrayFrame).release();
-				gpuMatsMap.at(GPUMatTypesEnum::GrayFrameRGB).release();
-				break;
-			}
-			case FilterTypeEnum::Sobel:
-			{
-				gpuMatsMap.at(GPUMatTypesEnum::SobelFrame).release();
-				gpuMatsMap.at(GPUMatTypesEnum::SobelGradXGpu).release();
-				gpuMatsMap.at(GPUMatTypesEnum::SobelGradYGpu).release();
-				break;
-			}
-			default:
-				break;
-		}
+		filterStages.at(filterType)->release();
+
+		if (!isCpuLumaFilterActive())
+			flippedLumaFrame.release();
 
 		changeActiveCombinedFilters(filterType, false);
 	}
@@ -244,6 +717,84 @@ void WebcamController::processChangedActiveFiltersOnCombinedFilters(std::shared_
 	changeActiveCombinedFilters(changeActiveFiltersOnCombinedFilterEventPtr->getFilterType(), changeActiveFiltersOnCombinedFilterEventPtr->getIsActive());
 }
 
+// Applies from the next frame, which is processed whole because of the event
+void WebcamController::processChangedCannyThresholds(std::shared_ptr<ViewEvent> event)
+{
+	auto* cannyEdgeStage = dynamic_cast<CpuLumaFilterStage<CannyEdgeFilter>*>(filterStages.at(FilterTypeEnum::Canny).get());
+
+	if (cannyEdgeStage != nullptr)
+		cannyEdgeStage->getFilter().setThresholds(std::static_pointer_cast<ChangeCannyThresholds>(event)->getCannyThresholds());
+}
+
+void WebcamController::processChangedGeometricWarp(std::shared_ptr<ViewEvent> event)
+{
+	std::shared_ptr<ChangeGeometricWarp> changeGeometricWarpEventPtr = std::static_pointer_cast<ChangeGeometricWarp>(event);
+
+	if (changeGeometricWarpEventPtr->getIsEnabled())
+	{
+		// Outputs are mirrored, the table does it in the same pass
+		WarpParameters warpParameters = changeGeometricWarpEventPtr->getWarpParameters();
+		warpParameters.mirrorHorizontally = true;
+
+		geometricWarpStage.configure(warpParameters);
+	}
+	else
+	{
+		geometricWarpStage.disable();
+		warpedCamFrame.release();
+	}
+
+	// Tiles of the previous geometry say nothing about the new one
+	dirtyTileDetector.reset();
+}
+
+void WebcamController::processChangedQualityGovernor(std::shared_ptr<ViewEvent> event)
+{
+	std::shared_ptr<ChangeQualityGovernor> changeQualityGovernorEventPtr = std::static_pointer_cast<ChangeQualityGovernor>(event);
+
+	qualityGovernor.configure(changeQualityGovernorEventPtr->getIsEnabled(), changeQualityGovernorEventPtr->getLadder());
+}
+
+void WebcamController::processChangedRegionOfInterest(std::shared_ptr<ViewEvent> event)
+{
+	std::shared_ptr<ChangeRegionOfInterest> changeRegionOfInterestEventPtr = std::static_pointer_cast<ChangeRegionOfInterest>(event);
+
+	{
+		std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+
+		regionOfInterestEnabled = changeRegionOfInterestEventPtr->getIsEnabled();
+		regionOfInterestCrops = changeRegionOfInterestEventPtr->getCropOutputs();
+		regionOfInterest = changeRegionOfInterestEventPtr->getRegionOfInterest();
+
+		if (!regionOfInterestEnabled)
+		{
+			for (auto presentedMat : m_PresentedWebcamMats.m_filteredMatsMap)
+			{
+				presentedMat.second.release();
+			}
+
+			m_PresentedWebcamMats.currentFiltersCombinedMat.release();
+		}
+	}
+
+	// A moved ROI of the same size still needs new history and tile references
+	processingFrameSize = cv::Size();
+}
+
+void WebcamController::processAttachFrameSink(std::shared_ptr<ViewEvent> event)
+{
+	std::shared_ptr<AttachFrameSink> attachFrameSinkEventPtr = std::static_pointer_cast<AttachFrameSink>(event);
+
+	frameSinks.emplace_back(attachFrameSinkEventPtr->getFrameSinkSource(), attachFrameSinkEventPtr->getFrameSink());
+}
+
+void WebcamController::processDetachFrameSink(std::shared_ptr<ViewEvent> event)
+{
+	std::shared_ptr<FrameSink> frameSink = std::static_pointer_cast<DetachFrameSink>(event)->getFrameSink();
+
+	std::erase_if(frameSinks, [&frameSink](const auto& attachedFrameSink) { return attachedFrameSink.second == frameSink; });
+}
+
 void WebcamController::changeActiveCombinedFilters(FilterTypeEnum filterType, bool isActive)
 {
 	bool& refCombined = combinedFilters.at(filterType);
@@ -251,6 +802,16 @@ void WebcamController::changeActiveCombinedFilters(FilterTypeEnum filterType, bo
 	if (refCombined == isActive)
 		return;
 
+	// The mosaic only exists while combining is on, a tile added while it is off is checked when it is turned on
+	if (isActive && combinedFiltersActive && !combinedMemoryAccount.request(estimateCombinedFrameBytes(1)))
+	{
+		std::cout << "Memory budget: " << getFilterTypeName(filterType) << " refused in the combined output on stream " << schedulingLane << "\n";
+
+		std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+		refusedOutputs.combinedFilters.push_back(filterType);
+		return;
+	}
+
 	if (refCombined = isActive)
 	{
 		combinedFiltersCount++;
@@ -269,11 +830,11 @@ void WebcamController::combinedFrameInitOrDestroy()
 
 	if (combinedFiltersActive && combinedFiltersCount != 0)
 	{
-		cv::MatSize& currentCamFrameSize = currentCamFrame.size;
-		currentFiltersCombinedGpuMat.create(currentCamFrameSize().height, currentCamFrameSize().width * combinedFiltersCount, currentCamFrame.type());
+		cv::Size frameSize = getProcessingFrameSize();
+		currentFiltersCombinedGpuMat.create(frameSize.height, frameSize.width * combinedFiltersCount, currentCamFrame.type());
 
 		std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
-		m_ControllersWebcamMats.currentFiltersCombinedMat.create(currentCamFrameSize().height, currentCamFrameSize().width * combinedFiltersCount, currentCamFrame.type());
+		m_ControllersWebcamMats.currentFiltersCombinedMat.create(frameSize.height, frameSize.width * combinedFiltersCount, currentCamFrame.type());
 	}
 	else if (combinedFiltersActive == false || combinedFiltersCount == 0)
 	{
@@ -284,212 +845,454 @@ void WebcamController::combinedFrameInitOrDestroy()
 	}
 }
 
-void WebcamController::flipCameraFrame()
+// Frames of the source, and of the stages trading buffers with it, belong to the source or the frame buffer pool
+void WebcamController::updateMemoryAccounts()
 {
-	cv::cuda::GpuMat& camFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::CamFrame);
-	camFrameGpuMat.upload(currentCamFrame);
-	cv::cuda::flip(camFrameGpuMat, camFrameGpuMat, 1);
+	captureMemoryAccount.setBytes(MemoryBudget::getBytes(gpuMatsMap.at(GPUMatTypesEnum::CamFrameUpload)) +
+								  MemoryBudget::getBytes(camFrameYuv.getLuma()) +
+								  MemoryBudget::getBytes(camFrameYuv.getChromaU()) +
+								  MemoryBudget::getBytes(camFrameYuv.getChromaV()) +
+								  MemoryBudget::getBytes(flippedLumaFrame));
+
+	for (auto filterMemoryAccount : filterMemoryAccounts)
+	{
+		FilterTypeEnum filterType = filterMemoryAccount.first;
+
+		filterMemoryAccount.second.setBytes(filterStages.at(filterType)->getMemoryBytes() +
+											MemoryBudget::getBytes(m_ControllersWebcamMats.m_filteredMatsMap.at(filterType)) +
+											MemoryBudget::getBytes(m_PresentedWebcamMats.m_filteredMatsMap.at(filterType)));
+	}
+
+	combinedMemoryAccount.setBytes(MemoryBudget::getBytes(gpuMatsMap.at(GPUMatTypesEnum::CurrentFiltersCombined)) +
+								   MemoryBudget::getBytes(m_ControllersWebcamMats.currentFiltersCombinedMat) +
+								   MemoryBudget::getBytes(m_PresentedWebcamMats.currentFiltersCombinedMat));
 }
 
-void WebcamController::generateActiveFilters()
+// Planes a new output brings at the processing size: GPU buffers and history, the output, its download and the view's texture
+size_t WebcamController::estimateOutputBytes(FilterTypeEnum filterType) const
 {
-	std::vector<std::thread> generateFramesThreads(activeFiltersCount);
+	cv::Size frameSize = getProcessingFrameSize();
+	int frameType = currentCamFrame.type();
 
-	for (const auto& filter : activeFiltersMap)
+	size_t outputBytes = PipelineCost::getTotalBytes(PipelineCost::getOutputBuffers(filterType, frameSize, combinedFilters.at(filterType), true));
+
+	// The first output also brings the upload and the YUV planes
+	if (activeFiltersCount == 0)
+		outputBytes += PipelineCost::getTotalBytes(PipelineCost::getCaptureBuffers(frameSize, frameType));
+
+	// The CPU filters share one downloaded luma plane
+	if (isFullFrameFilter(filterType) && !isCpuLumaFilterActive())
+		outputBytes += PipelineCost::getCpuLumaBuffer(frameSize).bytes;
+
+	return outputBytes;
+}
+
+// A tile is on the GPU, downloaded and in the view's texture
+size_t WebcamController::estimateCombinedFrameBytes(int tilesCount) const
+{
+	return PipelineCost::getTotalBytes(PipelineCost::getCombinedBuffers(getProcessingFrameSize(), currentCamFrame.type(), tilesCount, true));
+}
+
+// Tiles are compared after the warp, so they are in output coordinates already
+void WebcamController::warpCameraFrame()
+{
+	geometricWarpStage.apply(currentCamFrame, warpedCamFrame);
+
+	// The captured frame's buffer is reused as the next warp target,
+	// unless it is external memory such as a mapped recording
+	std::swap(currentCamFrame, warpedCamFrame);
+
+	if (warpedCamFrame.u == nullptr)
+		warpedCamFrame.release();
+}
+
+// Returns false when no tile changed since the last frame
+bool WebcamController::detectChangedTiles()
+{
+	int dirtyTilesCount = dirtyTileDetector.detect(currentCamFrame);
+	cv::Rect frameRect(0, 0, currentCamFrame.cols, currentCamFrame.rows);
+
+	if (fullFrameUpdate || dirtyTilesCount == dirtyTileDetector.getTilesCount())
 	{
-		if (filter.second == false)
-			continue;
+		uploadRects = { frameRect };
+		changedRects = { frameRect };
 
-		switch (filter.first)
-		{
-			case FilterTypeEnum::None:
-			{
-				generateFramesThreads.emplace_back(&WebcamController::generateCameraFrame, this);
-				break;
-			}
-			case FilterTypeEnum::Grayscale:
-			{
-				generateFramesThreads.emplace_back(&WebcamController::generateGrayscaleRGBFrame, this);
-				break;
-			}
-			case FilterTypeEnum::Sobel:
-			{
-				generateFramesThreads.emplace_back(&WebcamController::generateSobelFilteredFrame, this);
-				break;
-			}
-			default:
-				break;
-		}
+		fullFrameUpdate = false;
+		return true;
 	}
 
-	for (auto& thread : generateFramesThreads)
+	// Stateful filters read the exact luma of every frame, changes below the tile threshold included
+	if (isCpuLumaFilterActive())
+		uploadRects = { frameRect };
+	else
+		uploadRects = dirtyTileDetector.getDirtyRects();
+
+	if (dirtyTilesCount == 0)
 	{
-		if (thread.joinable())
-			thread.join();
+		changedRects.clear();
+		return false;
 	}
 
-	if (combinedFiltersActive
-		&& combinedFiltersCount != 0
-		&& gpuMatsMap.find(GPUMatTypesEnum::CurrentFiltersCombined) != gpuMatsMap.end())
+	changedRects = dirtyTileDetector.getDirtyRects(getActiveFiltersHalo());
+
+	if (geometricWarpStage.isEnabled())
+		return true;
+
+	// Outputs are mirrored, the tiles were detected on the captured frame
+	for (auto& changedRect : changedRects)
 	{
-		generateCombinedFilteredFrame();
+		changedRect.x = currentCamFrame.cols - changedRect.x - changedRect.width;
 	}
+
+	return true;
 }
 
-// Generate function is used by the thread for capturing frames
-void WebcamController::generateCameraFrame()
+// Pixels around a changed tile that a filter's kernel also changes
+int WebcamController::getActiveFiltersHalo() const
 {
-	cv::cuda::GpuMat& camFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::CamFrame);
-	cv::Mat& webcamMat = m_ControllersWebcamMats.m_filteredMatsMap.at(FilterTypeEnum::None);
-
-	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+	int halo = 0;
 
-	if (webcamMat.empty())
-		m_ControllersWebcamMats.activeMatsCount++;
+	for (const auto& filter : activeFiltersMap)
+	{
+		if (filter.second)
+			halo = std::max(halo, getFilterTraits(filter.first).halo);
+	}
 
-	camFrameGpuMat.download(webcamMat);
+	return halo;
 }
 
-// Generate function is used by the thread for capturing frames
-void WebcamController::generateGrayscaleRGBFrame()
+// Converts the captured frame to planar YUV once, flipping at 1.5 bytes per pixel instead of 3.
+// Only the changed tiles are uploaded, the conversion and flip stay full frame on the GPU.
+void WebcamController::flipCameraFrame()
 {
-	cv::cuda::GpuMat& camFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::CamFrame);
+	cv::cuda::GpuMat& camFrameUploadGpuMat = gpuMatsMap.at(GPUMatTypesEnum::CamFrameUpload);
 
-	cv::cuda::GpuMat& grayFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::GrayFrame);
+	for (const auto& uploadRect : uploadRects)
+	{
+		cv::cuda::GpuMat uploadArea = camFrameUploadGpuMat(uploadRect);
+		uploadArea.upload(currentCamFrame(uploadRect));
+	}
 
-	NppStatus status = nppiRGBToGray_8u_C3C1R(camFrameGpuMat.ptr(), static_cast<int>(camFrameGpuMat.step),
-											  grayFrameGpuMat.ptr(), static_cast<int>(grayFrameGpuMat.step),
-											  { camFrameGpuMat.cols, camFrameGpuMat.rows });
+	camFrameYuv.fromBGR(camFrameUploadGpuMat);
 
-	if (status != NPP_SUCCESS)
+	if (!geometricWarpStage.isEnabled())
+		camFrameYuv.flipHorizontal();
+}
+
+void WebcamController::pushCapturedFrameToSinks()
+{
+	for (auto& frameSink : frameSinks)
 	{
-		std::cerr << "Error computing grayscale gradient: " << status << std::endl;
-		return;
+		if (frameSink.first.captured)
+			frameSink.second->pushFrame(currentCamFrame);
 	}
+}
 
-	cv::cuda::GpuMat& grayFrameRGBGpuMat = gpuMatsMap.at(GPUMatTypesEnum::GrayFrameRGB);
-	cv::cuda::cvtColor(grayFrameGpuMat, grayFrameRGBGpuMat, cv::COLOR_GRAY2RGB);
+// Sinks copy what they keep, the outputs are updated in place on the next frame.
+// The resolution step stays inside the pipeline, sinks get the outputs scaled back to the captured size.
+void WebcamController::pushFramesToSinks()
+{
+	if (frameSinks.empty())
+		return;
 
-	cv::Mat& webcamMat = m_ControllersWebcamMats.m_filteredMatsMap.at(FilterTypeEnum::Grayscale);
+	cv::Size scaledFrameSize = getScaledFrameSize();
+	bool resolutionReduced = scaledFrameSize != capturedFrameSize;
 
 	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
 
+	const WebcamMats& outputWebcamMats = regionOfInterestEnabled ? m_PresentedWebcamMats : m_ControllersWebcamMats;
+
+	for (auto& frameSink : frameSinks)
+	{
+		const FrameSinkSource& frameSinkSource = frameSink.first;
+
+		if (frameSinkSource.captured)
+			continue;
+
+		const cv::Mat& outputMat = frameSinkSource.combined ?
+			outputWebcamMats.currentFiltersCombinedMat :
+			outputWebcamMats.m_filteredMatsMap.at(frameSinkSource.filterType);
+
+		if (outputMat.empty())
+			continue;
+
+		if (resolutionReduced)
+		{
+			cv::Size sinkFrameSize(outputMat.cols * capturedFrameSize.width / scaledFrameSize.width,
+								   outputMat.rows * capturedFrameSize.height / scaledFrameSize.height);
+
+			cv::resize(outputMat, scaledSinkFrame, sinkFrameSize, 0.0, 0.0, cv::INTER_LINEAR);
+			frameSink.second->pushFrame(scaledSinkFrame);
+		}
+		else
+		{
+			frameSink.second->pushFrame(outputMat);
+		}
+
+		getOutputMetrics(frameSinkSource).publishedFrames.add();
+	}
+}
+
+// Downloads only the given areas once the mat holds a full frame.
+// The caller holds m_WebcamMatsMutex for mats shared with the view.
+void WebcamController::downloadRects(const cv::cuda::GpuMat& gpuMat, cv::Mat& webcamMat, const std::vector<cv::Rect>& rects, int xOffset)
+{
 	if (webcamMat.empty())
-		m_ControllersWebcamMats.activeMatsCount++;
+	{
+		gpuMat.download(webcamMat);
+		return;
+	}
+
+	for (const auto& rect : rects)
+	{
+		cv::Rect outputRect = rect + cv::Point(xOffset, 0);
 
-	grayFrameRGBGpuMat.download(webcamMat);
+		cv::Mat webcamMatArea = webcamMat(outputRect);
+		gpuMat(outputRect).download(webcamMatArea);
+	}
 }
 
-// Generate function is used by the thread for capturing frames
-void WebcamController::generateSobelFilteredFrame()
+void WebcamController::generateActiveFilters()
 {
-	cv::cuda::GpuMat& camFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::CamFrame);
+	MetricsHistogram::ScopedTimer timer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Filters));
+
+	bool skipCpuLumaFilters = qualityGovernor.isStepActive(QualityStepEnum::HalveCpuFilterRate)
+		&& processedFramesCount.load(std::memory_order_relaxed) % 2 == 1;
 
-	NppiSize roi = { camFrameGpuMat.cols, camFrameGpuMat.rows };
-	const Npp8u* camFrameGpuMatPtr = static_cast<const Npp8u*>(camFrameGpuMat.ptr());
+	if (isCpuLumaFilterActive() && !skipCpuLumaFilters)
+		downloadFlippedLumaFrame();
 
-	cv::cuda::GpuMat& gradXGpuMat = gpuMatsMap.at(GPUMatTypesEnum::SobelGradXGpu);
-	Npp8u* gradXGpuPtr = static_cast<Npp8u*>(gradXGpuMat.ptr());
+	FilterStageInput filterStageInput = { camFrameYuv, flippedLumaFrame, changedRects };
 
-	NppStatus status = nppiFilterSobelHoriz_8u_C3R(camFrameGpuMatPtr, static_cast<Npp32s>(camFrameGpuMat.step),
-												   gradXGpuPtr, static_cast<Npp32s>(gradXGpuMat.step),
-												   roi);
-	if (status != NPP_SUCCESS)
+	std::vector<std::future<void>> gpuFilterOutputs;
+	std::vector<FilterTypeEnum> cpuLumaFilters;
+	gpuFilterOutputs.reserve(activeFiltersCount);
+
+	// GPU stages are pool tasks in the lane and deadline of this stream
+	for (const auto& filter : activeFiltersMap)
 	{
-		std::cerr << "Error computing horizontal gradient: " << status << std::endl;
-		return;
+		if (filter.second == false)
+			continue;
+
+		if (skipCpuLumaFilters && isFullFrameFilter(filter.first))
+		{
+			pipelineMetrics.getFilterMetrics(filter.first).droppedFrames.add();
+			continue;
+		}
+
+		pipelineMetrics.getFilterMetrics(filter.first).processedFrames.add();
+
+		if (isFullFrameFilter(filter.first))
+		{
+			cpuLumaFilters.push_back(filter.first);
+			continue;
+		}
+
+		gpuFilterOutputs.push_back(workerPool.submit([this, filterType = filter.first, &filterStageInput]()
+		{
+			generateFilterOutput(filterType, filterStageInput);
+		}));
 	}
 
-	cv::cuda::GpuMat& gradYGpuMat = gpuMatsMap.at(GPUMatTypesEnum::SobelGradYGpu);
-	Npp8u* gradYGpuPtr = static_cast<Npp8u*>(gradYGpuMat.ptr());
+	// CPU stages split their frame over the pool themselves, which cannot be done from a worker
+	for (FilterTypeEnum filterType : cpuLumaFilters)
+	{
+		generateFilterOutput(filterType, filterStageInput);
+	}
 
-	status = nppiFilterSobelVert_8u_C3R(camFrameGpuMatPtr, static_cast<Npp32s>(camFrameGpuMat.step),
-										gradYGpuPtr, static_cast<Npp32s>(gradYGpuMat.step),
-										roi);
-	if (status != NPP_SUCCESS)
+	for (auto& gpuFilterOutput : gpuFilterOutputs)
 	{
-		std::cerr << "Error computing vertical gradient: " << status << std::endl;
-		return;
+		gpuFilterOutput.get();
 	}
 
-	cv::cuda::GpuMat& sobelFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::SobelFrame);
+	if (combinedFiltersActive == false || combinedFiltersCount == 0)
+		return;
 
-	status = nppiAdd_8u_C3RSfs(gradXGpuPtr, static_cast<int>(gradXGpuMat.step),
-							   gradYGpuPtr, static_cast<int>(gradYGpuMat.step),
-							   static_cast<Npp8u*>(sobelFrameGpuMat.ptr()), static_cast<int>(sobelFrameGpuMat.step),
-							   roi, 0); // no scaling
-	if (status != NPP_SUCCESS)
+	if (qualityGovernor.isStepActive(QualityStepEnum::PauseCombinedRefresh))
 	{
-		std::cerr << "Error computing magnitude: " << status << std::endl;
+		pipelineMetrics.getCombinedMetrics().droppedFrames.add();
 		return;
 	}
 
-	cv::Mat& webcamMat = m_ControllersWebcamMats.m_filteredMatsMap.at(FilterTypeEnum::Sobel);
+	MetricsHistogram::ScopedTimer combinedTimer(pipelineMetrics.getStageSeconds(PipelineStageEnum::Combined));
+
+	generateCombinedFilteredFrame();
+	pipelineMetrics.getCombinedMetrics().processedFrames.add();
+}
+
+// Runs on a worker for the GPU stages and on the capture thread for the CPU stages
+void WebcamController::generateFilterOutput(FilterTypeEnum filterType, const FilterStageInput& filterStageInput)
+{
+	MetricsHistogram::ScopedTimer timer(pipelineMetrics.getFilterMetrics(filterType).generateSeconds);
+
+	FilterStage& filterStage = *filterStages.at(filterType);
+
+	if (!filterStage.generate(filterStageInput, combinedFilters.at(filterType)))
+		return;
+
+	cv::Mat& webcamMat = m_ControllersWebcamMats.m_filteredMatsMap.at(filterType);
 
 	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
 
 	if (webcamMat.empty())
 		m_ControllersWebcamMats.activeMatsCount++;
 
-	sobelFrameGpuMat.download(webcamMat);
+	// Temporal state and hysteresis change the output everywhere, so it is refreshed whole and not only in the changed tiles.
+	// A stateless output keeps its version on a frame without changed tiles.
+	bool pixelsChanged = true;
+
+	if (isFullFrameFilter(filterType))
+	{
+		filterStage.getHostOutput().copyTo(webcamMat);
+	}
+	else
+	{
+		pixelsChanged = webcamMat.empty() || !changedRects.empty();
+		downloadRects(filterStage.getGpuOutput(), webcamMat, changedRects);
+	}
+
+	stampOutput(m_ControllersWebcamMats.m_frameStampsMap.at(filterType), pixelsChanged);
+}
+
+// Stateful outputs change outside the changed tiles and are always refreshed whole
+bool WebcamController::isFullFrameFilter(FilterTypeEnum filterType) const
+{
+	return getFilterTraits(filterType).cpuLuma;
+}
+
+bool WebcamController::isCpuLumaFilterActive() const
+{
+	for (const auto& filter : activeFiltersMap)
+	{
+		if (filter.second && getFilterTraits(filter.first).cpuLuma)
+			return true;
+	}
+
+	return false;
+}
+
+// Stateful filters see every pixel of every frame, not only the changed tiles
+void WebcamController::downloadFlippedLumaFrame()
+{
+	camFrameYuv.getLuma().download(flippedLumaFrame);
 }
 
 // Generate function is used by the thread for capturing frames
 void WebcamController::generateCombinedFilteredFrame()
 {
 	cv::cuda::GpuMat& currentFiltersCombinedFrameGpuMat = gpuMatsMap.at(GPUMatTypesEnum::CurrentFiltersCombined);
-	int combinedFiltersPlace = 0;
+	cv::Size frameSize = currentCamFrame.size();
+
+	const std::vector<cv::Rect> fullFrameRects = { cv::Rect(cv::Point(), frameSize) };
+	std::vector<const std::vector<cv::Rect>*> placeRects;
 
+	// Every combined filter keeps its place in filter order, an output without pixels of this size yet is black
 	for (const auto& filter : combinedFilters)
 	{
 		if (filter.second == false)
 			continue;
 
-		cv::cuda::GpuMat* gpuMatPtr = nullptr;
+		int place = static_cast<int>(placeRects.size());
+		cv::cuda::GpuMat combinedFramePlace = currentFiltersCombinedFrameGpuMat.colRange(frameSize.width * place, frameSize.width * (place + 1));
 
-		switch (filter.first)
+		const cv::cuda::GpuMat& gpuMat = filterStages.at(filter.first)->getGpuOutput();
+
+		if (gpuMat.size() != frameSize)
 		{
-			case FilterTypeEnum::None:
-			{
-				gpuMatPtr = &gpuMatsMap.at(GPUMatTypesEnum::CamFrame);
-				break;
-			}
-			case FilterTypeEnum::Grayscale:
-			{
-				gpuMatPtr = &gpuMatsMap.at(GPUMatTypesEnum::GrayFrameRGB);
-				break;
-			}
-			case FilterTypeEnum::Sobel:
-			{
-				gpuMatPtr = &gpuMatsMap.at(GPUMatTypesEnum::SobelFrame);
-				break;
-			}
-			default:
-				break;
+			combinedFramePlace.setTo(cv::Scalar::all(0));
+			placeRects.push_back(&fullFrameRects);
+			continue;
 		}
 
-		if (gpuMatPtr == nullptr)
-			continue;
+		const std::vector<cv::Rect>& rects = isFullFrameFilter(filter.first) ? fullFrameRects : changedRects;
 
-		cv::cuda::GpuMat& gpuMat = *gpuMatPtr;
+		for (const auto& rect : rects)
+		{
+			cv::cuda::GpuMat combinedFramePlaceArea = combinedFramePlace(rect);
 
-		int gpuMatHeight = gpuMat.size().height;
-		int gpuMatWidth = gpuMat.size().width;
+			// Luma outputs are expanded to BGR only here, where the mosaic needs it
+			if (gpuMat.channels() == 1)
+				cv::cuda::cvtColor(gpuMat(rect), combinedFramePlaceArea, cv::COLOR_GRAY2BGR);
+			else
+				gpuMat(rect).copyTo(combinedFramePlaceArea);
+		}
+
+		placeRects.push_back(&rects);
+	}
 
-		gpuMat.copyTo(currentFiltersCombinedFrameGpuMat
-					  .rowRange(0, gpuMatHeight)
-					  .colRange(gpuMatWidth * combinedFiltersPlace, gpuMatWidth * (combinedFiltersPlace + 1)));
+	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
 
-		combinedFiltersPlace++;
+	for (size_t place = 0; place < placeRects.size(); place++)
+	{
+		downloadRects(currentFiltersCombinedFrameGpuMat, m_ControllersWebcamMats.currentFiltersCombinedMat, *placeRects[place], frameSize.width * static_cast<int>(place));
 	}
 
+	stampOutput(m_ControllersWebcamMats.combinedFrameStamp);
+}
+
+// The caller holds m_WebcamMatsMutex
+void WebcamController::stampOutput(FrameStamp& frameStamp, bool pixelsChanged)
+{
+	frameStamp.sequence = capturedFrameStamp.sequence;
+	frameStamp.captureTime = capturedFrameStamp.captureTime;
+	frameStamp.producedCount++;
+
+	if (pixelsChanged)
+		frameStamp.version = ++outputVersionsCount;
+}
+
+// Outputs of the previous frame still show the scene of this one, their version stays
+void WebcamController::stampUnchangedOutputs()
+{
 	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
-	currentFiltersCombinedFrameGpuMat.download(m_ControllersWebcamMats.currentFiltersCombinedMat);
+
+	for (auto frameStamp : m_ControllersWebcamMats.m_frameStampsMap)
+	{
+		if (m_ControllersWebcamMats.m_filteredMatsMap[frameStamp.first].empty() == false)
+			stampOutput(frameStamp.second, false);
+	}
+
+	if (m_ControllersWebcamMats.currentFiltersCombinedMat.empty() == false)
+		stampOutput(m_ControllersWebcamMats.combinedFrameStamp, false);
 }
 
 void WebcamController::getMats(WebcamMats& webcamMatsFromView)
 {
 	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
 
-	m_ControllersWebcamMats.copyTo(webcamMatsFromView);
+	WebcamMats& outputWebcamMats = regionOfInterestEnabled ? m_PresentedWebcamMats : m_ControllersWebcamMats;
+	webcamMatsFromView.activeMatsCount = outputWebcamMats.activeMatsCount;
+
+	// The view renders faster than frames arrive, a version counts as published the first time it is copied
+	for (const auto& filteredMat : outputWebcamMats.m_filteredMatsMap)
+	{
+		bool copied = WebcamMats::copyChangedMat(filteredMat.second, outputWebcamMats.m_frameStampsMap.at(filteredMat.first),
+												 webcamMatsFromView.m_filteredMatsMap.at(filteredMat.first),
+												 webcamMatsFromView.m_frameStampsMap.at(filteredMat.first));
+
+		if (copied && filteredMat.second.empty() == false)
+			pipelineMetrics.getFilterMetrics(filteredMat.first).publishedFrames.add();
+	}
+
+	bool combinedCopied = WebcamMats::copyChangedMat(outputWebcamMats.currentFiltersCombinedMat, outputWebcamMats.combinedFrameStamp,
+													 webcamMatsFromView.currentFiltersCombinedMat, webcamMatsFromView.combinedFrameStamp);
+
+	if (combinedCopied && outputWebcamMats.currentFiltersCombinedMat.empty() == false)
+		pipelineMetrics.getCombinedMetrics().publishedFrames.add();
+
+	outputWebcamMats.copyFrameStampsTo(webcamMatsFromView);
+}
+
+RefusedOutputs WebcamController::takeRefusedOutputs()
+{
+	std::lock_guard<std::mutex> lock(m_WebcamMatsMutex);
+	return std::exchange(refusedOutputs, RefusedOutputs());
+}
+
+OutputMetrics& WebcamController::getOutputMetrics(const FrameSinkSource& frameSinkSource)
+{
+	if (frameSinkSource.combined)
+		return pipelineMetrics.getCombinedMetrics();
+
+	return pipelineMetrics.getFilterMetrics(frameSinkSource.filterType);
 }
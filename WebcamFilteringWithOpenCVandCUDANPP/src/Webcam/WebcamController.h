@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -7,80 +10,242 @@
 #include <nppdefs.h>
 
 #include <opencv4/opencv2/core/cuda.hpp>
-#include <opencv4/opencv2/videoio.hpp>
 
-#include "Filters/FilterTypes.h"
+#include "Capture/FrameSource.h"
+#include "Filters/FilterTraits.h"
+#include "Filters/Stages/FilterStage.h"
+#include "Frames/MemoryBudget.h"
+#include "Frames/YuvFrame.h"
+#include "Geometry/GeometricWarpStage.h"
+#include "Metrics/FrameTimeTracker.h"
+#include "Metrics/PipelineMetrics.h"
+#include "Metrics/StartupTimeline.h"
+#include "Output/FrameSink.h"
+#include "Pipeline/DirtyTileDetector.h"
+#include "Pipeline/QualityGovernor.h"
+#include "Threading/ThreadPlacement.h"
+#include "Tuning/KernelTuning.h"
 #include "WebcamMats.h"
 
 class ViewEvent;
-class WebcamView;
+class ViewEventQueue;
+class WorkerPool;
 
 
+// Outputs the memory budget did not allow, the view unticks them
+struct RefusedOutputs
+{
+	std::vector<FilterTypeEnum> filters;
+	std::vector<FilterTypeEnum> combinedFilters;
+	bool combinedFrame = false;
+};
+
 class WebcamController
 {
 public:
-	WebcamController(WebcamView* parentView);
+	// Without a frame source the camera is opened through the MJPEG decode stage.
+	// The source is opened on the capture thread, constructing the controller does not wait for the camera.
+	WebcamController(ViewEventQueue& viewEventQueue, WorkerPool& workerPool, std::unique_ptr<FrameSource> frameSource = nullptr);
+
+	// Called on the capture thread whenever an output got new pixels, set it before the capture starts
+	void setNewFrameCallback(std::function<void()> newFrameCallback);
+
+	// Gives the strip counts and SIMD variants of the CPU kernels for the frame size, called on the capture thread
+	// once the source is open. Set it before the capture starts.
+	void setKernelTuningsProvider(std::function<KernelTunings(const cv::Size&)> kernelTuningsProvider);
+
+	// Outputs whose buffers are allocated before the first frame, so turning them on does not stall a frame.
+	// Set them before the capture starts.
+	void setPrewarmFilters(const std::vector<FilterTypeEnum>& prewarmFilters);
+
+	// CPUs, priority and memory node of the capture thread, set them before the capture starts
+	void setThreadPlacement(const ThreadPlacement& threadPlacement);
 
+	// Opens the source, prewarms and captures on the capture thread
 	void startVideoCapture();
+	void waitForVideoCaptureEnd();
 
+	const StartupTimeline& getStartupTimeline() const;
+
+	uint64_t getCapturedFramesCount() const;
+	uint64_t getProcessedFramesCount() const;
+
+	double getTileSkipRatio() const;
+	uint64_t getSkippedFramesCount() const;
+
+	int getSchedulingLane() const;
+	const QualityGovernor& getQualityGovernor() const;
+	// Processing time of every frame that ran the filters
+	const FrameTimeTracker& getFrameTimeTracker() const;
+
+	// Only outputs whose version changed are copied, the stamps of all of them are
 	void getMats(WebcamMats& webcamMatsFromView);
 
+	// Outputs refused since the last call
+	RefusedOutputs takeRefusedOutputs();
+
 	int activeFiltersCount;
-	std::unordered_map<FilterTypeEnum, bool> activeFiltersMap;
+	FilterTable<bool> activeFiltersMap;
 
 	bool combinedFiltersActive;
-	std::unordered_map<FilterTypeEnum, bool> combinedFilters;
+	FilterTable<bool> combinedFilters;
 
 private:
 	void initVariables();
-	void initGpuMatsAndMutexesMap();
 
-	void initVideoCapture();
+	bool openVideoCapture();
+	void prewarm();
+	void allocateFilterBuffers(FilterTypeEnum filterType);
+	void setKernelTunings(const KernelTunings& kernelTunings);
+	static void warmUpDevice();
 	void startVideoCaptureThread();
 
 	void processEvents();
+	void updateFrameDeadline();
+	void updateQualityLevel(std::chrono::steady_clock::time_point processingStartTime);
+
+	cv::Size getScaledFrameSize() const;
+	cv::Size getProcessingFrameSize() const;
+	void reduceCameraFrame();
+	void resizeFrameBuffers();
+
+	cv::Rect getRegionOfInterestRect() const;
+	cv::Rect getRegionOfInterestProcessingRect() const;
+	cv::Rect toFrameRect(const cv::Rect& outputRect, int frameWidth) const;
+	void cropCameraFrame();
+	void presentRegionOfInterest();
+	void presentMat(const cv::Mat& processedMat, cv::Mat& presentedMat, const cv::Rect& regionOfInterestRect, const cv::Rect& innerRect);
+
+	void warpCameraFrame();
+	bool detectChangedTiles();
+	int getActiveFiltersHalo() const;
 
 	void flipCameraFrame();
 	void generateActiveFilters();
 
-	void generateCameraFrame();
-	void generateGrayscaleRGBFrame();
-	void generateSobelFilteredFrame();
+	void generateFilterOutput(FilterTypeEnum filterType, const FilterStageInput& filterStageInput);
 	void generateCombinedFilteredFrame();
 
+	void stampOutput(FrameStamp& frameStamp, bool pixelsChanged = true);
+	void stampUnchangedOutputs();
+
+	bool isFullFrameFilter(FilterTypeEnum filterType) const;
+	bool isCpuLumaFilterActive() const;
+	void downloadFlippedLumaFrame();
+
 	void combinedFrameInitOrDestroy();
 
+	void updateMemoryAccounts();
+	size_t estimateOutputBytes(FilterTypeEnum filterType) const;
+	size_t estimateCombinedFrameBytes(int tilesCount) const;
+
+	void pushCapturedFrameToSinks();
+	void pushFramesToSinks();
+	OutputMetrics& getOutputMetrics(const FrameSinkSource& frameSinkSource);
+
+	void downloadRects(const cv::cuda::GpuMat& gpuMat, cv::Mat& webcamMat, const std::vector<cv::Rect>& rects, int xOffset = 0);
+
 	void processChangedActiveFilters(std::shared_ptr<ViewEvent> event);
 	void processChangedCombinedFiltersActive(std::shared_ptr<ViewEvent> event);
 	void processChangedActiveFiltersOnCombinedFilters(std::shared_ptr<ViewEvent> event);
+	void processChangedCannyThresholds(std::shared_ptr<ViewEvent> event);
+	void processChangedGeometricWarp(std::shared_ptr<ViewEvent> event);
+	void processChangedQualityGovernor(std::shared_ptr<ViewEvent> event);
+	void processChangedRegionOfInterest(std::shared_ptr<ViewEvent> event);
+	void processAttachFrameSink(std::shared_ptr<ViewEvent> event);
+	void processDetachFrameSink(std::shared_ptr<ViewEvent> event);
 
 	void changeActiveCombinedFilters(FilterTypeEnum filterType, bool isActive);
 
 	enum class GPUMatTypesEnum
 	{
-		CamFrame,
-		GrayFrame,
-		GrayFrameRGB,
-		SobelFrame,
-		SobelGradXGpu,
-		SobelGradYGpu,
+		CamFrameUpload,
 		CurrentFiltersCombined
 	};
 
+	static constexpr size_t gpuMatTypesCount = static_cast<size_t>(GPUMatTypesEnum::CurrentFiltersCombined) + 1;
+
 	// Variables
-	WebcamView* parentView;
+	ViewEventQueue& viewEventQueue;
+	WorkerPool& workerPool;
+
+	// Every task this stream puts on the shared pool is scheduled on its own lane
+	int schedulingLane;
+	std::chrono::steady_clock::time_point lastFrameTime;
+	double frameIntervalSeconds;
+
+	// Sheds load when frames take longer than the frame interval, the resolution step changes the processing size
+	QualityGovernor qualityGovernor;
+	FrameTimeTracker frameTimeTracker;
+	cv::Size capturedFrameSize;
+	cv::Size processingFrameSize;
+	cv::Mat reducedCamFrame;
+
+	// Labelled with the scheduling lane
+	PipelineMetrics pipelineMetrics;
 
 	WebcamMats m_ControllersWebcamMats;
 	std::mutex m_WebcamMatsMutex;
-
-	cv::VideoCapture camCapture;
+	// Last version given to an output, guarded by m_WebcamMatsMutex
+	uint64_t outputVersionsCount;
+
+	// Only the ROI and the halo of the active filters are processed, the outputs above are that size.
+	// The presented outputs are the ROI itself, or the whole frame with the camera image passed through around the ROI.
+	bool regionOfInterestEnabled;
+	bool regionOfInterestCrops;
+	cv::Rect2d regionOfInterest;
+	cv::Mat uncroppedCamFrame;
+	cv::Mat passthroughLumaArea;
+	WebcamMats m_PresentedWebcamMats;
+
+	std::unique_ptr<FrameSource> frameSource;
 	cv::Mat currentCamFrame;
-
-	bool videoCaptureCanBeStarted;
+	// Sequence and capture time of currentCamFrame, outputs computed from it carry them
+	FrameStamp capturedFrameStamp;
+
+	// Lens and perspective correction, it also mirrors the frame so the GPU flip is skipped while enabled
+	GeometricWarpStage geometricWarpStage;
+	cv::Mat warpedCamFrame;
+
+	// Internal frame format, BGR is only rebuilt for outputs that display it
+	YuvFrame camFrameYuv;
+
+	// Only tiles that changed since the last frame are uploaded, filtered and downloaded
+	DirtyTileDetector dirtyTileDetector;
+	std::vector<cv::Rect> uploadRects;
+	std::vector<cv::Rect> changedRects;
+	bool fullFrameUpdate;
+
+	// Every output is computed by its stage, which holds the buffers of the output while it is active.
+	// Stateful CPU filters run on a downloaded copy of the flipped luma plane.
+	FilterTable<std::unique_ptr<FilterStage>> filterStages;
+	cv::Mat flippedLumaFrame;
+
+	// Only touched on the capture thread, sinks are attached and detached through events
+	std::vector<std::pair<FrameSinkSource, std::shared_ptr<FrameSink>>> frameSinks;
+	// An output scaled back to the captured size while the resolution step is active
+	cv::Mat scaledSinkFrame;
+
+	std::function<void()> newFrameCallback;
+	std::function<KernelTunings(const cv::Size&)> kernelTuningsProvider;
+	std::vector<FilterTypeEnum> prewarmFilters;
+	ThreadPlacement threadPlacement;
+	StartupTimeline startupTimeline;
 	std::jthread videoCaptureThread;
 
+	std::atomic<uint64_t> capturedFramesCount;
+	std::atomic<uint64_t> processedFramesCount;
+
 	int combinedFiltersCount;
 
-	std::unordered_map<GPUMatTypesEnum, cv::cuda::GpuMat> gpuMatsMap;
+	EnumTable<GPUMatTypesEnum, cv::cuda::GpuMat, gpuMatTypesCount> gpuMatsMap;
+
+	// Buffers of this stream by owner, a new output has to fit in the budget before it is allocated.
+	// The capture stage holds what every output shares, the upload, the YUV frame and the CPU luma.
+	MemoryAccount captureMemoryAccount;
+	MemoryAccount combinedMemoryAccount;
+	FilterTable<MemoryAccount> filterMemoryAccounts;
+	// Guarded by m_WebcamMatsMutex
+	RefusedOutputs refusedOutputs;
 };
 
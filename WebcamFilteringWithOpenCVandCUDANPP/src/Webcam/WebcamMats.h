@@ -1,10 +1,9 @@
 #pragma once
 
-#include <unordered_map>
-
 #include <opencv4/opencv2/core/mat.hpp>
 
-#include "Filters/FilterTypes.h"
+#include "Filters/FilterTraits.h"
+#include "Frames/FrameStamp.h"
 
 
 class WebcamMats
@@ -13,26 +12,30 @@ public:
 	WebcamMats() :
 		activeMatsCount(0)
 	{
-		m_filteredMatsMap = {
-			{ FilterTypeEnum::None, cv::Mat() },
-			{ FilterTypeEnum::Grayscale, cv::Mat() },
-			{ FilterTypeEnum::Sobel, cv::Mat() }
-		};
 	}
 
-	void copyTo(WebcamMats& other)
+	// Copies an output whose version or buffer differs from the other one, returns whether it was copied
+	static bool copyChangedMat(const cv::Mat& mat, const FrameStamp& frameStamp, cv::Mat& otherMat, const FrameStamp& otherFrameStamp)
 	{
-		other.activeMatsCount = activeMatsCount;
+		if (frameStamp.version == otherFrameStamp.version && mat.data == otherMat.data && mat.size() == otherMat.size())
+			return false;
 
-		for (auto& filterMat : m_filteredMatsMap)
-		{
-			other.m_filteredMatsMap.at(filterMat.first) = filterMat.second;
-		}
+		otherMat = mat;
+		return true;
+	}
 
-		other.currentFiltersCombinedMat = currentFiltersCombinedMat;
+	void copyFrameStampsTo(WebcamMats& other)
+	{
+		other.m_frameStampsMap = m_frameStampsMap;
+		other.combinedFrameStamp = combinedFrameStamp;
 	}
 
 	int activeMatsCount;
-	std::unordered_map<FilterTypeEnum, cv::Mat> m_filteredMatsMap;
+	// Every filter has an entry, empty while it is off
+	FilterTable<cv::Mat> m_filteredMatsMap;
 	cv::Mat currentFiltersCombinedMat;
+
+	// The frame each output above was computed from, copied as one block
+	FilterTable<FrameStamp> m_frameStampsMap;
+	FrameStamp combinedFrameStamp;
 };
\ No newline at end of file
@@ -1,37 +1,197 @@
 #include "WebcamView.h"
 
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <iostream>
 
 #include <imgui_impl_opengl3.h>
 #include <imgui_impl_sdl2.h>
 
+#include "Capture/FrameSourceFactory.h"
 #include "Events/ViewEvents/ActivateCombinedFilter.h"
+#include "Events/ViewEvents/AttachFrameSink.h"
+#include "Events/ViewEvents/ChangeCannyThresholds.h"
+#include "Events/ViewEvents/ChangeGeometricWarp.h"
+#include "Events/ViewEvents/ChangeQualityGovernor.h"
+#include "Events/ViewEvents/ChangeRegionOfInterest.h"
+#include "Events/ViewEvents/DetachFrameSink.h"
 #include "Events/ViewEvents/ViewChangeFilterEvents/ChangeActiveFilters.h"
 #include "Events/ViewEvents/ViewChangeFilterEvents/ChangeActiveFiltersOnCombinedFilter.h"
 
 
-WebcamView::WebcamView() :
-	m_WebcamController(WebcamController(this))
+namespace
 {
+	// Frames drawn after the last input or new frame, ImGui needs a few to settle hover and focus
+	constexpr int settleFramesCount = 3;
+	// An idle view still redraws now and then to refresh the statistics
+	constexpr Uint32 idleRefreshMilliseconds = 250;
+
+	std::string makeTimestampedPath(const std::string& prefix, const std::string& extension)
+	{
+		char timestamp[32];
+		std::time_t now = std::time(nullptr);
+		std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+
+		return prefix + timestamp + extension;
+	}
+}
+
+
+WebcamView::WebcamView(const SessionPlan& sessionPlan) :
+	m_WorkerPool(sessionPlan.getWorkerThreadsCount()),
+	m_AutoTuner(m_WorkerPool),
+	m_SelectedStreamIndex(0),
+	m_NewFramePending(false),
+	m_IdleFramesCount(0),
+	m_TextureMemoryAccount("view textures")
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	const SessionConfig& sessionConfig = sessionPlan.getConfig();
+	const ThreadPlacements& threadPlacements = sessionConfig.threadPlacements;
+
+	// The view renders on the thread that creates it
+	ThreadPlacementControl::applyToCurrentThread("render", threadPlacements.render.forThread(0, 1));
+	m_WorkerPool.setThreadPlacement(threadPlacements.workers);
+
+	MemoryBudget::getInstance().setLimit(sessionConfig.memoryBudgetBytes);
+
+	if (sessionConfig.metricsPort > 0 && m_MetricsHttpServer.start(static_cast<uint16_t>(sessionConfig.metricsPort)))
+		std::cout << "Serving metrics on http://127.0.0.1:" << sessionConfig.metricsPort << "/metrics\n";
+
+	for (const StreamPlan& streamPlan : sessionPlan.getStreams())
+	{
+		// Pre-recorded streams loop at the playback rate, the camera's by default
+		m_VideoStreams.push_back(std::make_unique<VideoStream>(streamPlan.sourceName, m_WorkerPool,
+			FrameSourceFactory::createFrameSource(streamPlan.sourceName, m_WorkerPool, &m_FrameBufferPool, sessionConfig.decodeScale,
+												  sessionConfig.repeatCount, sessionConfig.playbackFps, sessionConfig.captureSettings)));
+	}
+
+	double firstStreamFps = sessionPlan.getStreams().front().frameSourceProbe.framesPerSecond;
+	m_RecordingFps = firstStreamFps > 0.0 ? firstStreamFps : 30.0;
+
+	// The configured filters reach the controllers before their sources open, the buffers are allocated before the first frame
+	m_View_ActiveFiltersMap = FilterTable<bool>(false);
+	m_View_CombinedFilters = FilterTable<bool>(false);
+	m_View_CombinedFiltersActive = sessionConfig.combinedFilters.empty() == false;
+
+	for (FilterTypeEnum filterType : sessionConfig.filters)
+	{
+		m_View_ActiveFiltersMap[filterType] = true;
+
+		std::shared_ptr<ChangeActiveFilters> changeActiveFilters = std::make_shared<ChangeActiveFilters>();
+		changeActiveFilters->setActiveFilterType(filterType, true);
+
+		addEventToAllStreams(changeActiveFilters);
+	}
+
+	if (m_View_CombinedFiltersActive)
+	{
+		std::shared_ptr<ActivateCombinedFilter> activateCombinedFilter = std::make_shared<ActivateCombinedFilter>();
+		activateCombinedFilter->setActivateCombinedFilter(true);
+
+		addEventToAllStreams(activateCombinedFilter);
+	}
+
+	for (FilterTypeEnum filterType : sessionConfig.combinedFilters)
+	{
+		m_View_CombinedFilters[filterType] = true;
+
+		std::shared_ptr<ChangeActiveFiltersOnCombinedFilter> changeActiveFiltersOnCombinedFilter = std::make_shared<ChangeActiveFiltersOnCombinedFilter>();
+		changeActiveFiltersOnCombinedFilter->setActiveFilterTypeOnCombined(filterType, true);
+
+		addEventToAllStreams(changeActiveFiltersOnCombinedFilter);
+	}
+
+	m_View_CannyThresholds = sessionConfig.cannyThresholds;
+
+	std::shared_ptr<ChangeCannyThresholds> changeCannyThresholds = std::make_shared<ChangeCannyThresholds>();
+	changeCannyThresholds->setCannyThresholds(m_View_CannyThresholds);
+
+	addEventToAllStreams(changeCannyThresholds);
+
 	init();
 	initContents();
 
+	// Sources are still opening, the window does not wait for them
+	std::cout << "Window shown after " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms\n";
+
 	io = &ImGui::GetIO();
 	(void)&io;
 
 	// dynamic contents
 	gain = 1.0f;
 
-	m_WebcamController.startVideoCapture();
+	for (size_t i = 0; i < m_VideoStreams.size(); i++)
+	{
+		WebcamController& webcamController = m_VideoStreams[i]->getWebcamController();
 
-	m_View_CombinedFiltersActive = m_WebcamController.combinedFiltersActive;
-	m_View_ActiveFiltersMap = m_WebcamController.activeFiltersMap;
-	m_View_ActiveFiltersStrings = {
-		{ FilterTypeEnum::None, "None" },
-		{ FilterTypeEnum::Grayscale, "Grayscale" },
-		{ FilterTypeEnum::Sobel, "Sobel" }
-	};
-	m_View_CombinedFilters = m_WebcamController.combinedFilters;
+		// Streams of the same size share one calibration, the first one to open runs it
+		webcamController.setKernelTuningsProvider([this, tuneKernels = sessionConfig.tuneKernels](const cv::Size& frameSize)
+		{
+			return m_AutoTuner.getTunings(frameSize, tuneKernels);
+		});
+		webcamController.setPrewarmFilters(sessionConfig.prewarmFilters);
+		webcamController.setNewFrameCallback([this, i]() { onNewFrame(i); });
+		webcamController.setThreadPlacement(threadPlacements.capture.forThread(i, m_VideoStreams.size()));
+		webcamController.startVideoCapture();
+	}
+
+	m_View_GeometricWarpEnabled = false;
+	m_View_LensK1 = 0.0f;
+	m_View_LensK2 = 0.0f;
+	m_View_Keystone = 0.0f;
+
+	// Live sources cannot wait, every stream starts with the governor on
+	m_View_QualityGovernorEnabled = true;
+
+	std::shared_ptr<ChangeQualityGovernor> changeQualityGovernor = std::make_shared<ChangeQualityGovernor>();
+	changeQualityGovernor->setQualityGovernor(true, QualityGovernor::getDefaultLadder());
+
+	addEventToAllStreams(changeQualityGovernor);
+
+	m_View_RegionOfInterestEnabled = false;
+	m_View_RegionOfInterest = cv::Rect2d(0.0, 0.0, 1.0, 1.0);
+	m_View_RegionOfInterestCrop = false;
+	m_RegionOfInterestDragging = false;
+
+	m_StreamViewStates.assign(m_VideoStreams.size(), { m_View_CombinedFiltersActive, m_View_ActiveFiltersMap, m_View_CombinedFilters,
+													   m_View_CannyThresholds,
+													   m_View_GeometricWarpEnabled, m_View_LensK1, m_View_LensK2, m_View_Keystone,
+													   m_View_QualityGovernorEnabled,
+													   m_View_RegionOfInterestEnabled, m_View_RegionOfInterest, m_View_RegionOfInterestCrop });
+
+	for (auto& videoStream : m_VideoStreams)
+	{
+		m_StreamLatencyTrackers.push_back(std::make_unique<StreamLatencyTrackers>(std::to_string(videoStream->getWebcamController().getSchedulingLane())));
+	}
+
+	m_View_SinkSource = sessionConfig.sinkSource;
+	m_View_RecordingFormat = RecordingFormatEnum::Video;
+	m_View_ReplayActive = false;
+	m_View_SharedMemoryActive = sessionConfig.sharedMemoryName.empty() == false;
+	m_SharedMemoryName = m_View_SharedMemoryActive ? sessionConfig.sharedMemoryName : "/webcam_filters";
+	m_View_HttpStreamsActive = sessionConfig.httpPort != 0;
+	m_View_HttpPort = m_View_HttpStreamsActive ? sessionConfig.httpPort : 8080;
+
+	m_View_MemoryBudgetMegabytes = static_cast<int>(MemoryBudget::getInstance().getLimit() / (1024 * 1024));
+
+	// Configured sinks start with the view, the selected stream feeds them like the ones started by hand
+	if (!sessionConfig.recordingPath.empty())
+	{
+		m_View_RecordingFormat = RecordingSink::getFormatOfPath(sessionConfig.recordingPath);
+		startRecording(sessionConfig.recordingPath, m_View_RecordingFormat);
+	}
+
+	if (m_View_SharedMemoryActive)
+		onSharedMemoryClicked();
+
+	if (m_View_HttpStreamsActive)
+		onHttpStreamsClicked();
+
+	m_ConsoleCommandReader.addCommand("replay", [this](const std::string& path) { onSaveReplay(path); });
+	m_ConsoleCommandReader.start();
 }
 
 float WebcamView::getGain()
@@ -88,6 +248,8 @@ void WebcamView::init()
 	// Setup Platform/Renderer bindings
 	ImGui_ImplSDL2_InitForOpenGL(window, gl_context);
 	ImGui_ImplOpenGL3_Init(glsl_version);
+
+	m_NewFrameEventType = SDL_RegisterEvents(1);
 }
 
 void WebcamView::initContents()
@@ -98,6 +260,10 @@ void WebcamView::initContents()
 void WebcamView::exit()
 {
 	// Cleanup
+	// Capture threads stop waking the view, the textures go before the context
+	m_NewFramePending = true;
+	clearTextures();
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplSDL2_Shutdown();
 	ImGui::DestroyContext();
@@ -134,11 +300,21 @@ void WebcamView::showMainContents()
 		ImGuiWindowFlags_NoBringToFrontOnFocus;
 	ImGui::Begin("Main Contents", nullptr, mainContentsFlags);
 
+	applyRefusedOutputs();
+
+	addStreamSelector();
+
 	ImGui::SliderFloat("gain", &gain, 0.0f, 2.0f, "%.3f");
 
 	ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate,
 				ImGui::GetIO().Framerate);
 
+	ImGui::Text("Unchanged tiles: %.1f%%", getSelectedController().getTileSkipRatio() * 100.0);
+	ImGui::Text("Unchanged frames: %llu", static_cast<unsigned long long>(getSelectedController().getSkippedFramesCount()));
+
+	addStartupStats();
+	addLatencyStats();
+
 	addFiltersTable();
 
 	if (ImGui::Checkbox("Combine Filters", &m_View_CombinedFiltersActive))
@@ -146,9 +322,54 @@ void WebcamView::showMainContents()
 		onActivateCombinedFilterClicked();
 	}
 
+	addCannyControls();
+
+	addGeometricWarpControls();
+
+	addQualityGovernorControls();
+
+	addRegionOfInterestControls();
+
+	addOutputSinkControls();
+
+	addMemoryBudgetControls();
+
 	ImGui::End();
 }
 
+void WebcamView::addStreamSelector()
+{
+	if (m_VideoStreams.size() < 2)
+		return;
+
+	if (ImGui::BeginCombo("Stream", m_VideoStreams[m_SelectedStreamIndex]->getName().c_str()))
+	{
+		for (size_t i = 0; i < m_VideoStreams.size(); i++)
+		{
+			ImGui::PushID(static_cast<int>(i));
+
+			if (ImGui::Selectable(m_VideoStreams[i]->getName().c_str(), i == m_SelectedStreamIndex))
+			{
+				selectStream(i);
+			}
+
+			ImGui::PopID();
+		}
+
+		ImGui::EndCombo();
+	}
+
+	WorkerPoolLaneStats laneStats = m_WorkerPool.getLaneStats(getSelectedController().getSchedulingLane());
+	FrameBufferPoolStats frameBufferPoolStats = m_FrameBufferPool.getStats();
+
+	ImGui::Text("Worker time: %.1f s, late tasks: %llu", laneStats.busySeconds,
+				static_cast<unsigned long long>(laneStats.missedDeadlineTasksCount));
+	ImGui::Text("Frame buffers: %.1f / %.1f MB", frameBufferPoolStats.inUseBytes / (1024.0 * 1024.0),
+				frameBufferPoolStats.pooledBytes / (1024.0 * 1024.0));
+
+	ImGui::Separator();
+}
+
 void WebcamView::addFiltersTable()
 {
 	ImGui::BeginTable("Filters", 2, ImGuiTableFlags_BordersOuter);
@@ -158,9 +379,10 @@ void WebcamView::addFiltersTable()
 
 	ImGui::TableHeadersRow();
 
-	addFilterRow(FilterTypeEnum::None);
-	addFilterRow(FilterTypeEnum::Grayscale);
-	addFilterRow(FilterTypeEnum::Sobel);
+	for (FilterTypeEnum filterType : allFilterTypes)
+	{
+		addFilterRow(filterType);
+	}
 
 	ImGui::EndTable();
 }
@@ -173,7 +395,7 @@ void WebcamView::addFilterRow(FilterTypeEnum filterType)
 	ImGui::PushID((int)filterType);
 
 	bool& activeFilter = m_View_ActiveFiltersMap.at(filterType);
-	if (ImGui::Checkbox(m_View_ActiveFiltersStrings.at(filterType).c_str(), &activeFilter))
+	if (ImGui::Checkbox(getFilterTraits(filterType).label, &activeFilter))
 	{
 		onActiveFilterComboboxClicked(filterType, activeFilter);
 	}
@@ -192,12 +414,436 @@ void WebcamView::addFilterRow(FilterTypeEnum filterType)
 	ImGui::PopID();
 }
 
+void WebcamView::addCannyControls()
+{
+	if (!m_View_ActiveFiltersMap[FilterTypeEnum::Canny])
+		return;
+
+	// Only the suppression and the hysteresis see the thresholds, a new value applies from the next frame
+	if (ImGui::DragIntRange2("Canny Thresholds", &m_View_CannyThresholds.low, &m_View_CannyThresholds.high, 1.0f, 0, 2040))
+	{
+		onCannyThresholdsChanged();
+	}
+}
+
+void WebcamView::addGeometricWarpControls()
+{
+	if (ImGui::Checkbox("Lens Correction", &m_View_GeometricWarpEnabled))
+	{
+		onGeometricWarpChanged();
+	}
+
+	if (!m_View_GeometricWarpEnabled)
+		return;
+
+	// Every new value builds a remap table, so it is only sent once the slider is released
+	ImGui::SliderFloat("k1", &m_View_LensK1, -0.5f, 0.5f, "%.3f");
+	if (ImGui::IsItemDeactivatedAfterEdit())
+		onGeometricWarpChanged();
+
+	ImGui::SliderFloat("k2", &m_View_LensK2, -0.2f, 0.2f, "%.3f");
+	if (ImGui::IsItemDeactivatedAfterEdit())
+		onGeometricWarpChanged();
+
+	ImGui::SliderFloat("Keystone", &m_View_Keystone, -0.5f, 0.5f, "%.3f");
+	if (ImGui::IsItemDeactivatedAfterEdit())
+		onGeometricWarpChanged();
+}
+
+void WebcamView::addQualityGovernorControls()
+{
+	if (ImGui::Checkbox("Adaptive Quality", &m_View_QualityGovernorEnabled))
+	{
+		onQualityGovernorClicked();
+	}
+
+	if (!m_View_QualityGovernorEnabled)
+		return;
+
+	const QualityGovernor& qualityGovernor = getSelectedController().getQualityGovernor();
+
+	ImGui::Text("Quality level: %d / %d, load %.0f%%", qualityGovernor.getLevel(), qualityGovernor.getLevelsCount() - 1,
+				qualityGovernor.getLoadRatio() * 100.0);
+}
+
+// Times are from the creation of the stream, the filtered frame only comes once a filter is on
+void WebcamView::addStartupStats()
+{
+	const StartupTimeline& startupTimeline = getSelectedController().getStartupTimeline();
+
+	if (!startupTimeline.isReached(StartupStageEnum::FirstFrame))
+	{
+		ImGui::Text("Opening the source...");
+		return;
+	}
+
+	ImGui::Text("First frame: %.0f ms", startupTimeline.getSeconds(StartupStageEnum::FirstFrame) * 1000.0);
+
+	if (startupTimeline.isReached(StartupStageEnum::FirstFilteredFrame))
+		ImGui::Text("First filtered frame: %.0f ms", startupTimeline.getSeconds(StartupStageEnum::FirstFilteredFrame) * 1000.0);
+	else if (!startupTimeline.isReached(StartupStageEnum::Prewarmed))
+		ImGui::Text("Prewarming...");
+}
+
+void WebcamView::addLatencyStats()
+{
+	StreamLatencyTrackers& streamLatencyTrackers = *m_StreamLatencyTrackers[m_SelectedStreamIndex];
+
+	for (const auto& filteredMat : m_ViewsWebcamMats.m_filteredMatsMap)
+	{
+		if (filteredMat.second.empty())
+			continue;
+
+		FrameLatencyStats frameLatencyStats = streamLatencyTrackers.getFilterTracker(filteredMat.first).getStats();
+
+		ImGui::Text("%s latency: %.1f / %.1f ms, %llu unshown", getFilterTraits(filteredMat.first).label,
+					frameLatencyStats.p50Seconds * 1000.0, frameLatencyStats.p99Seconds * 1000.0,
+					static_cast<unsigned long long>(frameLatencyStats.unpresentedFramesCount));
+	}
+
+	if (m_ViewsWebcamMats.currentFiltersCombinedMat.empty() == false)
+	{
+		FrameLatencyStats frameLatencyStats = streamLatencyTrackers.getCombinedTracker().getStats();
+
+		ImGui::Text("Combined latency: %.1f / %.1f ms, %llu unshown", frameLatencyStats.p50Seconds * 1000.0, frameLatencyStats.p99Seconds * 1000.0,
+					static_cast<unsigned long long>(frameLatencyStats.unpresentedFramesCount));
+	}
+}
+
+void WebcamView::addMemoryBudgetControls()
+{
+	ImGui::Separator();
+
+	MemoryBudget& memoryBudget = MemoryBudget::getInstance();
+
+	// 0 is unlimited
+	if (ImGui::InputInt("Memory Budget (MB)", &m_View_MemoryBudgetMegabytes, 64, 256))
+	{
+		m_View_MemoryBudgetMegabytes = std::max(m_View_MemoryBudgetMegabytes, 0);
+		memoryBudget.setLimit(static_cast<size_t>(m_View_MemoryBudgetMegabytes) * 1024 * 1024);
+	}
+
+	MemoryBudgetStats memoryBudgetStats = memoryBudget.getStats();
+
+	ImGui::Text("Memory: %.1f MB, peak %.1f MB, %llu refused", memoryBudgetStats.usedBytes / (1024.0 * 1024.0),
+				memoryBudgetStats.peakBytes / (1024.0 * 1024.0), static_cast<unsigned long long>(memoryBudgetStats.refusedCount));
+
+	if (m_View_RefusedOutput.empty() == false)
+		ImGui::Text("Over budget: %s", m_View_RefusedOutput.c_str());
+
+	if (!ImGui::TreeNode("Memory by Owner"))
+		return;
+
+	ImGui::BeginTable("Memory", 3, ImGuiTableFlags_BordersOuter);
+
+	ImGui::TableSetupColumn("Owner");
+	ImGui::TableSetupColumn("MB");
+	ImGui::TableSetupColumn("Peak MB");
+
+	ImGui::TableHeadersRow();
+
+	for (const MemoryOwnerUsage& ownerUsage : memoryBudgetStats.owners)
+	{
+		if (ownerUsage.peakBytes == 0)
+			continue;
+
+		std::string ownerName = ownerUsage.stream.empty() ? ownerUsage.owner : "Lane " + ownerUsage.stream + " " + ownerUsage.owner;
+
+		ImGui::TableNextRow();
+		ImGui::TableSetColumnIndex(0);
+		ImGui::TextUnformatted(ownerName.c_str());
+		ImGui::TableSetColumnIndex(1);
+		ImGui::Text("%.1f", ownerUsage.currentBytes / (1024.0 * 1024.0));
+		ImGui::TableSetColumnIndex(2);
+		ImGui::Text("%.1f", ownerUsage.peakBytes / (1024.0 * 1024.0));
+	}
+
+	ImGui::EndTable();
+	ImGui::TreePop();
+}
+
+// Refused outputs were never allocated, their boxes are unticked again
+void WebcamView::applyRefusedOutputs()
+{
+	RefusedOutputs refusedOutputs = getSelectedController().takeRefusedOutputs();
+
+	for (FilterTypeEnum filterType : refusedOutputs.filters)
+	{
+		m_View_ActiveFiltersMap.at(filterType) = false;
+		m_View_RefusedOutput = getFilterTraits(filterType).label;
+	}
+
+	for (FilterTypeEnum filterType : refusedOutputs.combinedFilters)
+	{
+		m_View_CombinedFilters.at(filterType) = false;
+		m_View_RefusedOutput = std::string(getFilterTraits(filterType).label) + " in Combined";
+	}
+
+	if (refusedOutputs.combinedFrame)
+	{
+		m_View_CombinedFiltersActive = false;
+		m_View_RefusedOutput = "Combined";
+	}
+}
+
+void WebcamView::addRegionOfInterestControls()
+{
+	if (!m_View_RegionOfInterestEnabled)
+	{
+		ImGui::Text("Drag on an output to select a ROI");
+		return;
+	}
+
+	ImGui::Text("ROI: %.0f%% of the frame", m_View_RegionOfInterest.area() * 100.0);
+
+	if (ImGui::Checkbox("Crop to ROI", &m_View_RegionOfInterestCrop))
+	{
+		onRegionOfInterestChanged();
+	}
+
+	if (ImGui::Button("Clear ROI"))
+	{
+		m_View_RegionOfInterestEnabled = false;
+		onRegionOfInterestChanged();
+	}
+}
+
+// Called right after an output image, dragging on it selects the ROI and a right click clears it
+void WebcamView::handleRegionOfInterestDrag()
+{
+	ImVec2 imageMin = ImGui::GetItemRectMin();
+	ImVec2 imageMax = ImGui::GetItemRectMax();
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+	if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+	{
+		m_RegionOfInterestDragging = true;
+		m_RegionOfInterestDragStart = ImGui::GetMousePos();
+		m_RegionOfInterestDragImageMin = imageMin;
+		m_RegionOfInterestDragImageMax = imageMax;
+	}
+
+	if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Right) && m_View_RegionOfInterestEnabled)
+	{
+		m_View_RegionOfInterestEnabled = false;
+		onRegionOfInterestChanged();
+	}
+
+	bool isDraggedImage = m_RegionOfInterestDragging
+		&& imageMin.x == m_RegionOfInterestDragImageMin.x && imageMin.y == m_RegionOfInterestDragImageMin.y;
+
+	if (!isDraggedImage)
+	{
+		if (m_View_RegionOfInterestEnabled && !m_View_RegionOfInterestCrop)
+		{
+			float imageWidth = imageMax.x - imageMin.x;
+			float imageHeight = imageMax.y - imageMin.y;
+
+			drawList->AddRect(ImVec2(imageMin.x + static_cast<float>(m_View_RegionOfInterest.x) * imageWidth,
+									 imageMin.y + static_cast<float>(m_View_RegionOfInterest.y) * imageHeight),
+							  ImVec2(imageMin.x + static_cast<float>(m_View_RegionOfInterest.br().x) * imageWidth,
+									 imageMin.y + static_cast<float>(m_View_RegionOfInterest.br().y) * imageHeight),
+							  IM_COL32(255, 255, 0, 255));
+		}
+
+		return;
+	}
+
+	ImVec2 mousePos = ImGui::GetMousePos();
+	mousePos.x = std::clamp(mousePos.x, imageMin.x, imageMax.x);
+	mousePos.y = std::clamp(mousePos.y, imageMin.y, imageMax.y);
+
+	ImVec2 selectionMin(std::min(mousePos.x, m_RegionOfInterestDragStart.x), std::min(mousePos.y, m_RegionOfInterestDragStart.y));
+	ImVec2 selectionMax(std::max(mousePos.x, m_RegionOfInterestDragStart.x), std::max(mousePos.y, m_RegionOfInterestDragStart.y));
+
+	drawList->AddRect(selectionMin, selectionMax, IM_COL32(255, 255, 0, 255));
+
+	if (!ImGui::IsMouseReleased(ImGuiMouseButton_Left))
+		return;
+
+	m_RegionOfInterestDragging = false;
+
+	// A click without a drag selects nothing
+	if (selectionMax.x - selectionMin.x < 8.0f || selectionMax.y - selectionMin.y < 8.0f)
+		return;
+
+	double imageWidth = imageMax.x - imageMin.x;
+	double imageHeight = imageMax.y - imageMin.y;
+
+	cv::Rect2d selection((selectionMin.x - imageMin.x) / imageWidth, (selectionMin.y - imageMin.y) / imageHeight,
+						 (selectionMax.x - selectionMin.x) / imageWidth, (selectionMax.y - selectionMin.y) / imageHeight);
+
+	// A cropped output only shows the current ROI
+	if (m_View_RegionOfInterestEnabled && m_View_RegionOfInterestCrop)
+	{
+		selection = cv::Rect2d(m_View_RegionOfInterest.x + selection.x * m_View_RegionOfInterest.width,
+							   m_View_RegionOfInterest.y + selection.y * m_View_RegionOfInterest.height,
+							   selection.width * m_View_RegionOfInterest.width,
+							   selection.height * m_View_RegionOfInterest.height);
+	}
+
+	m_View_RegionOfInterest = selection;
+	m_View_RegionOfInterestEnabled = true;
+
+	onRegionOfInterestChanged();
+}
+
+// Recording and instant replay take the output selected when they are started
+void WebcamView::addOutputSinkControls()
+{
+	ImGui::Separator();
+
+	const char* sinkSourceName = m_View_SinkSource.combined ?
+		"Combined" : getFilterTraits(m_View_SinkSource.filterType).label;
+
+	if (ImGui::BeginCombo("Output", sinkSourceName))
+	{
+		for (const FilterTraits& filterTraits : filterTraitsList)
+		{
+			bool isSelected = !m_View_SinkSource.combined && m_View_SinkSource.filterType == filterTraits.filterType;
+			if (ImGui::Selectable(filterTraits.label, isSelected))
+			{
+				m_View_SinkSource.combined = false;
+				m_View_SinkSource.filterType = filterTraits.filterType;
+			}
+		}
+
+		if (ImGui::Selectable("Combined", m_View_SinkSource.combined))
+		{
+			m_View_SinkSource.combined = true;
+		}
+
+		ImGui::EndCombo();
+	}
+
+	addRecordingControls();
+	addReplayControls();
+	addSharedMemoryControls();
+	addHttpStreamControls();
+}
+
+void WebcamView::addRecordingControls()
+{
+	if (m_RecordingSink != nullptr)
+	{
+		RecordingStats recordingStats = m_RecordingSink->getStats();
+
+		ImGui::Text("Recording %s", m_RecordingSink->getPath().c_str());
+		ImGui::Text("Queue: %zu / %zu", recordingStats.queuedFramesCount, recordingStats.maxQueuedFramesCount);
+		ImGui::Text("Written: %llu, dropped: %llu",
+					static_cast<unsigned long long>(recordingStats.writtenFramesCount),
+					static_cast<unsigned long long>(recordingStats.droppedFramesCount));
+		ImGui::Text("Writer: %.1f fps, %.1f MB/s", recordingStats.writeFramesPerSecond, recordingStats.writeMegabytesPerSecond);
+
+		if (ImGui::Button("Stop Recording"))
+		{
+			onStopRecordingClicked();
+		}
+
+		return;
+	}
+
+	const std::pair<RecordingFormatEnum, const char*> recordingFormats[] =
+	{
+		{ RecordingFormatEnum::Video, "MJPEG (AVI)" },
+		{ RecordingFormatEnum::Y4m, "Lossless (Y4M)" },
+		{ RecordingFormatEnum::RawFrames, "Captured Raw Frames" }
+	};
+
+	const char* recordingFormatName = recordingFormats[static_cast<size_t>(m_View_RecordingFormat)].second;
+
+	if (ImGui::BeginCombo("Format", recordingFormatName))
+	{
+		for (const auto& recordingFormat : recordingFormats)
+		{
+			if (ImGui::Selectable(recordingFormat.second, recordingFormat.first == m_View_RecordingFormat))
+				m_View_RecordingFormat = recordingFormat.first;
+		}
+
+		ImGui::EndCombo();
+	}
+
+	if (ImGui::Button("Start Recording"))
+	{
+		onStartRecordingClicked();
+	}
+}
+
+void WebcamView::addReplayControls()
+{
+	if (ImGui::Checkbox("Instant Replay", &m_View_ReplayActive))
+	{
+		onReplayClicked();
+	}
+
+	std::shared_ptr<ReplayBufferSink> replaySink;
+	{
+		std::lock_guard<std::mutex> lock(m_ReplaySinkMutex);
+		replaySink = m_ReplaySink;
+	}
+
+	if (replaySink == nullptr)
+		return;
+
+	ReplayStats replayStats = replaySink->getStats();
+
+	ImGui::Text("Buffered: %.1f s, %zu frames, %.1f MB", replayStats.bufferedSeconds, replayStats.bufferedFramesCount,
+				replayStats.bufferedBytes / (1024.0 * 1024.0));
+	ImGui::Text("Dropped: %llu", static_cast<unsigned long long>(replayStats.droppedFramesCount));
+
+	if (replayStats.dumpInProgress)
+	{
+		ImGui::Text("Saving replay...");
+	}
+	else if (ImGui::Button("Save Replay"))
+	{
+		onSaveReplay("");
+	}
+}
+
+void WebcamView::addSharedMemoryControls()
+{
+	if (ImGui::Checkbox("Shared Memory", &m_View_SharedMemoryActive))
+	{
+		onSharedMemoryClicked();
+	}
+
+	if (m_SharedMemorySink == nullptr)
+		return;
+
+	ImGui::Text("%s: %llu published, %llu dropped", m_SharedMemorySink->getName().c_str(),
+				static_cast<unsigned long long>(m_SharedMemorySink->getPublishedFramesCount()),
+				static_cast<unsigned long long>(m_SharedMemorySink->getDroppedFramesCount()));
+}
+
+void WebcamView::addHttpStreamControls()
+{
+	if (m_MjpegHttpServer == nullptr)
+		ImGui::InputInt("HTTP Port", &m_View_HttpPort);
+
+	if (ImGui::Checkbox("HTTP Streams", &m_View_HttpStreamsActive))
+	{
+		onHttpStreamsClicked();
+	}
+
+	if (m_MjpegHttpServer == nullptr)
+		return;
+
+	MjpegHttpStats mjpegHttpStats = m_MjpegHttpServer->getStats();
+
+	ImGui::Text("http://<host>:%d/", m_MjpegHttpServer->getPort());
+	ImGui::Text("Viewers: %zu, sent: %llu, skipped: %llu", mjpegHttpStats.clientsCount,
+				static_cast<unsigned long long>(mjpegHttpStats.sentFramesCount),
+				static_cast<unsigned long long>(mjpegHttpStats.skippedFramesCount));
+}
+
 void WebcamView::showFilters()
 {
-	m_WebcamController.getMats(m_ViewsWebcamMats);
+	getSelectedController().getMats(m_ViewsWebcamMats);
 
 	if (m_ViewsWebcamMats.activeMatsCount == 0)
 	{
+		clearTextures();
 		return;
 	}
 
@@ -217,45 +863,75 @@ void WebcamView::showFilters()
 
 	ImVec2 child_window_size = ImVec2(1280, 720);
 
-	m_FilteredTextures = std::vector<ImageTexture>(m_ViewsWebcamMats.activeMatsCount);
-	auto filteredTextureItr = m_FilteredTextures.begin();
-	for (auto& filteredMat : m_ViewsWebcamMats.m_filteredMatsMap)
+	for (const auto& filteredMat : m_ViewsWebcamMats.m_filteredMatsMap)
 	{
+		OutputTexture& filteredTexture = m_FilteredTextures[filteredMat.first];
+
 		if (filteredMat.second.empty())
+		{
+			filteredTexture.texture.release();
 			continue;
+		}
 
-		std::string& window_name = m_View_ActiveFiltersStrings.at(filteredMat.first);
+		const char* window_name = getFilterTraits(filteredMat.first).label;
 
-		filteredTextureItr->setImage(&filteredMat.second);
+		updateTexture(filteredTexture, filteredMat.second, m_ViewsWebcamMats.m_frameStampsMap.at(filteredMat.first));
 
-		ImGui::BeginChild(window_name.c_str(), child_window_size, true);
-		ImGui::Image((ImTextureID)(intptr_t)filteredTextureItr->getOpenglTexture(), filteredTextureItr->getSize());
+		ImGui::BeginChild(window_name, child_window_size, true);
+		ImGui::Image((ImTextureID)(intptr_t)filteredTexture.texture.getOpenglTexture(), filteredTexture.texture.getSize());
+		handleRegionOfInterestDrag();
 		ImGui::EndChild();
 
 		ImGui::SameLine();
-
-		filteredTextureItr++;
 	}
 
 	ImGui::End();
 
-	if (m_ViewsWebcamMats.currentFiltersCombinedMat.empty() == false)
+	if (m_ViewsWebcamMats.currentFiltersCombinedMat.empty())
 	{
-		m_CombinedTexture.setImage(&m_ViewsWebcamMats.currentFiltersCombinedMat);
+		m_CombinedTexture.texture.release();
+		return;
+	}
+
+	updateTexture(m_CombinedTexture, m_ViewsWebcamMats.currentFiltersCombinedMat, m_ViewsWebcamMats.combinedFrameStamp);
+
+	ImGui::SetNextWindowPos(ImVec2(m_mainContentsWidth, filtersHeight));
+	ImGui::SetNextWindowSize(filtersSize);
+
+	ImGui::Begin("Filters Combined", nullptr, filtersFlags);
+	ImGui::Image((ImTextureID)(intptr_t)m_CombinedTexture.texture.getOpenglTexture(), m_CombinedTexture.texture.getSize());
+	ImGui::End();
+}
+
+void WebcamView::updateTexture(OutputTexture& outputTexture, const cv::Mat& mat, const FrameStamp& frameStamp)
+{
+	if (outputTexture.texture.isBinded() && outputTexture.version == frameStamp.version)
+		return;
 
-		ImGui::SetNextWindowPos(ImVec2(m_mainContentsWidth, filtersHeight));
-		ImGui::SetNextWindowSize(filtersSize);
+	outputTexture.texture.setImage(&mat);
+	outputTexture.version = frameStamp.version;
+}
+
+void WebcamView::updateTextureMemoryAccount()
+{
+	size_t textureBytes = m_CombinedTexture.texture.getBytes();
 
-		ImGui::Begin("Filters Combined", nullptr, filtersFlags);
-		ImGui::Image((ImTextureID)(intptr_t)m_CombinedTexture.getOpenglTexture(), m_CombinedTexture.getSize());
-		ImGui::End();
+	for (const auto& filteredTexture : m_FilteredTextures)
+	{
+		textureBytes += filteredTexture.second.texture.getBytes();
 	}
+
+	m_TextureMemoryAccount.setBytes(textureBytes);
 }
 
 void WebcamView::clearTextures()
 {
-	m_FilteredTextures.clear();
-	m_CombinedTexture.release();
+	for (auto filteredTexture : m_FilteredTextures)
+	{
+		filteredTexture.second.texture.release();
+	}
+
+	m_CombinedTexture.texture.release();
 }
 
 void WebcamView::show()
@@ -268,10 +944,12 @@ void WebcamView::show()
 
 	showMainContents();
 	showFilters();
+	updateTextureMemoryAccount();
 
 	render();
 
-	clearTextures();
+	// The swap has returned, the frames drawn are on their way to the display
+	m_StreamLatencyTrackers[m_SelectedStreamIndex]->present(m_ViewsWebcamMats, std::chrono::steady_clock::now());
 }
 
 bool WebcamView::handleEvent()
@@ -280,6 +958,14 @@ bool WebcamView::handleEvent()
 	bool done = false;
 	while (SDL_PollEvent(&event))
 	{
+		m_IdleFramesCount = 0;
+
+		if (event.type == m_NewFrameEventType)
+		{
+			m_NewFramePending = false;
+			continue;
+		}
+
 		ImGui_ImplSDL2_ProcessEvent(&event);
 		if (event.type == SDL_QUIT) done = true;
 		if (event.type == SDL_WINDOWEVENT &&
@@ -290,24 +976,85 @@ bool WebcamView::handleEvent()
 	return done;
 }
 
+// Runs on the capture threads
+void WebcamView::onNewFrame(size_t streamIndex)
+{
+	if (streamIndex != m_SelectedStreamIndex || m_NewFramePending.exchange(true))
+		return;
+
+	SDL_Event event = {};
+	event.type = m_NewFrameEventType;
+	SDL_PushEvent(&event);
+}
+
 void WebcamView::startMainLoop()
 {
-	while (!handleEvent())
+	while (true)
 	{
+		// Instead of redrawing the same frame at the display rate, an idle view waits for input or a new frame
+		if (m_IdleFramesCount >= settleFramesCount)
+			SDL_WaitEventTimeout(nullptr, idleRefreshMilliseconds);
+
+		if (handleEvent())
+			break;
+
 		show();
+		m_IdleFramesCount++;
 	}
 
 	exit();
 }
 
+WebcamController& WebcamView::getSelectedController()
+{
+	return m_VideoStreams[m_SelectedStreamIndex]->getWebcamController();
+}
+
+void WebcamView::selectStream(size_t streamIndex)
+{
+	m_StreamViewStates[m_SelectedStreamIndex] = { m_View_CombinedFiltersActive, m_View_ActiveFiltersMap, m_View_CombinedFilters,
+												  m_View_CannyThresholds,
+												  m_View_GeometricWarpEnabled, m_View_LensK1, m_View_LensK2, m_View_Keystone,
+												  m_View_QualityGovernorEnabled,
+												  m_View_RegionOfInterestEnabled, m_View_RegionOfInterest, m_View_RegionOfInterestCrop };
+
+	const StreamViewState& streamViewState = m_StreamViewStates[streamIndex];
+
+	m_View_CombinedFiltersActive = streamViewState.combinedFiltersActive;
+	m_View_ActiveFiltersMap = streamViewState.activeFiltersMap;
+	m_View_CombinedFilters = streamViewState.combinedFilters;
+	m_View_CannyThresholds = streamViewState.cannyThresholds;
+	m_View_GeometricWarpEnabled = streamViewState.geometricWarpEnabled;
+	m_View_LensK1 = streamViewState.lensK1;
+	m_View_LensK2 = streamViewState.lensK2;
+	m_View_Keystone = streamViewState.keystone;
+	m_View_QualityGovernorEnabled = streamViewState.qualityGovernorEnabled;
+	m_View_RegionOfInterestEnabled = streamViewState.regionOfInterestEnabled;
+	m_View_RegionOfInterest = streamViewState.regionOfInterest;
+	m_View_RegionOfInterestCrop = streamViewState.regionOfInterestCrop;
+	m_RegionOfInterestDragging = false;
+
+	// Frames the stream produced while it was not shown are not missed frames
+	m_StreamLatencyTrackers[streamIndex]->restart();
+
+	// Versions are counted per stream, the textures of the other stream cannot be reused
+	m_ViewsWebcamMats = WebcamMats();
+	clearTextures();
+
+	m_SelectedStreamIndex = streamIndex;
+}
+
 void WebcamView::addEventToQueue(std::shared_ptr<ViewEvent> viewEvent)
 {
-	m_ViewEventQueue.pushViewEvent(viewEvent);
+	m_VideoStreams[m_SelectedStreamIndex]->getViewEventQueue().pushViewEvent(viewEvent);
 }
 
-std::shared_ptr<ViewEvent> WebcamView::getEventFromQueue()
+void WebcamView::addEventToAllStreams(std::shared_ptr<ViewEvent> viewEvent)
 {
-	return m_ViewEventQueue.popViewEvent();
+	for (auto& videoStream : m_VideoStreams)
+	{
+		videoStream->getViewEventQueue().pushViewEvent(viewEvent);
+	}
 }
 
 void WebcamView::onActivateCombinedFilterClicked()
@@ -333,3 +1080,194 @@ void WebcamView::onActiveFilterOnCombinedFilterComboboxClicked(const FilterTypeE
 
 	addEventToQueue(changeActiveFiltersOnCombinedFilter);
 }
+
+void WebcamView::onCannyThresholdsChanged()
+{
+	std::shared_ptr<ChangeCannyThresholds> changeCannyThresholds = std::make_shared<ChangeCannyThresholds>();
+	changeCannyThresholds->setCannyThresholds(m_View_CannyThresholds);
+
+	addEventToQueue(changeCannyThresholds);
+}
+
+void WebcamView::onGeometricWarpChanged()
+{
+	WarpParameters warpParameters;
+	warpParameters.k1 = m_View_LensK1;
+	warpParameters.k2 = m_View_LensK2;
+	warpParameters.setKeystone(m_View_Keystone);
+
+	std::shared_ptr<ChangeGeometricWarp> changeGeometricWarp = std::make_shared<ChangeGeometricWarp>();
+	changeGeometricWarp->setGeometricWarp(m_View_GeometricWarpEnabled, warpParameters);
+
+	addEventToQueue(changeGeometricWarp);
+}
+
+void WebcamView::onQualityGovernorClicked()
+{
+	std::shared_ptr<ChangeQualityGovernor> changeQualityGovernor = std::make_shared<ChangeQualityGovernor>();
+	changeQualityGovernor->setQualityGovernor(m_View_QualityGovernorEnabled, QualityGovernor::getDefaultLadder());
+
+	addEventToQueue(changeQualityGovernor);
+}
+
+void WebcamView::onRegionOfInterestChanged()
+{
+	std::shared_ptr<ChangeRegionOfInterest> changeRegionOfInterest = std::make_shared<ChangeRegionOfInterest>();
+	changeRegionOfInterest->setRegionOfInterest(m_View_RegionOfInterestEnabled, m_View_RegionOfInterest, m_View_RegionOfInterestCrop);
+
+	addEventToQueue(changeRegionOfInterest);
+}
+
+void WebcamView::onStartRecordingClicked()
+{
+	const char* extension = ".avi";
+	if (m_View_RecordingFormat == RecordingFormatEnum::Y4m)
+		extension = ".y4m";
+	else if (m_View_RecordingFormat == RecordingFormatEnum::RawFrames)
+		extension = ".rawframes";
+
+	startRecording(makeTimestampedPath("recording_", extension), m_View_RecordingFormat);
+}
+
+void WebcamView::startRecording(const std::string& recordingPath, RecordingFormatEnum recordingFormat)
+{
+	m_RecordingSink = std::make_shared<RecordingSink>(recordingPath, recordingFormat, m_RecordingFps);
+
+	// Raw frames record the camera as captured, to be replayed as a source
+	FrameSinkSource frameSinkSource = m_View_SinkSource;
+	frameSinkSource.captured = recordingFormat == RecordingFormatEnum::RawFrames;
+
+	std::shared_ptr<AttachFrameSink> attachFrameSink = std::make_shared<AttachFrameSink>();
+	attachFrameSink->setFrameSink(frameSinkSource, m_RecordingSink);
+
+	addEventToQueue(attachFrameSink);
+}
+
+void WebcamView::onStopRecordingClicked()
+{
+	std::shared_ptr<DetachFrameSink> detachFrameSink = std::make_shared<DetachFrameSink>();
+	detachFrameSink->setFrameSink(m_RecordingSink);
+
+	addEventToAllStreams(detachFrameSink);
+
+	// Writing the queued frames must not stall the view
+	m_WorkerPool.submit([recordingSink = std::move(m_RecordingSink)]() { recordingSink->stop(); });
+}
+
+void WebcamView::onReplayClicked()
+{
+	std::shared_ptr<FrameSink> frameSink;
+
+	{
+		std::lock_guard<std::mutex> lock(m_ReplaySinkMutex);
+
+		if (m_View_ReplayActive)
+		{
+			m_ReplaySink = std::make_shared<ReplayBufferSink>(m_WorkerPool);
+			frameSink = m_ReplaySink;
+		}
+		else
+		{
+			frameSink = std::move(m_ReplaySink);
+		}
+	}
+
+	if (m_View_ReplayActive)
+	{
+		std::shared_ptr<AttachFrameSink> attachFrameSink = std::make_shared<AttachFrameSink>();
+		attachFrameSink->setFrameSink(m_View_SinkSource, frameSink);
+
+		addEventToQueue(attachFrameSink);
+	}
+	else
+	{
+		std::shared_ptr<DetachFrameSink> detachFrameSink = std::make_shared<DetachFrameSink>();
+		detachFrameSink->setFrameSink(frameSink);
+
+		addEventToAllStreams(detachFrameSink);
+	}
+}
+
+// Runs on the view thread for the button and on the console thread for the "replay [path]" command
+void WebcamView::onSaveReplay(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(m_ReplaySinkMutex);
+
+	if (m_ReplaySink == nullptr)
+	{
+		std::cout << "Instant replay is not active\n";
+		return;
+	}
+
+	if (!m_ReplaySink->dump(path.empty() ? makeTimestampedPath("replay_", ".mjpeg") : path))
+		std::cout << "A replay is still being saved\n";
+}
+
+void WebcamView::onSharedMemoryClicked()
+{
+	if (m_View_SharedMemoryActive)
+	{
+		m_SharedMemorySink = std::make_shared<SharedMemorySink>(m_SharedMemoryName);
+
+		std::shared_ptr<AttachFrameSink> attachFrameSink = std::make_shared<AttachFrameSink>();
+		attachFrameSink->setFrameSink(m_View_SinkSource, m_SharedMemorySink);
+
+		addEventToQueue(attachFrameSink);
+	}
+	else
+	{
+		// The ring is removed once the controller lets go of the sink
+		std::shared_ptr<DetachFrameSink> detachFrameSink = std::make_shared<DetachFrameSink>();
+		detachFrameSink->setFrameSink(std::move(m_SharedMemorySink));
+
+		addEventToAllStreams(detachFrameSink);
+	}
+}
+
+void WebcamView::onHttpStreamsClicked()
+{
+	if (!m_View_HttpStreamsActive)
+	{
+		for (auto& mjpegHttpSink : m_MjpegHttpSinks)
+		{
+			std::shared_ptr<DetachFrameSink> detachFrameSink = std::make_shared<DetachFrameSink>();
+			detachFrameSink->setFrameSink(std::move(mjpegHttpSink));
+
+			addEventToAllStreams(detachFrameSink);
+		}
+
+		m_MjpegHttpSinks.clear();
+
+		// Sinks still attached until their detach event is processed keep publishing to a stopped server
+		m_MjpegHttpServer->stop();
+		m_MjpegHttpServer = nullptr;
+		return;
+	}
+
+	m_MjpegHttpServer = std::make_shared<MjpegHttpServer>();
+	if (!m_MjpegHttpServer->start(static_cast<uint16_t>(m_View_HttpPort)))
+	{
+		m_MjpegHttpServer = nullptr;
+		m_View_HttpStreamsActive = false;
+		return;
+	}
+
+	std::vector<FrameSinkSource> frameSinkSources;
+	for (FilterTypeEnum filterType : allFilterTypes)
+	{
+		frameSinkSources.push_back({ false, filterType });
+	}
+	frameSinkSources.push_back({ true, FilterTypeEnum::None });
+
+	for (const FrameSinkSource& frameSinkSource : frameSinkSources)
+	{
+		auto mjpegHttpSink = std::make_shared<MjpegHttpSink>(m_MjpegHttpServer, m_WorkerPool, MjpegHttpSink::getStreamName(frameSinkSource));
+
+		std::shared_ptr<AttachFrameSink> attachFrameSink = std::make_shared<AttachFrameSink>();
+		attachFrameSink->setFrameSink(frameSinkSource, mjpegHttpSink);
+
+		addEventToQueue(attachFrameSink);
+
+		m_MjpegHttpSinks.push_back(std::move(mjpegHttpSink));
+	}
+}
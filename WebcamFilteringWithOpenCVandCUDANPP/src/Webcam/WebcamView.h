@@ -1,34 +1,53 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <SDL2/SDL.h>
 
-#include "EventQueues/ViewEventQueue.h"
+#include "Control/ConsoleCommandReader.h"
+#include "Frames/FrameBufferPool.h"
+#include "Frames/MemoryBudget.h"
+#include "Metrics/FrameLatencyTracker.h"
+#include "Network/MetricsHttpServer.h"
+#include "Output/RecordingSink.h"
+#include "Output/MjpegHttpSink.h"
+#include "Output/ReplayBufferSink.h"
+#include "Output/SharedMemorySink.h"
+#include "Session/SessionPlan.h"
+#include "Streams/VideoStream.h"
 #include "Texture/ImageTexture.h"
-#include "WebcamController.h"
+#include "Threading/ThreadPlacement.h"
+#include "Threading/WorkerPool.h"
+#include "Tuning/AutoTuner.h"
 
 
 class WebcamView
 {
-	friend class WebcamController;
-
 public:
-	WebcamView();
+	// Every stream of the plan is shown, the configured filters, combined frame and sinks are on from the start.
+	// A metrics port serves the Prometheus endpoint on the loopback interface.
+	// CPU kernels run with the tunings cached for the machine and capture size, unless the plan tunes them again.
+	// The thread placements pin the capture threads, the worker pool and the thread running the view.
+	// Sources open in the background, the prewarm filters get their buffers before the first frame.
+	explicit WebcamView(const SessionPlan& sessionPlan);
 
 	void startMainLoop();
 
-protected:
-	std::shared_ptr<ViewEvent> getEventFromQueue();
-
 private:
 	void init();
 	void initContents();
 	void render();
 
 	void showMainContents();
+	void addStreamSelector();
 	void showFilters();
 	void clearTextures();
 
 	bool handleEvent();
+	void onNewFrame(size_t streamIndex);
 
 	void show();
 	void exit();
@@ -37,12 +56,43 @@ private:
 	void addFiltersTable();
 	void addFilterRow(FilterTypeEnum filterType);
 
+	void addCannyControls();
+	void addGeometricWarpControls();
+	void addQualityGovernorControls();
+	void addLatencyStats();
+	void addStartupStats();
+	void addMemoryBudgetControls();
+	void applyRefusedOutputs();
+	void addRegionOfInterestControls();
+	void handleRegionOfInterestDrag();
+	void addOutputSinkControls();
+	void addRecordingControls();
+	void addReplayControls();
+	void addSharedMemoryControls();
+	void addHttpStreamControls();
+
+	WebcamController& getSelectedController();
+	void selectStream(size_t streamIndex);
+
 	void addEventToQueue(std::shared_ptr<ViewEvent> viewEvent);
+	// A sink is detached from whichever stream it was attached to
+	void addEventToAllStreams(std::shared_ptr<ViewEvent> viewEvent);
 
 	// Event functions
 	void onActivateCombinedFilterClicked();
 	void onActiveFilterComboboxClicked(const FilterTypeEnum& filterType, const bool& isActive);
 	void onActiveFilterOnCombinedFilterComboboxClicked(const FilterTypeEnum& filterType, const bool& isAdded);
+	void onCannyThresholdsChanged();
+	void onGeometricWarpChanged();
+	void onQualityGovernorClicked();
+	void onRegionOfInterestChanged();
+	void onStartRecordingClicked();
+	void startRecording(const std::string& recordingPath, RecordingFormatEnum recordingFormat);
+	void onStopRecordingClicked();
+	void onReplayClicked();
+	void onSaveReplay(const std::string& path);
+	void onSharedMemoryClicked();
+	void onHttpStreamsClicked();
 
 	// View Variables
 	SDL_Window* window;
@@ -57,20 +107,113 @@ private:
 	float gain;
 
 	// Controller Variables
-	ViewEventQueue m_ViewEventQueue;
+	WorkerPool m_WorkerPool;
+	FrameBufferPool m_FrameBufferPool;
+	AutoTuner m_AutoTuner;
+
+	std::vector<std::unique_ptr<VideoStream>> m_VideoStreams;
+	// Read by the capture threads to wake the view for the selected stream only
+	std::atomic<size_t> m_SelectedStreamIndex;
+
+	// Pushed by a capture thread when the selected stream has new pixels, at most one is queued at a time.
+	// The view sleeps until one arrives, or input, once nothing changed for a few frames.
+	Uint32 m_NewFrameEventType;
+	std::atomic<bool> m_NewFramePending;
+	int m_IdleFramesCount;
+
+	// Filter and warp settings of every stream, the m_View_ copies below belong to the selected one
+	struct StreamViewState
+	{
+		bool combinedFiltersActive;
+		FilterTable<bool> activeFiltersMap;
+		FilterTable<bool> combinedFilters;
 
-	WebcamController m_WebcamController;
+		CannyThresholds cannyThresholds;
+
+		bool geometricWarpEnabled;
+		float lensK1;
+		float lensK2;
+		float keystone;
+
+		bool qualityGovernorEnabled;
+
+		bool regionOfInterestEnabled;
+		cv::Rect2d regionOfInterest;
+		bool regionOfInterestCrop;
+	};
+
+	std::vector<StreamViewState> m_StreamViewStates;
 
 	WebcamMats m_ViewsWebcamMats;
 
+	// Capture to SDL_GL_SwapWindow, only the selected stream is presented
+	std::vector<std::unique_ptr<StreamLatencyTrackers>> m_StreamLatencyTrackers;
+
 	bool m_View_CombinedFiltersActive;
 
-	std::unordered_map<FilterTypeEnum, bool> m_View_ActiveFiltersMap;
-	std::unordered_map<FilterTypeEnum, std::string> m_View_ActiveFiltersStrings;
+	FilterTable<bool> m_View_ActiveFiltersMap;
+	FilterTable<bool> m_View_CombinedFilters;
+
+	CannyThresholds m_View_CannyThresholds;
+
+	bool m_View_GeometricWarpEnabled;
+	float m_View_LensK1;
+	float m_View_LensK2;
+	float m_View_Keystone;
+
+	bool m_View_QualityGovernorEnabled;
+
+	// Relative to the uncropped output, dragging on a cropped output selects inside the current ROI
+	bool m_View_RegionOfInterestEnabled;
+	cv::Rect2d m_View_RegionOfInterest;
+	bool m_View_RegionOfInterestCrop;
+
+	bool m_RegionOfInterestDragging;
+	ImVec2 m_RegionOfInterestDragStart;
+	ImVec2 m_RegionOfInterestDragImageMin;
+	ImVec2 m_RegionOfInterestDragImageMax;
+
+	FrameSinkSource m_View_SinkSource;
+	RecordingFormatEnum m_View_RecordingFormat;
+	std::shared_ptr<RecordingSink> m_RecordingSink;
+	// Rate of the first stream, pre-recorded streams unpaced are recorded at 30 fps
+	double m_RecordingFps;
+
+	// Also used by the console command thread
+	bool m_View_ReplayActive;
+	std::mutex m_ReplaySinkMutex;
+	std::shared_ptr<ReplayBufferSink> m_ReplaySink;
+
+	bool m_View_SharedMemoryActive;
+	std::string m_SharedMemoryName;
+	std::shared_ptr<SharedMemorySink> m_SharedMemorySink;
+
+	// Every output is served, the sinks only encode for outputs someone watches
+	bool m_View_HttpStreamsActive;
+	int m_View_HttpPort;
+	std::shared_ptr<MjpegHttpServer> m_MjpegHttpServer;
+	std::vector<std::shared_ptr<MjpegHttpSink>> m_MjpegHttpSinks;
+
+	ConsoleCommandReader m_ConsoleCommandReader;
+
+	MetricsHttpServer m_MetricsHttpServer;
+
+	// Kept between frames, an output is uploaded again only when its version changed
+	struct OutputTexture
+	{
+		ImageTexture texture;
+		uint64_t version = 0;
+	};
+
+	void updateTexture(OutputTexture& outputTexture, const cv::Mat& mat, const FrameStamp& frameStamp);
+	void updateTextureMemoryAccount();
 
-	std::unordered_map<FilterTypeEnum, bool> m_View_CombinedFilters;
+	FilterTable<OutputTexture> m_FilteredTextures;
+	OutputTexture m_CombinedTexture;
+	MemoryAccount m_TextureMemoryAccount;
 
-	std::vector<ImageTexture> m_FilteredTextures;
-	ImageTexture m_CombinedTexture;
+	// Changes apply to outputs turned on later, a refused output is unticked again and named here
+	int m_View_MemoryBudgetMegabytes;
+	std::string m_View_RefusedOutput;
 };
 
@@ -1,8 +1,27 @@
 ﻿#define SDL_MAIN_HANDLED
+#include "Headless/HeadlessRunner.h"
+#include "Offline/OfflineTranscoder.h"
+#include "Session/SessionPlan.h"
 #include "Webcam/WebcamView.h"
 
+#include <iostream>
+#include <string>
+#include <vector>
+
 int main(int argc, char* argv[])
 {
+	if (argc > 1 && std::string(argv[1]) == "--headless")
+	{
+		HeadlessRunner headlessRunner(argc, argv);
+		return headlessRunner.run();
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--transcode")
+	{
+		OfflineTranscoder offlineTranscoder(argc, argv);
+		return offlineTranscoder.run();
+	}
+
 	// return memcpyTutorialFunction();
 
 	// return convertImageTutorialFunction();
@@ -13,7 +32,67 @@ int main(int argc, char* argv[])
 
 	worker.join();*/
 
-	WebcamView gui;
+	// --config session.yml reads the session settings, arguments given after it override them
+	// --plan prints the streams, buffers and per-frame traffic the session would use and exits
+	// --sources 0,1,clip.mjpeg opens one stream per camera index or MJPEG file
+	// --camera-size 1920x1080 --camera-fps 30 --fourcc YUYV --capture-backend v4l2 sets the camera mode
+	// --affinity, --priority and --numa place the capture, worker and render threads, e.g. --affinity workers=4-15
+	// --memory-budget 512 refuses outputs that would take the frame buffers past 512 MB
+	SessionConfig sessionConfig;
+	std::vector<std::string> errors;
+	bool printPlan = false;
+
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (std::string(argv[i]) == "--config")
+			sessionConfig.loadFile(argv[++i], errors);
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--config" && hasValue)
+			i++;
+		else if (argument == "--plan")
+			printPlan = true;
+		else if (SessionConfig::isFlagArgument(argument))
+			sessionConfig.parseArgument(argument, "", errors);
+		else if (!hasValue || !sessionConfig.parseArgument(argument, argv[++i], errors))
+			errors.push_back("Unknown argument " + argument);
+	}
+
+	if (sessionConfig.sources.empty())
+		sessionConfig.sources.push_back("0");
+
+	SessionPlan sessionPlan;
+	if (errors.empty())
+		SessionPlan::compile(sessionConfig, sessionPlan, errors);
+
+	if (errors.empty() == false)
+	{
+		for (const std::string& error : errors)
+		{
+			std::cout << "Error: " << error << "\n";
+		}
+
+		std::cout << SessionConfig::getUsage();
+		return 1;
+	}
+
+	if (printPlan)
+	{
+		sessionPlan.print(std::cout);
+		return 0;
+	}
+
+	for (const std::string& warning : sessionPlan.getWarnings())
+	{
+		std::cout << "Warning: " << warning << "\n";
+	}
+
+	WebcamView gui(sessionPlan);
 	gui.startMainLoop();
 
 	return 0;